@@ -0,0 +1,219 @@
+// Alert scheduling: start_next + advance cost per alert with four lanes
+// cycling, plus lane allocation, the single media lane, arrival order
+// behind an event waiting for it, lanes taken away while alerts play and
+// durations from media.
+//
+//   bench_alert_scheduler [--check]
+
+#include <string>
+#include <vector>
+
+#include "alert_scheduler.hpp"
+#include "bench_util.hpp"
+
+namespace {
+
+constexpr float kDefaultSec = 5.0f;
+
+// Tips: below 10 text only, 10+ with full-frame media
+struct Profiles {
+  AlertProfile p[kEventKindCount];
+
+  explicit Profiles(float media_duration = 0.0f)
+  {
+    std::vector<TierSpec> specs(2);
+    specs[0].min_milli = 0;
+    specs[0].text_template = "{user} tipped {amount}";
+    specs[1].min_milli = 10000;
+    specs[1].media = "big.webm";
+    specs[1].duration_sec = media_duration;
+    for (int k = 0; k < kEventKindCount; ++k)
+      build_alert_profile(p[k], (EventKind)k, k == (int)EventKind::Tip ? specs : std::vector<TierSpec>(), "",
+                          kDefaultSec);
+  }
+};
+
+TipEvent make_event(int id, long long amount_milli)
+{
+  TipEvent ev;
+  ev.kind = EventKind::Tip;
+  ev.amount_milli = amount_milli;
+  ev.dedupe_hash = (uint64_t)id;
+  ev.symbol = intern_symbol("TWICH");
+  ev.set_text("viewer" + std::to_string(id), std::to_string(amount_milli / 1000), "");
+  return ev;
+}
+
+TipEvent text_event(int id) { return make_event(id, 1000); }
+TipEvent media_event(int id) { return make_event(id, 20000); }
+
+// Starts whatever can start now; returns the ids in start order
+std::vector<int> start_all(AlertScheduler& sched, TipEventQueue& q, const Profiles& pr,
+                           std::vector<AlertStart>* starts = nullptr)
+{
+  std::vector<int> ids;
+  AlertStart st;
+  while (sched.start_next(q, pr.p, kDefaultSec, st)) {
+    ids.push_back((int)st.ev.dedupe_hash);
+    if (starts)
+      starts->push_back(std::move(st));
+  }
+  return ids;
+}
+
+void lane_cases()
+{
+  Profiles pr;
+  AlertScheduler sched;
+  TipEventQueue q;
+
+  sched.set_lanes(0);
+  bench::expect(sched.lanes() == 1, "lanes clamp to at least one");
+  sched.set_lanes(9);
+  bench::expect(sched.lanes() == AlertScheduler::kMaxLanes, "lanes clamp to kMaxLanes");
+
+  sched.set_lanes(3);
+  for (int i = 1; i <= 5; ++i)
+    q.push(text_event(i));
+
+  std::vector<AlertStart> starts;
+  bench::expect(start_all(sched, q, pr, &starts) == std::vector<int>{1, 2, 3}, "one alert per free lane");
+  bench::expect(starts.size() == 3 && starts[0].lane == 0 && starts[1].lane == 1 && starts[2].lane == 2,
+                "lanes fill from the top");
+  bench::expect(starts.size() == 3 && starts[0].text == "viewer1 tipped 1" && starts[0].duration_sec == kDefaultSec,
+                "the start carries its text and duration");
+  bench::expect(q.stats().depth == 2, "events wait in the queue while every lane plays");
+
+  bench::expect(sched.advance(kDefaultSec - 1.0f) == 0 && sched.elapsed(1) == kDefaultSec - 1.0f &&
+                    sched.time_left(1) == 1.0f,
+                "advance counts time on every lane");
+  bench::expect(sched.advance(1.0f) == 0b111 && !sched.playing(), "all three end on the same tick");
+
+  starts.clear();
+  bench::expect(start_all(sched, q, pr, &starts) == std::vector<int>{4, 5} && starts[0].lane == 0 &&
+                    starts[1].lane == 1,
+                "freed lanes are reused from the top");
+}
+
+void media_cases()
+{
+  Profiles pr;
+  AlertScheduler sched;
+  TipEventQueue q;
+  sched.set_lanes(4);
+
+  q.push(media_event(1));
+  q.push(media_event(2));
+  bench::expect(start_all(sched, q, pr) == std::vector<int>{1} && sched.media_lane() == 0,
+                "one media alert at a time");
+
+  // a text alert arriving after a waiting media one does not overtake it
+  q.push(text_event(3));
+  bench::expect(start_all(sched, q, pr).empty(), "alerts behind a waiting media event wait too");
+
+  sched.advance(kDefaultSec);
+  std::vector<AlertStart> starts;
+  bench::expect(start_all(sched, q, pr, &starts) == std::vector<int>{2, 3}, "arrival order holds once media frees up");
+  bench::expect(starts.size() == 2 && starts[0].lane == 0 && starts[1].lane == 1 && sched.media_lane() == 0,
+                "the next media alert takes the first free lane");
+
+  // text plays next to media
+  q.push(text_event(4));
+  bench::expect(start_all(sched, q, pr) == std::vector<int>{4}, "text alerts share the frame with media");
+}
+
+void shrink_cases()
+{
+  Profiles pr;
+  AlertScheduler sched;
+  TipEventQueue q;
+  sched.set_lanes(4);
+
+  q.push(text_event(1));
+  q.push(text_event(2));
+  start_all(sched, q, pr);
+  sched.advance(2.0f);
+  q.push(text_event(3));
+  q.push(text_event(4));
+  start_all(sched, q, pr);
+
+  sched.set_lanes(2);
+  q.push(text_event(5));
+  bench::expect(start_all(sched, q, pr).empty(), "no start while the remaining lanes are busy");
+
+  // lanes 0-1 end; 2-3 are still playing but no longer count
+  sched.advance(kDefaultSec - 2.0f);
+  bench::expect(sched.playing(2) && sched.playing(3) && sched.elapsed(3) == kDefaultSec - 2.0f,
+                "alerts on lanes taken away keep playing");
+  q.push(text_event(6));
+  q.push(text_event(7));
+  std::vector<AlertStart> starts;
+  bench::expect(start_all(sched, q, pr, &starts) == std::vector<int>{5, 6} && starts[0].lane == 0 &&
+                    starts[1].lane == 1,
+                "new alerts only go to the remaining lanes");
+
+  sched.advance(2.0f);
+  bench::expect(!sched.playing(2) && !sched.playing(3) && start_all(sched, q, pr).empty() && q.stats().depth == 1,
+                "lanes taken away stay empty once their alerts end");
+}
+
+void duration_cases()
+{
+  AlertScheduler sched;
+  TipEventQueue q;
+  sched.set_lanes(2);
+  sched.set_media_duration([](const std::string& path) { return path == "big.webm" ? 7.5f : 0.0f; });
+
+  Profiles pr;
+  q.push(media_event(1));
+  q.push(text_event(2));
+  std::vector<AlertStart> starts;
+  start_all(sched, q, pr, &starts);
+  bench::expect(starts.size() == 2 && starts[0].duration_sec == 7.5f, "media without a set duration plays its length");
+  bench::expect(starts.size() == 2 && starts[1].duration_sec == kDefaultSec, "text alerts keep the default");
+  bench::expect(sched.advance(kDefaultSec) == 0b10 && sched.advance(2.5f) == 0b01, "each lane ends on its own time");
+
+  Profiles set(3.0f);
+  q.push(media_event(3));
+  starts.clear();
+  start_all(sched, q, set, &starts);
+  bench::expect(starts.size() == 1 && starts[0].duration_sec == 3.0f, "a set duration wins over the media length");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const bool check = bench::check_mode(argc, argv);
+
+  lane_cases();
+  media_cases();
+  shrink_cases();
+  duration_cases();
+
+  // four lanes, one media alert in eight, one-second ticks
+  const int alerts = check ? 2000 : 200000;
+  Profiles pr;
+  AlertScheduler sched;
+  sched.set_lanes(4);
+  TipEventQueue q;
+  q.configure(64ull * 1024 * 1024, OverflowPolicy::Reject, "");
+  for (int i = 0; i < alerts; ++i)
+    q.push(i % 8 == 0 ? media_event(i) : text_event(i));
+
+  int started = 0;
+  long long ticks = 0;
+  AlertStart st;
+  const double t0 = bench::now_ms();
+  while (started < alerts) {
+    sched.advance(1.0f);
+    while (sched.start_next(q, pr.p, kDefaultSec, st))
+      started++;
+    ticks++;
+  }
+  const double per_alert_ns = (bench::now_ms() - t0) * 1e6 / alerts;
+  bench::expect(q.stats().depth == 0, "every alert started");
+
+  printf("%d alerts on 4 lanes: %.0f ns per alert (start_next + advance), %lld ticks\n", alerts, per_alert_ns, ticks);
+  return bench::result();
+}
@@ -0,0 +1,302 @@
+// Alert sound decoding and mixing: WAV decode and resample time for a 10 s
+// clip, mixer cost per video frame with every voice playing, plus each
+// supported WAV encoding, damaged headers, and the mixer's timing and
+// ducking.
+//
+//   bench_audio [--check]
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "audio_clip.hpp"
+#include "audio_mixer.hpp"
+#include "bench_util.hpp"
+
+namespace {
+
+constexpr float kLeft = 0.5f;
+constexpr float kRight = -0.25f;
+
+struct WavSpec {
+  uint16_t format = 1;     // 1 PCM, 3 float
+  uint16_t channels = 2;
+  uint32_t rate = 48000;
+  uint16_t bits = 16;
+  uint32_t frames = 480;
+  bool extensible = false;
+  bool odd_chunk = false;  // an odd-sized chunk before "data" (word alignment)
+};
+
+void put_u16(std::string& s, uint16_t v) { s += (char)(v & 0xFF); s += (char)(v >> 8); }
+void put_u32(std::string& s, uint32_t v) { put_u16(s, (uint16_t)v); put_u16(s, (uint16_t)(v >> 16)); }
+
+void put_sample(std::string& s, const WavSpec& w, float v)
+{
+  if (w.format == 3) {
+    if (w.bits == 32) {
+      char b[4];
+      std::memcpy(b, &v, 4);
+      s.append(b, 4);
+    } else {
+      const double d = v;
+      char b[8];
+      std::memcpy(b, &d, 8);
+      s.append(b, 8);
+    }
+    return;
+  }
+  switch (w.bits) {
+  case 8: s += (char)(uint8_t)(128 + (int)(v * 128)); break;
+  case 16: put_u16(s, (uint16_t)(int16_t)(v * 32768)); break;
+  case 24: {
+    const int32_t x = (int32_t)(v * 8388608);
+    s += (char)(x & 0xFF); s += (char)((x >> 8) & 0xFF); s += (char)((x >> 16) & 0xFF);
+    break;
+  }
+  default: put_u32(s, (uint32_t)(int32_t)(v * 2147483648.0)); break;
+  }
+}
+
+// Channel 0 holds kLeft, channel 1 kRight, the rest 0.9 (must be dropped)
+std::string make_wav(const WavSpec& w)
+{
+  std::string fmt;
+  put_u16(fmt, w.extensible ? 0xFFFE : w.format);
+  put_u16(fmt, w.channels);
+  put_u32(fmt, w.rate);
+  put_u32(fmt, w.rate * w.channels * (w.bits / 8));
+  put_u16(fmt, (uint16_t)(w.channels * (w.bits / 8)));
+  put_u16(fmt, w.bits);
+  if (w.extensible) {
+    put_u16(fmt, 22);      // cbSize
+    put_u16(fmt, w.bits);  // valid bits
+    put_u32(fmt, 0);       // channel mask
+    put_u16(fmt, w.format); // SubFormat GUID, format code first
+    fmt.append(14, '\0');
+  }
+
+  std::string data;
+  for (uint32_t i = 0; i < w.frames; ++i)
+    for (uint16_t c = 0; c < w.channels; ++c)
+      put_sample(data, w, c == 0 ? kLeft : c == 1 ? kRight : 0.9f);
+
+  std::string body = "WAVE";
+  body += "fmt ";
+  put_u32(body, (uint32_t)fmt.size());
+  body += fmt;
+  if (w.odd_chunk) {
+    body += "LIST";
+    put_u32(body, 3);
+    body += "abc";
+    body += '\0'; // pad byte
+  }
+  body += "data";
+  put_u32(body, (uint32_t)data.size());
+  body += data;
+
+  std::string wav = "RIFF";
+  put_u32(wav, (uint32_t)body.size());
+  return wav + body;
+}
+
+bool decode(const std::string& wav, uint32_t rate, AudioClip& clip, std::string& error)
+{
+  return decode_wav((const uint8_t*)wav.data(), wav.size(), rate, clip, error);
+}
+
+bool near(float a, float b) { return std::fabs(a - b) < 0.01f; }
+
+void encoding_cases()
+{
+  struct Case {
+    const char* what;
+    WavSpec spec;
+  };
+  std::vector<Case> cases = {
+    {"8-bit PCM", {1, 2, 48000, 8}},
+    {"16-bit PCM", {1, 2, 48000, 16}},
+    {"24-bit PCM", {1, 2, 48000, 24}},
+    {"32-bit PCM", {1, 2, 48000, 32}},
+    {"32-bit float", {3, 2, 48000, 32}},
+    {"64-bit float", {3, 2, 48000, 64}},
+    {"extensible 24-bit PCM", {1, 2, 48000, 24, 480, true}},
+    {"extensible 32-bit float", {3, 2, 48000, 32, 480, true}},
+    {"5.1, first two channels kept", {1, 6, 48000, 16}},
+    {"odd-sized chunk before data", {1, 2, 48000, 16, 480, false, true}},
+  };
+
+  for (const Case& c : cases) {
+    AudioClip clip;
+    std::string error;
+    const bool ok = decode(make_wav(c.spec), 48000, clip, error);
+    bench::expect(ok && clip.frames() == c.spec.frames && near(clip.left[10], kLeft) && near(clip.right[10], kRight),
+                  c.what);
+  }
+
+  AudioClip clip;
+  std::string error;
+  WavSpec mono;
+  mono.channels = 1;
+  bench::expect(decode(make_wav(mono), 48000, clip, error) && near(clip.right[10], kLeft),
+                "mono is copied to both sides");
+
+  WavSpec slow;
+  slow.rate = 24000;
+  bench::expect(decode(make_wav(slow), 48000, clip, error) && clip.frames() == 960 && clip.sample_rate == 48000 &&
+                    near(clip.left[100], kLeft),
+                "resampled to the mixer rate");
+
+  // streamed writers leave the data size at 0xFFFFFFFF
+  std::string streamed = make_wav(WavSpec());
+  const size_t data_at = streamed.find("data") + 4;
+  streamed.replace(data_at, 4, "\xFF\xFF\xFF\xFF");
+  bench::expect(decode(streamed, 48000, clip, error) && clip.frames() == 480, "unknown data size reads to the end");
+}
+
+void expect_rejected(const std::string& wav, const char* what)
+{
+  AudioClip clip;
+  std::string error;
+  bench::expect(!decode(wav, 48000, clip, error) && !error.empty(), what);
+}
+
+// Header fields patched in place; offsets are into a plain 44-byte header
+std::string patched(WavSpec spec, size_t at, uint16_t value)
+{
+  std::string wav = make_wav(spec);
+  wav[at] = (char)(value & 0xFF);
+  wav[at + 1] = (char)(value >> 8);
+  return wav;
+}
+
+void malformed_cases()
+{
+  constexpr size_t kChannelsAt = 22, kBlockAt = 32, kBitsAt = 34;
+
+  expect_rejected("", "empty input");
+  expect_rejected("RIFF\x04\0\0\0WAV", "cut inside the RIFF header");
+  expect_rejected(std::string("RIFX\x04\0\0\0WAVE", 12), "not RIFF");
+  expect_rejected(std::string("RIFF\x04\0\0\0WAVE", 12), "no chunks");
+
+  std::string no_data = make_wav(WavSpec());
+  no_data.resize(no_data.find("data"));
+  expect_rejected(no_data, "no data chunk");
+
+  std::string no_fmt = make_wav(WavSpec());
+  no_fmt.replace(12, 4, "junk");
+  expect_rejected(no_fmt, "no fmt chunk");
+
+  expect_rejected(patched(WavSpec(), kChannelsAt, 0), "zero channels");
+  expect_rejected(patched(WavSpec(), kChannelsAt, 9), "more channels than a WAV can carry");
+  expect_rejected(patched(WavSpec(), kChannelsAt, 32768), "32768 channels (block align wrapped to 0)");
+  expect_rejected(patched(WavSpec(), kChannelsAt, 65535), "65535 channels");
+  expect_rejected(patched(WavSpec(), kBitsAt, 12), "12-bit PCM");
+  expect_rejected(patched(WavSpec(), kBitsAt, 0), "0-bit samples");
+  expect_rejected(patched(WavSpec(), 20, 2), "ADPCM");
+
+  WavSpec f16;
+  f16.format = 3;
+  f16.bits = 16;
+  expect_rejected(make_wav(f16), "16-bit float");
+
+  // a block align smaller than a frame must not read past the data
+  AudioClip clip;
+  std::string error;
+  std::string small_block = patched(WavSpec(), kBlockAt, 1);
+  bench::expect(decode(small_block, 48000, clip, error) && clip.frames() == 480, "block align below a frame is widened");
+
+  // data shorter than the header claims: only whole frames are read
+  std::string cut = make_wav(WavSpec());
+  cut.resize(cut.size() - 3);
+  bench::expect(decode(cut, 48000, clip, error) && clip.frames() == 479, "truncated data keeps whole frames");
+
+  WavSpec long_clip;
+  long_clip.rate = 100;
+  long_clip.frames = 100 * 121;
+  expect_rejected(make_wav(long_clip), "longer than kMaxClipSeconds");
+}
+
+std::shared_ptr<const AudioClip> constant_clip(float value, size_t frames)
+{
+  auto c = std::make_shared<AudioClip>();
+  c->sample_rate = 48000;
+  c->left.assign(frames, value);
+  c->right.assign(frames, value);
+  return c;
+}
+
+void mixer_cases()
+{
+  constexpr uint64_t kT0 = 5'000'000'000ull;
+  constexpr uint64_t kFrameNs = 16'666'667ull;
+
+  AudioMixer mix;
+  mix.set_sample_rate(48000);
+  mix.set_duck_gain(0.25f);
+
+  uint64_t ts = 0;
+  bench::expect(mix.render_until(kT0, ts) == 0, "an idle mixer renders nothing");
+
+  mix.play(constant_clip(0.5f, 48000), kT0);
+  const size_t n = mix.render_until(kT0 + kFrameNs, ts);
+  bench::expect(n == 800 && ts == kT0, "a voice starts on the first sample of the next chunk");
+  bench::expect(near(mix.left()[0], 0.5f) && near(mix.right()[799], 0.5f), "the lead voice plays at full gain");
+
+  // a newer voice ducks the older one once the ramp is through
+  mix.play(constant_clip(0.0f, 48000), kT0 + kFrameNs);
+  for (int f = 2; f <= 6; ++f)
+    mix.render_until(kT0 + f * kFrameNs, ts);
+  bench::expect(near(mix.left()[0], 0.5f * 0.25f), "an overlapped voice ducks to the duck gain");
+
+  // a stalled tick skips the gap instead of replaying it
+  const size_t stalled = mix.render_until(kT0 + 3'000'000'000ull, ts);
+  bench::expect(stalled == 24000, "a stalled tick renders at most half a second");
+
+  mix.render_until(kT0 + 10'000'000'000ull, ts);
+  bench::expect(!mix.active(), "voices end with their clips");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const bool check = bench::check_mode(argc, argv);
+
+  encoding_cases();
+  malformed_cases();
+  mixer_cases();
+
+  // decode: 10 s of 16-bit stereo at 44.1 kHz, to the 48 kHz output
+  WavSpec ten_s;
+  ten_s.rate = 44100;
+  ten_s.frames = 441000;
+  const std::string wav = make_wav(ten_s);
+  const int decodes = check ? 2 : 20;
+  AudioClip clip;
+  std::string error;
+  const double t0 = bench::now_ms();
+  for (int i = 0; i < decodes; ++i)
+    decode(wav, 48000, clip, error);
+  const double decode_ms = (bench::now_ms() - t0) / decodes;
+  bench::expect(clip.frames() == 480000, "10 s clip resampled to 48 kHz");
+
+  // mix: every voice playing, one 60 fps frame per call
+  AudioMixer mix;
+  mix.set_sample_rate(48000);
+  auto voice = constant_clip(0.1f, 48000 * 60);
+  for (size_t i = 0; i < AudioMixer::kMaxVoices; ++i)
+    mix.play(voice, 1'000'000'000ull);
+  const int frames = check ? 600 : 3600;
+  uint64_t ts = 0;
+  const double t1 = bench::now_ms();
+  for (int f = 1; f <= frames; ++f)
+    mix.render_until(1'000'000'000ull + (uint64_t)f * 16'666'667ull, ts);
+  const double mix_us = (bench::now_ms() - t1) * 1000.0 / frames;
+
+  printf("decode 10 s WAV (44.1 -> 48 kHz): %.2f ms, mix %zu voices: %.1f us per video frame\n", decode_ms,
+         AudioMixer::kMaxVoices, mix_us);
+  return bench::result();
+}
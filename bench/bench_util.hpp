@@ -0,0 +1,46 @@
+#pragma once
+
+// Shared bits for the bench/ drivers. Each driver prints its numbers and
+// exits non-zero when a check fails; `--check` runs a short pass (what
+// ctest uses), so structural claims stay guarded without timing noise.
+// Timings are only meaningful in an optimized build:
+//   cmake -S . -B build -DCMAKE_BUILD_TYPE=Release
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace bench {
+
+inline bool check_mode(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+    if (!strcmp(argv[i], "--check"))
+      return true;
+  return false;
+}
+
+inline double now_ms()
+{
+  using namespace std::chrono;
+  return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+inline int g_failures = 0;
+
+inline void expect(bool ok, const char* what)
+{
+  if (!ok) {
+    fprintf(stderr, "FAILED: %s\n", what);
+    g_failures++;
+  }
+}
+
+inline int result()
+{
+  if (g_failures == 0)
+    printf("ok\n");
+  return g_failures ? 1 : 0;
+}
+
+} // namespace bench
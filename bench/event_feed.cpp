@@ -0,0 +1,381 @@
+// WebSocket event feed: fan-out time per event to 1-32 overlay clients,
+// against a local server and raw-socket clients, plus the handshake,
+// ping/pong, dedupe and slow-client eviction.
+//
+//   bench_event_feed [--check]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  include <winsock2.h>
+#  include <ws2tcpip.h>
+#else
+#  include <arpa/inet.h>
+#  include <netinet/in.h>
+#  include <sys/socket.h>
+#  include <sys/time.h>
+#  include <unistd.h>
+#endif
+
+#include "bench_util.hpp"
+#include "event_feed.hpp"
+
+namespace {
+
+#ifdef _WIN32
+using socket_t = SOCKET;
+constexpr socket_t kBadSocket = INVALID_SOCKET;
+void close_socket(socket_t s) { closesocket(s); }
+#else
+using socket_t = int;
+constexpr socket_t kBadSocket = -1;
+void close_socket(socket_t s) { ::close(s); }
+#endif
+
+// The RFC 6455 example key and its accept value
+constexpr const char* kKey = "dGhlIHNhbXBsZSBub25jZQ==";
+constexpr const char* kAccept = "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=";
+
+// Blocking loopback client; recv() gives up after `timeout_ms`
+struct RawClient {
+  socket_t fd = kBadSocket;
+  std::string in;
+
+  RawClient() = default;
+  RawClient(const RawClient&) = delete;
+  RawClient& operator=(const RawClient&) = delete;
+  ~RawClient() { close(); }
+
+  bool connect_to(uint16_t port, int rcvbuf = 0)
+  {
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == kBadSocket)
+      return false;
+    if (rcvbuf > 0)
+      setsockopt(fd, SOL_SOCKET, SO_RCVBUF, (const char*)&rcvbuf, sizeof(rcvbuf));
+    set_timeout(2000);
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    return connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0;
+  }
+
+  void set_timeout(int timeout_ms)
+  {
+#ifdef _WIN32
+    DWORD tv = (DWORD)timeout_ms;
+#else
+    timeval tv{timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+#endif
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof(tv));
+  }
+
+  void close()
+  {
+    if (fd != kBadSocket)
+      close_socket(fd);
+    fd = kBadSocket;
+  }
+
+  bool send_all(std::string_view data)
+  {
+    while (!data.empty()) {
+      const auto n = send(fd, data.data(), (int)data.size(), 0);
+      if (n <= 0)
+        return false;
+      data.remove_prefix((size_t)n);
+    }
+    return true;
+  }
+
+  // False on timeout, EOF or error
+  bool fill()
+  {
+    char buf[16384];
+    const auto n = recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0)
+      return false;
+    in.append(buf, (size_t)n);
+    return true;
+  }
+
+  // Request + response headers; the feed's frames may follow in `in`
+  std::string request(const char* path, bool upgrade)
+  {
+    std::string req = std::string("GET ") + path + " HTTP/1.1\r\nHost: 127.0.0.1\r\n";
+    if (upgrade)
+      req += std::string("Upgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Version: 13\r\n"
+                         "Sec-WebSocket-Key: ") + kKey + "\r\n";
+    req += "\r\n";
+    if (!send_all(req))
+      return {};
+
+    size_t end;
+    while ((end = in.find("\r\n\r\n")) == std::string::npos)
+      if (!fill())
+        return {};
+    std::string head = in.substr(0, end + 4);
+    in.erase(0, end + 4);
+    return head;
+  }
+
+  // Client frames are masked; a zero mask keeps the payload readable
+  bool send_frame(uint8_t opcode, std::string_view payload)
+  {
+    std::string f;
+    f += (char)(0x80 | opcode);
+    f += (char)(0x80 | payload.size()); // short control/test frames only
+    f.append(4, '\0');
+    f += payload;
+    return send_all(f);
+  }
+
+  // Next server frame (unmasked); false on timeout or close
+  bool read_frame(uint8_t& opcode, std::string& payload)
+  {
+    for (;;) {
+      if (in.size() >= 2) {
+        const uint8_t* p = (const uint8_t*)in.data();
+        uint64_t len = p[1] & 0x7F;
+        size_t at = 2;
+        if (len == 126) {
+          len = in.size() >= 4 ? ((uint64_t)p[2] << 8) | p[3] : ~0ull;
+          at = 4;
+        } else if (len == 127) {
+          len = 0;
+          for (int i = 0; i < 8 && in.size() >= 10; ++i)
+            len = (len << 8) | p[2 + i];
+          at = 10;
+        }
+        if (in.size() >= at && len != ~0ull && in.size() - at >= len) {
+          opcode = p[0] & 0x0F;
+          payload.assign(in, at, (size_t)len);
+          in.erase(0, at + (size_t)len);
+          return true;
+        }
+      }
+      if (!fill())
+        return false;
+    }
+  }
+
+  // Counts text frames until `want` arrived or the stream went quiet
+  size_t read_texts(size_t want)
+  {
+    uint8_t op;
+    std::string payload;
+    size_t n = 0;
+    while (n < want && read_frame(op, payload))
+      n += op == 0x1;
+    return n;
+  }
+};
+
+bool upgrade(RawClient& c, uint16_t port)
+{
+  if (!c.connect_to(port))
+    return false;
+  const std::string head = c.request("/", true);
+  return head.find(" 101 ") != std::string::npos;
+}
+
+TipEvent make_event(uint64_t hash)
+{
+  TipEvent ev;
+  ev.kind = EventKind::Tip;
+  ev.amount_milli = 12500;
+  ev.ts_ms = 1700000000000LL + (long long)hash;
+  ev.dedupe_hash = hash;
+  ev.set_text("viewer" + std::to_string(hash % 97), "12.500", "thanks for the stream, keep it up!");
+  return ev;
+}
+
+bool wait_for(const std::function<bool()>& done, double timeout_ms = 3000)
+{
+  const double until = bench::now_ms() + timeout_ms;
+  while (!done()) {
+    if (bench::now_ms() > until)
+      return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+std::shared_ptr<EventFeedServer> start_server()
+{
+  std::string error;
+  for (uint16_t port = 47311; port < 47361; ++port)
+    if (auto server = acquire_event_feed(port, error))
+      return server;
+  fprintf(stderr, "no free port: %s\n", error.c_str());
+  return nullptr;
+}
+
+void protocol_cases(EventFeedServer& server)
+{
+  const uint16_t port = server.port();
+
+  RawClient http;
+  bench::expect(http.connect_to(port), "plain client connects");
+  bench::expect(http.request("/", false).find(" 200 ") != std::string::npos, "plain GET gets a status line");
+
+  RawClient c;
+  bench::expect(c.connect_to(port), "WebSocket client connects");
+  const std::string head = c.request("/", true);
+  bench::expect(head.find(" 101 ") != std::string::npos, "upgrade answered with 101");
+  bench::expect(head.find(kAccept) != std::string::npos, "Sec-WebSocket-Accept matches RFC 6455");
+  bench::expect(wait_for([&] { return server.stats().clients == 1; }), "upgraded client counted");
+
+  uint8_t op = 0;
+  std::string payload;
+  bench::expect(c.send_frame(0x9, "hi") && c.read_frame(op, payload) && op == 0xA && payload == "hi",
+                "ping answered with a pong carrying its payload");
+
+  // ten broadcasts, five distinct bot messages
+  for (uint64_t i = 0; i < 10; ++i)
+    server.broadcast(make_event(1 + i % 5));
+  bench::expect(c.read_texts(5) == 5, "each distinct event arrives once");
+  c.set_timeout(100);
+  bench::expect(!c.read_frame(op, payload), "repeats are not sent");
+  c.set_timeout(2000);
+
+  server.broadcast(make_event(99));
+  bench::expect(c.read_frame(op, payload) && op == 0x1 &&
+                    payload.find("\"type\":\"tip\"") != std::string::npos &&
+                    payload.find("\"amount_milli\":12500") != std::string::npos,
+                "event arrives as feed JSON");
+
+  bench::expect(c.send_frame(0x8, "") && c.read_frame(op, payload) && op == 0x8, "close is echoed");
+}
+
+// A client that stops reading is dropped; one that reads gets everything
+void eviction_case(EventFeedServer& server, int events)
+{
+  bench::expect(wait_for([&] { return server.stats().clients == 0; }), "earlier clients gone");
+  const EventFeedStats before = server.stats();
+
+  RawClient slow, reader;
+  bench::expect(slow.connect_to(server.port(), 4096) && slow.request("/", true).find(" 101 ") != std::string::npos,
+                "slow client upgrades");
+  bench::expect(upgrade(reader, server.port()), "reading client upgrades");
+  bench::expect(wait_for([&] { return server.stats().clients == before.clients + 2; }), "both clients counted");
+
+  size_t got = 0;
+  std::thread t([&] { got = reader.read_texts((size_t)events); });
+  for (int i = 0; i < events; ++i)
+    server.broadcast(make_event(1000000 + (uint64_t)i));
+  t.join();
+
+  bench::expect(wait_for([&] { return server.stats().evicted > before.evicted; }), "client that stopped reading is evicted");
+  bench::expect(got == (size_t)events, "reading client gets every event of the burst");
+
+  // the evicted socket ends after whatever the kernel already held
+  slow.set_timeout(200);
+  while (slow.fill()) {}
+}
+
+// `events` to `clients` readers, broadcast in batches the readers drain
+// before the next (a burst would outrun them and get them evicted):
+// first broadcast to last frame read, per event
+double fan_out_us(EventFeedServer& server, int clients, int events, uint64_t& base)
+{
+  constexpr int kBatch = 256; // ~50 KB of frames, well under kMaxClientBacklog
+
+  struct Reader {
+    RawClient c;
+    std::atomic<size_t> got{0};
+  };
+
+  const size_t before = server.stats().clients;
+  std::vector<std::unique_ptr<Reader>> readers;
+  for (int i = 0; i < clients; ++i) {
+    readers.push_back(std::make_unique<Reader>());
+    if (!upgrade(readers.back()->c, server.port())) {
+      bench::expect(false, "reader upgrades");
+      return 0;
+    }
+  }
+  bench::expect(wait_for([&] { return server.stats().clients == before + (size_t)clients; }), "readers counted");
+
+  std::vector<std::thread> threads;
+  for (auto& r : readers)
+    threads.emplace_back([&events, rd = r.get()] {
+      uint8_t op;
+      std::string payload;
+      while (rd->got.load() < (size_t)events && rd->c.read_frame(op, payload))
+        if (op == 0x1)
+          rd->got++;
+    });
+
+  auto caught_up = [&](size_t sent) {
+    for (const auto& r : readers)
+      if (r->got.load() < sent)
+        return false;
+    return true;
+  };
+
+  bool kept_up = true;
+  const double t0 = bench::now_ms();
+  for (int sent = 0; sent < events && kept_up;) {
+    const int n = std::min(kBatch, events - sent);
+    for (int i = 0; i < n; ++i)
+      server.broadcast(make_event(base + (uint64_t)(sent + i)));
+    sent += n;
+    const double until = bench::now_ms() + 3000;
+    while (!caught_up((size_t)sent) && (kept_up = bench::now_ms() < until))
+      std::this_thread::yield();
+  }
+  const double ms = bench::now_ms() - t0;
+  base += (uint64_t)events;
+
+  for (auto& r : readers)
+    r->c.set_timeout(1); // lets a reader stuck on a missing frame give up
+  for (std::thread& t : threads)
+    t.join();
+
+  bench::expect(kept_up, "every reader gets every event");
+  return ms * 1000.0 / events;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const bool check = bench::check_mode(argc, argv);
+
+  std::shared_ptr<EventFeedServer> feed = start_server();
+  if (!feed)
+    return 1;
+  EventFeedServer& server = *feed;
+
+  protocol_cases(server);
+  eviction_case(server, check ? 20000 : 50000);
+
+  const std::vector<int> clients = check ? std::vector<int>{8} : std::vector<int>{1, 8, 32};
+  const int events = check ? 2000 : 20000;
+  uint64_t base = 10000000;
+
+  printf("%8s  %8s  %12s\n", "clients", "events", "us/event");
+  for (int n : clients) {
+    const double us = fan_out_us(server, n, events, base);
+    printf("%8d  %8d  %12.2f\n", n, events, us);
+    bench::expect(wait_for([&] { return server.stats().clients == 0; }), "readers disconnected");
+  }
+
+  const EventFeedStats st = server.stats();
+  printf("broadcast %llu, evicted %llu\n", (unsigned long long)st.broadcast, (unsigned long long)st.evicted);
+  feed.reset();
+  return bench::result();
+}
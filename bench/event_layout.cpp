@@ -0,0 +1,158 @@
+// Bytes and allocations per event: the arena-backed TipEvent moved through
+// TipEventQueue, against the original layout (five std::strings, copied
+// out of the queue in tick).
+//
+//   bench_event_layout [--check]
+
+#include <cstdlib>
+#include <deque>
+#include <new>
+#include <string>
+
+#include "bench_util.hpp"
+#include "event_queue.hpp"
+
+// ---- allocation counting (this executable only) ----
+static size_t g_allocs = 0;
+
+void* operator new(size_t n)
+{
+  g_allocs++;
+  if (void* p = std::malloc(n ? n : 1))
+    return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+// The layout before the arena: every field a separate string
+struct LegacyTipEvent {
+  std::string from_username;
+  std::string amount_str;
+  std::string symbol;
+  std::string message;
+  long long   ts_ms = 0;
+  std::string dedupe_key;
+};
+
+size_t string_heap(const std::string& s)
+{
+  // heap block only when the string outgrew its small buffer
+  return s.capacity() > std::string().capacity() ? s.capacity() + 1 : 0;
+}
+
+size_t legacy_bytes(const LegacyTipEvent& e)
+{
+  return sizeof(LegacyTipEvent) + string_heap(e.from_username) + string_heap(e.amount_str) +
+         string_heap(e.symbol) + string_heap(e.message) + string_heap(e.dedupe_key);
+}
+
+struct Fields {
+  const char* name;
+  std::string user, amount, message;
+};
+
+struct Result {
+  double allocs = 0;  // per event, build + queue + take out (incl. queue storage)
+  double bytes = 0;   // per queued event
+  double ns = 0;      // per event
+};
+
+Result run_legacy(const Fields& f, int n)
+{
+  std::deque<LegacyTipEvent> q;
+  size_t bytes = 0;
+
+  const size_t a0 = g_allocs;
+  const double t0 = bench::now_ms();
+  for (int i = 0; i < n; ++i) {
+    LegacyTipEvent e;
+    e.from_username = f.user;
+    e.amount_str = f.amount;
+    e.symbol = "TWICH";
+    e.message = f.message;
+    e.ts_ms = 1700000000000LL + i;
+    e.dedupe_key = std::to_string(e.ts_ms) + "|" + e.from_username + "|" + e.amount_str;
+    bytes += legacy_bytes(e);
+    q.push_back(e);          // the producer copied into std::queue
+  }
+  for (int i = 0; i < n; ++i) {
+    LegacyTipEvent ev = q.front();   // tick: ev = s->queue.front()
+    q.pop_front();
+  }
+  const double t1 = bench::now_ms();
+
+  return {(double)(g_allocs - a0) / n, (double)bytes / n, (t1 - t0) * 1e6 / n};
+}
+
+Result run_arena(const Fields& f, int n)
+{
+  TipEventQueue q;
+  q.configure((size_t)1 << 30, OverflowPolicy::Reject, std::string());
+  size_t bytes = 0;
+
+  const size_t a0 = g_allocs;
+  const double t0 = bench::now_ms();
+  for (int i = 0; i < n; ++i) {
+    TipEvent e;
+    e.set_text(f.user, f.amount, f.message);
+    e.symbol = "TWICH";
+    e.ts_ms = 1700000000000LL + i;
+    e.dedupe_hash = fnv1a_64(f.amount, fnv1a_64(f.user, (uint64_t)e.ts_ms));
+    bytes += tip_event_bytes(e);
+    q.push(std::move(e));
+  }
+  TipEvent ev;
+  for (int i = 0; i < n; ++i)
+    q.pop(ev);
+  const double t1 = bench::now_ms();
+
+  return {(double)(g_allocs - a0) / n, (double)bytes / n, (t1 - t0) * 1e6 / n};
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const bool check = bench::check_mode(argc, argv);
+  const int n = check ? 2000 : 200000;
+
+  const Fields cases[] = {
+    {"typical", "bob", "12.500", "hello there"},
+    {"long", "a_rather_long_telegram_username_x", "1234.500",
+     "thanks for the stream, this one is for the new emote and the next raid!"},
+  };
+
+  printf("%-8s  %-7s  %10s  %10s  %10s\n", "event", "layout", "bytes/ev", "allocs/ev", "ns/ev");
+  for (const Fields& f : cases) {
+    const Result before = run_legacy(f, n);
+    const Result after = run_arena(f, n);
+    printf("%-8s  %-7s  %10.1f  %10.2f  %10.1f\n", f.name, "strings", before.bytes, before.allocs, before.ns);
+    printf("%-8s  %-7s  %10.1f  %10.2f  %10.1f\n", f.name, "arena", after.bytes, after.allocs, after.ns);
+
+    bench::expect(after.bytes < before.bytes, "arena layout is smaller per event");
+    bench::expect(after.allocs < before.allocs, "arena layout allocates less per event");
+  }
+
+  // The event's own allocations, without queue storage (deque block
+  // sizes differ between standard libraries): build, move twice, drop.
+  for (int c = 0; c < 2; ++c) {
+    const Fields& f = cases[c];
+    const size_t a0 = g_allocs;
+    {
+      TipEvent e;
+      e.set_text(f.user, f.amount, f.message);
+      TipEvent queued(std::move(e));
+      TipEvent taken;
+      taken = std::move(queued);
+    }
+    const size_t own = g_allocs - a0;
+    printf("%-8s  arena event allocations (no queue): %zu\n", f.name, own);
+    bench::expect(own == (c == 0 ? 0u : 1u), c == 0 ? "a typical tip stays in the inline buffer"
+                                                      : "a long tip costs exactly one allocation");
+  }
+
+  return bench::result();
+}
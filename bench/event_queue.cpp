@@ -0,0 +1,209 @@
+// Event queue under overflow: push + pop cost per event with the queue over
+// its budget under each policy (Reject, Summarize, Spill), plus what each
+// policy keeps, FIFO order through the spill journal, and a journal left by
+// an earlier run being replayed.
+//
+//   bench_event_queue [--check]
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "event_queue.hpp"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// Room for this many events with inline text
+constexpr size_t kRoom = 4;
+constexpr size_t kBudget = kRoom * sizeof(TipEvent);
+
+TipEvent make_event(int i, const char* symbol = "TWICH", EventKind kind = EventKind::Tip)
+{
+  TipEvent ev;
+  ev.kind = kind;
+  ev.amount_milli = 1000LL * (i + 1);
+  ev.ts_ms = 1700000000000LL + i;
+  ev.dedupe_hash = 1000 + (uint64_t)i;
+  ev.symbol = intern_symbol(symbol);
+  ev.set_text("viewer" + std::to_string(i), std::to_string(i + 1) + ".000", "gg");
+  return ev;
+}
+
+std::vector<TipEvent> drain(TipEventQueue& q)
+{
+  std::vector<TipEvent> out;
+  TipEvent ev;
+  while (q.pop(ev))
+    out.push_back(std::move(ev));
+  return out;
+}
+
+// Events i = first, first + 1, ... in that order
+bool in_order(const std::vector<TipEvent>& evs, size_t from, size_t to, int first)
+{
+  for (size_t i = from; i < to; ++i)
+    if (evs[i].ts_ms != 1700000000000LL + first + (long long)(i - from))
+      return false;
+  return true;
+}
+
+fs::path scratch(const char* name)
+{
+  const fs::path dir = fs::temp_directory_path() / "twich_bench_event_queue";
+  fs::create_directories(dir);
+  const fs::path p = dir / name;
+  fs::remove(p);
+  return p;
+}
+
+void reject_case()
+{
+  TipEventQueue q;
+  q.configure(kBudget, OverflowPolicy::Reject, "");
+
+  int accepted = 0;
+  for (int i = 0; i < 10; ++i)
+    accepted += q.push(make_event(i));
+  bench::expect(accepted == (int)kRoom && q.stats().rejected == 10 - kRoom, "Reject keeps what fits, drops the rest");
+
+  const std::vector<TipEvent> evs = drain(q);
+  bench::expect(evs.size() == kRoom && in_order(evs, 0, kRoom, 0), "Reject plays the kept events in order");
+  bench::expect(!q.pending(), "a drained queue is idle");
+
+  // a tiny budget still lets one event through
+  TipEventQueue tiny;
+  tiny.configure(1, OverflowPolicy::Reject, "");
+  bench::expect(tiny.push(make_event(0)) && !tiny.push(make_event(1)), "a budget below one event holds one");
+}
+
+void summarize_case()
+{
+  TipEventQueue q;
+  q.configure(kBudget, OverflowPolicy::Summarize, "");
+
+  for (int i = 0; i < 10; ++i)
+    q.push(make_event(i, i % 2 ? "SUI" : "TWICH"));
+  q.push(make_event(10, "TWICH", EventKind::Follow));
+  bench::expect(q.stats().summarized == 11 - kRoom && q.stats().depth == kRoom, "Summarize folds what does not fit");
+
+  const std::vector<TipEvent> evs = drain(q);
+  bench::expect(evs.size() == kRoom + 3 && in_order(evs, 0, kRoom, 0), "queued events play before the summaries");
+
+  // over budget: 4, 6, 8 (TWICH), 5, 7, 9 (SUI), 10 (follow)
+  bench::expect(evs.size() > kRoom + 2 && evs[kRoom].from_username() == "3 more viewers" &&
+                    evs[kRoom].symbol == std::string("TWICH") && evs[kRoom].amount_milli == 5000 + 7000 + 9000,
+                "one summary per token adds up its amounts");
+  bench::expect(evs.size() > kRoom + 2 && evs[kRoom + 1].symbol == std::string("SUI") &&
+                    evs[kRoom + 1].amount_milli == 6000 + 8000 + 10000,
+                "tokens are never mixed in a summary");
+  bench::expect(evs.size() > kRoom + 2 && evs[kRoom + 2].kind == EventKind::Follow &&
+                    evs[kRoom + 2].from_username() == "1 more viewers",
+                "event kinds are summarized apart");
+}
+
+void spill_case()
+{
+  const fs::path journal = scratch("spill.jsonl");
+  TipEventQueue q;
+  q.configure(kBudget, OverflowPolicy::Spill, journal.string());
+
+  for (int i = 0; i < 10; ++i)
+    q.push(make_event(i));
+  bench::expect(q.stats().spilled == 10 - kRoom && q.stats().spill_pending == 10 - kRoom && fs::exists(journal),
+                "Spill writes what does not fit to the journal");
+
+  // room frees up, but the journal goes first: FIFO order holds
+  TipEvent ev;
+  q.pop(ev);
+  q.push(make_event(10));
+  std::vector<TipEvent> evs = drain(q);
+  bench::expect(evs.size() == 10 && in_order(evs, 0, 10, 1), "spilled events come back in arrival order");
+  bench::expect(q.stats().spill_pending == 0 && !fs::exists(journal), "a drained journal is removed");
+
+  // no journal path: Spill cannot write and rejects instead
+  TipEventQueue nowhere;
+  nowhere.configure(kBudget, OverflowPolicy::Spill, "");
+  for (int i = 0; i < 10; ++i)
+    nowhere.push(make_event(i));
+  bench::expect(nowhere.stats().rejected == 10 - kRoom, "Spill without a journal rejects");
+}
+
+// A crash leaves the journal behind; the next configure() replays it
+void recovery_case()
+{
+  const fs::path journal = scratch("crashed.jsonl");
+  const fs::path left = scratch("left_behind.jsonl");
+  {
+    TipEventQueue q;
+    q.configure(kBudget, OverflowPolicy::Spill, journal.string());
+    for (int i = 0; i < 10; ++i)
+      q.push(make_event(i, i == 7 ? "SUI" : "TWICH"));
+    fs::copy_file(journal, left); // what a crash right now leaves on disk
+  }
+  {
+    std::ofstream f(left, std::ios::app);
+    f << "{\"from_username\": cut off mid-write\n";
+  }
+
+  TipEventQueue q;
+  q.configure(kBudget, OverflowPolicy::Spill, left.string());
+  bench::expect(q.stats().recovered == 10 - kRoom + 1 && q.pending(), "a journal from an earlier run is picked up");
+
+  const std::vector<TipEvent> evs = drain(q);
+  bench::expect(evs.size() == 10 - kRoom && in_order(evs, 0, evs.size(), (int)kRoom),
+                "recovered events replay in order, a damaged line is skipped");
+  bench::expect(evs.size() == 10 - kRoom && evs[3].symbol == std::string("SUI") && evs[3].from_username() == "viewer7" &&
+                    evs[3].amount_milli == 8000 && evs[3].dedupe_hash == 1007 && evs[3].message() == "gg",
+                "a recovered event keeps every field");
+  bench::expect(!fs::exists(left), "a replayed journal is removed");
+
+  fs::remove_all(journal.parent_path());
+}
+
+double overflow_ns(OverflowPolicy policy, const std::string& journal, int n)
+{
+  TipEventQueue q;
+  q.configure(kBudget * 16, policy, journal);
+
+  // fill the budget, then every push overflows; pop the same number back
+  for (int i = 0; i < (int)kRoom * 16; ++i)
+    q.push(make_event(i));
+
+  TipEvent ev;
+  const double t0 = bench::now_ms();
+  for (int i = 0; i < n; ++i) {
+    q.push(make_event(i));
+    if (i % 4 == 3)
+      for (int k = 0; k < 4; ++k)
+        q.pop(ev);
+  }
+  return (bench::now_ms() - t0) * 1e6 / n;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const bool check = bench::check_mode(argc, argv);
+
+  reject_case();
+  summarize_case();
+  spill_case();
+  recovery_case();
+
+  const int n = check ? 2000 : 100000;
+  const fs::path journal = scratch("timing.jsonl");
+  const double reject_ns = overflow_ns(OverflowPolicy::Reject, "", n);
+  const double summarize_ns = overflow_ns(OverflowPolicy::Summarize, "", n);
+  const double spill_ns = overflow_ns(OverflowPolicy::Spill, journal.string(), n);
+  fs::remove_all(journal.parent_path());
+
+  printf("%d pushes over budget (+ pops): Reject %.0f ns, Summarize %.0f ns, Spill %.0f ns per event\n", n, reject_ns,
+         summarize_ns, spill_ns);
+  return bench::result();
+}
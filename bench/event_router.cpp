@@ -0,0 +1,222 @@
+// Routing rules: compile time and per-event cost for 10-4000 random rules,
+// checked event by event against a plain top-to-bottom scan, plus the
+// RouteMatch::kMaxRules cap on "continue" chains.
+//
+//   bench_event_router [--check]
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "event_parse.hpp"
+#include "event_router.hpp"
+
+namespace {
+
+bool ieq(std::string_view text, const std::string& lower, bool prefix)
+{
+  if (prefix ? text.size() < lower.size() : text.size() != lower.size())
+    return false;
+  for (size_t i = 0; i < lower.size(); ++i) {
+    char c = text[i];
+    if (c >= 'A' && c <= 'Z')
+      c += 'a' - 'A';
+    if (c != lower[i])
+      return false;
+  }
+  return true;
+}
+
+bool rule_matches(const RouteRule& r, const TipEvent& ev)
+{
+  if (!(r.kinds & (1u << (int)ev.kind)))
+    return false;
+  if (ev.amount_milli < r.min_milli || ev.amount_milli >= r.max_milli)
+    return false;
+  if (!r.user.empty() && !ieq(ev.from_username(), r.user, false))
+    return false;
+  if (!r.account.empty() && !ieq(ev.account, r.account, false))
+    return false;
+  if (!r.message_prefix.empty() && !ieq(ev.message(), r.message_prefix, true))
+    return false;
+  return true;
+}
+
+// Reference: every rule tested in file order, same stopping rules
+void linear_scan(const std::vector<RouteRule>& rules, const TipEvent& ev, RouteMatch& out)
+{
+  out = RouteMatch();
+  for (uint32_t i = 0; i < rules.size(); ++i) {
+    if (!rule_matches(rules[i], ev))
+      continue;
+    out.rules[out.count++] = i;
+    out.drop = out.drop || rules[i].drop;
+    if (!rules[i].cont)
+      return;
+    if (out.count == RouteMatch::kMaxRules) {
+      out.truncated = true;
+      return;
+    }
+  }
+}
+
+bool same(const RouteMatch& a, const RouteMatch& b)
+{
+  if (a.count != b.count || a.drop != b.drop || a.truncated != b.truncated)
+    return false;
+  for (int i = 0; i < a.count; ++i)
+    if (a.rules[i] != b.rules[i])
+      return false;
+  return true;
+}
+
+// A mix of every condition kind; a quarter of the rules say "continue"
+std::string random_rules(std::mt19937& rng, int n)
+{
+  static const char* types[] = {"tip", "follow", "sub"};
+  std::string js = "{\"rules\":[";
+  for (int i = 0; i < n; ++i) {
+    js += i ? ",{" : "{";
+    js += "\"type\":\"" + std::string(types[rng() % 3]) + "\"";
+    switch (rng() % 5) {
+    case 0:
+    case 1: {
+      const int lo = (int)(rng() % 100000);
+      js += ",\"min\":" + std::to_string(lo) + ",\"max\":" + std::to_string(lo + 1 + rng() % 50);
+      break;
+    }
+    case 2: js += ",\"user\":\"user" + std::to_string(rng() % 300) + "\""; break;
+    case 3: js += ",\"message_prefix\":\"!cmd" + std::to_string(rng() % 200) + "\""; break;
+    default: js += ",\"account\":\"acc" + std::to_string(5 + rng() % 50) + "\""; break;
+    }
+    js += ",\"sources\":[\"S" + std::to_string(i % 20) + "\"]";
+    if (rng() % 4 == 0)
+      js += ",\"continue\":true";
+    js += "}";
+  }
+  return js + "]}";
+}
+
+std::vector<TipEvent> random_events(std::mt19937& rng, int n)
+{
+  const char* accounts[5];
+  for (int i = 0; i < 5; ++i)
+    accounts[i] = intern_symbol("acc" + std::to_string(i));
+
+  std::vector<TipEvent> evs(n);
+  for (TipEvent& ev : evs) {
+    ev.kind = (EventKind)(rng() % 3);
+    ev.amount_milli = (long long)(rng() % 100000) * 1000;
+    ev.account = accounts[rng() % 5];
+    const std::string msg = rng() % 3 == 0 ? "!cmd" + std::to_string(rng() % 250) + " please" : "hello there";
+    ev.set_text("User" + std::to_string(rng() % 400), "1", msg);
+  }
+  return evs;
+}
+
+bool build_table(const std::string& json, RouteTable& table, std::vector<RouteRule>* copy)
+{
+  RouteSet set;
+  std::string error;
+  if (parse_route_set(json, set, error)) {
+    if (copy)
+      *copy = set.rules;
+    if (table.build(std::move(set), error))
+      return true;
+  }
+  fprintf(stderr, "rules rejected: %s\n", error.c_str());
+  return false;
+}
+
+// Ten matching "continue" rules: the match holds the first kMaxRules
+void continue_cap()
+{
+  std::string js = "{\"rules\":[";
+  for (int i = 0; i < 10; ++i)
+    js += std::string(i ? "," : "") + "{\"type\":\"tip\",\"sources\":[\"S" + std::to_string(i) + "\"],\"continue\":true}";
+  js += "]}";
+
+  RouteTable table;
+  bench::expect(build_table(js, table, nullptr), "ten \"continue\" rules load");
+
+  TipEvent ev;
+  ev.kind = EventKind::Tip;
+  ev.set_text("someone", "1", "");
+  RouteMatch m;
+  table.evaluate(ev, m);
+  bench::expect(m.count == RouteMatch::kMaxRules, "a \"continue\" chain stops at kMaxRules matches");
+  bench::expect(m.truncated, "a capped chain is flagged");
+  bench::expect(m.rules[RouteMatch::kMaxRules - 1] == RouteMatch::kMaxRules - 1, "the first rules are the ones kept");
+
+  RouteTable short_table;
+  bench::expect(build_table("{\"rules\":[{\"type\":\"tip\",\"sources\":[\"A\"],\"continue\":true},"
+                            "{\"type\":\"tip\",\"sources\":[\"B\"]}]}",
+                            short_table, nullptr),
+                "two rules load");
+  short_table.evaluate(ev, m);
+  bench::expect(m.count == 2 && !m.truncated, "a chain under the cap is not flagged");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const bool check = bench::check_mode(argc, argv);
+
+  continue_cap();
+
+  const std::vector<int> sizes = check ? std::vector<int>{1000} : std::vector<int>{10, 100, 1000, 4000};
+  const int events_n = check ? 1024 : 4096;
+  const int rounds = check ? 4 : 200;
+
+  printf("%8s  %10s  %14s  %14s\n", "rules", "build ms", "table ns/evt", "linear ns/evt");
+  for (int rules_n : sizes) {
+    std::mt19937 rng(42 + rules_n);
+    const std::string json = random_rules(rng, rules_n);
+    const std::vector<TipEvent> evs = random_events(rng, events_n);
+
+    std::vector<RouteRule> rules;
+    RouteTable table;
+    const double t0 = bench::now_ms();
+    if (!build_table(json, table, &rules)) {
+      bench::expect(false, "random rules load");
+      continue;
+    }
+    const double build_ms = bench::now_ms() - t0;
+
+    size_t mismatches = 0, matched = 0;
+    RouteMatch a, b;
+    for (const TipEvent& ev : evs) {
+      table.evaluate(ev, a);
+      linear_scan(rules, ev, b);
+      mismatches += !same(a, b);
+      matched += a.count > 0;
+    }
+
+    long sink = 0;
+    const double t1 = bench::now_ms();
+    for (int r = 0; r < rounds; ++r)
+      for (const TipEvent& ev : evs) {
+        table.evaluate(ev, a);
+        sink += a.count;
+      }
+    const double table_ns = (bench::now_ms() - t1) * 1e6 / ((double)rounds * events_n);
+
+    // the reference is slower: fewer rounds
+    const int linear_rounds = rounds > 10 ? rounds / 10 : 1;
+    const double t2 = bench::now_ms();
+    for (int r = 0; r < linear_rounds; ++r)
+      for (const TipEvent& ev : evs) {
+        linear_scan(rules, ev, b);
+        sink += b.count;
+      }
+    const double linear_ns = (bench::now_ms() - t2) * 1e6 / ((double)linear_rounds * events_n);
+
+    printf("%8d  %10.2f  %14.0f  %14.0f   (%zu of %d events matched, sink %ld)\n",
+           rules_n, build_ms, table_ns, linear_ns, matched, events_n, sink & 1);
+    bench::expect(mismatches == 0, "compiled table matches the same rules as the top-to-bottom scan");
+  }
+
+  return bench::result();
+}
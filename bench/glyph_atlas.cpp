@@ -0,0 +1,158 @@
+// Glyph atlas: cost of laying out an alert against a warm atlas (no
+// rasterization) and of rasterizing new glyphs, plus the layout's reveal
+// order, line metrics, glyph reuse and what happens when the atlas fills.
+// Needs FreeType and an installed font; skipped otherwise.
+//
+//   bench_glyph_atlas [--check]
+
+#include <string>
+#include <thread>
+
+#include "bench_util.hpp"
+#include "glyph_atlas.hpp"
+#include "text_timeline.hpp"
+
+namespace {
+
+FontFile any_font()
+{
+  for (const char* face : {"DejaVu Sans", "Arial", "Liberation Sans", "Segoe UI", "Helvetica", "Noto Sans"}) {
+    FontFile f = find_font_file(face);
+    if (!f.empty())
+      return f;
+  }
+  return FontFile();
+}
+
+// Code points [from, from + count) as UTF-8
+std::string code_points(char32_t from, int count)
+{
+  std::string s;
+  for (char32_t cp = from; cp < from + (char32_t)count; ++cp) {
+    if (cp < 0x800) {
+      s += (char)(0xC0 | (cp >> 6));
+      s += (char)(0x80 | (cp & 0x3F));
+    } else {
+      s += (char)(0xE0 | (cp >> 12));
+      s += (char)(0x80 | ((cp >> 6) & 0x3F));
+      s += (char)(0x80 | (cp & 0x3F));
+    }
+  }
+  return s;
+}
+
+void layout_checks(const FontFile& font)
+{
+  GlyphAtlas atlas;
+  std::string error;
+  bench::expect(atlas.open(font, 36, error), "atlas opens the font");
+
+  const std::string text = "bob tipped 12.500 TWICH\nhello there \xF0\x9F\x98\x80 \xD0\xBF\xD1\x80\xD0\xB8";
+  TextLayout lay;
+  bench::expect(atlas.layout(text, lay), "alert text lays out");
+
+  const RevealLayout reveal = RevealLayout::measure(text);
+  bench::expect(lay.chars == reveal.total, "layout counts characters as RevealLayout does");
+  bench::expect(lay.height > 0 && lay.height % 2 == 0 && lay.width > 0, "two lines, non-empty glyph box");
+  bench::expect(lay.shown_quads(0.0f) == 0 && lay.shown_quads(1.0f) == lay.quads.size(), "reveal ends");
+
+  size_t last = 0;
+  bool monotone = true;
+  for (int i = 0; i <= 100; ++i) {
+    const size_t n = lay.shown_quads((float)i / 100.0f);
+    monotone = monotone && n >= last;
+    last = n;
+  }
+  bench::expect(monotone, "reveal shows quads in text order");
+
+  bool in_atlas = true;
+  for (const GlyphQuad& q : lay.quads)
+    in_atlas = in_atlas && q.u0 >= 0.0f && q.v0 >= 0.0f && q.u1 <= 1.0f && q.v1 <= 1.0f && q.x1 > q.x0;
+  bench::expect(in_atlas, "quads sample inside the atlas");
+
+  const uint64_t before = atlas.rasterized();
+  const uint64_t gen = atlas.generation();
+  TextLayout again;
+  atlas.layout(text, again);
+  bench::expect(atlas.rasterized() == before && atlas.generation() == gen, "a repeated text rasterizes nothing");
+}
+
+void overflow_checks(const FontFile& font)
+{
+  GlyphAtlas atlas;
+  std::string error;
+  atlas.open(font, 96, error);
+
+  // more 96 px glyphs than the atlas holds: it starts over
+  TextLayout lay;
+  const uint64_t epoch = atlas.epoch();
+  for (char32_t block : {0x0100, 0x0180, 0x0391, 0x0410, 0x0450, 0x1E00, 0x1E80}) {
+    atlas.layout(code_points(block, 64), lay);
+  }
+  bench::expect(atlas.epoch() > epoch, "a full atlas starts over");
+  bench::expect(atlas.layout("after the reset", lay) && lay.epoch == atlas.epoch(),
+                "layouts after a reset carry the new epoch");
+
+  // one text with more glyphs than even an empty atlas holds
+  bench::expect(!atlas.layout(code_points(0x0100, 400) + code_points(0x0400, 250), lay) && lay.quads.empty(),
+                "a text too large for the atlas fails cleanly");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const bool check = bench::check_mode(argc, argv);
+
+  const FontFile font = any_font();
+  if (font.empty()) {
+    printf("no FreeType or no installed font: skipped\n");
+    return bench::result();
+  }
+  printf("font: %s (face %d)\n", font.path.c_str(), font.index);
+
+  layout_checks(font);
+  overflow_checks(font);
+
+  // loader: font lookup + ASCII warm-up on the worker pool
+  {
+    GlyphAtlasLoader loader;
+    const double t0 = bench::now_ms();
+    loader.submit("DejaVu Sans", 36);
+    while (!loader.has_ready() && bench::now_ms() - t0 < 10000.0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::shared_ptr<GlyphAtlas> atlas;
+    bench::expect(loader.take_ready(atlas) && atlas && atlas->glyphs() >= 94, "loader warms the ASCII glyphs");
+    printf("loader: atlas ready in %.1f ms (font index already built)\n", bench::now_ms() - t0);
+  }
+
+  const int rounds = check ? 200 : 20000;
+  const std::string alert = "a_rather_long_telegram_username tipped 1234.500 TWICH\n"
+                            "thanks for the stream, this one is for the new emote!";
+
+  GlyphAtlas atlas;
+  std::string error;
+  atlas.open(font, 36, error);
+
+  TextLayout lay;
+  double t0 = bench::now_ms();
+  atlas.layout(alert, lay);
+  const double cold_ms = bench::now_ms() - t0;
+  const uint64_t cold_glyphs = atlas.rasterized();
+
+  t0 = bench::now_ms();
+  for (int i = 0; i < rounds; ++i)
+    atlas.layout(alert, lay);
+  const double warm_us = (bench::now_ms() - t0) * 1e3 / rounds;
+
+  printf("%-34s  %10s\n", "step", "time");
+  printf("%-34s  %8.2f ms  (%llu glyphs rasterized)\n", "first alert, cold atlas", cold_ms,
+         (unsigned long long)cold_glyphs);
+  printf("%-34s  %8.2f us  (%zu quads, one draw per pass)\n", "later alerts, warm atlas", warm_us,
+         lay.quads.size());
+  printf("atlas: %u x %u, %zu glyphs cached\n", atlas.size(), atlas.size(), atlas.glyphs());
+
+  bench::expect(atlas.rasterized() == cold_glyphs, "warm layouts rasterize nothing");
+
+  return bench::result();
+}
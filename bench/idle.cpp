@@ -0,0 +1,91 @@
+// Idle cost of 50 alert sources per video frame: the tick's parked path
+// (atomic checks only) against polling the queues (clock read, expire(),
+// a locked pop()), plus the flags the parked path relies on.
+//
+//   bench_idle [--check]
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "approval_queue.hpp"
+#include "bench_util.hpp"
+#include "event_queue.hpp"
+
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr int kSources = 50;
+
+// The per-source state the tick looks at while nothing plays
+struct Source {
+  TipEventQueue queue;
+  ApprovalQueue held;
+};
+
+void flag_cases()
+{
+  TipEventQueue q;
+  TipEvent ev;
+  bench::expect(!q.pending(), "a new queue is not pending");
+  TipEvent e;
+  e.amount_milli = 1000;
+  bench::expect(q.push(std::move(e)) && q.pending(), "push sets pending");
+  bench::expect(q.pop(ev) && !q.pop(ev) && !q.pending(), "the pop that finds nothing clears pending");
+
+  ApprovalQueue held;
+  std::vector<TipEvent> due;
+  bench::expect(!held.may_expire(), "nothing held: no clock read needed");
+  held.set_timeout(20ms);
+  held.push(TipEvent());
+  bench::expect(held.may_expire(), "a held event with a timeout can expire");
+  bench::expect(held.expire(ApprovalQueue::Clock::now(), due) == 0, "nothing expires before the deadline");
+  std::this_thread::sleep_for(30ms);
+  bench::expect(held.expire(ApprovalQueue::Clock::now(), due) == 1, "the hold expires once the deadline passes");
+  bench::expect(!held.may_expire(), "back to no clock read once it expired");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const bool check = bench::check_mode(argc, argv);
+
+  flag_cases();
+
+  const int frames = check ? 2000 : 200000;
+  auto sources = std::make_unique<Source[]>(kSources);
+  for (int i = 0; i < kSources; ++i)
+    sources[i].held.set_timeout(60000ms);
+
+  std::vector<TipEvent> due;
+  TipEvent ev;
+  size_t sink = 0;
+
+  // what every idle tick did before sources parked
+  const double t0 = bench::now_ms();
+  for (int f = 0; f < frames; ++f)
+    for (int i = 0; i < kSources; ++i) {
+      sink += sources[i].held.expire(ApprovalQueue::Clock::now(), due);
+      sink += sources[i].queue.pop(ev);
+    }
+  const double poll_ns = (bench::now_ms() - t0) * 1e6 / frames;
+
+  // the parked tick: two atomic loads per source
+  bool parked = true;
+  const double t1 = bench::now_ms();
+  for (int f = 0; f < frames; ++f)
+    for (int i = 0; i < kSources; ++i) {
+      if (sources[i].held.may_expire())
+        sink += sources[i].held.expire(ApprovalQueue::Clock::now(), due);
+      parked = parked && !sources[i].queue.pending();
+    }
+  const double idle_ns = (bench::now_ms() - t1) * 1e6 / frames;
+
+  bench::expect(parked && sink == 0, "idle sources stay parked");
+
+  printf("%d idle sources: polling %.0f ns/frame (%.1f ns/source), parked %.0f ns/frame (%.2f ns/source)\n",
+         kSources, poll_ns, poll_ns / kSources, idle_ns, idle_ns / kSources);
+  return bench::result();
+}
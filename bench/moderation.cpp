@@ -0,0 +1,209 @@
+// Word-list matcher: build time and per-message scan cost for 1k-50k term
+// lists, checked against a term-by-term search, plus the word-boundary
+// cases (emoji, Unicode punctuation, other scripts) and the background
+// word list loader.
+//
+//   bench_moderation [--check]
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "moderation.hpp"
+#include "unicode_word.hpp"
+
+namespace {
+
+std::string random_word(std::mt19937& rng, int min_len, int max_len)
+{
+  std::uniform_int_distribution<int> len(min_len, max_len);
+  std::uniform_int_distribution<int> letter('a', 'z');
+  std::string w;
+  for (int i = len(rng); i > 0; --i)
+    w += (char)letter(rng);
+  return w;
+}
+
+// 140-byte chat line: words from the list now and then, separated by
+// spaces, ASCII/Unicode punctuation, emoji and Cyrillic words
+std::string random_message(std::mt19937& rng, const std::vector<std::string>& terms)
+{
+  static const char* seps[] = {" ", " ", " ", ", ", "! ", "\xE2\x80\x94", "\xF0\x9F\x98\x80", "\xE2\x80\xA6 ",
+                               " \xD0\xBF\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82 "};
+  std::uniform_int_distribution<size_t> pick_term(0, terms.size() - 1);
+  std::uniform_int_distribution<size_t> pick_sep(0, std::size(seps) - 1);
+  std::uniform_int_distribution<int> coin(0, 9);
+
+  std::string m;
+  while (m.size() < 140) {
+    m += coin(rng) == 0 ? terms[pick_term(rng)] : random_word(rng, 2, 8);
+    m += seps[pick_sep(rng)];
+  }
+  utf8_truncate(m, 140);
+  return m;
+}
+
+// Reference: every term searched on its own, same boundary rule
+size_t naive_hits(const std::vector<std::string>& terms, const std::string& text)
+{
+  const uint8_t* d = (const uint8_t*)text.data();
+  const size_t n = text.size();
+  size_t hits = 0;
+  for (const std::string& t : terms) {
+    for (size_t at = text.find(t); at != std::string::npos; at = text.find(t, at + 1)) {
+      const size_t end = at + t.size();
+      const bool left = at > 0 && is_word_code_point(utf8_decode_before(d, n, at));
+      const bool right = end < n && is_word_code_point(utf8_decode_at(d, n, end));
+      if (!left && !right)
+        hits++;
+    }
+  }
+  return hits;
+}
+
+bool blocks(const BlocklistMatcher& m, const char* text)
+{
+  return m.scan(text);
+}
+
+void boundary_cases()
+{
+  BlocklistMatcher m;
+  m.build({"spam", "*scam*", "\xD0\xBC\xD0\xB0\xD1\x82"}); // "мат"
+
+  bench::expect(blocks(m, "spam"), "bare term");
+  bench::expect(blocks(m, "SPAM!"), "ASCII punctuation after, folded case");
+  bench::expect(blocks(m, "spam\xF0\x9F\x98\x80"), "emoji after (spam😀)");
+  bench::expect(blocks(m, "\xE2\x9D\xA4\xEF\xB8\x8Fspam"), "emoji with variation selector before (❤️spam)");
+  bench::expect(blocks(m, "spam\xE2\x80\x94" "and more"), "em dash after (spam—)");
+  bench::expect(blocks(m, "\xC2\xABspam\xC2\xBB"), "guillemets around («spam»)");
+  bench::expect(blocks(m, "spam\xE2\x80\xA6"), "ellipsis after (spam…)");
+  bench::expect(!blocks(m, "spammer"), "ASCII letter after");
+  bench::expect(!blocks(m, "spam\xC3\xA9"), "Latin letter after (spamé)");
+  bench::expect(!blocks(m, "\xD0\xB6spam"), "Cyrillic letter before (жspam)");
+  bench::expect(!blocks(m, "spam\xD9\xA3"), "Arabic-Indic digit after");
+  bench::expect(!blocks(m, "spam\xCC\x81"), "combining accent after");
+  bench::expect(blocks(m, "\xD0\x9C\xD0\x90\xD0\xA2!"), "Cyrillic term, folded (МАТ!)");
+  bench::expect(!blocks(m, "\xD0\xBC\xD0\xB0\xD1\x82\xD1\x8C"), "Cyrillic term inside a word (мать)");
+  bench::expect(blocks(m, "bigscammer"), "open term inside a word");
+}
+
+ModerationVerdict verdict(const ModerationStage& stage, const char* message)
+{
+  TipEvent ev;
+  ev.set_text("viewer", "1.000", message);
+  return stage.apply(ev);
+}
+
+// Waits until the loader has applied `n` lists in all
+bool wait_loaded(const WordListLoader& loader, uint64_t n)
+{
+  for (int i = 0; i < 3000 && loader.loaded() < n; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  return loader.loaded() >= n;
+}
+
+void loader_cases()
+{
+  namespace fs = std::filesystem;
+  const fs::path dir = fs::temp_directory_path() / "twich_bench_moderation";
+  fs::create_directories(dir);
+  const std::string list = (dir / "words.txt").string();
+  std::ofstream(list) << "# comment\nspam\nscam\n";
+
+  ModerationStage stage;
+  WordListLoader loader(stage);
+  std::string last_error;
+  loader.set_on_load([&](const std::string&, size_t, const std::string& error) { last_error = error; });
+
+  loader.submit(list, ModerationPolicy::Drop);
+  bench::expect(wait_loaded(loader, 1) && loader.terms() == 2, "a list is built in the background");
+  bench::expect(verdict(stage, "buy spam now") == ModerationVerdict::Drop, "the built list is applied by the stage");
+
+  // a burst of edits: lists not started yet are replaced, the last one wins
+  const int burst = 50;
+  for (int i = 0; i < burst; ++i)
+    loader.submit(i % 2 ? list : std::string(), ModerationPolicy::Hold);
+  loader.submit(list, ModerationPolicy::Mask);
+  for (int i = 0; i < 3000 && verdict(stage, "buy spam now") != ModerationVerdict::Masked; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  bench::expect(verdict(stage, "buy spam now") == ModerationVerdict::Masked, "the last list submitted is applied");
+  bench::expect(loader.loaded() < 1 + burst + 1, "lists replaced before they started are skipped");
+
+  const uint64_t n = loader.loaded();
+  loader.submit((dir / "missing.txt").string(), ModerationPolicy::Drop);
+  bench::expect(wait_loaded(loader, n + 1) && loader.terms() == 0 && !last_error.empty() &&
+                    verdict(stage, "buy spam now") == ModerationVerdict::Clean,
+                "a missing list reports an error and turns the list off");
+
+  loader.stop();
+  fs::remove_all(dir);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const bool check = bench::check_mode(argc, argv);
+
+  boundary_cases();
+  loader_cases();
+
+  const int sizes_full[] = {1000, 10000, 50000};
+  const int sizes_check[] = {10000};
+  const int messages = check ? 200 : 20000;
+
+  printf("%8s  %10s  %12s  %14s\n", "terms", "build ms", "scan ns/msg", "naive ns/msg");
+  for (int terms_n : check ? std::vector<int>(std::begin(sizes_check), std::end(sizes_check))
+                           : std::vector<int>(std::begin(sizes_full), std::end(sizes_full))) {
+    std::mt19937 rng(1234 + terms_n);
+    std::vector<std::string> terms;
+    terms.reserve(terms_n);
+    for (int i = 0; i < terms_n; ++i)
+      terms.push_back(random_word(rng, 4, 10));
+
+    std::vector<std::string> msgs;
+    for (int i = 0; i < messages; ++i)
+      msgs.push_back(random_message(rng, terms));
+
+    BlocklistMatcher m;
+    const double t0 = bench::now_ms();
+    m.build(terms);
+    const double build_ms = bench::now_ms() - t0;
+
+    std::vector<BlocklistMatcher::Hit> hits;
+    size_t found = 0;
+    const double t1 = bench::now_ms();
+    for (const std::string& msg : msgs) {
+      hits.clear();
+      m.scan(msg, &hits);
+      found += hits.size();
+    }
+    const double scan_ns = (bench::now_ms() - t1) * 1e6 / messages;
+
+    // the reference is slow: a sample of the messages
+    const int sample = std::min(messages, check ? 200 : 500);
+    size_t expected = 0, sampled = 0;
+    const double t2 = bench::now_ms();
+    for (int i = 0; i < sample; ++i)
+      expected += naive_hits(terms, msgs[i]);
+    const double naive_ns = (bench::now_ms() - t2) * 1e6 / sample;
+    for (int i = 0; i < sample; ++i) {
+      hits.clear();
+      m.scan(msgs[i], &hits);
+      sampled += hits.size();
+    }
+
+    printf("%8d  %10.2f  %12.0f  %14.0f   (%zu hits in %d messages)\n",
+           terms_n, build_ms, scan_ns, naive_ns, found, messages);
+    bench::expect(sampled == expected, "matcher finds the same hits as the term-by-term search");
+  }
+
+  return bench::result();
+}
@@ -0,0 +1,141 @@
+// Account teardown order: a re-acquired account dropped while an earlier
+// instance is still closing (the case that used to deadlock), other names
+// not waiting, and the cost of an open + close on a closer thread.
+//
+//   bench_ordered_closer [--check]
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "ordered_closer.hpp"
+
+namespace {
+
+using namespace std::chrono_literals;
+
+// Stands in for TelegramAccount: the starter waits for earlier instances,
+// the destructor joins it
+struct FakeAccount {
+  OrderedCloser& closer;
+  const std::string name;
+  const uint64_t generation;
+  std::atomic<bool> started{false};
+  std::thread starter;
+
+  FakeAccount(OrderedCloser& c, std::string n)
+    : closer(c), name(std::move(n)), generation(c.open(name))
+  {
+    starter = std::thread([this] {
+      closer.wait_closed_before(name, generation);
+      started = true;
+    });
+  }
+
+  ~FakeAccount() { starter.join(); }
+};
+
+// Released by hand: keeps a close running
+struct Latch {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool open = false;
+
+  void wait()
+  {
+    std::unique_lock<std::mutex> lk(mutex);
+    cv.wait(lk, [this] { return open; });
+  }
+  void release()
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    open = true;
+    cv.notify_all();
+  }
+};
+
+void drop(OrderedCloser& closer, FakeAccount* a, Latch* hold = nullptr)
+{
+  closer.close(a->name, a->generation, [a, hold] {
+    if (hold)
+      hold->wait();
+    delete a;
+  });
+}
+
+// A hang here is the bug; fail instead of blocking ctest until its timeout
+void finish_within(OrderedCloser& closer, const char* what)
+{
+  auto done = std::async(std::launch::async, [&closer] { closer.wait_all(); });
+  if (done.wait_for(3s) != std::future_status::ready) {
+    fprintf(stderr, "FAILED: %s (still closing after 3 s)\n", what);
+    std::_Exit(1);
+  }
+}
+
+bool soon(const std::atomic<bool>& flag)
+{
+  for (int i = 0; i < 2000 && !flag; ++i)
+    std::this_thread::sleep_for(1ms);
+  return flag;
+}
+
+void reacquire_while_closing()
+{
+  OrderedCloser closer;
+  Latch slow_stop;
+
+  auto* first = new FakeAccount(closer, "x");
+  bench::expect(soon(first->started), "the first instance starts at once");
+  drop(closer, first, &slow_stop); // TDLib still stopping
+
+  auto* second = new FakeAccount(closer, "x"); // switched back to the account
+  auto* other = new FakeAccount(closer, "y");
+  bench::expect(soon(other->started), "another account does not wait");
+  std::this_thread::sleep_for(50ms);
+  bench::expect(!second->started, "the re-acquired instance waits for the earlier one");
+
+  drop(closer, second); // switched away again before it started
+  auto* third = new FakeAccount(closer, "x");
+  bench::expect(closer.closing() == 2, "both instances are closing");
+
+  slow_stop.release();
+  bench::expect(soon(third->started), "a later instance starts once the earlier ones closed");
+
+  drop(closer, third);
+  drop(closer, other);
+  finish_within(closer, "a re-acquired account dropped while an earlier one closes");
+  bench::expect(closer.closing() == 0, "nothing left closing");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const bool check = bench::check_mode(argc, argv);
+
+  reacquire_while_closing();
+
+  const int n = check ? 200 : 5000;
+  OrderedCloser closer;
+  const double t0 = bench::now_ms();
+  for (int i = 0; i < n; ++i) {
+    const std::string name = "acc" + std::to_string(i % 8);
+    const uint64_t gen = closer.open(name);
+    closer.close(name, gen, [] {});
+  }
+  const double queued_ms = bench::now_ms() - t0;
+  finish_within(closer, "plain closes");
+  const double all_ms = bench::now_ms() - t0;
+
+  printf("%d instances: open + close %.1f us each on the caller, all closed in %.1f ms\n", n, queued_ms * 1000.0 / n,
+         all_ms);
+  return bench::result();
+}
@@ -0,0 +1,135 @@
+// Session key: time to create a key, read it back from its store and hit
+// the process cache, plus the key's shape, the key file's mode, older
+// "TWK1" key files and a damaged file that must not be replaced.
+//
+//   bench_session_key [--check]
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include "bench_util.hpp"
+#include "session_key.hpp"
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+std::string temp_key_path(const char* tag)
+{
+  std::random_device rd;
+  const auto dir = std::filesystem::temp_directory_path();
+  return (dir / ("twich_bench_" + std::string(tag) + "_" + std::to_string(rd()) + ".key")).string();
+}
+
+void write_raw(const std::string& path, const std::string& bytes)
+{
+  std::ofstream f(path, std::ios::binary | std::ios::trunc);
+  f.write(bytes.data(), (std::streamsize)bytes.size());
+}
+
+struct Times {
+  double created = 0, store = 0, cache = 0;
+};
+
+void round_trip(const std::string& path, Times& t)
+{
+  std::string error;
+  SessionKey made, read, cached;
+
+  const bool ok_made = session_key_get(path, made, error);
+  bench::expect(ok_made && made.from == SessionKey::From::Created, "a missing key file gets a new key");
+  bench::expect(made.key.size() == 44 && made.key.back() == '=', "the key is 32 bytes (44 base64 chars)");
+
+  session_key_evict(path);
+  const bool ok_read = session_key_load(path, read, error);
+  bench::expect(ok_read && read.from == SessionKey::From::Store, "an evicted key is read from its store");
+  bench::expect(read.key == made.key, "the stored key reads back unchanged");
+  bench::expect(read.protection == made.protection, "the store reports the protection it was written with");
+
+  const bool ok_cached = session_key_get(path, cached, error);
+  bench::expect(ok_cached && cached.from == SessionKey::From::Cache && cached.key == made.key,
+                "a second call hits the process cache");
+
+  t.created += made.ms;
+  t.store += read.ms;
+  t.cache += cached.ms;
+}
+
+void file_checks()
+{
+  std::string error;
+  SessionKey k;
+
+  const std::string path = temp_key_path("checks");
+  bench::expect(!session_key_load(path, k, error) && error.empty(), "loading a missing key fails quietly");
+
+  bench::expect(session_key_get(path, k, error), "key created");
+  printf("protection: %s%s%s\n", session_key_protection_name(k.protection), k.note.empty() ? "" : " - ",
+         k.note.c_str());
+#ifndef _WIN32
+  struct stat st {};
+  bench::expect(::stat(path.c_str(), &st) == 0 && (st.st_mode & 0777) == 0600, "the key file is mode 0600");
+#endif
+
+  session_key_forget(path);
+  bench::expect(!std::filesystem::exists(path), "forget removes the key file");
+  SessionKey again;
+  bench::expect(session_key_get(path, again, error) && again.key != k.key, "a forgotten key is not reused");
+  session_key_forget(path);
+
+  // damaged file: the database may still need the real key, keep the file
+  write_raw(path, std::string("TWK2F") + "short");
+  const auto size_before = std::filesystem::file_size(path);
+  bench::expect(!session_key_get(path, k, error) && !error.empty(), "a damaged key file is an error");
+  bench::expect(std::filesystem::file_size(path) == size_before, "a damaged key file is not replaced");
+  std::filesystem::remove(path);
+
+#ifndef _WIN32
+  // written before the keystores: "TWK1" + the bare key
+  std::string raw(32, '\0');
+  for (size_t i = 0; i < raw.size(); ++i)
+    raw[i] = (char)(i * 7 + 3);
+  write_raw(path, "TWK1" + raw);
+  bench::expect(session_key_load(path, k, error) && k.from == SessionKey::From::Store, "TWK1 key file is read");
+  bench::expect(k.key == base64_encode((const uint8_t*)raw.data(), raw.size()), "TWK1 key reads back unchanged");
+
+  session_key_evict(path);
+  SessionKey reread;
+  bench::expect(session_key_load(path, reread, error) && reread.key == k.key &&
+                  reread.protection == k.protection,
+                "a TWK1 key survives its move to the current format");
+  session_key_forget(path);
+#endif
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const bool check = bench::check_mode(argc, argv);
+  const int rounds = check ? 3 : 50;
+
+  file_checks();
+
+  Times t;
+  for (int i = 0; i < rounds; ++i) {
+    const std::string path = temp_key_path("round");
+    round_trip(path, t);
+    session_key_forget(path);
+  }
+
+  printf("%-24s  %10s\n", "step", "ms (mean)");
+  printf("%-24s  %10.3f\n", "create and store", t.created / rounds);
+  printf("%-24s  %10.3f\n", "read from store", t.store / rounds);
+  printf("%-24s  %10.4f\n", "process cache", t.cache / rounds);
+
+  // no key derivation left: even the slow path is file (and keystore) I/O
+  if (!check)
+    bench::expect(t.store / rounds < 50.0, "reading the key takes well under the old 165 ms scrypt cost");
+
+  return bench::result();
+}
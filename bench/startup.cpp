@@ -0,0 +1,135 @@
+// Scene-collection load: time for the core part of creating 1-100 alert
+// sources at default settings, next to the work that no longer runs while
+// OBS creates them. Font lookup and glyph warm-up finish on the worker pool
+// afterwards; the session key (first TDLib start) waits for activation.
+//
+//   bench_startup [--check]
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "alert_scheduler.hpp"
+#include "approval_queue.hpp"
+#include "bench_util.hpp"
+#include "event_queue.hpp"
+#include "glyph_atlas.hpp"
+#include "moderation.hpp"
+#include "session_key.hpp"
+#include "sound_bank.hpp"
+
+namespace {
+
+constexpr int kTiers = 10; // tiers per kind in the settings
+
+// Core state a tip_alert_source sets up in create
+struct CoreSource {
+  TipEventQueue queue;
+  ApprovalQueue held;
+  ModerationStage moderation;
+  AlertScheduler sched;
+  AlertProfile profiles[kEventKindCount];
+  SoundBankLoader sounds;
+  GlyphAtlasLoader glyphs;
+};
+
+// What tip_alert_create -> tip_alert_update does outside libobs, with the
+// default settings: tier tables, lanes, moderation, queue budget, and the
+// background loaders it hands work to
+std::unique_ptr<CoreSource> create_source()
+{
+  auto s = std::make_unique<CoreSource>();
+
+  s->glyphs.submit("Arial", 36);
+  s->sched.set_lanes(1);
+
+  for (int k = 0; k < kEventKindCount; ++k) {
+    const EventKindInfo& info = event_kind_info((EventKind)k);
+    std::vector<TierSpec> specs(kTiers);
+    for (int t = 0; t < kTiers; ++t)
+      specs[t].min_milli = (long long)(info.default_thresholds[t < 3 ? t : 2] * 1000.0);
+    build_alert_profile(s->profiles[k], (EventKind)k, std::move(specs), info.default_template, 5.0f);
+  }
+  s->sounds.submit({}, 48000);
+
+  s->moderation.set(nullptr, ModerationPolicy::Mask);
+  s->held.set_timeout(std::chrono::seconds(60));
+  s->queue.configure(256 * 1024, OverflowPolicy::Summarize, "");
+  return s;
+}
+
+bool wait_for(const std::function<bool()>& done, double timeout_ms)
+{
+  const double until = bench::now_ms() + timeout_ms;
+  while (!done()) {
+    if (bench::now_ms() > until)
+      return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+// Deferred to the first activation: getting the account's session key
+// (created on the very first run), what TDLib bring-up does in the core
+double first_run_key_ms()
+{
+  std::random_device rd;
+  const std::string path =
+      (std::filesystem::temp_directory_path() / ("twich_bench_startup_" + std::to_string(rd()) + ".key")).string();
+
+  SessionKey key;
+  std::string error;
+  const bool ok = session_key_get(path, key, error);
+  bench::expect(ok && key.from == SessionKey::From::Created, "first run creates the session key");
+  session_key_forget(path);
+  return key.ms;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const bool check = bench::check_mode(argc, argv);
+
+  const std::vector<int> counts = check ? std::vector<int>{20} : std::vector<int>{1, 20, 100};
+
+  printf("%8s  %10s  %12s  %14s\n", "sources", "create ms", "ms/source", "background ms");
+  for (int n : counts) {
+    std::vector<std::unique_ptr<CoreSource>> sources;
+    sources.reserve(n);
+
+    const double t0 = bench::now_ms();
+    for (int i = 0; i < n; ++i)
+      sources.push_back(create_source());
+    const double create_ms = bench::now_ms() - t0;
+
+    // the loaders' work, finished on the pool while OBS goes on loading
+    auto all_ready = [&] {
+      for (const auto& s : sources)
+        if (!s->glyphs.has_ready() || !s->sounds.has_ready())
+          return false;
+      return true;
+    };
+    bench::expect(wait_for(all_ready, 30000), "every source's background loads finish");
+    const double background_ms = bench::now_ms() - t0;
+
+    size_t atlases = 0;
+    for (const auto& s : sources) {
+      std::shared_ptr<GlyphAtlas> atlas;
+      s->glyphs.take_ready(atlas);
+      atlases += atlas != nullptr;
+      bench::expect(s->sounds.take_ready() != nullptr, "an empty sound bank is delivered");
+      bench::expect(s->profiles[0].tiers.size() == (size_t)kTiers, "tier tables are built in create");
+    }
+
+    printf("%8d  %10.2f  %12.3f  %14.1f   (%zu with a glyph atlas)\n", n, create_ms, create_ms / n, background_ms,
+           atlases);
+  }
+
+  printf("deferred to first activation: session key, first run %.2f ms\n", first_run_key_ms());
+  return bench::result();
+}
@@ -0,0 +1,174 @@
+// Text effects: spec compile time and per-frame sample cost for every
+// preset, plus keys measured from the end of the alert, presets against
+// their specs, easing, and the errors a bad spec reports.
+//
+//   bench_text_timeline [--check]
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "text_timeline.hpp"
+
+namespace {
+
+bool near(float a, float b) { return std::fabs(a - b) < 1e-4f; }
+
+TextTimeline compiled(const char* spec)
+{
+  TextTimeline tl;
+  std::string error;
+  if (!tl.compile(spec, error))
+    fprintf(stderr, "  %s: %s\n", spec, error.c_str());
+  return tl;
+}
+
+float alpha_at(const TextTimeline& tl, float t, float duration) { return tl.sample(t, duration).alpha; }
+
+void end_key_cases()
+{
+  const TextTimeline tl = compiled("alpha 0 0, 0.5 1, end-1 1, end 0");
+  bench::expect(near(alpha_at(tl, 0.25f, 4.0f), 0.5f) && near(alpha_at(tl, 2.0f, 4.0f), 1.0f),
+                "keys from the start ramp in");
+  bench::expect(near(alpha_at(tl, 3.5f, 4.0f), 0.5f) && near(alpha_at(tl, 4.0f, 4.0f), 0.0f),
+                "end-1 and end fade out over the last second");
+  bench::expect(near(alpha_at(tl, 3.5f, 8.0f), 1.0f) && near(alpha_at(tl, 7.5f, 8.0f), 0.5f),
+                "end keys follow the alert's length");
+
+  // a 1 s alert: end-1 would land before 0.5, so it is squeezed onto it
+  bench::expect(near(alpha_at(tl, 0.25f, 1.0f), 0.5f) && near(alpha_at(tl, 0.75f, 1.0f), 0.5f) &&
+                    near(alpha_at(tl, 1.0f, 1.0f), 0.0f),
+                "a short alert squeezes end keys instead of reordering them");
+
+  bench::expect(near(alpha_at(tl, -1.0f, 4.0f), 0.0f) && near(alpha_at(tl, 9.0f, 4.0f), 0.0f),
+                "before the first and after the last key the value holds");
+
+  const TimelineSample s = tl.sample(2.0f, 4.0f);
+  bench::expect(s.x == 0.0f && s.y == 0.0f && s.scale == 1.0f && s.reveal == 1.0f,
+                "tracks without keys keep their defaults");
+}
+
+void ease_cases()
+{
+  const TextTimeline tl = compiled("scale 0 0, 1 1 out-back; alpha 0 0, 1 2; x 0 0, 1 100 step");
+  bench::expect(tl.sample(0.8f, 5.0f).scale > 1.0f, "out-back overshoots on scale");
+  bench::expect(near(tl.sample(0.75f, 5.0f).alpha, 1.0f), "alpha is clamped to 1");
+  bench::expect(tl.sample(0.99f, 5.0f).x == 0.0f && tl.sample(1.0f, 5.0f).x == 100.0f,
+                "step holds until its keyframe");
+
+  bench::expect(apply_ease(Ease::OutBounce, 1.0f) == 1.0f && apply_ease(Ease::OutElastic, 0.0f) == 0.0f,
+                "every ease starts at 0 and ends at 1");
+  bench::expect(near(apply_ease(Ease::InOutCubic, 0.5f), 0.5f) && near(apply_ease(Ease::InQuad, 0.5f), 0.25f),
+                "ease curves");
+}
+
+void preset_cases()
+{
+  bench::expect(TextTimeline::preset_count() >= 7 && !TextTimeline::preset_name(TextTimeline::preset_count()),
+                "the preset list ends");
+
+  bool all = true;
+  for (size_t i = 0; i < TextTimeline::preset_count(); ++i) {
+    const char* name = TextTimeline::preset_name(i);
+    TextTimeline by_name, by_spec;
+    std::string error;
+    all = all && TextTimeline::preset(name) && by_name.compile(name, error) &&
+          by_spec.compile(TextTimeline::preset(name), error);
+    for (float t = 0.0f; all && t <= 3.0f; t += 0.1f) {
+      const TimelineSample a = by_name.sample(t, 3.0f), b = by_spec.sample(t, 3.0f);
+      all = a.x == b.x && a.y == b.y && a.scale == b.scale && a.alpha == b.alpha && a.reveal == b.reveal;
+    }
+  }
+  bench::expect(all, "every preset compiles and plays its spec");
+  bench::expect(!TextTimeline::preset("wobble"), "unknown names are not presets");
+
+  TextTimeline padded;
+  std::string error;
+  bench::expect(padded.compile("  pop \n", error), "preset names are trimmed");
+
+  const TextTimeline fade = compiled("fade");
+  const TextTimeline classic = TextTimeline::fade(0.2f, 0.25f);
+  bool same = true;
+  for (float t = 0.0f; t <= 4.0f; t += 0.05f)
+    same = same && near(fade.sample(t, 4.0f).alpha, classic.sample(t, 4.0f).alpha);
+  bench::expect(same, "the fade preset matches the classic fade");
+
+  const TextTimeline tw = compiled("typewriter");
+  bench::expect(near(tw.sample(0.75f, 5.0f).reveal, 0.5f), "typewriter reveals over 1.5 s");
+}
+
+// The spec is rejected and the error names the problem
+void expect_error(const char* spec, const char* mentions, const char* what)
+{
+  TextTimeline tl;
+  std::string error;
+  bench::expect(!tl.compile(spec, error) && error.find(mentions) != std::string::npos, what);
+}
+
+void error_cases()
+{
+  expect_error("", "no keyframes", "empty spec");
+  expect_error("alpha", "no keyframes", "track without keys");
+  expect_error("wobble 0 1", "unknown track \"wobble\"", "unknown track");
+  expect_error("alpha 0 0; alpha 1 1", "given twice", "track given twice");
+  expect_error("alpha end+1 0", "end-<seconds>", "end+<seconds>");
+  expect_error("alpha endless 0", "end-<seconds>", "a word starting with end");
+  expect_error("alpha end- 0", "end-<seconds>", "end- without seconds");
+  expect_error("alpha end--1 0", "end-<seconds>", "negative end offset");
+  expect_error("alpha -1 0", "bad time \"-1\"", "negative time");
+  expect_error("alpha soon 0", "bad time", "time that is not a number");
+  expect_error("alpha 1", "needs a value", "keyframe without a value");
+  expect_error("alpha 0 inf", "needs a value", "infinite value");
+  expect_error("alpha 0 1 wobbly", "unknown easing \"wobbly\"", "unknown easing");
+  expect_error("alpha 0 1 linear extra", "unexpected \"extra\"", "trailing words");
+
+  std::string many = "x";
+  for (size_t i = 0; i <= TextTimeline::kMaxKeysPerTrack; ++i)
+    many += (i ? ", " : " ") + std::to_string(i) + " 0";
+  expect_error(many.c_str(), "too many keyframes", "more than kMaxKeysPerTrack keys");
+
+  TextTimeline tl;
+  std::string error;
+  bench::expect(tl.compile("alpha 0 0,, 1 1 ;; ", error), "empty keyframes and tracks are skipped");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const bool check = bench::check_mode(argc, argv);
+
+  end_key_cases();
+  ease_cases();
+  preset_cases();
+  error_cases();
+
+  const int compiles = check ? 200 : 20000;
+  const int samples = check ? 20000 : 2000000;
+
+  printf("%-12s  %12s  %12s\n", "preset", "compile us", "sample ns");
+  for (size_t i = 0; i < TextTimeline::preset_count(); ++i) {
+    const char* name = TextTimeline::preset_name(i);
+    TextTimeline tl;
+    std::string error;
+
+    const double t0 = bench::now_ms();
+    for (int r = 0; r < compiles; ++r)
+      tl.compile(name, error);
+    const double compile_us = (bench::now_ms() - t0) * 1000.0 / compiles;
+
+    // one alert of 5 s at 60 fps, over and over
+    float sink = 0.0f;
+    const double t1 = bench::now_ms();
+    for (int f = 0; f < samples; ++f) {
+      const TimelineSample s = tl.sample((float)(f % 300) / 60.0f, 5.0f);
+      sink += s.x + s.y + s.scale + s.alpha + s.reveal;
+    }
+    const double sample_ns = (bench::now_ms() - t1) * 1e6 / samples;
+
+    printf("%-12s  %12.2f  %12.1f   (%.0f)\n", name, compile_us, sample_ns, sink);
+  }
+
+  return bench::result();
+}
@@ -0,0 +1,168 @@
+// Tier table: rebuild time and per-event lookup cost for 3-10 tiers, plus
+// inheritance of empty fields from lower tiers, thresholds on their exact
+// boundaries and the fallback template for amounts below every tier.
+//
+//   bench_tier_table [--check]
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "alert_scheduler.hpp"
+#include "bench_util.hpp"
+#include "tier_table.hpp"
+
+namespace {
+
+constexpr float kDefaultSec = 5.0f;
+
+TierSpec spec(long long min_milli, std::string media = "", std::string tpl = "", float duration = 0.0f,
+              std::string sound = "", std::string effect = "")
+{
+  TierSpec s;
+  s.min_milli = min_milli;
+  s.media = std::move(media);
+  s.text_template = std::move(tpl);
+  s.duration_sec = duration;
+  s.sound = std::move(sound);
+  s.effect = std::move(effect);
+  return s;
+}
+
+TipEvent tip(long long amount_milli)
+{
+  TipEvent ev;
+  ev.kind = EventKind::Tip;
+  ev.amount_milli = amount_milli;
+  ev.symbol = intern_symbol("TWICH");
+  ev.set_text("viewer", format_amount_milli(amount_milli), "gg");
+  return ev;
+}
+
+int tier_at(const TierTable& t, long long amount_milli)
+{
+  const Tier* tier = t.lookup(amount_milli);
+  return tier ? tier->index : -1;
+}
+
+void threshold_cases()
+{
+  // settings order differs from threshold order
+  TierTable t;
+  t.rebuild({spec(50000), spec(0), spec(10000)}, "{user}", kDefaultSec);
+
+  bench::expect(t.size() == 3 && t.at(0).min_milli == 0 && t.at(2).min_milli == 50000, "tiers sort by threshold");
+  bench::expect(tier_at(t, 0) == 1, "an amount on the lowest threshold gets that tier");
+  bench::expect(tier_at(t, 9999) == 1 && tier_at(t, 10000) == 2, "10.000 is tier 2, 9.999 is not");
+  bench::expect(tier_at(t, 49999) == 2 && tier_at(t, 50000) == 0, "50.000 is tier 3, 49.999 is not");
+  bench::expect(tier_at(t, 1LL << 60) == 0, "huge amounts get the top tier");
+  bench::expect(tier_at(t, -1) == -1, "nothing below the lowest threshold");
+
+  // equal thresholds keep settings order: the later one wins the lookup
+  TierTable same;
+  same.rebuild({spec(5000, "a.webm"), spec(5000, "b.webm")}, "{user}", kDefaultSec);
+  bench::expect(same.lookup(5000) && same.lookup(5000)->media == "b.webm", "equal thresholds: the later tier wins");
+
+  TierTable none;
+  none.rebuild({}, "{user}", kDefaultSec);
+  bench::expect(none.size() == 0 && !none.lookup(0), "no tiers: every lookup misses");
+}
+
+void inheritance_cases()
+{
+  TierTable t;
+  t.rebuild({spec(0, "low.webm", "", 0.0f, "low.wav", "pop"),
+             spec(10000, "", "{user} is generous", 8.0f),
+             spec(50000, "high.webm", "", 0.0f, "", "not an effect"),
+             spec(100000)},
+            "{user} tipped", kDefaultSec);
+
+  const Tier& t1 = t.at(0);
+  const Tier& t2 = t.at(1);
+  const Tier& t3 = t.at(2);
+  const Tier& t4 = t.at(3);
+  const TipEvent ev = tip(1000);
+
+  bench::expect(t1.tpl.render(ev) == "viewer tipped", "the lowest tier falls back to the kind template");
+  bench::expect(t1.duration_sec == kDefaultSec && !t1.duration_set, "no duration anywhere: the source default");
+  bench::expect(t2.media == "low.webm" && t2.sound == "low.wav", "empty media and sound come from the tier below");
+  bench::expect(t2.duration_set && t3.duration_sec == 8.0f && t4.duration_set, "a set duration carries upward");
+  bench::expect(t3.tpl.render(ev) == "viewer is generous" && t4.tpl.render(ev) == "viewer is generous",
+                "templates carry upward");
+  bench::expect(t3.media == "high.webm" && t4.media == "high.webm", "a tier's own media replaces the inherited one");
+
+  bench::expect(t1.effect && t2.effect == t1.effect, "inherited effects share one compiled timeline");
+  bench::expect(t3.effect == t1.effect && !t3.effect_error.empty(),
+                "a bad effect keeps the inherited one and says why");
+  bench::expect(t4.effect == t1.effect && t4.effect_error.empty(), "the error stays with the tier that has it");
+}
+
+// Amounts below every tier still play, with the kind's template
+void fallback_cases()
+{
+  AlertProfile profiles[kEventKindCount];
+  for (int k = 0; k < kEventKindCount; ++k)
+    build_alert_profile(profiles[k], (EventKind)k, {}, "", kDefaultSec);
+  build_alert_profile(profiles[(int)EventKind::Tip], EventKind::Tip,
+                      {spec(5000, "big.webm", "{user} big tip", 3.0f)}, "{user} small tip", kDefaultSec);
+
+  TipEventQueue q;
+  q.push(tip(4999));
+  q.push(tip(5000));
+
+  AlertScheduler sched;
+  sched.set_lanes(2);
+  AlertStart below, at;
+  sched.start_next(q, profiles, kDefaultSec, below);
+  sched.advance(10.0f);
+  sched.start_next(q, profiles, kDefaultSec, at);
+
+  bench::expect(!below.tier && below.text == "viewer small tip" && below.duration_sec == kDefaultSec,
+                "below every tier: the fallback template, no media, the default length");
+  bench::expect(at.tier && at.text == "viewer big tip" && at.duration_sec == 3.0f, "on the threshold: the tier");
+
+  AlertProfile plain;
+  build_alert_profile(plain, EventKind::Tip, {}, "", kDefaultSec);
+  bench::expect(plain.text_template == event_kind_info(EventKind::Tip).default_template,
+                "an empty template falls back to the kind default");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const bool check = bench::check_mode(argc, argv);
+
+  threshold_cases();
+  inheritance_cases();
+  fallback_cases();
+
+  const int lookups = check ? 100000 : 10000000;
+  const int rebuilds = check ? 100 : 10000;
+
+  printf("%6s  %12s  %14s\n", "tiers", "rebuild us", "lookup ns");
+  for (int n : {3, 10}) {
+    std::vector<TierSpec> specs;
+    for (int i = 0; i < n; ++i)
+      specs.push_back(spec(i * 10000LL, i % 3 == 0 ? "tier.webm" : "", i % 2 ? "{user} tipped {amount}" : ""));
+
+    TierTable t;
+    const double t0 = bench::now_ms();
+    for (int r = 0; r < rebuilds; ++r)
+      t.rebuild(specs, "{user}", kDefaultSec);
+    const double rebuild_us = (bench::now_ms() - t0) * 1000.0 / rebuilds;
+
+    long long sink = 0;
+    const long long top = n * 10000LL;
+    const double t1 = bench::now_ms();
+    for (int i = 0; i < lookups; ++i)
+      if (const Tier* tier = t.lookup((i * 7919LL) % top))
+        sink += tier->index;
+    const double lookup_ns = (bench::now_ms() - t1) * 1e6 / lookups;
+
+    printf("%6d  %12.2f  %14.1f   (%lld)\n", n, rebuild_us, lookup_ns, sink);
+    bench::expect(tier_at(t, top) == n - 1, "the top tier covers everything above it");
+  }
+
+  return bench::result();
+}
@@ -0,0 +1,202 @@
+// Text-to-speech pipeline with the stub tone engine: request/take cost on
+// the alert path, synthesis throughput, cache hits, and the late, deadline,
+// restart and command-engine cases.
+//
+//   bench_tts [--check]
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "tts.hpp"
+
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr uint32_t kRate = 48000;
+
+bool wait_for(const std::function<bool()>& done, double timeout_ms = 3000)
+{
+  const double until = bench::now_ms() + timeout_ms;
+  while (!done()) {
+    if (bench::now_ms() > until)
+      return false;
+    std::this_thread::sleep_for(1ms);
+  }
+  return true;
+}
+
+// take() ends a request either way, so wait for the engine run first
+std::shared_ptr<const AudioClip> take_when_ready(TtsPipeline& tts, uint64_t key, uint64_t synthesized)
+{
+  wait_for([&] { return tts.stats().synthesized >= synthesized; });
+  return tts.take(key);
+}
+
+void pipeline_cases()
+{
+  TtsPipeline tts;
+  tts.start(std::make_shared<ToneTtsEngine>(50ms), "tone", kRate, 1000ms);
+
+  tts.request(1, "thanks for the tip");
+  bench::expect(tts.take(1) == nullptr, "take right after request does not wait");
+  bench::expect(tts.stats().late == 1, "an early take counts as late");
+
+  // a fresh pipeline: the late job may or may not have been synthesized
+  tts.stop();
+  const TtsStats base = tts.stats();
+  tts.start(std::make_shared<ToneTtsEngine>(50ms), "tone, again", kRate, 1000ms);
+  tts.request(2, "four words right here");
+  std::shared_ptr<const AudioClip> clip = take_when_ready(tts, 2, base.synthesized + 1);
+  bench::expect(clip && clip->frames() > 0 && clip->sample_rate == kRate, "a later take gets the clip");
+
+  tts.request(3, "four words right here");
+  bench::expect(tts.take(3) != nullptr, "a repeated phrase is ready at once");
+  bench::expect(tts.stats().cache_hits == base.cache_hits + 1 && tts.stats().synthesized == base.synthesized + 1,
+                "a repeated phrase comes from the cache");
+
+  tts.start(std::make_shared<ToneTtsEngine>(400ms), "slow tone", kRate, 100ms);
+  tts.request(4, "this engine is too slow");
+  bench::expect(wait_for([&] { return tts.stats().failed == base.failed + 1; }), "a job past its deadline fails");
+  bench::expect(tts.take(4) == nullptr, "a failed job plays silent");
+  tts.stop();
+}
+
+// Settings changes restart the pipeline on the video thread: stop() must not
+// wait for a synthesis in progress, and that job's result must not leak into
+// the restarted pipeline
+void restart_cases()
+{
+  TtsPipeline tts;
+  tts.start(std::make_shared<ToneTtsEngine>(300ms), "slow", kRate, 2000ms);
+  tts.request(1, "still talking");
+  std::this_thread::sleep_for(50ms); // inside the engine now
+
+  const double t0 = bench::now_ms();
+  tts.stop();
+  tts.start(std::make_shared<ToneTtsEngine>(), "fast", kRate, 2000ms);
+  bench::expect(bench::now_ms() - t0 < 100, "a restart does not wait for the running synthesis");
+
+  // one word: a single beep and gap, where the old job says two
+  const TtsStats base = tts.stats();
+  tts.request(1, "one");
+  std::shared_ptr<const AudioClip> clip = take_when_ready(tts, 1, base.synthesized + 1);
+  bench::expect(clip && clip->frames() == (size_t)(kRate * 0.12) + (size_t)(kRate * 0.04),
+                "the restarted pipeline answers with its own engine");
+
+  std::this_thread::sleep_for(400ms); // the old job is done by now
+  tts.request(2, "still talking");
+  bench::expect(tts.stats().synthesized == base.synthesized + 1 && tts.stats().cache_hits == base.cache_hits,
+                "a job from before the restart drops its result");
+}
+
+#ifndef _WIN32
+// 0.1 s of 16-bit mono silence
+void write_wav(const std::string& path)
+{
+  const uint32_t rate = 22050, frames = rate / 10, data = frames * 2;
+  std::ofstream f(path, std::ios::binary);
+  auto u32 = [&](uint32_t v) { f.write((const char*)&v, 4); };
+  auto u16 = [&](uint16_t v) { f.write((const char*)&v, 2); };
+  f.write("RIFF", 4); u32(36 + data); f.write("WAVE", 4);
+  f.write("fmt ", 4); u32(16); u16(1); u16(1); u32(rate); u32(rate * 2); u16(2); u16(16);
+  f.write("data", 4); u32(data);
+  f.write(std::string(data, '\0').data(), data);
+}
+
+void command_cases()
+{
+  namespace fs = std::filesystem;
+  const fs::path dir = fs::temp_directory_path() / "twich_bench_tts";
+  fs::create_directories(dir);
+  const std::string wav = (dir / "voice.wav").string();
+  const std::string marker = (dir / "injected").string();
+  write_wav(wav);
+  fs::remove(marker);
+
+  const auto deadline = [] { return TtsClock::now() + 2s; };
+  AudioClip clip;
+  std::string error;
+
+  CommandTtsEngine copy("cp \"" + wav + "\" \"{out}\"");
+  bench::expect(copy.synthesize("hello", kRate, deadline(), clip, error) && clip.frames() == kRate / 10,
+                "command engine decodes the WAV it wrote, at the mixer rate");
+
+  const std::string hostile = "\"; touch " + marker + "; echo \"$(touch " + marker + ")`touch " + marker + "`";
+  copy.synthesize(hostile, kRate, deadline(), clip, error);
+  bench::expect(!fs::exists(marker), "message text never reaches the shell");
+
+  CommandTtsEngine hung("sleep 5");
+  const double t0 = bench::now_ms();
+  bench::expect(!hung.synthesize("hello", kRate, TtsClock::now() + 200ms, clip, error), "a hung command fails");
+  bench::expect(bench::now_ms() - t0 < 1500, "a hung command is killed at the deadline");
+
+  fs::remove_all(dir);
+}
+#endif
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const bool check = bench::check_mode(argc, argv);
+
+  pipeline_cases();
+  restart_cases();
+#ifndef _WIN32
+  command_cases();
+#endif
+
+  // Alert-path cost and throughput with an instant engine, in rounds of
+  // kMaxPending requests (more would push the oldest out unsynthesized)
+  const int batch = (int)TtsPipeline::kMaxPending;
+  const int rounds = check ? 1 : 20;
+  const int phrases = batch * rounds;
+  auto phrase = [](int i) { return "tip number " + std::to_string(i) + " thanks a lot"; };
+
+  TtsPipeline tts;
+  tts.start(std::make_shared<ToneTtsEngine>(), "tone", kRate, 3000ms);
+
+  double request_ms = 0, take_ms = 0;
+  int ready = 0;
+  const double t0 = bench::now_ms();
+  for (int r = 0; r < rounds; ++r) {
+    const int first = r * batch;
+    const double t1 = bench::now_ms();
+    for (int i = first; i < first + batch; ++i)
+      tts.request(1000 + (uint64_t)i, phrase(i));
+    request_ms += bench::now_ms() - t1;
+
+    wait_for([&] { return tts.stats().synthesized >= (uint64_t)(first + batch); }, 30000);
+
+    const double t2 = bench::now_ms();
+    for (int i = first; i < first + batch; ++i)
+      ready += tts.take(1000 + (uint64_t)i) != nullptr;
+    take_ms += bench::now_ms() - t2;
+  }
+  const double all_ms = bench::now_ms() - t0;
+  bench::expect(ready == phrases, "every phrase is synthesized and taken");
+
+  // the newest phrases again (the cache holds a few dozen of these clips)
+  const int repeats = 16;
+  const uint64_t hits = tts.stats().cache_hits;
+  const double t3 = bench::now_ms();
+  for (int i = phrases - repeats; i < phrases; ++i)
+    tts.request(1000000 + (uint64_t)i, phrase(i));
+  const double hit_us = (bench::now_ms() - t3) * 1000.0 / repeats;
+  bench::expect(tts.stats().cache_hits - hits == (uint64_t)repeats, "repeats are cache hits");
+  tts.stop();
+
+  const double request_us = request_ms * 1000.0 / phrases;
+  const double take_us = take_ms * 1000.0 / phrases;
+  printf("%d phrases: request %.2f us, take %.2f us, cached request %.2f us, all synthesized in %.1f ms (%.1f/s)\n",
+         phrases, request_us, take_us, hit_us, all_ms, phrases * 1000.0 / all_ms);
+  return bench::result();
+}
@@ -0,0 +1,101 @@
+#include "alert_scheduler.hpp"
+
+#include <utility>
+
+void build_alert_profile(AlertProfile& p, EventKind kind, std::vector<TierSpec> specs,
+                         std::string text_template, float default_duration_sec)
+{
+  p.text_template = text_template.empty()
+    ? std::string(event_kind_info(kind).default_template)
+    : std::move(text_template);
+
+  p.tiers.rebuild(std::move(specs), p.text_template, default_duration_sec);
+}
+
+void AlertScheduler::set_lanes(int n)
+{
+  lanes_ = n < 1 ? 1 : (n > kMaxLanes ? kMaxLanes : n);
+}
+
+uint32_t AlertScheduler::advance(float seconds)
+{
+  uint32_t ended = 0;
+  for (int i = 0; i < kMaxLanes; ++i) {
+    if (!playing(i))
+      continue;
+
+    Lane& l = lane_[i];
+    l.elapsed += seconds;
+    l.time_left -= seconds;
+    if (l.time_left <= 0.0f) {
+      playing_mask_ &= ~(1u << i);
+      ended |= 1u << i;
+    }
+  }
+  return ended;
+}
+
+int AlertScheduler::free_lane(bool media) const
+{
+  if (media && media_lane() >= 0)
+    return -1;
+
+  for (int i = 0; i < lanes_; ++i)
+    if (!playing(i))
+      return i;
+  return -1;
+}
+
+int AlertScheduler::media_lane() const
+{
+  for (int i = 0; i < kMaxLanes; ++i)
+    if (playing(i) && lane_[i].media)
+      return i;
+  return -1;
+}
+
+bool AlertScheduler::start_next(TipEventQueue& queue,
+                                const AlertProfile (&profiles)[kEventKindCount],
+                                float default_duration_sec,
+                                AlertStart& start)
+{
+  // no lane free at all: leave the event in the queue
+  if (free_lane(false) < 0)
+    return false;
+
+  if (!has_waiting_) {
+    if (!queue.pop(waiting_))
+      return false;
+    has_waiting_ = true;
+  }
+
+  // choose tier for this event (binary search on the fixed-point amount)
+  const AlertProfile& prof = profiles[(int)waiting_.kind];
+  const Tier* tier = prof.tiers.lookup(waiting_.amount_milli);
+  const bool media = tier && !tier->media.empty();
+
+  const int lane = free_lane(media);
+  if (lane < 0)
+    return false;
+
+  start.text = tier
+    ? tier->tpl.render(waiting_)
+    : CompiledTemplate(prof.text_template).render(waiting_);
+  start.tier = tier;
+  start.duration_sec = (tier && tier->duration_sec > 0.0f) ? tier->duration_sec : default_duration_sec;
+  if (tier && !tier->duration_set && media && media_duration_) {
+    const float media_sec = media_duration_(tier->media);
+    if (media_sec > 0.0f)
+      start.duration_sec = media_sec;
+  }
+  start.ev = std::move(waiting_);
+  start.lane = lane;
+  has_waiting_ = false;
+
+  Lane& l = lane_[lane];
+  l.elapsed = 0.0f;
+  l.time_left = start.duration_sec;
+  l.media = media;
+  playing_mask_ |= 1u << lane;
+  return true;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "event_parse.hpp"
+#include "event_queue.hpp"
+#include "tier_table.hpp"
+
+// Per event kind: fallback template + sorted tier table.
+// Settings keys are the tip keys with the kind's prefix ("follow_tier1_media").
+struct AlertProfile
+{
+  std::string text_template;
+  TierTable tiers;
+};
+
+// Rebuilds `p` from its tier specs; an empty template falls back to the
+// kind's default. Used for live settings and for replayed captures alike.
+void build_alert_profile(AlertProfile& p, EventKind kind, std::vector<TierSpec> specs,
+                         std::string text_template, float default_duration_sec);
+
+// An alert that just started playing
+struct AlertStart
+{
+  TipEvent ev;
+  const Tier* tier = nullptr; // nullptr when no tier threshold is met
+  std::string text;           // rendered template
+  float duration_sec = 0.0f;
+  int lane = 0;               // where it plays
+};
+
+// Alert timelines on a caller-driven clock (no libobs): up to kMaxLanes
+// alerts play at once, each on its own lane. Pops the next event when a lane
+// is free, resolves its tier and text, and tracks elapsed/remaining time per
+// lane so callers only apply the visible side effects.
+//
+// Alerts with media are assumed to fill the frame, so only one of them
+// plays at a time; alerts without (text, sound) take any free lane. An
+// event that has to wait for the media lane holds up the ones behind it,
+// so alerts still start in arrival order.
+class AlertScheduler
+{
+public:
+  static constexpr int kMaxLanes = 4;
+
+  // 1..kMaxLanes; alerts on lanes taken away play to their end
+  void set_lanes(int n);
+  int  lanes() const { return lanes_; }
+
+  // Advances every playing lane. Bit i of the result: lane i ended this tick.
+  uint32_t advance(float seconds);
+
+  // Starts the next queued event on a free lane; call until false after
+  // advance(). False when the queue is empty or nothing can start yet.
+  bool start_next(TipEventQueue& queue,
+                  const AlertProfile (&profiles)[kEventKindCount],
+                  float default_duration_sec,
+                  AlertStart& start);
+
+  // Optional media length lookup (seconds, <= 0 if unknown). When set, a
+  // tier with no explicit duration plays for the length of its media.
+  using MediaDurationFn = std::function<float(const std::string& path)>;
+  void set_media_duration(MediaDurationFn fn) { media_duration_ = std::move(fn); }
+
+  bool  playing() const { return playing_mask_ != 0; }
+  bool  playing(int lane) const { return (playing_mask_ >> lane) & 1u; }
+  float elapsed(int lane) const { return lane_[lane].elapsed; }
+  float time_left(int lane) const { return lane_[lane].time_left; }
+
+  // Lane of the playing media alert, -1 if none
+  int media_lane() const;
+
+private:
+  struct Lane {
+    float elapsed = 0.0f;
+    float time_left = 0.0f;
+    bool  media = false;
+  };
+
+  int free_lane(bool media) const;
+
+  Lane     lane_[kMaxLanes];
+  uint32_t playing_mask_ = 0;
+  int      lanes_ = 1;
+
+  // popped, waiting for the media lane (tier resolved again on each try,
+  // since profiles may be rebuilt in between)
+  bool     has_waiting_ = false;
+  TipEvent waiting_;
+
+  MediaDurationFn media_duration_;
+};
@@ -0,0 +1,199 @@
+#include "approval_queue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+static std::atomic<uint64_t> g_next_id{1};
+
+void ApprovalQueue::set_on_change(OnChange cb)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  on_change_ = std::move(cb);
+}
+
+void ApprovalQueue::set_timeout(std::chrono::milliseconds timeout)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  timeout_ = timeout;
+}
+
+std::chrono::milliseconds ApprovalQueue::timeout() const
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return timeout_;
+}
+
+ApprovalQueue::Held ApprovalQueue::view(uint64_t id, const TipEvent& ev)
+{
+  Held h;
+  h.id = id;
+  h.kind = ev.kind;
+  h.user = ev.from_username();
+  h.amount = ev.amount_str();
+  h.message = ev.message();
+  h.symbol = ev.symbol;
+  h.account = ev.account;
+  return h;
+}
+
+uint64_t ApprovalQueue::push(TipEvent ev, bool may_expire)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+
+  if (held_.size() >= kMaxHeld)
+    take_locked(held_.begin(), Change::Rejected, nullptr);
+
+  const uint64_t id = g_next_id.fetch_add(1);
+  const Clock::time_point deadline =
+    (may_expire && timeout_.count() > 0) ? Clock::now() + timeout_ : Clock::time_point::max();
+
+  held_.push_back({id, std::move(ev), deadline});
+  by_id_[id] = std::prev(held_.end());
+  if (deadline != Clock::time_point::max()) {
+    if (expiring_.empty())
+      next_deadline_.store(deadline.time_since_epoch().count(), std::memory_order_relaxed);
+    expiring_.push_back(id);
+  }
+
+  if (on_change_)
+    on_change_(Change::Added, view_locked(held_.back(), Clock::now()));
+  return id;
+}
+
+ApprovalQueue::Held ApprovalQueue::view_locked(const Entry& e, Clock::time_point now) const
+{
+  Held h = view(e.id, e.ev);
+  if (e.deadline != Clock::time_point::max())
+    h.seconds_left = std::max(0.001, std::chrono::duration<double>(e.deadline - now).count());
+  return h;
+}
+
+void ApprovalQueue::take_locked(List::iterator it, Change why, TipEvent* out)
+{
+  if (on_change_)
+    on_change_(why, view(it->id, it->ev));
+
+  if (out)
+    *out = std::move(it->ev);
+
+  by_id_.erase(it->id);
+  held_.erase(it);
+}
+
+bool ApprovalQueue::approve(uint64_t id, TipEvent& out)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = by_id_.find(id);
+  if (it == by_id_.end())
+    return false;
+
+  take_locked(it->second, Change::Approved, &out);
+  return true;
+}
+
+bool ApprovalQueue::reject(uint64_t id)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = by_id_.find(id);
+  if (it == by_id_.end())
+    return false;
+
+  take_locked(it->second, Change::Rejected, nullptr);
+  return true;
+}
+
+bool ApprovalQueue::approve_oldest(TipEvent& out)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (held_.empty())
+    return false;
+
+  take_locked(held_.begin(), Change::Approved, &out);
+  return true;
+}
+
+bool ApprovalQueue::reject_oldest()
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (held_.empty())
+    return false;
+
+  take_locked(held_.begin(), Change::Rejected, nullptr);
+  return true;
+}
+
+size_t ApprovalQueue::expire(Clock::time_point now, std::vector<TipEvent>& out)
+{
+  // a lower bound: the entry it belongs to may be decided already
+  if (now.time_since_epoch().count() < next_deadline_.load(std::memory_order_relaxed))
+    return 0;
+
+  std::lock_guard<std::mutex> lk(mutex_);
+
+  // deadlines grow along expiring_ unless the timeout was shortened since;
+  // then an event waits for the one before it, which is fine
+  size_t n = 0;
+  while (!expiring_.empty()) {
+    auto it = by_id_.find(expiring_.front());
+    if (it == by_id_.end()) {
+      expiring_.pop_front(); // decided already
+      continue;
+    }
+    if (it->second->deadline > now)
+      break;
+
+    expiring_.pop_front();
+    out.emplace_back();
+    take_locked(it->second, Change::Expired, &out.back());
+    ++n;
+  }
+
+  next_deadline_.store(expiring_.empty()
+                         ? Clock::time_point::max().time_since_epoch().count()
+                         : by_id_.at(expiring_.front())->deadline.time_since_epoch().count(),
+                       std::memory_order_relaxed);
+  return n;
+}
+
+size_t ApprovalQueue::size() const
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return held_.size();
+}
+
+std::vector<ApprovalQueue::Held> ApprovalQueue::snapshot(size_t max) const
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  const Clock::time_point now = Clock::now();
+
+  std::vector<Held> out;
+  for (auto it = held_.begin(); it != held_.end() && out.size() < max; ++it)
+    out.push_back(view_locked(*it, now));
+  return out;
+}
+
+void ApprovalQueue::replay(const std::function<void(const Held&)>& fn) const
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  const Clock::time_point now = Clock::now();
+  for (const Entry& e : held_)
+    fn(view_locked(e, now));
+}
+
+std::vector<std::string> ApprovalQueue::describe(size_t max) const
+{
+  std::vector<std::string> lines;
+  for (const Held& h : snapshot(max))
+    lines.push_back(h.user + " (" + h.amount + "): " + h.message);
+  return lines;
+}
+
+void ApprovalQueue::clear()
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  while (!held_.empty())
+    take_locked(held_.begin(), Change::Rejected, nullptr);
+  expiring_.clear();
+  next_deadline_.store(Clock::time_point::max().time_since_epoch().count(), std::memory_order_relaxed);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "event_parse.hpp"
+
+// Events parked for a human decision (moderation "Hold", or hold-all mode).
+// Approved events go on to the alert queue; rejected ones are discarded.
+//
+// Held events sit in arrival order on a list indexed by id, so approving or
+// rejecting any one of them, by id or oldest-first, is O(1). With a timeout
+// set, events nobody decided on are approved when it runs out (expire()),
+// unless they were pushed as not expiring. All methods are thread-safe.
+class ApprovalQueue {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr size_t kMaxHeld = 256; // the oldest is rejected beyond this
+
+  enum class Change { Added, Approved, Rejected, Expired };
+
+  struct Held {
+    uint64_t    id = 0;
+    EventKind   kind = EventKind::Tip;
+    std::string user;
+    std::string amount;
+    std::string message;
+    const char* symbol = "";
+    const char* account = "";
+    double      seconds_left = 0.0; // 0 when it never times out
+  };
+
+  static Held view(uint64_t id, const TipEvent& ev);
+
+  // Called with the queue locked, on whichever thread made the change;
+  // must not call back into the queue
+  using OnChange = std::function<void(Change, const Held& h)>;
+
+  void set_on_change(OnChange cb);
+
+  // Applies to events held from now on; 0 = wait forever
+  void set_timeout(std::chrono::milliseconds timeout);
+  std::chrono::milliseconds timeout() const;
+
+  // Returns the id, unique for the process lifetime
+  uint64_t push(TipEvent ev, bool may_expire = true);
+
+  bool approve(uint64_t id, TipEvent& out);
+  bool reject(uint64_t id);
+
+  // Oldest held event; false when nothing is held
+  bool approve_oldest(TipEvent& out);
+  bool reject_oldest();
+
+  // Approves (moves into `out`) every event whose timeout has run out.
+  // Lock-free while no deadline has come up (called every frame).
+  size_t expire(Clock::time_point now, std::vector<TipEvent>& out);
+
+  // False while no held event can time out (lets callers skip the clock)
+  bool may_expire() const
+  {
+    return next_deadline_.load(std::memory_order_relaxed) != Clock::time_point::max().time_since_epoch().count();
+  }
+
+  size_t size() const;
+
+  // Oldest first
+  std::vector<Held> snapshot(size_t max = kMaxHeld) const;
+
+  // Calls `fn` for every held event, oldest first, with the queue locked,
+  // so no change slips in between (a view handed to a new observer)
+  void replay(const std::function<void(const Held&)>& fn) const;
+
+  // "user (amount): message" of the oldest `max` events
+  std::vector<std::string> describe(size_t max) const;
+
+  void clear();
+
+private:
+  struct Entry {
+    uint64_t          id;
+    TipEvent          ev;
+    Clock::time_point deadline; // max() = never
+  };
+
+  using List = std::list<Entry>;
+
+  void take_locked(List::iterator it, Change why, TipEvent* out);
+  Held view_locked(const Entry& e, Clock::time_point now) const;
+
+  mutable std::mutex mutex_;
+  List held_;
+  std::unordered_map<uint64_t, List::iterator> by_id_;
+  std::deque<uint64_t> expiring_; // ids that may time out, in push order; stale ids skipped lazily
+  std::atomic<Clock::rep> next_deadline_{Clock::time_point::max().time_since_epoch().count()}; // no earlier expiry
+  std::chrono::milliseconds timeout_{0};
+  OnChange on_change_;
+};
@@ -0,0 +1,200 @@
+#include "asset_manager.hpp"
+
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+AssetManager::~AssetManager()
+{
+  stop();
+}
+
+void AssetManager::set_on_report(OnReport cb)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  on_report_ = std::move(cb);
+}
+
+void AssetManager::set_preload_cap(uint64_t bytes)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  preload_cap_ = bytes;
+}
+
+void AssetManager::submit(std::vector<AssetRequest> assets)
+{
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (stopping_)
+      return;
+
+    pending_list_ = std::move(assets);
+    pending_ = true;
+
+    if (!running_)
+      running_ = tasks_.post([this]() { run(); });
+  }
+}
+
+float AssetManager::media_duration(const std::string& path) const
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = cache_.find(path);
+  if (it == cache_.end() || !it->second.report.ok)
+    return 0.0f;
+  return (float)it->second.report.info.duration_sec;
+}
+
+void AssetManager::stop()
+{
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    stopping_ = true;
+  }
+
+  // a file being checked finishes first (it stops between files)
+  tasks_.cancel();
+}
+
+// Reads the whole file in large chunks and throws the bytes away: the point
+// is the OS page cache, which ffmpeg_source then opens warm.
+static bool read_through(const std::string& path)
+{
+  std::ifstream f(path, std::ios::binary);
+  if (!f)
+    return false;
+
+  std::vector<char> buf(1 << 20);
+  while (f.read(buf.data(), (std::streamsize)buf.size()) || f.gcount() > 0) {
+  }
+  return f.eof();
+}
+
+static bool codec_supported(const std::string& codec)
+{
+  // what ffmpeg_source decodes with alpha in WebM
+  return codec == "V_VP8" || codec == "V_VP9" || codec == "V_AV1";
+}
+
+static bool is_matroska_path(const std::string& path)
+{
+  std::string ext = fs::path(path).extension().string();
+  for (char& c : ext)
+    c = (char)tolower((unsigned char)c);
+  return ext == ".webm" || ext == ".mkv";
+}
+
+static AssetReport check_asset(const AssetRequest& req, uint64_t size, uint64_t cap)
+{
+  AssetReport r;
+  r.size = size;
+  r.ok = true;
+
+  if (req.video && is_matroska_path(req.path)) {
+    std::string err;
+    if (!probe_media_file(req.path, r.info, err)) {
+      r.ok = false;
+      r.problem = err;
+      return r;
+    }
+    if (!codec_supported(r.info.codec_id)) {
+      r.ok = false;
+      r.problem = "unsupported codec " + (r.info.codec_id.empty() ? std::string("(none)") : r.info.codec_id);
+      return r;
+    }
+    if (!r.info.alpha)
+      r.problem = "no alpha channel (background will be opaque)";
+  }
+
+  if (cap > 0 && size <= cap)
+    r.preloaded = read_through(req.path);
+
+  return r;
+}
+
+void AssetManager::run()
+{
+  for (;;) {
+    std::vector<AssetRequest> list;
+    uint64_t cap = 0;
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      if (stopping_ || !pending_) {
+        running_ = false;
+        return;
+      }
+
+      list = std::move(pending_list_);
+      pending_list_.clear();
+      pending_ = false;
+      cap = preload_cap_;
+    }
+
+    std::string problems;
+    for (const AssetRequest& req : list) {
+      if (req.path.empty())
+        continue;
+
+      std::error_code ec;
+      const uint64_t size = fs::file_size(req.path, ec);
+      if (ec) {
+        problems += req.label + ": file not found\n";
+        std::lock_guard<std::mutex> lk(mutex_);
+        cache_.erase(req.path);
+        continue;
+      }
+      const auto mtime_raw = fs::last_write_time(req.path, ec);
+      const int64_t mtime = ec ? 0 : (int64_t)mtime_raw.time_since_epoch().count();
+
+      AssetReport report;
+      bool cached = false;
+      {
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto it = cache_.find(req.path);
+        if (it != cache_.end() && it->second.size == size && it->second.mtime == mtime) {
+          report = it->second.report;
+          cached = true;
+        }
+      }
+
+      if (!cached) {
+        report = check_asset(req, size, cap);
+
+        std::lock_guard<std::mutex> lk(mutex_);
+        Entry& e = cache_[req.path];
+        e.report = report;
+        e.size = size;
+        e.mtime = mtime;
+      }
+
+      if (!report.problem.empty())
+        problems += req.label + ": " + report.problem + "\n";
+
+      // a newer list supersedes this one; report on that instead
+      std::lock_guard<std::mutex> lk(mutex_);
+      if (stopping_ || pending_)
+        break;
+    }
+
+    OnReport cb;
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      if (stopping_) {
+        running_ = false;
+        return;
+      }
+      if (pending_)
+        continue;
+      cb = on_report_;
+    }
+
+    if (!problems.empty() && problems.back() == '\n')
+      problems.pop_back();
+    if (cb)
+      cb(problems);
+  }
+}
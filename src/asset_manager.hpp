@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "media_probe.hpp"
+#include "worker_pool.hpp"
+
+// A file referenced by the settings, e.g. "Tips tier 2 media"
+struct AssetRequest {
+  std::string label;
+  std::string path;
+  bool        video = true; // probe as tier media (false: sound clip, existence only)
+};
+
+struct AssetReport {
+  bool        ok = false;        // usable as configured
+  std::string problem;           // why not, or a warning such as "no alpha channel"
+  MediaInfo   info;              // video only, when the header could be read
+  uint64_t    size = 0;
+  bool        preloaded = false; // read through once to warm the OS cache
+};
+
+// Background checker for tier media and sound files.
+// submit() hands the latest file list to the shared worker pool; earlier,
+// still unprocessed lists are dropped. Each file is stat'ed, probed (WebM/Matroska
+// header: codec, size, alpha, duration) and, when small enough, read once so
+// the first alert does not pay the cold-disk open. Results are cached by
+// path and revalidated by size + mtime, so re-submitting unchanged settings
+// costs one stat per file.
+class AssetManager {
+public:
+  // Called on a pool thread after each list, with one line per problem
+  // ("" when everything is fine)
+  using OnReport = std::function<void(const std::string& problems)>;
+
+  AssetManager() = default;
+  ~AssetManager();
+
+  AssetManager(const AssetManager&) = delete;
+  AssetManager& operator=(const AssetManager&) = delete;
+
+  void set_on_report(OnReport cb);
+
+  // Files larger than this are validated but not preloaded (0 = never preload)
+  void set_preload_cap(uint64_t bytes);
+
+  void submit(std::vector<AssetRequest> assets);
+
+  // Media duration in seconds, 0 when unknown or not checked yet
+  float media_duration(const std::string& path) const;
+
+  void stop();
+
+private:
+  struct Entry {
+    AssetReport report;
+    uint64_t    size = 0;
+    int64_t     mtime = 0;
+  };
+
+  void run();
+
+  mutable std::mutex mutex_;
+  TaskGroup tasks_;
+  bool running_ = false;  // a pool task is working through lists
+  bool stopping_ = false;
+
+  bool pending_ = false;
+  std::vector<AssetRequest> pending_list_;
+  uint64_t preload_cap_ = 32ull * 1024 * 1024;
+
+  std::unordered_map<std::string, Entry> cache_;
+  OnReport on_report_;
+};
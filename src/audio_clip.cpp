@@ -0,0 +1,182 @@
+#include "audio_clip.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+
+static constexpr uint16_t kFormatPcm        = 0x0001;
+static constexpr uint16_t kFormatFloat      = 0x0003;
+static constexpr uint16_t kFormatExtensible = 0xFFFE;
+
+static uint32_t rd_u32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static uint16_t rd_u16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+// One sample at `p` -> float in [-1, 1]
+static float sample_to_float(const uint8_t* p, uint16_t format, uint16_t bits)
+{
+  if (format == kFormatFloat) {
+    if (bits == 32) {
+      float f;
+      std::memcpy(&f, p, 4);
+      return f;
+    }
+    double d;
+    std::memcpy(&d, p, 8);
+    return (float)d;
+  }
+
+  switch (bits) {
+  case 8:  return ((int)p[0] - 128) / 128.0f; // 8-bit WAV is unsigned
+  case 16: return (int16_t)rd_u16(p) / 32768.0f;
+  case 24: {
+    int32_t v = (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24) >> 8;
+    return v / 8388608.0f;
+  }
+  default: return (int32_t)rd_u32(p) / 2147483648.0f;
+  }
+}
+
+// Linear resampling; alert clips are short and this runs once per settings change
+static void resample(std::vector<float>& ch, uint32_t from, uint32_t to)
+{
+  if (from == to || ch.empty())
+    return;
+
+  const size_t out_n = (size_t)((double)ch.size() * to / from);
+  std::vector<float> out(out_n);
+  const double step = (double)from / to;
+
+  for (size_t i = 0; i < out_n; ++i) {
+    const double src = i * step;
+    const size_t i0 = (size_t)src;
+    const size_t i1 = std::min(i0 + 1, ch.size() - 1);
+    const float t = (float)(src - (double)i0);
+    out[i] = ch[i0] + (ch[i1] - ch[i0]) * t;
+  }
+  ch.swap(out);
+}
+
+bool decode_wav(const uint8_t* data, size_t len, uint32_t target_rate,
+                AudioClip& out, std::string& error)
+{
+  if (len < 12 || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0) {
+    error = "not a WAV file";
+    return false;
+  }
+
+  uint16_t format = 0, channels = 0, bits = 0;
+  size_t block = 0;
+  uint32_t rate = 0;
+  const uint8_t* pcm = nullptr;
+  size_t pcm_len = 0;
+
+  size_t pos = 12;
+  while (pos + 8 <= len) {
+    const uint8_t* id = data + pos;
+    size_t size = rd_u32(data + pos + 4);
+    pos += 8;
+    size = std::min(size, len - pos); // streamed writers leave 0xFFFFFFFF
+
+    if (std::memcmp(id, "fmt ", 4) == 0 && size >= 16) {
+      const uint8_t* f = data + pos;
+      format   = rd_u16(f);
+      channels = rd_u16(f + 2);
+      rate     = rd_u32(f + 4);
+      block    = rd_u16(f + 12);
+      bits     = rd_u16(f + 14);
+      if (format == kFormatExtensible && size >= 26)
+        format = rd_u16(f + 24); // SubFormat GUID starts with the format code
+    } else if (std::memcmp(id, "data", 4) == 0) {
+      pcm = data + pos;
+      pcm_len = size;
+      break;
+    }
+
+    pos += size + (size & 1); // chunks are word aligned
+  }
+
+  if (!pcm || !channels || !rate) {
+    error = "WAV has no fmt/data chunk";
+    return false;
+  }
+  if (channels > kMaxWavChannels) {
+    error = "WAV has " + std::to_string(channels) + " channels (at most " + std::to_string(kMaxWavChannels) + ")";
+    return false;
+  }
+
+  const bool int_ok = format == kFormatPcm && (bits == 8 || bits == 16 || bits == 24 || bits == 32);
+  const bool float_ok = format == kFormatFloat && (bits == 32 || bits == 64);
+  if (!int_ok && !float_ok) {
+    error = "unsupported WAV encoding (format " + std::to_string(format) + ", " +
+            std::to_string(bits) + "-bit)";
+    return false;
+  }
+
+  // a header's block align smaller than one frame would read past the data
+  const size_t bytes = bits / 8;
+  block = std::max(block, bytes * channels);
+  if (block == 0) {
+    error = "WAV has an empty frame";
+    return false;
+  }
+
+  const size_t frames = pcm_len / block;
+  if ((double)frames / rate > kMaxClipSeconds) {
+    error = "sound longer than " + std::to_string((int)kMaxClipSeconds) + " s";
+    return false;
+  }
+
+  out = AudioClip();
+  out.left.resize(frames);
+  out.right.resize(frames);
+
+  const size_t right_off = (channels > 1) ? bytes : 0;
+  for (size_t i = 0; i < frames; ++i) {
+    const uint8_t* fr = pcm + i * block;
+    out.left[i]  = sample_to_float(fr, format, bits);
+    out.right[i] = sample_to_float(fr + right_off, format, bits);
+  }
+
+  const uint32_t rate_out = target_rate ? target_rate : rate;
+  resample(out.left, rate, rate_out);
+  resample(out.right, rate, rate_out);
+  out.sample_rate = rate_out;
+  return true;
+}
+
+bool load_wav_file(const std::string& path, uint32_t target_rate,
+                   AudioClip& out, std::string& error)
+{
+  std::ifstream f(path, std::ios::binary | std::ios::ate);
+  if (!f) {
+    error = "cannot open";
+    return false;
+  }
+
+  const std::streamoff size = f.tellg();
+  if (size <= 0) {
+    error = "empty file";
+    return false;
+  }
+
+  std::vector<uint8_t> bytes((size_t)size);
+  f.seekg(0);
+  if (!f.read((char*)bytes.data(), size)) {
+    error = "read failed";
+    return false;
+  }
+
+  return decode_wav(bytes.data(), bytes.size(), target_rate, out, error);
+}
+
+bool is_wav_path(const std::string& path)
+{
+  if (path.size() < 4)
+    return false;
+
+  std::string ext = path.substr(path.size() - 4);
+  for (char& c : ext)
+    c = (char)tolower((unsigned char)c);
+  return ext == ".wav";
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A sound clip decoded once into planar stereo float at the output rate,
+// ready to be mixed sample by sample.
+struct AudioClip {
+  uint32_t           sample_rate = 0;
+  std::vector<float> left;
+  std::vector<float> right; // same length as left (mono sources are duplicated)
+
+  size_t frames() const { return left.size(); }
+  double duration_sec() const { return sample_rate ? (double)frames() / sample_rate : 0.0; }
+};
+
+// Longest clip we decode; alert sounds are seconds, not songs.
+constexpr double kMaxClipSeconds = 120.0;
+
+// Most channels a WAV may have (7.1); more is treated as a damaged header
+constexpr uint16_t kMaxWavChannels = 8;
+
+// RIFF/WAVE: PCM 8/16/24/32-bit, IEEE float 32/64, WAVE_FORMAT_EXTENSIBLE.
+// More than two channels keep the first two. Resampled (linear) to
+// `target_rate` when it differs from the file.
+// Returns false with `error` set for anything else (MP3/OGG are not
+// decoded here; those still play through a media source).
+bool decode_wav(const uint8_t* data, size_t len, uint32_t target_rate,
+                AudioClip& out, std::string& error);
+
+bool load_wav_file(const std::string& path, uint32_t target_rate,
+                   AudioClip& out, std::string& error);
+
+// Cheap extension check, so non-WAV sounds skip the decode attempt
+bool is_wav_path(const std::string& path);
@@ -0,0 +1,134 @@
+#include "audio_mixer.hpp"
+
+#include <algorithm>
+
+// Duck/unduck ramp, long enough not to click
+static constexpr double kRampSeconds = 0.05;
+
+// A stalled tick renders at most this much; the rest of the gap is skipped
+static constexpr double kMaxChunkSeconds = 0.5;
+
+void AudioMixer::set_sample_rate(uint32_t rate)
+{
+  if (rate == rate_)
+    return;
+  rate_ = rate ? rate : 48000;
+  stop_all();
+}
+
+int64_t AudioMixer::frames_at(uint64_t ns) const
+{
+  if (ns <= anchor_ns_)
+    return 0;
+  // split so hours of uptime times the rate cannot overflow
+  const uint64_t d = ns - anchor_ns_;
+  return (int64_t)((d / 1000000000ull) * rate_ + (d % 1000000000ull) * rate_ / 1000000000ull);
+}
+
+uint64_t AudioMixer::ns_at(int64_t frame) const
+{
+  const uint64_t f = (uint64_t)frame;
+  return anchor_ns_ + (f / rate_) * 1000000000ull + (f % rate_) * 1000000000ull / rate_;
+}
+
+void AudioMixer::play(std::shared_ptr<const AudioClip> clip, uint64_t start_ns, float volume)
+{
+  if (!clip || clip->frames() == 0)
+    return;
+
+  if (!anchored_) {
+    anchored_ = true;
+    anchor_ns_ = start_ns;
+    rendered_ = 0;
+  }
+
+  if (voices_.size() >= kMaxVoices)
+    voices_.erase(voices_.begin()); // oldest
+
+  Voice v;
+  v.clip = std::move(clip);
+  v.start = std::max(frames_at(start_ns), rendered_); // can't start in the past
+  v.volume = volume;
+  v.seq = next_seq_++;
+  voices_.push_back(std::move(v));
+}
+
+void AudioMixer::stop_all()
+{
+  voices_.clear();
+  anchored_ = false;
+  rendered_ = 0;
+}
+
+size_t AudioMixer::render_until(uint64_t now_ns, uint64_t& ts_ns)
+{
+  if (voices_.empty()) {
+    anchored_ = false;
+    return 0;
+  }
+
+  int64_t n = frames_at(now_ns) - rendered_;
+  if (n <= 0)
+    return 0;
+
+  const int64_t max_chunk = (int64_t)(rate_ * kMaxChunkSeconds);
+  if (n > max_chunk) {
+    // move the timeline up so voices resume instead of replaying the gap
+    const int64_t skip = n - max_chunk;
+    for (Voice& v : voices_)
+      v.start += skip;
+    rendered_ += skip;
+    n = max_chunk;
+  }
+
+  left_.assign((size_t)n, 0.0f);
+  right_.assign((size_t)n, 0.0f);
+
+  const int64_t chunk_end = rendered_ + n;
+
+  // newest voice that has started plays at full gain, the others duck
+  uint64_t lead_seq = 0;
+  bool any_started = false;
+  for (const Voice& v : voices_) {
+    if (v.start < chunk_end && (!any_started || v.seq > lead_seq)) {
+      lead_seq = v.seq;
+      any_started = true;
+    }
+  }
+
+  const float ramp_step = (float)(1.0 / (rate_ * kRampSeconds));
+
+  for (Voice& v : voices_) {
+    const int64_t begin = std::max(v.start, rendered_);
+    const int64_t clip_len = (int64_t)v.clip->frames();
+    const int64_t end = std::min(chunk_end, v.start + clip_len);
+    if (begin >= end)
+      continue;
+
+    const float target = (v.seq == lead_seq) ? 1.0f : duck_gain_;
+    const float* cl = v.clip->left.data() + (begin - v.start);
+    const float* cr = v.clip->right.data() + (begin - v.start);
+    float* ol = left_.data() + (begin - rendered_);
+    float* orr = right_.data() + (begin - rendered_);
+
+    const int64_t count = end - begin;
+    for (int64_t i = 0; i < count; ++i) {
+      if (v.gain < target)      v.gain = std::min(target, v.gain + ramp_step);
+      else if (v.gain > target) v.gain = std::max(target, v.gain - ramp_step);
+
+      const float g = v.gain * v.volume;
+      ol[i]  += cl[i] * g;
+      orr[i] += cr[i] * g;
+    }
+  }
+
+  ts_ns = ns_at(rendered_);
+  rendered_ = chunk_end;
+
+  voices_.erase(std::remove_if(voices_.begin(), voices_.end(),
+                               [&](const Voice& v) {
+                                 return v.start + (int64_t)v.clip->frames() <= rendered_;
+                               }),
+                voices_.end());
+  return (size_t)n;
+}
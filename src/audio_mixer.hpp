@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "audio_clip.hpp"
+
+// Mixes pre-decoded alert sounds into stereo float chunks on a nanosecond
+// timeline, for a source that pushes its own audio.
+//
+// The owner calls render_until(now) once per video frame and outputs the
+// chunk at the returned timestamp; a voice started with play(clip, now)
+// therefore begins on the first sample of the next chunk, i.e. exactly at
+// the frame its visual starts. While more than one voice plays, all but
+// the newest ramp down to the duck gain and ramp back up once the newer
+// one ends. Not thread-safe: use from one thread (video_tick).
+class AudioMixer {
+public:
+  static constexpr size_t kMaxVoices = 8;
+
+  void set_sample_rate(uint32_t rate);
+  uint32_t sample_rate() const { return rate_; }
+
+  // Linear gain for overlapped (older) voices; 1 disables ducking
+  void set_duck_gain(float gain) { duck_gain_ = gain; }
+
+  void play(std::shared_ptr<const AudioClip> clip, uint64_t start_ns, float volume = 1.0f);
+  void stop_all();
+
+  bool active() const { return !voices_.empty(); }
+
+  // Mixes everything up to `now_ns`. Returns the frame count (0 when idle);
+  // `ts_ns` is the timestamp of the first frame, samples are in left()/right().
+  size_t render_until(uint64_t now_ns, uint64_t& ts_ns);
+
+  const float* left() const { return left_.data(); }
+  const float* right() const { return right_.data(); }
+
+private:
+  struct Voice {
+    std::shared_ptr<const AudioClip> clip;
+    int64_t  start = 0;  // frame on the mixer timeline
+    float    volume = 1.0f;
+    float    gain = 1.0f; // current duck gain (ramped)
+    uint64_t seq = 0;     // play order; highest started voice is not ducked
+  };
+
+  int64_t frames_at(uint64_t ns) const;
+  uint64_t ns_at(int64_t frame) const;
+
+  uint32_t rate_ = 48000;
+  float duck_gain_ = 0.25f;
+
+  std::vector<Voice> voices_;
+  uint64_t next_seq_ = 0;
+
+  // timeline: frame 0 is anchor_ns_; everything before rendered_ is out
+  bool     anchored_ = false;
+  uint64_t anchor_ns_ = 0;
+  int64_t  rendered_ = 0;
+
+  std::vector<float> left_;
+  std::vector<float> right_;
+};
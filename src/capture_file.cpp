@@ -0,0 +1,164 @@
+#include "capture_file.hpp"
+
+#include "nlohmann_json.hpp"
+
+using nlohmann::json;
+
+static constexpr char kMagic[8] = {'T', 'W', 'C', 'A', 'P', 0x01, 0x00, 0x00};
+
+// Records larger than this are treated as corruption by the reader
+static constexpr uint32_t kMaxRecordBytes = 16u * 1024 * 1024;
+
+static void put_le(char* p, uint64_t v, int bytes)
+{
+  for (int i = 0; i < bytes; ++i)
+    p[i] = (char)((v >> (8 * i)) & 0xFF);
+}
+
+static uint64_t get_le(const char* p, int bytes)
+{
+  uint64_t v = 0;
+  for (int i = bytes - 1; i >= 0; --i)
+    v = (v << 8) | (unsigned char)p[i];
+  return v;
+}
+
+bool CaptureWriter::open(const std::string& path)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+
+  if (out_.is_open())
+    out_.close();
+
+  out_.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!out_.is_open())
+    return false;
+
+  out_.write(kMagic, sizeof(kMagic));
+  out_.flush();
+  return out_.good();
+}
+
+void CaptureWriter::close()
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (out_.is_open())
+    out_.close();
+}
+
+bool CaptureWriter::is_open() const
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return out_.is_open();
+}
+
+void CaptureWriter::write(CaptureRecord type, long long ts_ms, std::string_view payload)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (!out_.is_open())
+    return;
+
+  char hdr[13];
+  hdr[0] = (char)type;
+  put_le(hdr + 1, (uint64_t)ts_ms, 8);
+  put_le(hdr + 9, (uint64_t)payload.size(), 4);
+
+  out_.write(hdr, sizeof(hdr));
+  out_.write(payload.data(), (std::streamsize)payload.size());
+
+  // Flushed per record: a capture is for incidents, so it must survive a crash.
+  out_.flush();
+}
+
+bool CaptureReader::open(const std::string& path)
+{
+  in_.open(path, std::ios::in | std::ios::binary);
+  if (!in_.is_open())
+    return false;
+
+  char magic[sizeof(kMagic)];
+  if (!in_.read(magic, sizeof(magic)))
+    return false;
+
+  for (size_t i = 0; i < sizeof(kMagic); ++i)
+    if (magic[i] != kMagic[i])
+      return false;
+  return true;
+}
+
+bool CaptureReader::next(Record& out)
+{
+  char hdr[13];
+  if (!in_.read(hdr, sizeof(hdr)))
+    return false;
+
+  const uint32_t len = (uint32_t)get_le(hdr + 9, 4);
+  if (len > kMaxRecordBytes)
+    return false;
+
+  out.type = (CaptureRecord)(uint8_t)hdr[0];
+  out.ts_ms = (long long)get_le(hdr + 1, 8);
+  out.payload.resize(len);
+  return (bool)in_.read(out.payload.data(), (std::streamsize)len);
+}
+
+std::string capture_config_to_json(const CaptureConfig& cfg)
+{
+  json kinds = json::array();
+  for (int k = 0; k < kEventKindCount; ++k) {
+    json tiers = json::array();
+    for (const TierSpec& t : cfg.tiers[k]) {
+      tiers.push_back({
+        {"min_milli", t.min_milli},
+        {"media", t.media},
+        {"template", t.text_template},
+        {"duration", t.duration_sec},
+        {"sound", t.sound},
+        {"effect", t.effect},
+      });
+    }
+    kinds.push_back({{"text_template", cfg.text_template[k]}, {"tiers", std::move(tiers)}});
+  }
+
+  json j = {
+    {"duration", cfg.duration_sec},
+    {"duration_from_media", cfg.duration_from_media},
+    {"queue_budget_kb", cfg.queue_budget_kb},
+    {"queue_overflow_policy", cfg.queue_policy},
+    {"lanes", cfg.lanes},
+    {"kinds", std::move(kinds)},
+  };
+  return j.dump();
+}
+
+bool capture_config_from_json(std::string_view text, CaptureConfig& cfg)
+{
+  try {
+    const json j = json::parse(text);
+
+    cfg = CaptureConfig();
+    cfg.duration_sec        = j.value("duration", cfg.duration_sec);
+    cfg.duration_from_media = j.value("duration_from_media", false);
+    cfg.queue_budget_kb     = j.value("queue_budget_kb", cfg.queue_budget_kb);
+    cfg.queue_policy        = j.value("queue_overflow_policy", 0);
+    cfg.lanes               = j.value("lanes", 1);
+
+    const json& kinds = j.at("kinds");
+    for (int k = 0; k < kEventKindCount && k < (int)kinds.size(); ++k) {
+      cfg.text_template[k] = kinds[k].value("text_template", "");
+      for (const json& t : kinds[k].at("tiers")) {
+        TierSpec sp;
+        sp.min_milli     = t.value("min_milli", 0LL);
+        sp.media         = t.value("media", "");
+        sp.text_template = t.value("template", "");
+        sp.duration_sec  = t.value("duration", 0.0f);
+        sp.sound         = t.value("sound", "");
+        sp.effect        = t.value("effect", "");
+        cfg.tiers[k].push_back(std::move(sp));
+      }
+    }
+    return true;
+  } catch (...) {
+    return false;
+  }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "event_types.hpp"
+#include "tier_table.hpp"
+
+// Binary capture of what reached the plugin, for replaying incidents.
+//
+// File layout (little-endian):
+//   "TWCAP" 0x01 0x00 0x00                       8-byte header
+//   { u8 type, u64 ts_ms, u32 len, len bytes }   records, in arrival order
+enum class CaptureRecord : uint8_t {
+  Config   = 1, // alert settings as JSON (tiers, duration, queue; never credentials)
+  Update   = 2, // raw TDLib updateNewMessage JSON that passed the sender filter
+  Filtered = 3, // chat_id + sender_id of a message dropped by the sender filter
+};
+
+// Alert settings carried by a Config record: everything that decides which
+// alert plays and for how long, nothing else (no credentials, no styling).
+struct CaptureConfig {
+  float       duration_sec = 8.9f;
+  bool        duration_from_media = false;
+  int         queue_budget_kb = 256;
+  int         queue_policy = 0; // OverflowPolicy
+  int         lanes = 1;        // concurrent alerts
+  std::string text_template[kEventKindCount];
+  std::vector<TierSpec> tiers[kEventKindCount];
+};
+
+std::string capture_config_to_json(const CaptureConfig& cfg);
+bool capture_config_from_json(std::string_view text, CaptureConfig& cfg);
+
+// Appends records; thread-safe, cheap no-op while closed.
+class CaptureWriter {
+public:
+  CaptureWriter() = default;
+  ~CaptureWriter() { close(); }
+
+  CaptureWriter(const CaptureWriter&) = delete;
+  CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+  // Truncates `path` and writes the header; false if it cannot be created
+  bool open(const std::string& path);
+  void close();
+  bool is_open() const;
+
+  void write(CaptureRecord type, long long ts_ms, std::string_view payload);
+
+private:
+  mutable std::mutex mutex_;
+  std::ofstream out_;
+};
+
+class CaptureReader {
+public:
+  struct Record {
+    CaptureRecord type = CaptureRecord::Update;
+    long long     ts_ms = 0;
+    std::string   payload;
+  };
+
+  // False if the file is missing or not a capture
+  bool open(const std::string& path);
+
+  // False at the end of the file or on a truncated record
+  bool next(Record& out);
+
+private:
+  std::ifstream in_;
+};
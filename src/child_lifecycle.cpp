@@ -0,0 +1,68 @@
+#include "child_lifecycle.hpp"
+
+#include <cstdio>
+
+bool ChildLifecycle::tick(float seconds, bool busy)
+{
+  if (busy || !live_) {
+    idle_ = 0.0f;
+    return false;
+  }
+
+  idle_ += seconds;
+  if (teardown_after_ <= 0.0f || idle_ < teardown_after_)
+    return false;
+
+  live_ = false;
+  idle_ = 0.0f;
+  return true;
+}
+
+uint64_t child_footprint_bytes(const ChildFootprint& f)
+{
+  const uint64_t frame = (uint64_t)f.cx * f.cy * 4;
+  switch (f.role) {
+  case ChildRole::Media: return 2 * frame;
+  case ChildRole::Text:  return frame + (uint64_t)f.cache_cx * f.cache_cy * 4;
+  case ChildRole::Sound: return 0;
+  }
+  return 0;
+}
+
+static const char* role_name(ChildRole r)
+{
+  switch (r) {
+  case ChildRole::Media: return "media";
+  case ChildRole::Sound: return "sound";
+  case ChildRole::Text:  return "text";
+  }
+  return "?";
+}
+
+std::string child_memory_report(const ChildFootprint* f, size_t n)
+{
+  if (!n)
+    return "No child sources loaded";
+
+  std::string out;
+  uint64_t total = 0;
+  char line[128];
+
+  for (size_t i = 0; i < n; ++i) {
+    const uint64_t bytes = child_footprint_bytes(f[i]);
+    total += bytes;
+
+    if (f[i].role == ChildRole::Sound)
+      snprintf(line, sizeof(line), "Lane %d sound: audio only\n", f[i].lane + 1);
+    else if (!f[i].cx || !f[i].cy)
+      snprintf(line, sizeof(line), "Lane %d %s: no frame yet\n", f[i].lane + 1, role_name(f[i].role));
+    else
+      snprintf(line, sizeof(line), "Lane %d %s: %ux%u, ~%.1f MB\n", f[i].lane + 1, role_name(f[i].role),
+               f[i].cx, f[i].cy, (double)bytes / (1024.0 * 1024.0));
+    out += line;
+  }
+
+  snprintf(line, sizeof(line), "Total ~%.1f MB (estimate, RGBA frames)", (double)total / (1024.0 * 1024.0));
+  out += line;
+  return out;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Media/sound/text children of the tip alert source: when they exist.
+//
+// Children are created on the first alert (or warmed up on activation) and
+// kept while alerts keep coming, so later alerts skip source creation and
+// decoder startup. After `teardown_after` seconds with nothing playing they
+// are released, giving their decoder and texture memory back until the
+// next alert (or activation) brings them back.
+class ChildLifecycle {
+public:
+  // 0 = keep children for the source's lifetime
+  void set_teardown_after(float seconds) { teardown_after_ = seconds > 0.0f ? seconds : 0.0f; }
+  float teardown_after() const { return teardown_after_; }
+
+  // Children were created (warm-up or an alert)
+  void created() { live_ = true; idle_ = 0.0f; }
+
+  bool live() const { return live_; }
+
+  // Once per video tick. True exactly once when the children are due for
+  // teardown; the caller releases them.
+  bool tick(float seconds, bool busy);
+
+private:
+  float teardown_after_ = 0.0f;
+  float idle_ = 0.0f;
+  bool  live_ = false;
+};
+
+enum class ChildRole : uint8_t { Media, Sound, Text };
+
+// Size of one live child, as the memory report sees it
+struct ChildFootprint {
+  ChildRole role = ChildRole::Media;
+  int       lane = 0;
+  uint32_t  cx = 0, cy = 0;             // child's video size (0 while it has no frame)
+  uint32_t  cache_cx = 0, cache_cy = 0; // our rasterized copy (text only)
+
+  bool operator==(const ChildFootprint&) const = default;
+};
+
+// Estimated resident bytes: RGBA frames. Media holds a decoded frame plus
+// its texture; text its own texture plus our cached copy. Sound children
+// hold no video.
+uint64_t child_footprint_bytes(const ChildFootprint& f);
+
+// One line per child plus a total, e.g. "Lane 1 media: 1920x1080, ~15.8 MB"
+std::string child_memory_report(const ChildFootprint* f, size_t n);
@@ -1,5 +1,6 @@
 #include "config.hpp"
 
+#include <algorithm>
 #include <cctype>
 #include <fstream>
 #include <string>
@@ -106,6 +107,7 @@ TgAppCreds load_tg_creds()
 
     out.api_id   = j.value("api_id", "");
     out.api_hash = j.value("api_hash", "");
+    out.encrypt_session = j.value("encrypt_session", true);
 
     std::string err;
     out.valid = validate_tg_creds(out.api_id, out.api_hash, err);
@@ -119,8 +121,41 @@ TgAppCreds load_tg_creds()
   }
 }
 
+// Current config.json as an object; empty when missing or unreadable
+static json read_config_object(const std::string& path)
+{
+  std::ifstream f(path, std::ios::binary);
+  if (!f.good()) return json::object();
+
+  try {
+    json j;
+    f >> j;
+    if (j.is_object()) return j;
+  } catch (...) {
+  }
+  return json::object();
+}
+
+static bool write_config_object(const std::string& path, const json& j, std::string& out_error)
+{
+  const std::string dir = parent_dir_of(path);
+  if (!dir.empty())
+    os_mkdirs(dir.c_str());
+
+  std::ofstream out(path, std::ios::binary);
+  if (!out.good()) {
+    out_error = "Failed to write config.json (cannot open for writing).";
+    return false;
+  }
+
+  out << j.dump(2);
+  out_error.clear();
+  return true;
+}
+
 bool save_tg_creds(const std::string& api_id,
                    const std::string& api_hash,
+                   bool encrypt_session,
                    std::string& out_error)
 {
   std::string err;
@@ -131,24 +166,119 @@ bool save_tg_creds(const std::string& api_id,
 
   const std::string path = twich_config_path();
 
-  const std::string dir = parent_dir_of(path);
-  if (!dir.empty())
-    os_mkdirs(dir.c_str());
+  // accounts and anything else in the file stay
+  json j = read_config_object(path);
+  j["api_id"] = api_id;
+  j["api_hash"] = api_hash;
+  j["encrypt_session"] = encrypt_session;
+
+  if (!write_config_object(path, j, out_error))
+    return false;
+
+  blog(LOG_INFO, "[TWICH] Saved Telegram config to: %s", path.c_str());
+  return true;
+}
 
-  json j = {
-    {"api_id", api_id},
-    {"api_hash", api_hash}
+bool valid_tg_account_name(const std::string& name)
+{
+  if (name.empty() || name.size() > 32) return false;
+  for (unsigned char c : name) {
+    if (!(std::isalnum(c) || c == '_' || c == '-'))
+      return false;
+  }
+  return true;
+}
+
+std::vector<std::string> parse_bot_list(const std::string& text)
+{
+  std::vector<std::string> bots;
+  std::string cur;
+
+  auto flush = [&] {
+    if (!cur.empty() && cur[0] == '@') cur.erase(cur.begin());
+    if (!cur.empty() && std::find(bots.begin(), bots.end(), cur) == bots.end())
+      bots.push_back(cur);
+    cur.clear();
   };
 
-  std::ofstream out(path, std::ios::binary);
-  if (!out.good()) {
-    out_error = "Failed to write config.json (cannot open for writing).";
+  for (unsigned char c : text) {
+    if (c == ',' || c == ';' || std::isspace(c))
+      flush();
+    else
+      cur.push_back((char)c);
+  }
+  flush();
+  return bots;
+}
+
+std::vector<TgAccountConfig> load_tg_accounts()
+{
+  std::vector<TgAccountConfig> out;
+  const json j = read_config_object(twich_config_path());
+
+  if (j.contains("accounts") && j["accounts"].is_array()) {
+    for (const json& a : j["accounts"]) {
+      if (!a.is_object()) continue;
+
+      TgAccountConfig acc;
+      acc.name = a.value("name", "");
+      if (!valid_tg_account_name(acc.name)) {
+        blog(LOG_WARNING, "[TWICH] config.json: skipping account with invalid name '%s'", acc.name.c_str());
+        continue;
+      }
+      if (a.contains("bots") && a["bots"].is_array()) {
+        for (const json& b : a["bots"]) {
+          if (b.is_string()) {
+            for (std::string& u : parse_bot_list(b.get<std::string>()))
+              acc.bots.push_back(std::move(u));
+          }
+        }
+      }
+
+      const bool dup = std::any_of(out.begin(), out.end(),
+                                   [&](const TgAccountConfig& o) { return o.name == acc.name; });
+      if (!dup)
+        out.push_back(std::move(acc));
+    }
+  }
+
+  auto dflt = std::find_if(out.begin(), out.end(),
+                           [](const TgAccountConfig& a) { return a.name == kDefaultTgAccount; });
+  if (dflt == out.end())
+    dflt = out.insert(out.begin(), TgAccountConfig{kDefaultTgAccount, {}});
+  if (dflt->bots.empty())
+    dflt->bots.push_back(kDefaultTgBot);
+
+  return out;
+}
+
+bool save_tg_account(const TgAccountConfig& account, std::string& out_error)
+{
+  if (!valid_tg_account_name(account.name)) {
+    out_error = "Account names are 1-32 letters, digits, '_' or '-'.";
     return false;
   }
 
-  out << j.dump(2);
-  out_error.clear();
+  const std::string path = twich_config_path();
+  json j = read_config_object(path);
 
-  blog(LOG_INFO, "[TWICH] Saved Telegram config to: %s", path.c_str());
+  json list = (j.contains("accounts") && j["accounts"].is_array()) ? j["accounts"] : json::array();
+  json entry = {{"name", account.name}, {"bots", account.bots}};
+
+  bool replaced = false;
+  for (json& a : list) {
+    if (a.is_object() && a.value("name", "") == account.name) {
+      a = entry;
+      replaced = true;
+    }
+  }
+  if (!replaced)
+    list.push_back(entry);
+  j["accounts"] = list;
+
+  if (!write_config_object(path, j, out_error))
+    return false;
+
+  blog(LOG_INFO, "[TWICH] Saved Telegram account '%s' (%zu bot(s))", account.name.c_str(), account.bots.size());
   return true;
 }
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 struct TgAppCreds {
   std::string api_id;
   std::string api_hash;
+  bool encrypt_session = true; // encrypt the TDLib session database
   bool valid = false;
   std::string error;
 };
@@ -21,8 +23,32 @@ bool validate_tg_creds(const std::string& api_id,
 // If missing/invalid -> valid=false and error filled.
 TgAppCreds load_tg_creds();
 
-// Save creds into config.json (creates file if missing).
+// Save creds into config.json (creates file if missing, keeps other keys).
 // Returns false + out_error on validation or write failure.
 bool save_tg_creds(const std::string& api_id,
                    const std::string& api_hash,
+                   bool encrypt_session,
                    std::string& out_error);
+
+// A named Telegram login: its own session dir and the bots whose messages
+// are events. All accounts share the app's api_id/api_hash.
+struct TgAccountConfig {
+  std::string name;
+  std::vector<std::string> bots; // usernames, without '@'
+};
+
+constexpr const char* kDefaultTgAccount = "default"; // uses the original tg_session dir
+constexpr const char* kDefaultTgBot = "EddieLives_bot";
+
+// 1..32 of [A-Za-z0-9_-] (the name is part of a directory name)
+bool valid_tg_account_name(const std::string& name);
+
+// "@a_bot, b_bot" -> {"a_bot", "b_bot"}
+std::vector<std::string> parse_bot_list(const std::string& text);
+
+// "accounts" from config.json. Always has the default account, which gets
+// the stock bot when none is configured.
+std::vector<TgAccountConfig> load_tg_accounts();
+
+// Adds or replaces one account in config.json
+bool save_tg_account(const TgAccountConfig& account, std::string& out_error);
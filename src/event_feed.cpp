@@ -0,0 +1,970 @@
+#include "event_feed.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <string_view>
+#include <unordered_map>
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  include <winsock2.h>
+#  include <ws2tcpip.h>
+#else
+#  include <arpa/inet.h>
+#  include <fcntl.h>
+#  include <netinet/in.h>
+#  include <netinet/tcp.h>
+#  include <sys/socket.h>
+#  include <sys/uio.h>
+#  include <unistd.h>
+#  include <cerrno>
+#  ifdef __linux__
+#    include <sys/epoll.h>
+#    include <sys/eventfd.h>
+#  else
+#    include <poll.h>
+#  endif
+#endif
+
+#include "nlohmann_json.hpp"
+
+using nlohmann::json;
+
+// ------------------------------------------------------------
+// Event -> JSON
+// ------------------------------------------------------------
+std::string event_to_feed_json(const TipEvent& ev)
+{
+  static constexpr const char* kKindNames[kEventKindCount] = {"tip", "follow", "sub"};
+
+  char id[17];
+  snprintf(id, sizeof(id), "%016llx", (unsigned long long)ev.dedupe_hash);
+
+  json j = {
+    {"type", kKindNames[(int)ev.kind]},
+    {"user", std::string(ev.from_username())},
+    {"amount", std::string(ev.amount_str())},
+    {"amount_milli", ev.amount_milli},
+    {"symbol", ev.symbol},
+    {"account", ev.account},
+    {"message", std::string(ev.message())},
+    {"ts", ev.ts_ms},
+    {"id", id},
+  };
+  return j.dump(-1, ' ', false, json::error_handler_t::replace);
+}
+
+static std::string hex_id(uint64_t id)
+{
+  char buf[17];
+  snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)id);
+  return buf;
+}
+
+std::string pending_to_feed_json(uint64_t id, const ApprovalQueue::Held& h, long long expires_ms)
+{
+  static constexpr const char* kKindNames[kEventKindCount] = {"tip", "follow", "sub"};
+
+  json j = {
+    {"type", "pending"},
+    {"id", hex_id(id)},
+    {"kind", kKindNames[(int)h.kind]},
+    {"user", h.user},
+    {"amount", h.amount},
+    {"symbol", h.symbol},
+    {"account", h.account},
+    {"message", h.message},
+    {"expires", expires_ms},
+  };
+  return j.dump(-1, ' ', false, json::error_handler_t::replace);
+}
+
+std::string resolved_to_feed_json(uint64_t id, const char* outcome)
+{
+  json j = {
+    {"type", "resolved"},
+    {"id", hex_id(id)},
+    {"outcome", outcome},
+  };
+  return j.dump();
+}
+
+// ------------------------------------------------------------
+// Handshake helpers (SHA-1 + base64 for Sec-WebSocket-Accept)
+// ------------------------------------------------------------
+static void sha1(const uint8_t* data, size_t len, uint8_t out[20])
+{
+  uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+  auto rol = [](uint32_t v, int n) { return (v << n) | (v >> (32 - n)); };
+
+  // message + 0x80 + zero pad + 64-bit bit length, in 64-byte blocks
+  std::vector<uint8_t> m(data, data + len);
+  m.push_back(0x80);
+  while (m.size() % 64 != 56)
+    m.push_back(0);
+  const uint64_t bits = (uint64_t)len * 8;
+  for (int i = 7; i >= 0; --i)
+    m.push_back((uint8_t)(bits >> (8 * i)));
+
+  for (size_t off = 0; off < m.size(); off += 64) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; ++i)
+      w[i] = ((uint32_t)m[off + 4 * i] << 24) | ((uint32_t)m[off + 4 * i + 1] << 16) |
+             ((uint32_t)m[off + 4 * i + 2] << 8) | (uint32_t)m[off + 4 * i + 3];
+    for (int i = 16; i < 80; ++i)
+      w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; ++i) {
+      uint32_t f, k;
+      if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+      else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+      else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+      else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+
+      const uint32_t t = rol(a, 5) + f + e + k + w[i];
+      e = d; d = c; c = rol(b, 30); b = a; a = t;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+  }
+
+  for (int i = 0; i < 5; ++i)
+    for (int j = 0; j < 4; ++j)
+      out[4 * i + j] = (uint8_t)(h[i] >> (24 - 8 * j));
+}
+
+static std::string base64(const uint8_t* data, size_t len)
+{
+  static constexpr char kAlphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+  std::string out;
+  out.reserve((len + 2) / 3 * 4);
+  for (size_t i = 0; i < len; i += 3) {
+    const uint32_t n = ((uint32_t)data[i] << 16) |
+                       ((i + 1 < len ? (uint32_t)data[i + 1] : 0) << 8) |
+                       (i + 2 < len ? (uint32_t)data[i + 2] : 0);
+    out += kAlphabet[(n >> 18) & 63];
+    out += kAlphabet[(n >> 12) & 63];
+    out += (i + 1 < len) ? kAlphabet[(n >> 6) & 63] : '=';
+    out += (i + 2 < len) ? kAlphabet[n & 63] : '=';
+  }
+  return out;
+}
+
+static std::string websocket_accept(std::string_view key)
+{
+  std::string s(key);
+  s += "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+  uint8_t digest[20];
+  sha1((const uint8_t*)s.data(), s.size(), digest);
+  return base64(digest, sizeof(digest));
+}
+
+// Server -> client frame (FIN, unmasked)
+static std::string ws_frame(uint8_t opcode, std::string_view payload)
+{
+  std::string f;
+  f.reserve(payload.size() + 10);
+  f += (char)(0x80 | opcode);
+
+  const uint64_t n = payload.size();
+  if (n < 126) {
+    f += (char)n;
+  } else if (n <= 0xFFFF) {
+    f += (char)126;
+    f += (char)(n >> 8);
+    f += (char)(n & 0xFF);
+  } else {
+    f += (char)127;
+    for (int i = 7; i >= 0; --i)
+      f += (char)((n >> (8 * i)) & 0xFF);
+  }
+
+  f.append(payload.data(), payload.size());
+  return f;
+}
+
+// Value of an HTTP header (case-insensitive name), "" if absent
+static std::string_view http_header(std::string_view req, std::string_view name)
+{
+  size_t pos = req.find("\r\n");
+  while (pos != std::string_view::npos && pos + 2 < req.size()) {
+    const size_t line_start = pos + 2;
+    const size_t line_end = req.find("\r\n", line_start);
+    if (line_end == std::string_view::npos || line_end == line_start)
+      break;
+
+    std::string_view line = req.substr(line_start, line_end - line_start);
+    const size_t colon = line.find(':');
+    if (colon == name.size()) {
+      bool match = true;
+      for (size_t i = 0; i < name.size() && match; ++i)
+        match = tolower((unsigned char)line[i]) == tolower((unsigned char)name[i]);
+      if (match) {
+        std::string_view v = line.substr(colon + 1);
+        while (!v.empty() && (v.front() == ' ' || v.front() == '\t')) v.remove_prefix(1);
+        while (!v.empty() && (v.back() == ' ' || v.back() == '\t')) v.remove_suffix(1);
+        return v;
+      }
+    }
+    pos = line_end;
+  }
+  return {};
+}
+
+// Origin of the /pending page itself, or none (not a browser)
+static bool trusted_origin(std::string_view origin, uint16_t port)
+{
+  if (origin.empty())
+    return true;
+  const std::string p = std::to_string(port);
+  return origin == "http://127.0.0.1:" + p || origin == "http://localhost:" + p;
+}
+
+// Custom browser dock for held events (View > Docks > Custom Browser Docks)
+static const char kPendingPage[] = R"HTML(<!doctype html>
+<html><head><meta charset="utf-8"><title>TWICH held alerts</title>
+<style>
+body{font:13px sans-serif;margin:6px;background:#1e1e1e;color:#ddd}
+.e{border-bottom:1px solid #333;padding:4px 0}
+.u{font-weight:bold}.m{white-space:pre-wrap;word-break:break-word}
+.t{color:#999;font-size:11px}button{margin-right:4px}
+#s{color:#999}
+</style></head><body>
+<div id="s">connecting...</div><div id="l"></div>
+<script>
+const list=document.getElementById('l'),stat=document.getElementById('s');
+const rows=new Map();let ws=null;
+function send(cmd,id){if(ws&&ws.readyState===1)ws.send(JSON.stringify({cmd:cmd,id:id}));}
+function add(e){
+  if(rows.has(e.id))return;
+  const d=document.createElement('div');d.className='e';
+  const h=document.createElement('div');
+  const u=document.createElement('span');u.className='u';u.textContent=e.user;
+  h.appendChild(u);h.appendChild(document.createTextNode(' '+e.kind+(e.kind==='tip'?' '+e.amount+' '+e.symbol:'')));
+  const m=document.createElement('div');m.className='m';m.textContent=e.message;
+  const t=document.createElement('div');t.className='t';
+  const a=document.createElement('button');a.textContent='Approve';a.onclick=()=>send('approve',e.id);
+  const r=document.createElement('button');r.textContent='Reject';r.onclick=()=>send('reject',e.id);
+  d.append(h,m,a,r,t);list.appendChild(d);rows.set(e.id,{el:d,t:t,expires:e.expires});
+  count();
+}
+function drop(id){const r=rows.get(id);if(r){r.el.remove();rows.delete(id);count();}}
+function count(){stat.textContent=rows.size?rows.size+' held':'nothing held';}
+setInterval(()=>{const now=Date.now();for(const r of rows.values())
+  r.t.textContent=r.expires?'auto-approves in '+Math.max(0,Math.ceil((r.expires-now)/1000))+' s':'';},500);
+function connect(){
+  ws=new WebSocket('ws://'+location.host+'/pending');
+  ws.onopen=()=>{list.textContent='';rows.clear();count();};
+  ws.onmessage=(m)=>{const e=JSON.parse(m.data);if(e.type==='pending')add(e);else if(e.type==='resolved')drop(e.id);};
+  ws.onclose=()=>{stat.textContent='disconnected, retrying...';setTimeout(connect,2000);};
+}
+connect();
+</script></body></html>
+)HTML";
+
+// ------------------------------------------------------------
+// Sockets + poller
+// ------------------------------------------------------------
+#ifdef _WIN32
+using socket_t = SOCKET;
+static constexpr socket_t kBadSocket = INVALID_SOCKET;
+static void close_socket(socket_t s) { closesocket(s); }
+static bool would_block() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+static void set_nonblocking(socket_t s) { u_long on = 1; ioctlsocket(s, FIONBIO, &on); }
+#else
+using socket_t = int;
+static constexpr socket_t kBadSocket = -1;
+static void close_socket(socket_t s) { ::close(s); }
+static bool would_block() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+static void set_nonblocking(socket_t s) { fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK); }
+#endif
+
+namespace {
+
+using Frame = std::shared_ptr<const std::string>;
+
+struct Client {
+  socket_t          fd = kBadSocket;
+  bool              upgraded = false;
+  bool              moderation = false;    // on /pending
+  bool              needs_snapshot = false; // just upgraded to /pending
+  bool              close_after_flush = false;
+  std::string       in;       // unparsed bytes from the client
+  std::deque<Frame> out;      // shared frames waiting to be written
+  size_t            out_off = 0;   // bytes of out.front() already sent
+  size_t            out_bytes = 0; // total queued, for eviction
+  bool              want_write = false;
+};
+
+struct Ready {
+  socket_t fd;
+  bool     readable;
+  bool     writable;
+};
+
+} // namespace
+
+struct EventFeedServer::Impl {
+  socket_t listener = kBadSocket;
+  std::unordered_map<socket_t, Client> clients;
+
+#if defined(__linux__)
+  int epfd = -1;
+  int wakefd = -1; // eventfd
+
+  bool init_poller()
+  {
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epfd < 0 || wakefd < 0)
+      return false;
+    watch(wakefd, false);
+    return true;
+  }
+
+  void watch(socket_t fd, bool want_write)
+  {
+    epoll_event e{};
+    e.events = EPOLLIN | (want_write ? (uint32_t)EPOLLOUT : 0u);
+    e.data.fd = fd;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &e);
+  }
+
+  void rewatch(socket_t fd, bool want_write)
+  {
+    epoll_event e{};
+    e.events = EPOLLIN | (want_write ? (uint32_t)EPOLLOUT : 0u);
+    e.data.fd = fd;
+    epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &e);
+  }
+
+  void unwatch(socket_t fd) { epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr); }
+
+  void wait(int timeout_ms, std::vector<Ready>& ready)
+  {
+    epoll_event evs[64];
+    const int n = epoll_wait(epfd, evs, 64, timeout_ms);
+    for (int i = 0; i < n; ++i) {
+      ready.push_back({evs[i].data.fd,
+                       (evs[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0,
+                       (evs[i].events & EPOLLOUT) != 0});
+    }
+  }
+
+  bool is_wake(socket_t fd) const { return fd == wakefd; }
+
+  void wake()
+  {
+    const uint64_t one = 1;
+    (void)!::write(wakefd, &one, sizeof(one));
+  }
+
+  void drain_wake()
+  {
+    uint64_t v;
+    (void)!::read(wakefd, &v, sizeof(v));
+  }
+
+  void close_poller()
+  {
+    if (wakefd >= 0) ::close(wakefd);
+    if (epfd >= 0) ::close(epfd);
+    wakefd = epfd = -1;
+  }
+#else
+  // poll()/WSAPoll: the set is rebuilt per wait; fine for a few dozen overlays.
+  // Wake-ups go through a loopback UDP socket that sends to itself.
+  std::map<socket_t, bool> watched; // fd -> want_write
+  socket_t wake_sock = kBadSocket;
+  sockaddr_in wake_addr{};
+
+  bool init_poller()
+  {
+    wake_sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (wake_sock == kBadSocket)
+      return false;
+
+    wake_addr.sin_family = AF_INET;
+    wake_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    wake_addr.sin_port = 0;
+    if (bind(wake_sock, (sockaddr*)&wake_addr, sizeof(wake_addr)) != 0)
+      return false;
+
+    socklen_t len = sizeof(wake_addr);
+    getsockname(wake_sock, (sockaddr*)&wake_addr, &len);
+    set_nonblocking(wake_sock);
+    watch(wake_sock, false);
+    return true;
+  }
+
+  void watch(socket_t fd, bool want_write) { watched[fd] = want_write; }
+  void rewatch(socket_t fd, bool want_write) { watched[fd] = want_write; }
+  void unwatch(socket_t fd) { watched.erase(fd); }
+
+  void wait(int timeout_ms, std::vector<Ready>& ready)
+  {
+    std::vector<pollfd> pfds;
+    pfds.reserve(watched.size());
+    for (const auto& [fd, ww] : watched) {
+      pollfd p{};
+      p.fd = fd;
+      p.events = POLLIN | (ww ? POLLOUT : 0);
+      pfds.push_back(p);
+    }
+
+#ifdef _WIN32
+    const int n = WSAPoll(pfds.data(), (ULONG)pfds.size(), timeout_ms);
+#else
+    const int n = poll(pfds.data(), (nfds_t)pfds.size(), timeout_ms);
+#endif
+    if (n <= 0)
+      return;
+
+    for (const pollfd& p : pfds) {
+      if (!p.revents)
+        continue;
+      ready.push_back({(socket_t)p.fd,
+                       (p.revents & (POLLIN | POLLHUP | POLLERR)) != 0,
+                       (p.revents & POLLOUT) != 0});
+    }
+  }
+
+  bool is_wake(socket_t fd) const { return fd == wake_sock; }
+
+  void wake()
+  {
+    const char b = 1;
+    sendto(wake_sock, &b, 1, 0, (const sockaddr*)&wake_addr, sizeof(wake_addr));
+  }
+
+  void drain_wake()
+  {
+    char buf[64];
+    while (recv(wake_sock, buf, sizeof(buf), 0) > 0) {
+    }
+  }
+
+  void close_poller()
+  {
+    if (wake_sock != kBadSocket) close_socket(wake_sock);
+    wake_sock = kBadSocket;
+    watched.clear();
+  }
+#endif
+};
+
+// ------------------------------------------------------------
+// Server
+// ------------------------------------------------------------
+EventFeedServer::~EventFeedServer()
+{
+  stop();
+}
+
+bool EventFeedServer::start(uint16_t port, std::string& error)
+{
+  if (running_.load())
+    return true;
+
+#ifdef _WIN32
+  WSADATA wsa;
+  if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+    error = "WSAStartup failed";
+    return false;
+  }
+#endif
+
+  impl_ = std::make_unique<Impl>();
+
+  socket_t ls = socket(AF_INET, SOCK_STREAM, 0);
+  if (ls == kBadSocket) {
+    error = "socket() failed";
+    impl_.reset();
+    return false;
+  }
+
+  int yes = 1;
+  setsockopt(ls, SOL_SOCKET, SO_REUSEADDR, (const char*)&yes, sizeof(yes));
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // localhost only
+  addr.sin_port = htons(port);
+
+  if (bind(ls, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(ls, 16) != 0) {
+    error = "cannot listen on 127.0.0.1:" + std::to_string(port);
+    close_socket(ls);
+    impl_.reset();
+    return false;
+  }
+  set_nonblocking(ls);
+
+  if (!impl_->init_poller()) {
+    error = "cannot create poller";
+    close_socket(ls);
+    impl_->close_poller();
+    impl_.reset();
+    return false;
+  }
+
+  impl_->listener = ls;
+  impl_->watch(ls, false);
+
+  port_ = port;
+  running_.store(true);
+  thr_ = std::thread([this]() { run(); });
+  return true;
+}
+
+void EventFeedServer::stop()
+{
+  if (!running_.exchange(false))
+    return;
+
+  impl_->wake();
+  if (thr_.joinable())
+    thr_.join();
+
+  for (auto& [fd, c] : impl_->clients)
+    close_socket(fd);
+  impl_->clients.clear();
+
+  close_socket(impl_->listener);
+  impl_->close_poller();
+  impl_.reset();
+  clients_.store(0);
+  docks_.store(0);
+
+#ifdef _WIN32
+  WSACleanup();
+#endif
+}
+
+void EventFeedServer::broadcast(const TipEvent& ev)
+{
+  if (!running_.load())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lk(inbox_mutex_);
+    if (!dedupe_.admit(ev.dedupe_hash))
+      return;
+
+    // framed once; every client queue shares this buffer
+    inbox_.push_back({std::make_shared<const std::string>(ws_frame(0x1, event_to_feed_json(ev))), false});
+  }
+
+  broadcast_++;
+  impl_->wake();
+}
+
+void EventFeedServer::publish_pending(uint64_t id, std::string json)
+{
+  if (!running_.load())
+    return;
+
+  auto frame = std::make_shared<const std::string>(ws_frame(0x1, json));
+  {
+    std::lock_guard<std::mutex> lk(inbox_mutex_);
+    pending_[id] = frame;
+    inbox_.push_back({std::move(frame), true});
+  }
+  impl_->wake();
+}
+
+void EventFeedServer::resolve_pending(uint64_t id, std::string json)
+{
+  if (!running_.load())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lk(inbox_mutex_);
+    pending_.erase(id);
+    inbox_.push_back({std::make_shared<const std::string>(ws_frame(0x1, json)), true});
+  }
+  impl_->wake();
+}
+
+uint64_t EventFeedServer::add_command_handler(CommandHandler handler)
+{
+  std::lock_guard<std::mutex> lk(handlers_mutex_);
+  const uint64_t token = next_handler_++;
+  handlers_[token] = std::move(handler);
+  return token;
+}
+
+void EventFeedServer::remove_command_handler(uint64_t token)
+{
+  std::lock_guard<std::mutex> lk(handlers_mutex_);
+  handlers_.erase(token);
+}
+
+EventFeedStats EventFeedServer::stats() const
+{
+  EventFeedStats st;
+  st.clients = clients_.load();
+  st.docks = docks_.load();
+  st.broadcast = broadcast_.load();
+  st.evicted = evicted_.load();
+  return st;
+}
+
+namespace {
+
+// Gathered write of as many queued frames as the socket takes.
+// Returns false on a hard error.
+bool flush_client(Client& c)
+{
+  while (!c.out.empty()) {
+    constexpr int kMaxIov = 16;
+    size_t n_iov = 0;
+
+#ifdef _WIN32
+    WSABUF iov[kMaxIov];
+    for (auto it = c.out.begin(); it != c.out.end() && n_iov < kMaxIov; ++it, ++n_iov) {
+      const size_t off = (n_iov == 0) ? c.out_off : 0;
+      iov[n_iov].buf = (char*)(*it)->data() + off;
+      iov[n_iov].len = (ULONG)((*it)->size() - off);
+    }
+    DWORD sent_dw = 0;
+    const int rc = WSASend(c.fd, iov, (DWORD)n_iov, &sent_dw, 0, nullptr, nullptr);
+    if (rc != 0)
+      return would_block();
+    size_t sent = sent_dw;
+#else
+    iovec iov[kMaxIov];
+    for (auto it = c.out.begin(); it != c.out.end() && n_iov < kMaxIov; ++it, ++n_iov) {
+      const size_t off = (n_iov == 0) ? c.out_off : 0;
+      iov[n_iov].iov_base = (void*)((*it)->data() + off);
+      iov[n_iov].iov_len = (*it)->size() - off;
+    }
+    msghdr msg{};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = n_iov;
+#  ifdef MSG_NOSIGNAL
+    const ssize_t rc = sendmsg(c.fd, &msg, MSG_NOSIGNAL);
+#  else
+    const ssize_t rc = sendmsg(c.fd, &msg, 0);
+#  endif
+    if (rc < 0)
+      return would_block();
+    size_t sent = (size_t)rc;
+#endif
+
+    c.out_bytes -= std::min(c.out_bytes, sent);
+    while (sent > 0 && !c.out.empty()) {
+      const size_t left = c.out.front()->size() - c.out_off;
+      if (sent >= left) {
+        sent -= left;
+        c.out.pop_front();
+        c.out_off = 0;
+      } else {
+        c.out_off += sent;
+        sent = 0;
+      }
+    }
+
+    if (!c.out.empty())
+      return true; // partial write: wait for writable
+  }
+  return true;
+}
+
+void enqueue(Client& c, Frame f)
+{
+  c.out_bytes += f->size();
+  c.out.push_back(std::move(f));
+}
+
+void respond_and_close(Client& c, const char* status, const char* type, std::string_view body)
+{
+  enqueue(c, std::make_shared<const std::string>(
+    std::string("HTTP/1.1 ") + status + "\r\nContent-Type: " + type +
+    "\r\nCache-Control: no-store\r\nConnection: close\r\nContent-Length: " +
+    std::to_string(body.size()) + "\r\n\r\n" + std::string(body)));
+  c.close_after_flush = true;
+  c.in.clear();
+}
+
+// Returns false when the connection should be dropped
+bool handle_handshake(Client& c, uint16_t port)
+{
+  const size_t end = c.in.find("\r\n\r\n");
+  if (end == std::string::npos)
+    return c.in.size() < 8192; // keep reading, within reason
+
+  const std::string_view req(c.in.data(), end + 2);
+  if (req.compare(0, 4, "GET ") != 0)
+    return false;
+
+  // request target, without the query
+  std::string_view path = req.substr(4, req.find(' ', 4) - 4);
+  path = path.substr(0, path.find('?'));
+  const bool pending = (path == "/pending");
+
+  const std::string_view key = http_header(req, "Sec-WebSocket-Key");
+  if (key.empty()) {
+    if (pending)
+      respond_and_close(c, "200 OK", "text/html; charset=utf-8",
+                        std::string_view(kPendingPage, sizeof(kPendingPage) - 1));
+    else // plain HTTP: one-line status, then close
+      respond_and_close(c, "200 OK", "text/plain", "TWICH event feed: connect with a WebSocket client\n");
+    return true;
+  }
+
+  if (pending && !trusted_origin(http_header(req, "Origin"), port)) {
+    respond_and_close(c, "403 Forbidden", "text/plain", "");
+    return true;
+  }
+
+  enqueue(c, std::make_shared<const std::string>(
+    "HTTP/1.1 101 Switching Protocols\r\n"
+    "Upgrade: websocket\r\n"
+    "Connection: Upgrade\r\n"
+    "Sec-WebSocket-Accept: " + websocket_accept(key) + "\r\n\r\n"));
+
+  c.upgraded = true;
+  c.moderation = pending;
+  c.needs_snapshot = pending;
+  c.in.erase(0, end + 4);
+  return true;
+}
+
+// Client frames: answer ping/close, collect text from docks into
+// `commands`, ignore the rest. False to drop the client.
+bool handle_frames(Client& c, std::vector<std::string>& commands)
+{
+  constexpr uint64_t kMaxPayload = 64 * 1024;
+
+  for (;;) {
+    if (c.in.size() < 2)
+      return true;
+
+    const uint8_t b0 = (uint8_t)c.in[0];
+    const uint8_t b1 = (uint8_t)c.in[1];
+    const uint8_t opcode = b0 & 0x0F;
+    if (!(b1 & 0x80))
+      return false; // clients must mask
+
+    size_t hdr = 2;
+    uint64_t len = b1 & 0x7F;
+    if (len == 126) {
+      if (c.in.size() < 4) return true;
+      len = ((uint64_t)(uint8_t)c.in[2] << 8) | (uint8_t)c.in[3];
+      hdr = 4;
+    } else if (len == 127) {
+      if (c.in.size() < 10) return true;
+      len = 0;
+      for (int i = 0; i < 8; ++i)
+        len = (len << 8) | (uint8_t)c.in[2 + (size_t)i];
+      hdr = 10;
+    }
+    if (len > kMaxPayload)
+      return false;
+
+    if (c.in.size() < hdr + 4 + len)
+      return true;
+
+    const uint8_t* mask = (const uint8_t*)c.in.data() + hdr;
+    std::string payload(c.in.data() + hdr + 4, (size_t)len);
+    for (size_t i = 0; i < payload.size(); ++i)
+      payload[i] = (char)(payload[i] ^ mask[i % 4]);
+    c.in.erase(0, hdr + 4 + (size_t)len);
+
+    if (opcode == 0x8) {        // close: echo and hang up
+      enqueue(c, std::make_shared<const std::string>(ws_frame(0x8, payload.substr(0, 2))));
+      c.close_after_flush = true;
+      return true;
+    }
+    if (opcode == 0x9)          // ping
+      enqueue(c, std::make_shared<const std::string>(ws_frame(0xA, payload)));
+    else if (opcode == 0x1 && c.moderation && (b0 & 0x80))
+      commands.push_back(std::move(payload));
+  }
+}
+
+} // namespace
+
+void EventFeedServer::run()
+{
+  Impl& im = *impl_;
+  std::vector<Ready> ready;
+  std::vector<socket_t> drop;
+  std::vector<std::string> commands;
+
+  auto close_client = [&](socket_t fd) {
+    im.unwatch(fd);
+    close_socket(fd);
+    im.clients.erase(fd);
+  };
+
+  while (running_.load()) {
+    ready.clear();
+    im.wait(1000, ready);
+    drop.clear();
+    commands.clear();
+
+    for (const Ready& r : ready) {
+      if (im.is_wake(r.fd)) {
+        im.drain_wake();
+        continue;
+      }
+
+      if (r.fd == im.listener) {
+        for (;;) {
+          socket_t cfd = accept(im.listener, nullptr, nullptr);
+          if (cfd == kBadSocket)
+            break;
+          if (im.clients.size() >= kMaxClients) {
+            close_socket(cfd);
+            continue;
+          }
+
+          set_nonblocking(cfd);
+          int one = 1;
+          setsockopt(cfd, IPPROTO_TCP, TCP_NODELAY, (const char*)&one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+          setsockopt(cfd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+          Client& c = im.clients[cfd];
+          c.fd = cfd;
+          im.watch(cfd, false);
+        }
+        continue;
+      }
+
+      auto it = im.clients.find(r.fd);
+      if (it == im.clients.end())
+        continue;
+      Client& c = it->second;
+
+      if (r.readable) {
+        char buf[4096];
+        bool ok = true;
+        for (;;) {
+          const auto n = recv(c.fd, buf, sizeof(buf), 0);
+          if (n > 0) {
+            c.in.append(buf, (size_t)n);
+            if (c.in.size() > 128 * 1024) { ok = false; break; }
+            continue;
+          }
+          if (n == 0 || !would_block())
+            ok = false; // peer closed or hard error
+          break;
+        }
+
+        if (ok && !c.close_after_flush)
+          ok = c.upgraded ? handle_frames(c, commands) : handle_handshake(c, port_);
+
+        if (!ok) {
+          drop.push_back(c.fd);
+          continue;
+        }
+      }
+
+      if (!flush_client(c))
+        drop.push_back(c.fd);
+    }
+
+    if (!commands.empty()) {
+      std::lock_guard<std::mutex> lk(handlers_mutex_);
+      for (const std::string& cmd : commands)
+        for (auto& [token, handler] : handlers_)
+          handler(cmd);
+    }
+
+    // fan out new events: one shared buffer, a reference per client
+    std::vector<Outgoing> frames;
+    std::vector<Frame> snapshot;
+    bool want_snapshot = false;
+    for (const auto& [fd, c] : im.clients)
+      want_snapshot |= c.needs_snapshot;
+    {
+      std::lock_guard<std::mutex> lk(inbox_mutex_);
+      frames.swap(inbox_);
+      if (want_snapshot)
+        for (const auto& [id, f] : pending_)
+          snapshot.push_back(f);
+    }
+
+    for (auto& [fd, c] : im.clients) {
+      const bool fresh = c.needs_snapshot;
+      if (fresh) {
+        // taken with this round's inbox, so it already reflects those changes
+        c.needs_snapshot = false;
+        for (const Frame& f : snapshot)
+          enqueue(c, f);
+      }
+
+      if ((fresh || !frames.empty()) && c.upgraded && !c.close_after_flush) {
+        for (const Outgoing& o : frames)
+          if (o.moderation == c.moderation && !(fresh && o.moderation))
+            enqueue(c, o.frame);
+
+        if (c.out_bytes > kMaxClientBacklog) {
+          evicted_++;
+          drop.push_back(fd);
+          continue;
+        }
+        if (!flush_client(c)) {
+          drop.push_back(fd);
+          continue;
+        }
+      }
+
+      if (c.out.empty() && c.close_after_flush) {
+        drop.push_back(fd);
+        continue;
+      }
+
+      const bool want_write = !c.out.empty();
+      if (want_write != c.want_write) {
+        c.want_write = want_write;
+        im.rewatch(fd, want_write);
+      }
+    }
+
+    std::sort(drop.begin(), drop.end());
+    drop.erase(std::unique(drop.begin(), drop.end()), drop.end());
+    for (socket_t fd : drop)
+      close_client(fd);
+
+    size_t upgraded = 0, docks = 0;
+    for (const auto& [fd, c] : im.clients) {
+      upgraded += c.upgraded ? 1 : 0;
+      docks += c.moderation ? 1 : 0;
+    }
+    clients_.store(upgraded);
+    docks_.store(docks);
+  }
+}
+
+// ------------------------------------------------------------
+// Process-wide registry
+// ------------------------------------------------------------
+std::shared_ptr<EventFeedServer> acquire_event_feed(uint16_t port, std::string& error)
+{
+  static std::mutex mutex;
+  static std::map<uint16_t, std::weak_ptr<EventFeedServer>> servers;
+
+  std::lock_guard<std::mutex> lk(mutex);
+
+  if (auto existing = servers[port].lock())
+    return existing;
+
+  auto server = std::make_shared<EventFeedServer>();
+  if (!server->start(port, error))
+    return nullptr;
+
+  servers[port] = server;
+  return server;
+}
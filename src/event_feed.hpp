@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "approval_queue.hpp"
+#include "event_ingest.hpp"
+#include "event_parse.hpp"
+
+// Compact JSON for overlays:
+// {"type":"tip","user":"..","amount":"12.500","amount_milli":12500,
+//  "symbol":"TWICH","message":"..","ts":..,"id":"<dedupe hash hex>"}
+std::string event_to_feed_json(const TipEvent& ev);
+
+// Moderation channel messages:
+// {"type":"pending","id":"<hex>","kind":"tip","user":..,"amount":..,
+//  "symbol":..,"message":..,"expires":<epoch ms, 0 = never>}
+// {"type":"resolved","id":"<hex>","outcome":"approved|rejected|expired"}
+std::string pending_to_feed_json(uint64_t id, const ApprovalQueue::Held& h, long long expires_ms);
+std::string resolved_to_feed_json(uint64_t id, const char* outcome);
+
+struct EventFeedStats {
+  size_t   clients = 0;   // upgraded WebSocket connections
+  size_t   docks = 0;     // of which on the moderation channel
+  uint64_t broadcast = 0; // events sent
+  uint64_t evicted = 0;   // clients dropped for falling behind
+};
+
+// Localhost WebSocket feed of parsed events for browser-source overlays.
+//
+// One I/O thread multiplexes every socket (epoll on Linux, poll/WSAPoll
+// elsewhere). Each event is framed once into a shared, immutable buffer;
+// every client's send queue holds a reference to it and writes it with a
+// gathered send, so N clients cost N references, not N copies. A client
+// whose queue grows past kMaxClientBacklog is disconnected instead of
+// holding memory for an overlay that stopped reading.
+//
+// Plain HTTP GET (no Upgrade) answers with a one-line status, so the port
+// can be checked from a browser; ws://127.0.0.1:<port>/ is the feed.
+//
+// /pending is the moderation channel: GET serves a small page meant for an
+// OBS custom browser dock, whose WebSocket gets every held event on connect
+// and then only the changes, and sends approve/reject commands back. It
+// only accepts connections from that page's own origin (or from clients
+// that send none), so an arbitrary web page cannot read or approve held
+// events.
+class EventFeedServer {
+public:
+  static constexpr size_t kMaxClients = 64;
+  static constexpr size_t kMaxClientBacklog = 256 * 1024; // queued bytes per client
+
+  EventFeedServer() = default;
+  ~EventFeedServer();
+
+  EventFeedServer(const EventFeedServer&) = delete;
+  EventFeedServer& operator=(const EventFeedServer&) = delete;
+
+  // Binds 127.0.0.1:port and starts the I/O thread
+  bool start(uint16_t port, std::string& error);
+  void stop();
+
+  uint16_t port() const { return port_; }
+
+  // Thread-safe. Repeats of the same dedupe hash are dropped, so several
+  // sources sharing one server broadcast each bot message once.
+  void broadcast(const TipEvent& ev);
+
+  // Moderation channel, thread-safe. A published entry is replayed to docks
+  // that connect later, until it is resolved.
+  void publish_pending(uint64_t id, std::string json);
+  void resolve_pending(uint64_t id, std::string json);
+
+  // Text messages from docks, run on the I/O thread. Every handler sees
+  // every command; ids are process-unique, so each source picks its own.
+  using CommandHandler = std::function<void(const std::string& json)>;
+  uint64_t add_command_handler(CommandHandler handler);
+  void remove_command_handler(uint64_t token); // waits out a running call
+
+  EventFeedStats stats() const;
+
+  // opaque platform state (sockets, poller, wake-up handle)
+  struct Impl;
+
+private:
+  void run();
+
+  std::unique_ptr<Impl> impl_;
+  std::thread thr_;
+  std::atomic<bool> running_{false};
+  uint16_t port_ = 0;
+
+  struct Outgoing {
+    std::shared_ptr<const std::string> frame;
+    bool moderation;
+  };
+
+  // producer side (any thread) -> I/O thread
+  mutable std::mutex inbox_mutex_;
+  std::vector<Outgoing> inbox_;
+  std::map<uint64_t, std::shared_ptr<const std::string>> pending_; // replayed to new docks
+  DedupeWindow dedupe_;
+
+  std::mutex handlers_mutex_;
+  std::map<uint64_t, CommandHandler> handlers_;
+  uint64_t next_handler_ = 1;
+
+  std::atomic<size_t> clients_{0};
+  std::atomic<size_t> docks_{0};
+  std::atomic<uint64_t> broadcast_{0};
+  std::atomic<uint64_t> evicted_{0};
+};
+
+// Process-wide server for `port`, shared by every source that enables the
+// feed; stops when the last reference goes away. nullptr (with error) if
+// the port cannot be bound.
+std::shared_ptr<EventFeedServer> acquire_event_feed(uint16_t port, std::string& error);
@@ -0,0 +1,89 @@
+#include "event_ingest.hpp"
+
+#include <utility>
+
+using nlohmann::json;
+
+bool text_from_tdlib_update(const json& update, long long& chat_id, std::string& text)
+{
+  try {
+    if (update.value("@type", "") != "updateNewMessage")
+      return false;
+
+    const json& msg = update.at("message");
+    const json& content = msg.at("content");
+    if (content.value("@type", "") != "messageText")
+      return false;
+
+    chat_id = msg.at("chat_id").get<long long>();
+    text = content.at("text").at("text").get<std::string>();
+    return true;
+  } catch (...) {
+    return false;
+  }
+}
+
+bool DedupeWindow::admit(uint64_t hash)
+{
+  if (seen_.count(hash))
+    return false;
+
+  if (ring_.size() < kCapacity) {
+    ring_.push_back(hash);
+  } else {
+    seen_.erase(ring_[next_]);
+    ring_[next_] = hash;
+    next_ = (next_ + 1) % kCapacity;
+  }
+
+  seen_.insert(hash);
+  return true;
+}
+
+void DedupeWindow::clear()
+{
+  seen_.clear();
+  ring_.clear();
+  next_ = 0;
+}
+
+IngestResult ingest_message(const std::string& text, DedupeWindow& dedupe, TipEventQueue& queue,
+                            TipEvent* parsed, const ModerationStage* moderation, ApprovalQueue* held,
+                            const char* account)
+{
+  auto ev = parse_tip_event_from_message(text);
+  if (!ev)
+    return IngestResult::NotEvent;
+  ev->account = account;
+
+  const ModerationVerdict verdict = moderation ? moderation->apply(*ev) : ModerationVerdict::Clean;
+
+  if (parsed) {
+    // copy for the caller's log line; the queue takes the original
+    parsed->kind = ev->kind;
+    parsed->amount_milli = ev->amount_milli;
+    parsed->ts_ms = ev->ts_ms;
+    parsed->dedupe_hash = ev->dedupe_hash;
+    parsed->symbol = ev->symbol;
+    parsed->account = ev->account;
+    parsed->set_text(ev->from_username(), ev->amount_str(), ev->message());
+  }
+
+  if (!dedupe.admit(ev->dedupe_hash))
+    return IngestResult::Duplicate;
+
+  if (verdict == ModerationVerdict::Drop)
+    return IngestResult::Blocked;
+
+  if (verdict == ModerationVerdict::Hold || verdict == ModerationVerdict::Review) {
+    if (held) {
+      // only events that passed the word list may time out into the queue
+      held->push(std::move(*ev), verdict == ModerationVerdict::Review);
+      return IngestResult::Held;
+    }
+    if (verdict == ModerationVerdict::Hold)
+      return IngestResult::Blocked;
+  }
+
+  return queue.push(std::move(*ev)) ? IngestResult::Queued : IngestResult::Dropped;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "approval_queue.hpp"
+#include "event_queue.hpp"
+#include "moderation.hpp"
+#include "nlohmann_json.hpp"
+
+// Text of a TDLib updateNewMessage carrying messageText; false for anything else.
+// Shared by the live TDLib loop and the capture replayer.
+bool text_from_tdlib_update(const nlohmann::json& update, long long& chat_id, std::string& text);
+
+// Remembers the dedupe hashes of the last kCapacity accepted events, so a
+// bot message delivered twice (reconnect, TDLib resync) plays once.
+class DedupeWindow {
+public:
+  static constexpr size_t kCapacity = 1024;
+
+  // True if the hash is new (and records it); false for a repeat
+  bool admit(uint64_t hash);
+
+  void clear();
+
+private:
+  std::unordered_set<uint64_t> seen_;
+  std::vector<uint64_t> ring_; // insertion order, for eviction
+  size_t next_ = 0;
+};
+
+enum class IngestResult {
+  NotEvent,  // not a "#EVENT {...}" message or unknown type/token
+  Duplicate, // dedupe hash seen recently
+  Queued,    // (possibly with masked words)
+  Dropped,   // rejected by the queue's overflow policy
+  Blocked,   // word list hit, policy Drop
+  Held,      // parked in the approval queue (word list hit or hold-all)
+};
+
+// Bot message -> parse -> moderate -> dedupe -> queue. The one path every
+// event takes, live or replayed. Not thread-safe with respect to `dedupe`.
+// `parsed`, if given, receives a copy of the decoded event after moderation
+// (masked text included). Without `held`, the Hold policy drops and
+// hold-all mode has no effect. `account` (interned, see intern_symbol)
+// tags the event with the Telegram account it arrived on.
+IngestResult ingest_message(const std::string& text, DedupeWindow& dedupe, TipEventQueue& queue,
+                            TipEvent* parsed = nullptr,
+                            const ModerationStage* moderation = nullptr,
+                            ApprovalQueue* held = nullptr,
+                            const char* account = "");
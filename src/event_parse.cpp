@@ -1,12 +1,91 @@
 #include "event_parse.hpp"
 #include <string>
 #include <cctype>
+#include <cstring>
+#include <mutex>
+#include <unordered_set>
 #include <sstream>
 #include <iomanip>
 #include "nlohmann_json.hpp" // external/nlohmann_json.hpp
 
 using nlohmann::json;
 
+// ---- TipEvent arena ----
+TipEvent::~TipEvent() {
+  delete[] heap_;
+}
+
+TipEvent::TipEvent(TipEvent&& o) noexcept {
+  *this = std::move(o);
+}
+
+TipEvent& TipEvent::operator=(TipEvent&& o) noexcept {
+  if (this == &o) return *this;
+
+  delete[] heap_;
+
+  kind         = o.kind;
+  amount_milli = o.amount_milli;
+  ts_ms        = o.ts_ms;
+  dedupe_hash  = o.dedupe_hash;
+  symbol       = o.symbol;
+  account      = o.account;
+
+  heap_        = o.heap_;
+  off_amount_  = o.off_amount_;
+  off_message_ = o.off_message_;
+  end_         = o.end_;
+  if (!heap_) std::memcpy(inline_, o.inline_, end_);
+
+  o.heap_ = nullptr;
+  o.off_amount_ = o.off_message_ = o.end_ = 0;
+  return *this;
+}
+
+void TipEvent::set_text(std::string_view from_username,
+                        std::string_view amount_str,
+                        std::string_view message) {
+  // Offsets are 16-bit; clamp so the whole block stays addressable.
+  const size_t cap = 0xFFFF;
+  if (amount_str.size() > cap) amount_str = amount_str.substr(0, cap);
+  if (message.size() > cap - amount_str.size()) message = message.substr(0, cap - amount_str.size());
+  if (from_username.size() > cap - amount_str.size() - message.size())
+    from_username = from_username.substr(0, cap - amount_str.size() - message.size());
+
+  const size_t total = from_username.size() + amount_str.size() + message.size();
+
+  delete[] heap_;
+  heap_ = (total > kInlineCap) ? new char[total] : nullptr;
+
+  char* dst = heap_ ? heap_ : inline_;
+  std::memcpy(dst, from_username.data(), from_username.size());
+  std::memcpy(dst + from_username.size(), amount_str.data(), amount_str.size());
+  std::memcpy(dst + from_username.size() + amount_str.size(), message.data(), message.size());
+
+  off_amount_  = (uint16_t)from_username.size();
+  off_message_ = (uint16_t)(off_amount_ + amount_str.size());
+  end_         = (uint16_t)total;
+}
+
+void utf8_truncate(std::string& s, size_t max_bytes) {
+  if (s.size() <= max_bytes) return;
+
+  // back up over continuation bytes to the start of the cut code point
+  size_t n = max_bytes;
+  while (n > 0 && ((unsigned char)s[n] & 0xC0) == 0x80) --n;
+  s.resize(n);
+}
+
+const char* intern_symbol(std::string_view symbol) {
+  // node-based set: element addresses never move
+  static std::mutex mtx;
+  static std::unordered_set<std::string> pool;
+
+  std::lock_guard<std::mutex> lk(mtx);
+  auto it = pool.emplace(symbol).first;
+  return it->c_str();
+}
+
 static std::optional<std::string> extract_event_json(const std::string& text) {
   auto p = text.find("#EVENT");
   if (p == std::string::npos) return std::nullopt;
@@ -28,26 +107,52 @@ static std::optional<std::string> extract_event_json(const std::string& text) {
   return std::nullopt;
 }
 
-static std::string format_amount_9dp(const std::string& amount_twits_str) {
-  // amount_twits is integer string. TWICH assumed 9 decimals.
-  // Display 3 decimals by default.
-  long long v = 0;
-  try { v = std::stoll(amount_twits_str); } catch (...) { return "0.000"; }
+// Raw integer amount with `decimals` decimals -> fixed point with `precision`
+// decimals, rounded half away from zero.
+static long long units_to_fixed(long long v, int decimals, int precision) {
+  if (decimals <= precision) {
+    for (int i = decimals; i < precision; ++i) v *= 10;
+    return v;
+  }
+
+  long long step = 1;
+  for (int i = precision; i < decimals; ++i) step *= 10;
 
-  const long long denom = 1000000000LL;
-  long long whole = v / denom;
-  long long frac  = llabs(v % denom);
+  const long long q = llabs(v) / step;
+  const long long r = llabs(v) % step;
+  const long long out = q + (r >= (step + 1) / 2 ? 1 : 0);
+  return v < 0 ? -out : out;
+}
+
+static std::string format_fixed(long long v, int precision) {
+  long long denom = 1;
+  for (int i = 0; i < precision; ++i) denom *= 10;
 
-  // Convert to 3 decimals (rounded)
-  // frac is 0..999,999,999; take first 3 decimals with rounding from 4th decimal
-  long long frac3 = (frac + 500000LL) / 1000000LL; // +0.0005 for rounding at 4th digit
-  if (frac3 >= 1000) { whole += 1; frac3 -= 1000; }
+  const long long a = llabs(v);
 
   std::ostringstream oss;
-  oss << whole << "." << std::setw(3) << std::setfill('0') << frac3;
+  if (v < 0) oss << "-";
+  oss << (a / denom);
+  if (precision > 0)
+    oss << "." << std::setw(precision) << std::setfill('0') << (a % denom);
   return oss.str();
 }
 
+std::string format_amount_milli(long long amount_milli, int precision) {
+  if (precision < 0) precision = 0;
+  if (precision > 3) precision = 3;
+  return format_fixed(units_to_fixed(amount_milli, 3, precision), precision);
+}
+
+// Amount fields may arrive as JSON strings (big integers) or numbers.
+static std::string json_amount_string(const json& j, const char* key) {
+  if (!key || !j.contains(key)) return "0";
+  const auto& v = j[key];
+  if (v.is_string()) return v.get<std::string>();
+  if (v.is_number_integer()) return std::to_string(v.get<long long>());
+  return "0";
+}
+
 std::optional<TipEvent> parse_tip_event_from_message(const std::string& text) {
   auto jtxt = extract_event_json(text);
   if (!jtxt) return std::nullopt;
@@ -56,24 +161,53 @@ std::optional<TipEvent> parse_tip_event_from_message(const std::string& text) {
   try { j = json::parse(*jtxt); }
   catch (...) { return std::nullopt; }
 
-  if (!j.contains("type") || j["type"].get<std::string>() != "TWICH_TIP")
+  if (!j.is_object() || !j.contains("type") || !j["type"].is_string())
     return std::nullopt;
 
+  const EventTypeDescriptor* desc = find_event_type(j["type"].get<std::string>());
+  if (!desc) return std::nullopt;
+
+  // a symbol that is not a string is as unknown as an unregistered one
+  const TokenDescriptor* token = nullptr;
+  if (desc->token != kTokenFromField)
+    token = &kTokens[desc->token];
+  else if (j.contains("symbol") && j["symbol"].is_string())
+    token = find_token(j["symbol"].get<std::string>());
+  if (!token) return std::nullopt; // unregistered token
+
+  std::string from_username;
+  std::string message;
+
   TipEvent ev;
-  ev.symbol = "TWICH";
+  ev.kind = desc->kind;
+  ev.symbol = token->symbol;
+
+  try {
+    if (j.contains("from_username")) from_username = j["from_username"].get<std::string>();
+    if (j.contains("message")) message = j["message"].get<std::string>();
+    if (j.contains("ts")) ev.ts_ms = j["ts"].get<long long>();
+  } catch (...) {
+    return std::nullopt;
+  }
 
-  if (j.contains("from_username")) ev.from_username = j["from_username"].get<std::string>();
-  if (j.contains("message")) ev.message = j["message"].get<std::string>();
-  if (j.contains("ts")) ev.ts_ms = j["ts"].get<long long>();
+  const std::string amount_raw = json_amount_string(j, desc->amount_key);
+  long long units = 0;
+  try { units = std::stoll(amount_raw); } catch (...) { units = 0; }
 
-  std::string amount_twits = j.value("amount_twits", "0");
-  ev.amount_str = format_amount_9dp(amount_twits);
+  ev.amount_milli = units_to_fixed(units, token->decimals, 3);
 
-  // Dedupe key: ts + from + amount (good enough; better if you add event_id)
-  ev.dedupe_key = std::to_string(ev.ts_ms) + "|" + ev.from_username + "|" + amount_twits;
+  // Dedupe hash: type + ts + from + amount (good enough; better if you add event_id)
+  uint64_t h = fnv1a_64(desc->type);
+  h = fnv1a_64(std::to_string(ev.ts_ms), h);
+  h = fnv1a_64("|", h);
+  h = fnv1a_64(from_username, h);
+  h = fnv1a_64("|", h);
+  ev.dedupe_hash = fnv1a_64(amount_raw, h);
 
   // Truncate message for overlay sanity
-  if (ev.message.size() > 140) ev.message.resize(140);
+  utf8_truncate(message, 140);
 
+  const int prec = token->display_precision;
+  ev.set_text(from_username, format_fixed(units_to_fixed(units, token->decimals, prec), prec), message);
   return ev;
 }
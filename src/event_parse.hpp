@@ -1,14 +1,66 @@
 #pragma once
-#include <string>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <string>
+#include <string_view>
 
+#include "event_types.hpp"
+
+// Compact tip event.
+// The three variable-length fields (user, amount text, message) share one
+// arena block addressed by offsets; short events fit the inline buffer and
+// never touch the heap. symbol points at an interned, never-freed string.
+// Move-only: events travel producer -> queue -> tick without copies.
 struct TipEvent {
-  std::string from_username;
-  std::string amount_str;   // display formatted e.g. "0.200"
-  std::string symbol;       // "TWICH"
-  std::string message;
+  static constexpr size_t kInlineCap = 64;
+
+  EventKind   kind = EventKind::Tip;
+  long long   amount_milli = 0;  // amount in thousandths (fixed point)
   long long   ts_ms = 0;
-  std::string dedupe_key;
+  uint64_t    dedupe_hash = 0;   // FNV-1a of ts|from|raw amount
+  const char* symbol = "";       // registry or interned string, e.g. "TWICH"
+  const char* account = "";      // interned Telegram account name, "" = not tagged
+
+  TipEvent() = default;
+  ~TipEvent();
+
+  TipEvent(TipEvent&& o) noexcept;
+  TipEvent& operator=(TipEvent&& o) noexcept;
+
+  TipEvent(const TipEvent&) = delete;
+  TipEvent& operator=(const TipEvent&) = delete;
+
+  // Replaces all three text fields with one arena write.
+  void set_text(std::string_view from_username,
+                std::string_view amount_str,
+                std::string_view message);
+
+  std::string_view from_username() const { return {data(), off_amount_}; }
+  std::string_view amount_str() const { return {data() + off_amount_, (size_t)(off_message_ - off_amount_)}; }
+  std::string_view message() const { return {data() + off_message_, (size_t)(end_ - off_message_)}; }
+
+  // Heap bytes owned by this event (0 when the inline buffer is used)
+  size_t heap_bytes() const { return heap_ ? end_ : 0; }
+
+private:
+  const char* data() const { return heap_ ? heap_ : inline_; }
+
+  char*    heap_ = nullptr;
+  uint16_t off_amount_ = 0;   // user is [0, off_amount_)
+  uint16_t off_message_ = 0;  // amount is [off_amount_, off_message_)
+  uint16_t end_ = 0;          // message is [off_message_, end_)
+  char     inline_[kInlineCap];
 };
 
+// Interned symbol storage; returned pointers stay valid for the process lifetime.
+const char* intern_symbol(std::string_view symbol);
+
+// Fixed-point thousandths -> "12.500" (precision 0..3 decimals)
+std::string format_amount_milli(long long amount_milli, int precision = 3);
+
+// Cuts `s` to at most `max_bytes` without splitting a UTF-8 sequence
+void utf8_truncate(std::string& s, size_t max_bytes);
+
+// Decodes any registered "#EVENT {...}" type (see event_types.hpp)
 std::optional<TipEvent> parse_tip_event_from_message(const std::string& text);
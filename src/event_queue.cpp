@@ -0,0 +1,359 @@
+#include "event_queue.hpp"
+
+#include <cstdio>
+#include <utility>
+
+#include "nlohmann_json.hpp"
+
+using nlohmann::json;
+
+size_t tip_event_bytes(const TipEvent& ev)
+{
+  return sizeof(TipEvent) + ev.heap_bytes();
+}
+
+static json event_to_json(const TipEvent& ev)
+{
+  return json{
+    {"from_username", ev.from_username()},
+    {"amount_str", ev.amount_str()},
+    {"kind", (int)ev.kind},
+    {"amount_milli", ev.amount_milli},
+    {"symbol", ev.symbol},
+    {"account", ev.account},
+    {"message", ev.message()},
+    {"ts", ev.ts_ms},
+    {"dedupe_hash", ev.dedupe_hash},
+  };
+}
+
+static bool event_from_json(const std::string& line, TipEvent& ev)
+{
+  try {
+    json j = json::parse(line);
+    ev.set_text(j.value("from_username", ""),
+                j.value("amount_str", ""),
+                j.value("message", ""));
+    ev.kind         = (EventKind)j.value("kind", 0);
+    ev.amount_milli = j.value("amount_milli", 0LL);
+    const std::string sym = j.value("symbol", "");
+    const TokenDescriptor* token = find_token(sym);
+    ev.symbol       = token ? token->symbol : intern_symbol(sym);
+    ev.account      = intern_symbol(j.value("account", ""));
+    ev.ts_ms        = j.value("ts", 0LL);
+    ev.dedupe_hash  = j.value("dedupe_hash", 0ULL);
+    return true;
+  } catch (...) {
+    return false;
+  }
+}
+
+TipEventQueue::~TipEventQueue()
+{
+  std::lock_guard<std::mutex> jl(journal_mutex_);
+  reset_journal();
+}
+
+void TipEventQueue::configure(size_t budget_bytes, OverflowPolicy policy, const std::string& journal_path)
+{
+  std::lock_guard<std::mutex> jl(journal_mutex_);
+
+  bool switch_journal = false;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    budget_ = budget_bytes;
+    policy_ = policy;
+
+    // Moving the journal would lose spilled events; only switch when it is empty.
+    switch_journal = journal_path != journal_path_ && journal_pending_ == 0;
+  }
+
+  if (switch_journal) {
+    reset_journal();
+    journal_path_ = journal_path;
+    recover_journal();
+  }
+
+  // Budget may have grown: pull spilled events back in.
+  refill();
+}
+
+bool TipEventQueue::fits_locked(size_t ev_bytes) const
+{
+  // Always allow one event so a tiny budget never wedges the pipeline.
+  return events_.empty() || bytes_ + ev_bytes <= budget_;
+}
+
+void TipEventQueue::push_locked(TipEvent&& ev, size_t ev_bytes)
+{
+  bytes_ += ev_bytes;
+  events_.push_back(std::move(ev));
+}
+
+bool TipEventQueue::push(TipEvent ev)
+{
+  const size_t ev_bytes = tip_event_bytes(ev);
+
+  // Producer side: may wait for a journal read, never the other way round
+  std::lock_guard<std::mutex> jl(journal_mutex_);
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+
+    // Once spilling, keep FIFO order: everything goes to the journal until it drains.
+    if (journal_pending_ == 0 && fits_locked(ev_bytes)) {
+      push_locked(std::move(ev), ev_bytes);
+      pending_.store(true, std::memory_order_release);
+      return true;
+    }
+
+    if (policy_ == OverflowPolicy::Summarize) {
+      summarize_locked(ev);
+      pending_.store(true, std::memory_order_release);
+      return true;
+    }
+
+    if (policy_ == OverflowPolicy::Reject) {
+      rejected_++;
+      return false;
+    }
+  }
+
+  const bool ok = spill(ev);
+
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (!ok) {
+    rejected_++;
+    return false;
+  }
+  journal_pending_++;
+  spilled_++;
+  pending_.store(true, std::memory_order_release);
+  return true;
+}
+
+bool TipEventQueue::pop(TipEvent& out)
+{
+  auto take_front_locked = [&] {
+    out = std::move(events_.front());
+    events_.pop_front();
+    const size_t ev_bytes = tip_event_bytes(out);
+    bytes_ = (bytes_ > ev_bytes) ? bytes_ - ev_bytes : 0;
+  };
+
+  bool got = false;
+  bool journal = false;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (!events_.empty()) {
+      take_front_locked();
+      got = true;
+    } else if (journal_pending_ == 0 && take_summary_locked(out)) {
+      got = true;
+    }
+
+    journal = journal_pending_ > 0;
+    if (!got && !journal)
+      pending_.store(false, std::memory_order_relaxed);
+  }
+
+  if (!journal)
+    return got;
+
+  // Read back outside the queue lock; if a producer is writing the
+  // journal right now, try again next frame instead of waiting.
+  std::unique_lock<std::mutex> jl(journal_mutex_, std::try_to_lock);
+  if (jl.owns_lock())
+    refill();
+
+  if (!got) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (!events_.empty()) {
+      take_front_locked();
+      got = true;
+    }
+  }
+  return got;
+}
+
+QueueStats TipEventQueue::stats() const
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+
+  QueueStats st;
+  st.depth = events_.size();
+  st.bytes = bytes_;
+  st.budget = budget_;
+  st.rejected = rejected_;
+  st.summarized = summarized_;
+  st.spilled = spilled_;
+  st.spill_pending = journal_pending_;
+  st.recovered = recovered_;
+  return st;
+}
+
+void TipEventQueue::clear()
+{
+  std::lock_guard<std::mutex> jl(journal_mutex_);
+  reset_journal();
+
+  std::lock_guard<std::mutex> lk(mutex_);
+  events_.clear();
+  bytes_ = 0;
+  summaries_.clear();
+  pending_.store(false, std::memory_order_relaxed);
+}
+
+// ---- Summarize ----
+void TipEventQueue::summarize_locked(const TipEvent& ev)
+{
+  // One running summary per (kind, symbol, account) so amounts never mix
+  // tokens or creators
+  for (auto& sm : summaries_) {
+    if (sm.kind == ev.kind && sm.symbol == ev.symbol && sm.account == ev.account) {
+      sm.count++;
+      sm.amount_milli += ev.amount_milli;
+      summarized_++;
+      return;
+    }
+  }
+
+  Summary sm;
+  sm.kind = ev.kind;
+  sm.symbol = ev.symbol;
+  sm.account = ev.account;
+  sm.count = 1;
+  sm.amount_milli = ev.amount_milli;
+  summaries_.push_back(sm);
+  summarized_++;
+}
+
+bool TipEventQueue::take_summary_locked(TipEvent& out)
+{
+  if (summaries_.empty())
+    return false;
+
+  const Summary sm = summaries_.front();
+  summaries_.erase(summaries_.begin());
+
+  const TokenDescriptor* token = find_token(sm.symbol);
+
+  out = TipEvent();
+  out.set_text(std::to_string(sm.count) + " more viewers",
+               format_amount_milli(sm.amount_milli, token ? token->display_precision : 3),
+               "");
+  out.kind = sm.kind;
+  out.amount_milli = sm.amount_milli;
+  out.symbol = sm.symbol;
+  out.account = sm.account;
+  out.dedupe_hash = fnv1a_64("summary|" + std::to_string(summarized_));
+  return true;
+}
+
+// ---- Spill journal ----
+bool TipEventQueue::spill(const TipEvent& ev)
+{
+  if (journal_path_.empty())
+    return false;
+
+  if (!journal_.is_open()) {
+    journal_.open(journal_path_, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+    journal_read_pos_ = 0;
+    if (!journal_.is_open())
+      return false;
+  }
+
+  journal_.clear();
+  journal_.seekp(0, std::ios::end);
+  journal_ << event_to_json(ev).dump() << '\n';
+  journal_.flush();
+  return journal_.good();
+}
+
+void TipEventQueue::refill()
+{
+  for (;;) {
+    if (!staged_) {
+      {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (journal_pending_ == 0)
+          break;
+      }
+
+      std::string line;
+      if (journal_.is_open()) {
+        journal_.clear();
+        journal_.seekg(journal_read_pos_);
+      }
+      if (!journal_.is_open() || !std::getline(journal_, line)) {
+        // Journal is shorter than our count says (disk error); give up on it.
+        reset_journal();
+        return;
+      }
+      journal_read_pos_ = journal_.tellg();
+
+      TipEvent ev;
+      if (!event_from_json(line, ev)) {
+        std::lock_guard<std::mutex> lk(mutex_);
+        journal_pending_--;
+        continue;
+      }
+      staged_.emplace(std::move(ev));
+    }
+
+    std::lock_guard<std::mutex> lk(mutex_);
+    const size_t ev_bytes = tip_event_bytes(*staged_);
+    if (!fits_locked(ev_bytes))
+      return;
+
+    journal_pending_--;
+    push_locked(std::move(*staged_), ev_bytes);
+    staged_.reset();
+    pending_.store(true, std::memory_order_release);
+  }
+
+  // Fully drained: truncate so the file does not grow forever.
+  if (journal_.is_open())
+    reset_journal();
+}
+
+void TipEventQueue::recover_journal()
+{
+  if (journal_path_.empty())
+    return;
+
+  journal_.open(journal_path_, std::ios::in | std::ios::out | std::ios::binary);
+  if (!journal_.is_open())
+    return;
+
+  uint64_t lines = 0;
+  std::string line;
+  while (std::getline(journal_, line))
+    lines++;
+
+  if (lines == 0) {
+    reset_journal();
+    return;
+  }
+
+  journal_read_pos_ = 0;
+
+  std::lock_guard<std::mutex> lk(mutex_);
+  journal_pending_ = lines;
+  recovered_ = lines;
+  pending_.store(true, std::memory_order_release);
+}
+
+void TipEventQueue::reset_journal()
+{
+  if (journal_.is_open())
+    journal_.close();
+
+  if (!journal_path_.empty())
+    std::remove(journal_path_.c_str());
+
+  journal_read_pos_ = 0;
+  staged_.reset();
+
+  std::lock_guard<std::mutex> lk(mutex_);
+  journal_pending_ = 0;
+}
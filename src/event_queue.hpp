@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "event_parse.hpp"
+
+// What to do with a new event when the queue is over its memory budget
+enum class OverflowPolicy : int {
+  Reject    = 0, // drop the new event
+  Summarize = 1, // fold it into one "N more viewers" event (per kind/token) played after the queue drains
+  Spill     = 2, // append it to an on-disk journal, reloaded as memory frees up
+};
+
+struct QueueStats {
+  size_t   depth = 0;          // events held in memory
+  size_t   bytes = 0;          // accounted bytes of those events
+  size_t   budget = 0;         // configured ceiling
+  uint64_t rejected = 0;
+  uint64_t summarized = 0;
+  uint64_t spilled = 0;
+  uint64_t spill_pending = 0;  // spilled events not yet reloaded
+  uint64_t recovered = 0;      // of those, found on disk from an earlier run
+};
+
+// Footprint of one queued event (struct + arena block)
+size_t tip_event_bytes(const TipEvent& ev);
+
+// Producer/consumer queue shared by the TDLib thread and the video tick.
+// All methods are thread-safe. Journal file I/O happens outside the queue
+// lock, and pop() never waits for it.
+class TipEventQueue {
+public:
+  TipEventQueue() = default;
+  ~TipEventQueue();
+
+  TipEventQueue(const TipEventQueue&) = delete;
+  TipEventQueue& operator=(const TipEventQueue&) = delete;
+
+  // journal_path is only used by OverflowPolicy::Spill. A journal left at
+  // that path by an earlier run (a crash) is picked up and replayed.
+  void configure(size_t budget_bytes, OverflowPolicy policy, const std::string& journal_path);
+
+  // Returns false if the event was rejected by the overflow policy
+  bool push(TipEvent ev);
+
+  // Pops the oldest event; the pending summary comes out once the queue is empty
+  bool pop(TipEvent& out);
+
+  // Lock-free check for the consumer's idle path: false means pop() would
+  // return false. Set by every accepted push, cleared by the pop that finds
+  // nothing left.
+  bool pending() const { return pending_.load(std::memory_order_acquire); }
+
+  QueueStats stats() const;
+
+  // Drop everything, including the spill journal
+  void clear();
+
+private:
+  bool fits_locked(size_t ev_bytes) const;
+  void push_locked(TipEvent&& ev, size_t ev_bytes);
+
+  void summarize_locked(const TipEvent& ev);
+  bool take_summary_locked(TipEvent& out);
+
+  // journal_mutex_ held (never mutex_)
+  bool spill(const TipEvent& ev);
+  void refill();
+  void recover_journal();
+  void reset_journal();
+
+  // Lock order: journal_mutex_, then mutex_
+  std::mutex journal_mutex_;
+  mutable std::mutex mutex_;
+  std::atomic<bool> pending_{false};
+  std::deque<TipEvent> events_;
+  size_t bytes_ = 0;
+
+  size_t budget_ = 256 * 1024;
+  OverflowPolicy policy_ = OverflowPolicy::Reject;
+
+  uint64_t rejected_ = 0;
+  uint64_t summarized_ = 0;
+  uint64_t spilled_ = 0;
+
+  // Summarize state
+  struct Summary {
+    EventKind   kind = EventKind::Tip;
+    const char* symbol = "";
+    const char* account = "";
+    uint64_t    count = 0;
+    long long   amount_milli = 0;
+  };
+  std::vector<Summary> summaries_;
+
+  // Spill journal (one JSON object per line)
+  uint64_t     journal_pending_ = 0;   // guarded by mutex_; includes staged_
+  uint64_t     recovered_ = 0;         // guarded by mutex_
+  std::string  journal_path_;          // the rest: journal_mutex_
+  std::fstream journal_;
+  std::streamoff journal_read_pos_ = 0;
+  std::optional<TipEvent> staged_;     // read back, waiting for room
+};
@@ -0,0 +1,422 @@
+#include "event_router.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <map>
+
+#include "nlohmann_json.hpp"
+
+using nlohmann::json;
+
+static constexpr const char* kKindNames[kEventKindCount] = {"tip", "follow", "sub"};
+static constexpr size_t kMaxWords = RouteTable::kMaxRules / 64;
+
+static std::string fold_ascii(std::string_view s)
+{
+  std::string out(s);
+  for (char& c : out) {
+    if (c >= 'A' && c <= 'Z')
+      c = (char)(c + 32);
+  }
+  return out;
+}
+
+static std::string strip_at(std::string s)
+{
+  if (!s.empty() && s[0] == '@')
+    s.erase(s.begin());
+  return s;
+}
+
+// ------------------------------------------------------------
+// routes.json
+// ------------------------------------------------------------
+static bool parse_names(const json& v, std::vector<std::string>& out)
+{
+  if (v.is_string()) {
+    out.push_back(v.get<std::string>());
+    return true;
+  }
+  if (!v.is_array())
+    return false;
+  for (const json& e : v) {
+    if (!e.is_string())
+      return false;
+    out.push_back(e.get<std::string>());
+  }
+  return true;
+}
+
+static bool parse_rule(const json& j, RouteRule& r, std::string& error)
+{
+  if (!j.is_object()) {
+    error = "not an object";
+    return false;
+  }
+
+  for (auto it = j.begin(); it != j.end(); ++it) {
+    const std::string& key = it.key();
+    const json& v = it.value();
+
+    if (key == "name") {
+      if (!v.is_string()) { error = "\"name\" must be a string"; return false; }
+      r.name = v.get<std::string>();
+    } else if (key == "type") {
+      std::vector<std::string> names;
+      if (!parse_names(v, names)) { error = "\"type\" must be a string or a list"; return false; }
+      r.kinds = 0;
+      for (const std::string& n : names) {
+        const auto* k = std::find(std::begin(kKindNames), std::end(kKindNames), n);
+        if (k == std::end(kKindNames)) { error = "unknown type \"" + n + "\" (tip, follow, sub)"; return false; }
+        r.kinds |= 1u << (k - std::begin(kKindNames));
+      }
+    } else if (key == "min" || key == "max") {
+      if (!v.is_number()) { error = "\"" + key + "\" must be a number"; return false; }
+      const long long milli = llround(v.get<double>() * 1000.0);
+      (key == "min" ? r.min_milli : r.max_milli) = milli;
+    } else if (key == "user") {
+      if (!v.is_string()) { error = "\"user\" must be a string"; return false; }
+      r.user = fold_ascii(strip_at(v.get<std::string>()));
+    } else if (key == "account") {
+      if (!v.is_string()) { error = "\"account\" must be a string"; return false; }
+      r.account = fold_ascii(v.get<std::string>());
+    } else if (key == "message_prefix") {
+      if (!v.is_string()) { error = "\"message_prefix\" must be a string"; return false; }
+      r.message_prefix = fold_ascii(v.get<std::string>());
+    } else if (key == "sources") {
+      if (!parse_names(v, r.sources)) { error = "\"sources\" must be a string or a list"; return false; }
+    } else if (key == "scene") {
+      if (!v.is_string()) { error = "\"scene\" must be a string"; return false; }
+      r.scene = v.get<std::string>();
+    } else if (key == "drop") {
+      if (!v.is_boolean()) { error = "\"drop\" must be true or false"; return false; }
+      r.drop = v.get<bool>();
+    } else if (key == "continue") {
+      if (!v.is_boolean()) { error = "\"continue\" must be true or false"; return false; }
+      r.cont = v.get<bool>();
+    } else {
+      error = "unknown key \"" + key + "\"";
+      return false;
+    }
+  }
+
+  if (r.kinds == 0) {
+    error = "\"type\" is empty";
+    return false;
+  }
+  if (r.min_milli >= r.max_milli) {
+    error = "\"min\" must be below \"max\"";
+    return false;
+  }
+  if (r.sources.empty() && r.scene.empty() && !r.drop) {
+    error = "needs \"sources\", \"scene\" or \"drop\"";
+    return false;
+  }
+  return true;
+}
+
+bool parse_route_set(const std::string& json_text, RouteSet& out, std::string& error)
+{
+  json j;
+  try {
+    j = json::parse(json_text);
+  } catch (const std::exception& e) {
+    error = std::string("not valid JSON: ") + e.what();
+    return false;
+  }
+
+  if (!j.is_object() || !j.contains("rules") || !j["rules"].is_array()) {
+    error = "expected {\"rules\": [...]}";
+    return false;
+  }
+
+  RouteSet set;
+  size_t index = 0;
+  for (const json& jr : j["rules"]) {
+    ++index;
+    RouteRule r;
+    std::string why;
+    if (!parse_rule(jr, r, why)) {
+      error = "rule " + std::to_string(index);
+      if (jr.is_object() && jr.contains("name") && jr["name"].is_string())
+        error += " (" + jr["name"].get<std::string>() + ")";
+      error += ": " + why;
+      return false;
+    }
+    if (r.name.empty())
+      r.name = "rule " + std::to_string(index);
+    set.rules.push_back(std::move(r));
+  }
+
+  if (j.contains("fallback")) {
+    if (!parse_names(j["fallback"], set.fallback)) {
+      error = "\"fallback\" must be a string or a list";
+      return false;
+    }
+    set.has_fallback = true;
+  }
+
+  out = std::move(set);
+  error.clear();
+  return true;
+}
+
+// ------------------------------------------------------------
+// Compilation
+// ------------------------------------------------------------
+static void set_bit(uint64_t* bits, size_t i)
+{
+  bits[i / 64] |= 1ull << (i % 64);
+}
+
+// Per-name bitsets for one text field: rules without the condition go to
+// `any`, the others to the set of their name
+template <class Index>
+static bool index_names(const std::vector<RouteRule>& rules, std::string RouteRule::*field, size_t words,
+                        std::vector<uint64_t>& any, Index& offsets, std::vector<uint64_t>& bits)
+{
+  any.assign(words, 0);
+  bool used = false;
+  for (size_t i = 0; i < rules.size(); ++i) {
+    const std::string& name = rules[i].*field;
+    if (name.empty()) {
+      set_bit(any.data(), i);
+      continue;
+    }
+    used = true;
+    auto it = offsets.find(name);
+    if (it == offsets.end()) {
+      it = offsets.emplace(name, (uint32_t)bits.size()).first;
+      bits.resize(bits.size() + words, 0);
+    }
+    set_bit(bits.data() + it->second, i);
+  }
+  return used;
+}
+
+bool RouteTable::build(RouteSet set, std::string& error)
+{
+  if (set.rules.size() > kMaxRules) {
+    error = std::to_string(set.rules.size()) + " rules, at most " + std::to_string(kMaxRules);
+    return false;
+  }
+
+  *this = RouteTable();
+  rules_ = std::move(set.rules);
+  const size_t n = rules_.size();
+  words_ = (n + 63) / 64;
+
+  // kind jump table
+  kind_bits_.assign((size_t)kEventKindCount * words_, 0);
+  for (size_t i = 0; i < n; ++i)
+    for (int k = 0; k < kEventKindCount; ++k)
+      if (rules_[i].kinds & (1u << k))
+        set_bit(&kind_bits_[(size_t)k * words_], i);
+
+  // amount intervals: (-inf, b0), [b0, b1), ..., [b_last, +inf)
+  for (const RouteRule& r : rules_) {
+    if (r.min_milli != LLONG_MIN) bounds_.push_back(r.min_milli);
+    if (r.max_milli != LLONG_MAX) bounds_.push_back(r.max_milli);
+  }
+  std::sort(bounds_.begin(), bounds_.end());
+  bounds_.erase(std::unique(bounds_.begin(), bounds_.end()), bounds_.end());
+
+  amount_bits_.assign((bounds_.size() + 1) * words_, 0);
+  for (size_t iv = 0; iv <= bounds_.size(); ++iv) {
+    // every bound is some rule's edge, so one value stands for the interval
+    const long long at = iv == 0 ? LLONG_MIN : bounds_[iv - 1];
+    for (size_t i = 0; i < n; ++i)
+      if (rules_[i].min_milli <= at && at < rules_[i].max_milli)
+        set_bit(&amount_bits_[iv * words_], i);
+  }
+
+  // user + account hash lookups
+  has_user_ = index_names(rules_, &RouteRule::user, words_, any_user_, user_index_, user_bits_);
+  has_account_ = index_names(rules_, &RouteRule::account, words_, any_account_, account_index_, account_bits_);
+
+  // prefix trie, built with maps and flattened
+  any_prefix_.assign(words_, 0);
+  std::vector<std::map<uint8_t, uint32_t>> trie(1);
+  std::vector<int32_t> node_bits(1, -1);
+  for (size_t i = 0; i < n; ++i) {
+    const std::string& p = rules_[i].message_prefix;
+    if (p.empty()) {
+      set_bit(any_prefix_.data(), i);
+      continue;
+    }
+    has_prefix_ = true;
+
+    uint32_t node = 0;
+    for (unsigned char c : p) {
+      auto it = trie[node].find(c);
+      if (it == trie[node].end()) {
+        it = trie[node].emplace(c, (uint32_t)trie.size()).first;
+        trie.emplace_back();
+        node_bits.push_back(-1);
+      }
+      node = it->second;
+    }
+    if (node_bits[node] < 0) {
+      node_bits[node] = (int32_t)prefix_bits_.size();
+      prefix_bits_.resize(prefix_bits_.size() + words_, 0);
+    }
+    set_bit(&prefix_bits_[(size_t)node_bits[node]], i);
+  }
+  node_bits_ = std::move(node_bits);
+  edge_begin_.reserve(trie.size() + 1);
+  for (const auto& edges : trie) {
+    edge_begin_.push_back((uint32_t)edge_byte_.size());
+    for (const auto& [c, to] : edges) {
+      edge_byte_.push_back(c);
+      edge_to_.push_back(to);
+    }
+  }
+  edge_begin_.push_back((uint32_t)edge_byte_.size());
+
+  // delivery
+  for (const RouteRule& r : rules_)
+    targets_.insert(targets_.end(), r.sources.begin(), r.sources.end());
+  std::sort(targets_.begin(), targets_.end());
+  targets_.erase(std::unique(targets_.begin(), targets_.end()), targets_.end());
+
+  fallback_ = std::move(set.fallback);
+  std::sort(fallback_.begin(), fallback_.end());
+  has_fallback_ = set.has_fallback;
+
+  error.clear();
+  return true;
+}
+
+// ------------------------------------------------------------
+// Evaluation
+// ------------------------------------------------------------
+const uint64_t* RouteTable::bits_for(const NameIndex& index, const std::vector<uint64_t>& bits,
+                                     std::string_view key) const
+{
+  // keys are folded; usernames and account names are short
+  char buf[64] = {};
+  if (key.size() > sizeof(buf))
+    return nullptr;
+  for (size_t i = 0; i < key.size(); ++i) {
+    const char c = key[i];
+    buf[i] = (c >= 'A' && c <= 'Z') ? (char)(c + 32) : c;
+  }
+
+  auto it = index.find(std::string_view(buf, key.size()));
+  return it == index.end() ? nullptr : &bits[it->second];
+}
+
+void RouteTable::evaluate(const TipEvent& ev, RouteMatch& out) const
+{
+  out = RouteMatch();
+  if (rules_.empty())
+    return;
+
+  const size_t w = words_;
+  uint64_t acc[kMaxWords];
+
+  const uint64_t* kind = &kind_bits_[(size_t)ev.kind * w];
+  const size_t iv = (size_t)(std::upper_bound(bounds_.begin(), bounds_.end(), ev.amount_milli) - bounds_.begin());
+  const uint64_t* amount = &amount_bits_[iv * w];
+  for (size_t i = 0; i < w; ++i)
+    acc[i] = kind[i] & amount[i];
+
+  if (has_user_) {
+    std::string_view user = ev.from_username();
+    if (!user.empty() && user[0] == '@')
+      user.remove_prefix(1);
+    const uint64_t* named = bits_for(user_index_, user_bits_, user);
+    for (size_t i = 0; i < w; ++i)
+      acc[i] &= any_user_[i] | (named ? named[i] : 0);
+  }
+
+  if (has_account_) {
+    const uint64_t* named = bits_for(account_index_, account_bits_, ev.account);
+    for (size_t i = 0; i < w; ++i)
+      acc[i] &= any_account_[i] | (named ? named[i] : 0);
+  }
+
+  if (has_prefix_) {
+    uint64_t allowed[kMaxWords];
+    std::copy(any_prefix_.begin(), any_prefix_.end(), allowed);
+
+    // every prefix on the path the message walks down the trie
+    uint32_t node = 0;
+    for (char ch : ev.message()) {
+      uint8_t c = (uint8_t)ch;
+      if (c >= 'A' && c <= 'Z')
+        c += 32;
+
+      const auto first = edge_byte_.begin() + edge_begin_[node];
+      const auto last = edge_byte_.begin() + edge_begin_[node + 1];
+      const auto e = std::lower_bound(first, last, c);
+      if (e == last || *e != c)
+        break;
+      node = edge_to_[(size_t)(e - edge_byte_.begin())];
+
+      if (node_bits_[node] >= 0) {
+        const uint64_t* b = &prefix_bits_[(size_t)node_bits_[node]];
+        for (size_t i = 0; i < w; ++i)
+          allowed[i] |= b[i];
+      }
+    }
+    for (size_t i = 0; i < w; ++i)
+      acc[i] &= allowed[i];
+  }
+
+  // lowest bit first = file order
+  for (size_t i = 0; i < w; ++i) {
+    uint64_t bits = acc[i];
+    while (bits) {
+      const uint32_t r = (uint32_t)(i * 64 + (size_t)std::countr_zero(bits));
+      bits &= bits - 1;
+
+      out.rules[out.count++] = r;
+      out.drop = out.drop || rules_[r].drop;
+      if (!rules_[r].cont)
+        return;
+      if (out.count == RouteMatch::kMaxRules) {
+        out.truncated = true;
+        return;
+      }
+    }
+  }
+}
+
+bool RouteTable::sorted_contains(const std::vector<std::string>& names, std::string_view name)
+{
+  auto it = std::lower_bound(names.begin(), names.end(), name,
+                             [](const std::string& a, std::string_view b) { return a < b; });
+  return it != names.end() && *it == name;
+}
+
+bool RouteTable::delivers(const RouteMatch& m, std::string_view source) const
+{
+  if (m.drop)
+    return false;
+
+  bool named_any = false;
+  for (int i = 0; i < m.count; ++i) {
+    for (const std::string& s : rules_[m.rules[i]].sources) {
+      if (s == source)
+        return true;
+      named_any = true;
+    }
+  }
+  if (named_any)
+    return false;
+
+  // unmatched (or scene-only match)
+  return has_fallback_ ? sorted_contains(fallback_, source) : !sorted_contains(targets_, source);
+}
+
+std::string_view RouteTable::scene(const RouteMatch& m) const
+{
+  if (m.drop)
+    return {};
+  for (int i = 0; i < m.count; ++i)
+    if (!rules_[m.rules[i]].scene.empty())
+      return rules_[m.rules[i]].scene;
+  return {};
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "event_parse.hpp"
+
+// One routing rule from routes.json. Every condition is optional and all
+// given ones must hold; text conditions compare ASCII case-insensitively.
+struct RouteRule {
+  std::string name;                   // for logs and errors
+  uint32_t    kinds = ~0u;            // bit per EventKind
+  long long   min_milli = LLONG_MIN;  // amount >= min
+  long long   max_milli = LLONG_MAX;  // amount <  max
+  std::string user;                   // exact username, lower-case, no '@'
+  std::string account;                // Telegram account name, lower-case
+  std::string message_prefix;         // message starts with this, lower-case
+
+  std::vector<std::string> sources;   // sources that show the event
+  std::string scene;                  // switch the program scene to this
+  bool        drop = false;           // no source shows the event
+  bool        cont = false;           // "continue": later rules may match too
+};
+
+// Rules in priority (file) order, plus who gets unmatched events
+struct RouteSet {
+  std::vector<RouteRule> rules;
+  std::vector<std::string> fallback; // sources for unmatched events
+  bool has_fallback = false;         // without: every source no rule names
+};
+
+// routes.json -> RouteSet. False with `error` naming the rule on any
+// unknown key, bad value or rule without an action.
+// Any number of rules may say "continue", but one event stops at
+// RouteMatch::kMaxRules matching rules; later matches are not applied.
+bool parse_route_set(const std::string& json_text, RouteSet& out, std::string& error);
+
+// Rules that matched one event, in order. A "continue" chain ends at
+// kMaxRules matches, so the match stays a fixed-size value.
+struct RouteMatch {
+  static constexpr int kMaxRules = 8;
+
+  uint32_t rules[kMaxRules] = {};
+  int      count = 0;
+  bool     drop = false;
+  bool     truncated = false; // stopped at kMaxRules on a "continue" rule
+};
+
+// Compiled rule set, evaluated once per event without allocating.
+//
+// Each field has a lookup that yields the set of rules it allows, as a
+// bitset with one bit per rule: a jump table on the event kind, a binary
+// search over the amount intervals formed by every rule's bounds, a hash
+// lookup on the user and account, and a byte trie walked along the
+// message for prefixes. The matching rules are the AND of those sets,
+// read lowest bit (= highest priority) first. The cost depends on the
+// number of rules only through the bitset width (64 rules per word).
+class RouteTable {
+public:
+  static constexpr size_t kMaxRules = 4096;
+
+  // False (table unchanged) past kMaxRules
+  bool build(RouteSet set, std::string& error);
+
+  bool   empty() const { return rules_.empty(); }
+  size_t size() const { return rules_.size(); }
+  const RouteRule& rule(size_t i) const { return rules_[i]; }
+
+  // Distinct source names the rules send events to
+  size_t target_count() const { return targets_.size(); }
+
+  // Matching rules in order, up to the first without "continue"
+  void evaluate(const TipEvent& ev, RouteMatch& out) const;
+
+  // Whether the source named `source` shows an event with this match:
+  // named by a matched rule, or (no matched rule names any source) a
+  // fallback source
+  bool delivers(const RouteMatch& m, std::string_view source) const;
+
+  // First scene a matched rule switches to, "" if none (or dropped)
+  std::string_view scene(const RouteMatch& m) const;
+
+private:
+  struct Hash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+  };
+  using NameIndex = std::unordered_map<std::string, uint32_t, Hash, std::equal_to<>>;
+
+  const uint64_t* bits_for(const NameIndex& index, const std::vector<uint64_t>& bits,
+                           std::string_view key) const;
+  static bool sorted_contains(const std::vector<std::string>& names, std::string_view name);
+
+  std::vector<RouteRule> rules_;
+  size_t words_ = 0; // uint64_t per bitset
+
+  std::vector<uint64_t> kind_bits_;   // kEventKindCount sets
+
+  std::vector<long long> bounds_;     // sorted distinct min/max values
+  std::vector<uint64_t>  amount_bits_; // bounds_.size() + 1 interval sets
+
+  bool has_user_ = false;
+  std::vector<uint64_t> any_user_;    // rules without a user condition
+  NameIndex             user_index_;  // user -> offset into user_bits_
+  std::vector<uint64_t> user_bits_;
+
+  bool has_account_ = false;
+  std::vector<uint64_t> any_account_;
+  NameIndex             account_index_;
+  std::vector<uint64_t> account_bits_;
+
+  bool has_prefix_ = false;
+  std::vector<uint64_t> any_prefix_;   // rules without a prefix condition
+  // flattened trie: node n owns edges_[edge_begin_[n] .. edge_begin_[n + 1])
+  std::vector<uint32_t> edge_begin_;
+  std::vector<uint8_t>  edge_byte_;
+  std::vector<uint32_t> edge_to_;
+  std::vector<int32_t>  node_bits_;    // offset into prefix_bits_, -1 = no prefix ends here
+  std::vector<uint64_t> prefix_bits_;
+
+  std::vector<std::string> targets_;  // sorted, every rule's sources
+  std::vector<std::string> fallback_; // sorted
+  bool has_fallback_ = false;
+};
+
+// A table's verdict on one event, handed to every subscribed source
+struct RouteDecision {
+  std::shared_ptr<const RouteTable> table; // nullptr: no rules, every source shows it
+  RouteMatch match;
+
+  bool delivers_to(std::string_view source) const { return !table || table->delivers(match, source); }
+};
@@ -0,0 +1,41 @@
+#include "event_types.hpp"
+
+#include <array>
+
+// Hashes of the registry keys, computed at compile time.
+template <typename T, size_t N, typename KeyFn>
+static constexpr std::array<uint64_t, N> hash_table(const T (&entries)[N], KeyFn key)
+{
+  std::array<uint64_t, N> out{};
+  for (size_t i = 0; i < N; ++i)
+    out[i] = fnv1a_64(key(entries[i]));
+  return out;
+}
+
+static constexpr auto kTypeHashes = hash_table(
+  kEventTypes, [](const EventTypeDescriptor& d) { return d.type; });
+
+static constexpr auto kTokenHashes = hash_table(
+  kTokens, [](const TokenDescriptor& t) { return std::string_view(t.symbol); });
+
+const EventTypeDescriptor* find_event_type(std::string_view type)
+{
+  const uint64_t h = fnv1a_64(type);
+  for (size_t i = 0; i < kTypeHashes.size(); ++i) {
+    if (kTypeHashes[i] == h && kEventTypes[i].type == type)
+      return &kEventTypes[i];
+  }
+  return nullptr;
+}
+
+const TokenDescriptor* find_token(std::string_view symbol)
+{
+  if (symbol.empty()) return nullptr;
+
+  const uint64_t h = fnv1a_64(symbol);
+  for (size_t i = 0; i < kTokenHashes.size(); ++i) {
+    if (kTokenHashes[i] == h && symbol == kTokens[i].symbol)
+      return &kTokens[i];
+  }
+  return nullptr;
+}
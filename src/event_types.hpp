@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Compile-time registry of bot event types and tokens.
+// Adding a token or type is a table edit; decoding dispatches on a hash of
+// the "type" string, so a new entry costs other types nothing.
+
+// 64-bit FNV-1a (constexpr so registry hashes are computed at compile time)
+constexpr uint64_t fnv1a_64(std::string_view s, uint64_t seed = 14695981039346656037ULL)
+{
+  uint64_t h = seed;
+  for (char c : s) {
+    h ^= (unsigned char)c;
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+enum class EventKind : uint8_t {
+  Tip    = 0,
+  Follow = 1,
+  Sub    = 2,
+};
+constexpr int kEventKindCount = 3;
+
+// Per-kind presentation defaults; each kind has its own settings namespace
+struct EventKindInfo {
+  const char* setting_prefix;   // "" for tips (legacy keys), "follow_", "sub_"
+  const char* label;            // properties group title
+  const char* default_template;
+  double      default_thresholds[3];
+};
+
+inline constexpr EventKindInfo kEventKinds[kEventKindCount] = {
+  {"",        "Tips",          "{user} tipped {amount} {symbol}\n{message}",       {0.0, 10.0, 50.0}},
+  {"follow_", "Follows",       "{user} just followed!",                            {0.0, 0.0, 0.0}},
+  {"sub_",    "Subscriptions", "{user} subscribed for {amount} months\n{message}", {0.0, 6.0, 12.0}},
+};
+
+inline const EventKindInfo& event_kind_info(EventKind k)
+{
+  return kEventKinds[(int)k];
+}
+
+struct TokenDescriptor {
+  const char* symbol;
+  uint8_t     decimals;          // raw integer amount = value * 10^decimals
+  uint8_t     display_precision; // decimals shown in {amount}
+};
+
+// Index 0 is the unit-less count used by non-token events (e.g. sub months).
+inline constexpr TokenDescriptor kTokens[] = {
+  {"",      0, 0},
+  {"TWICH", 9, 3},
+  {"SUI",   9, 3},
+  {"USDC",  6, 2},
+};
+constexpr int kTokenCount = (int)(sizeof(kTokens) / sizeof(kTokens[0]));
+
+constexpr int kTokenNone = 0;
+constexpr int kTokenTwich = 1;
+constexpr int kTokenFromField = -1; // read "symbol" from the event JSON
+
+struct EventTypeDescriptor {
+  std::string_view type;       // value of the "type" field
+  EventKind        kind;
+  int              token;      // index into kTokens or kTokenFromField
+  const char*      amount_key; // raw integer amount field, nullptr if none
+};
+
+inline constexpr EventTypeDescriptor kEventTypes[] = {
+  {"TWICH_TIP", EventKind::Tip,    kTokenTwich,     "amount_twits"},
+  {"TOKEN_TIP", EventKind::Tip,    kTokenFromField, "amount_units"},
+  {"FOLLOW",    EventKind::Follow, kTokenNone,      nullptr},
+  {"SUB",       EventKind::Sub,    kTokenNone,      "months"},
+};
+
+// Hash dispatch over kEventTypes; nullptr for unknown types.
+const EventTypeDescriptor* find_event_type(std::string_view type);
+
+// Token by symbol; nullptr if not registered.
+const TokenDescriptor* find_token(std::string_view symbol);
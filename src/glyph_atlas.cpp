@@ -0,0 +1,483 @@
+#include "glyph_atlas.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+#include "unicode_word.hpp"
+
+#ifdef TWICH_HAVE_FREETYPE
+#include <ft2build.h>
+#include FT_FREETYPE_H
+static constexpr bool kHaveFreetype = true;
+#else
+static constexpr bool kHaveFreetype = false;
+#endif
+
+namespace fs = std::filesystem;
+
+// -------------------- TextLayout --------------------
+size_t TextLayout::shown_quads(float reveal) const
+{
+  if (reveal >= 1.0f)
+    return quads.size();
+  if (reveal <= 0.0f)
+    return 0;
+
+  // whole characters, as RevealLayout::visible counts them
+  const uint32_t shown = (uint32_t)(reveal * (float)chars + 1e-4f);
+  auto it = std::partition_point(quads.begin(), quads.end(),
+                                 [shown](const GlyphQuad& q) { return q.ordinal < shown; });
+  return (size_t)(it - quads.begin());
+}
+
+void TextLayout::clear()
+{
+  quads.clear();
+  width = height = chars = 0;
+  epoch = 0;
+}
+
+// -------------------- font lookup --------------------
+#ifdef TWICH_HAVE_FREETYPE
+
+static std::string lower(std::string s)
+{
+  for (char& c : s)
+    c = (char)std::tolower((unsigned char)c);
+  return s;
+}
+
+static std::vector<fs::path> font_dirs()
+{
+  std::vector<fs::path> dirs;
+  auto env = [](const char* name) -> std::string {
+    const char* v = std::getenv(name);
+    return v ? v : "";
+  };
+
+#if defined(_WIN32)
+  if (!env("WINDIR").empty())
+    dirs.push_back(fs::path(env("WINDIR")) / "Fonts");
+  if (!env("LOCALAPPDATA").empty())
+    dirs.push_back(fs::path(env("LOCALAPPDATA")) / "Microsoft" / "Windows" / "Fonts");
+#elif defined(__APPLE__)
+  dirs.push_back("/System/Library/Fonts");
+  dirs.push_back("/Library/Fonts");
+  if (!env("HOME").empty())
+    dirs.push_back(fs::path(env("HOME")) / "Library" / "Fonts");
+#else
+  dirs.push_back("/usr/share/fonts");
+  dirs.push_back("/usr/local/share/fonts");
+  if (!env("XDG_DATA_HOME").empty())
+    dirs.push_back(fs::path(env("XDG_DATA_HOME")) / "fonts");
+  if (!env("HOME").empty()) {
+    dirs.push_back(fs::path(env("HOME")) / ".local" / "share" / "fonts");
+    dirs.push_back(fs::path(env("HOME")) / ".fonts");
+  }
+#endif
+  return dirs;
+}
+
+struct FontIndexEntry {
+  FontFile file;
+  bool regular = false; // neither bold nor italic
+};
+
+// lower-cased family name -> faces
+using FontIndex = std::unordered_map<std::string, std::vector<FontIndexEntry>>;
+
+static FontIndex build_font_index()
+{
+  FontIndex index;
+  FT_Library lib = nullptr;
+  if (FT_Init_FreeType(&lib) != 0)
+    return index;
+
+  for (const fs::path& dir : font_dirs()) {
+    std::error_code ec;
+    fs::recursive_directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec), end;
+    for (; !ec && it != end; it.increment(ec)) {
+      if (!it->is_regular_file(ec))
+        continue;
+      const std::string ext = lower(it->path().extension().string());
+      if (ext != ".ttf" && ext != ".otf" && ext != ".ttc" && ext != ".otc")
+        continue;
+
+      const std::string path = it->path().string();
+      long faces = 1;
+      for (long i = 0; i < faces; ++i) {
+        FT_Face face = nullptr;
+        if (FT_New_Face(lib, path.c_str(), i, &face) != 0)
+          break;
+        faces = face->num_faces;
+        if (face->family_name) {
+          FontIndexEntry e;
+          e.file.path = path;
+          e.file.index = (int)i;
+          e.regular = !(face->style_flags & (FT_STYLE_FLAG_BOLD | FT_STYLE_FLAG_ITALIC));
+          index[lower(face->family_name)].push_back(std::move(e));
+        }
+        FT_Done_Face(face);
+      }
+    }
+  }
+
+  FT_Done_FreeType(lib);
+  return index;
+}
+
+FontFile find_font_file(const std::string& face)
+{
+  static std::mutex index_mutex;
+  static bool indexed = false;
+  static FontIndex index;
+
+  std::lock_guard<std::mutex> lk(index_mutex);
+  if (!indexed) {
+    index = build_font_index();
+    indexed = true;
+  }
+
+  auto it = index.find(lower(face));
+  if (it == index.end())
+    return FontFile();
+
+  for (const FontIndexEntry& e : it->second)
+    if (e.regular)
+      return e.file;
+  return it->second.front().file;
+}
+
+#else
+
+FontFile find_font_file(const std::string&)
+{
+  return FontFile();
+}
+
+#endif
+
+// -------------------- GlyphAtlas --------------------
+std::atomic<uint64_t> GlyphAtlas::next_serial_{0};
+
+#ifdef TWICH_HAVE_FREETYPE
+
+GlyphAtlas::~GlyphAtlas()
+{
+  if (face_)
+    FT_Done_Face(face_);
+  if (lib_)
+    FT_Done_FreeType(lib_);
+}
+
+bool GlyphAtlas::open(const FontFile& font, int pixel_size, std::string& error)
+{
+  if (face_ || font.empty() || pixel_size <= 0) {
+    error = "no font";
+    return false;
+  }
+  if (FT_Init_FreeType(&lib_) != 0) {
+    error = "FreeType failed to start";
+    return false;
+  }
+  if (FT_New_Face(lib_, font.path.c_str(), font.index, &face_) != 0) {
+    face_ = nullptr;
+    error = "cannot open " + font.path;
+    return false;
+  }
+  if (FT_Set_Pixel_Sizes(face_, 0, (FT_UInt)pixel_size) != 0) {
+    error = font.path + " has no size " + std::to_string(pixel_size);
+    return false;
+  }
+
+  font_ = font;
+  pixel_size_ = pixel_size;
+  line_height_ = (int)((face_->size->metrics.height + 63) >> 6);
+  ascender_ = (int)((face_->size->metrics.ascender + 63) >> 6);
+  pixels_.assign((size_t)kSize * kSize, 0);
+  return true;
+}
+
+bool GlyphAtlas::place(uint32_t w, uint32_t h, uint32_t& x, uint32_t& y)
+{
+  if (w > kSize || h > kSize)
+    return false;
+  if (shelf_x_ + w > kSize) {
+    shelf_y_ += shelf_h_;
+    shelf_x_ = 0;
+    shelf_h_ = 0;
+  }
+  if (shelf_y_ + h > kSize)
+    return false;
+
+  x = shelf_x_;
+  y = shelf_y_;
+  shelf_x_ += w;
+  shelf_h_ = std::max(shelf_h_, h);
+  return true;
+}
+
+void GlyphAtlas::start_over()
+{
+  glyphs_.clear();
+  std::fill(pixels_.begin(), pixels_.end(), 0);
+  shelf_x_ = shelf_y_ = shelf_h_ = 0;
+  epoch_++;
+  generation_++;
+}
+
+const GlyphAtlas::Glyph* GlyphAtlas::glyph(uint32_t index)
+{
+  auto it = glyphs_.find(index);
+  if (it != glyphs_.end())
+    return &it->second;
+
+  Glyph g;
+  if (FT_Load_Glyph(face_, index, FT_LOAD_RENDER | FT_LOAD_TARGET_NORMAL) == 0) {
+    const FT_GlyphSlot slot = face_->glyph;
+    const FT_Bitmap& bm = slot->bitmap;
+    g.advance = (float)slot->advance.x / 64.0f;
+    g.left = slot->bitmap_left;
+    g.top = slot->bitmap_top;
+    g.w = bm.width;
+    g.h = bm.rows;
+
+    if (g.w && g.h && (bm.pixel_mode == FT_PIXEL_MODE_GRAY || bm.pixel_mode == FT_PIXEL_MODE_MONO)) {
+      uint32_t x = 0, y = 0;
+      if (!place(g.w + 2 * kPad, g.h + 2 * kPad, x, y)) {
+        full_ = true;
+        return nullptr;
+      }
+
+      for (uint32_t row = 0; row < g.h; ++row) {
+        const uint8_t* src = bm.buffer + (ptrdiff_t)row * bm.pitch;
+        uint8_t* dst = pixels_.data() + (size_t)(y + kPad + row) * kSize + x + kPad;
+        if (bm.pixel_mode == FT_PIXEL_MODE_GRAY) {
+          memcpy(dst, src, g.w);
+        } else {
+          for (uint32_t col = 0; col < g.w; ++col)
+            dst[col] = (src[col >> 3] & (0x80 >> (col & 7))) ? 255 : 0;
+        }
+      }
+
+      const float inv = 1.0f / (float)kSize;
+      g.u0 = (float)x * inv;
+      g.v0 = (float)y * inv;
+      g.u1 = (float)(x + g.w + 2 * kPad) * inv;
+      g.v1 = (float)(y + g.h + 2 * kPad) * inv;
+      g.ink = true;
+      generation_++;
+    }
+    rasterized_++;
+  }
+
+  return &glyphs_.emplace(index, g).first->second;
+}
+
+static size_t utf8_length(uint8_t lead)
+{
+  return lead < 0x80 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+}
+
+bool GlyphAtlas::try_layout(std::string_view text, TextLayout& out)
+{
+  out.clear();
+  full_ = false;
+
+  const uint8_t* d = (const uint8_t*)text.data();
+  const size_t n = text.size();
+  const bool kerning = FT_HAS_KERNING(face_);
+
+  float pen = 0.0f, widest = 0.0f;
+  uint32_t line = 0, prev = 0;
+
+  for (size_t i = 0; i < n;) {
+    const uint8_t c = d[i];
+    if (c == '\n') {
+      widest = std::max(widest, pen);
+      pen = 0.0f;
+      prev = 0;
+      line++;
+      i++;
+      continue;
+    }
+    if (c == '\r' || (c & 0xC0) == 0x80) { // CR, stray UTF-8 continuation byte
+      i++;
+      continue;
+    }
+
+    char32_t cp = utf8_decode_at(d, n, i);
+    size_t len = utf8_length(c);
+    if (cp == kInvalidCodePoint) {
+      cp = 0xFFFD;
+      len = 1;
+    }
+    i += len;
+
+    const uint32_t ordinal = out.chars++;
+    const uint32_t index = FT_Get_Char_Index(face_, (FT_ULong)cp);
+
+    if (kerning && prev && index) {
+      FT_Vector k;
+      if (FT_Get_Kerning(face_, prev, index, FT_KERNING_DEFAULT, &k) == 0)
+        pen += (float)k.x / 64.0f;
+    }
+    prev = index;
+
+    const Glyph* g = glyph(index);
+    if (!g)
+      return false;
+
+    if (g->ink) {
+      GlyphQuad q;
+      q.x0 = std::round(pen) + (float)g->left - (float)kPad;
+      q.y0 = (float)(line * line_height_ + ascender_ - g->top) - (float)kPad;
+      q.x1 = q.x0 + (float)(g->w + 2 * kPad);
+      q.y1 = q.y0 + (float)(g->h + 2 * kPad);
+      q.u0 = g->u0;
+      q.v0 = g->v0;
+      q.u1 = g->u1;
+      q.v1 = g->v1;
+      q.ordinal = ordinal;
+      out.quads.push_back(q);
+    }
+    pen += g->advance;
+  }
+
+  widest = std::max(widest, pen);
+  out.width = (uint32_t)std::ceil(widest);
+  out.height = (line + 1) * (uint32_t)line_height_;
+  out.epoch = epoch_;
+  return !full_;
+}
+
+bool GlyphAtlas::layout(std::string_view text, TextLayout& out)
+{
+  if (!face_)
+    return false;
+  if (try_layout(text, out))
+    return true;
+
+  start_over();
+  if (try_layout(text, out))
+    return true;
+
+  out.clear();
+  return false;
+}
+
+#else
+
+GlyphAtlas::~GlyphAtlas() = default;
+
+bool GlyphAtlas::open(const FontFile&, int, std::string& error)
+{
+  error = "built without FreeType";
+  return false;
+}
+
+bool GlyphAtlas::layout(std::string_view, TextLayout& out)
+{
+  out.clear();
+  return false;
+}
+
+#endif
+
+// -------------------- GlyphAtlasLoader --------------------
+// Tried in order when the chosen face is not installed
+static const char* kFallbackFaces[] = {"Arial", "Liberation Sans", "DejaVu Sans", "Helvetica", "Segoe UI",
+                                       "Noto Sans"};
+
+// Rasterized ahead of the first alert
+static const char* kWarmText =
+  " !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~";
+
+void GlyphAtlasLoader::set_on_error(OnError cb)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  on_error_ = std::move(cb);
+}
+
+void GlyphAtlasLoader::submit(std::string face, int pixel_size)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  pending_face_ = std::move(face);
+  pending_size_ = pixel_size;
+  pending_ = true;
+
+  if (!running_) {
+    tasks_.reopen();
+    running_ = tasks_.post([this]() { run(); });
+  }
+}
+
+bool GlyphAtlasLoader::take_ready(std::shared_ptr<GlyphAtlas>& out)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  has_ready_.store(false, std::memory_order_relaxed);
+  if (!ready_set_)
+    return false;
+  ready_set_ = false;
+  out = std::move(ready_);
+  return true;
+}
+
+void GlyphAtlasLoader::stop()
+{
+  tasks_.cancel();
+
+  std::lock_guard<std::mutex> lk(mutex_);
+  running_ = false;
+  pending_ = false;
+}
+
+void GlyphAtlasLoader::run()
+{
+  for (;;) {
+    std::string face;
+    int size = 0;
+    OnError on_error;
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      if (!pending_) {
+        running_ = false;
+        return;
+      }
+      face = std::move(pending_face_);
+      size = pending_size_;
+      pending_ = false;
+      on_error = on_error_;
+    }
+
+    std::string error;
+    FontFile file = find_font_file(face);
+    for (size_t i = 0; file.empty() && i < std::size(kFallbackFaces); ++i)
+      file = find_font_file(kFallbackFaces[i]);
+
+    auto atlas = std::make_shared<GlyphAtlas>();
+    bool ok = false;
+    if (!kHaveFreetype) {
+      error = "built without FreeType";
+    } else if (file.empty()) {
+      error = "no such font installed";
+    } else if ((ok = atlas->open(file, size, error))) {
+      TextLayout warm;
+      atlas->layout(kWarmText, warm);
+    }
+
+    if (!ok && on_error)
+      on_error(face, error);
+
+    std::lock_guard<std::mutex> lk(mutex_);
+    ready_ = ok ? std::move(atlas) : nullptr;
+    ready_set_ = true;
+    has_ready_.store(true, std::memory_order_release);
+  }
+}
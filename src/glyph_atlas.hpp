@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "worker_pool.hpp"
+
+struct FT_LibraryRec_;
+struct FT_FaceRec_;
+
+// A font file and the face inside it (.ttc files hold several)
+struct FontFile {
+  std::string path;
+  int index = 0;
+
+  bool empty() const { return path.empty(); }
+};
+
+// Font file for a face name ("Arial"), matched on FreeType's family name,
+// regular style preferred. The system font folders are indexed on the first
+// call (hundreds of files): call it off the video thread.
+FontFile find_font_file(const std::string& face);
+
+// One glyph of a laid-out text: a textured quad in glyph box coordinates
+// (top-left origin, pixels). Quads extend GlyphAtlas::kPad past the ink on
+// every side so the outline pass has room.
+struct GlyphQuad {
+  float x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+  float u0 = 0, v0 = 0, u1 = 0, v1 = 0;
+  uint32_t ordinal = 0; // character index in the text (reveal order)
+};
+
+// A text laid out against one atlas; quads in text order
+struct TextLayout {
+  std::vector<GlyphQuad> quads;
+  uint32_t width = 0;  // glyph box: widest line x line count
+  uint32_t height = 0;
+  uint32_t chars = 0;  // characters, counted as RevealLayout does
+  uint64_t epoch = 0;  // atlas epoch the UVs belong to
+
+  // Quads to draw when `reveal` [0..1] of the characters show (typewriter)
+  size_t shown_quads(float reveal) const;
+
+  void clear();
+};
+
+// 8-bit coverage atlas for one font at one pixel size. Each glyph is
+// rasterized by FreeType once, the first time a layout needs it, and packed
+// on shelves. When the atlas is full it starts over and bumps epoch(), so
+// layouts made earlier must be redone.
+//
+// Not thread-safe: the loader fills it on a worker, then hands it to the
+// video thread, which is its only user from then on.
+class GlyphAtlas {
+public:
+  static constexpr uint32_t kSize = 2048;
+  static constexpr uint32_t kPad = 11; // widest outline (10 px) + a filtering texel
+
+  GlyphAtlas() = default;
+  ~GlyphAtlas();
+
+  GlyphAtlas(const GlyphAtlas&) = delete;
+  GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+  bool open(const FontFile& font, int pixel_size, std::string& error);
+
+  // Lays out UTF-8 `text` ('\n' breaks lines), rasterizing missing glyphs.
+  // False when the text's glyphs do not fit even in an empty atlas.
+  bool layout(std::string_view text, TextLayout& out);
+
+  const uint8_t* pixels() const { return pixels_.data(); }
+  uint32_t size() const { return kSize; }
+
+  uint64_t generation() const { return generation_; } // bumped when pixels change
+  uint64_t epoch() const { return epoch_; }           // bumped when the atlas starts over
+
+  size_t glyphs() const { return glyphs_.size(); }
+  uint64_t rasterized() const { return rasterized_; } // glyph rasterizations so far
+
+  const FontFile& font() const { return font_; }
+  int pixel_size() const { return pixel_size_; }
+
+  uint64_t serial() const { return serial_; } // unique per atlas in the process
+
+private:
+  struct Glyph {
+    float u0 = 0, v0 = 0, u1 = 0, v1 = 0;
+    int left = 0, top = 0;       // bitmap offset from the pen (FreeType bearings)
+    uint32_t w = 0, h = 0;       // bitmap size, padding excluded
+    float advance = 0;
+    bool ink = false;            // false for spaces
+  };
+
+  const Glyph* glyph(uint32_t index);
+  bool place(uint32_t w, uint32_t h, uint32_t& x, uint32_t& y);
+  void start_over();
+  bool try_layout(std::string_view text, TextLayout& out);
+
+  static std::atomic<uint64_t> next_serial_;
+  const uint64_t serial_ = ++next_serial_;
+
+  FT_LibraryRec_* lib_ = nullptr;
+  FT_FaceRec_*    face_ = nullptr;
+  FontFile font_;
+  int pixel_size_ = 0;
+  int line_height_ = 0;
+  int ascender_ = 0;
+
+  std::vector<uint8_t> pixels_;
+  std::unordered_map<uint32_t, Glyph> glyphs_; // by FreeType glyph index
+  uint32_t shelf_x_ = 0, shelf_y_ = 0, shelf_h_ = 0;
+
+  uint64_t generation_ = 0;
+  uint64_t epoch_ = 0;
+  uint64_t rasterized_ = 0;
+  bool full_ = false; // a glyph did not fit during the current layout
+};
+
+// Opens GlyphAtlases on the shared worker pool: font lookup, FreeType face
+// and the printable ASCII glyphs, so the first alert rasterizes little.
+// submit() takes the latest face/size; a newer one replaces one not started
+// yet. The video thread picks the result up with take_ready().
+class GlyphAtlasLoader {
+public:
+  // Worker thread: the face could not be used (the text source draws instead)
+  using OnError = std::function<void(const std::string& face, const std::string& error)>;
+
+  GlyphAtlasLoader() = default;
+  ~GlyphAtlasLoader() { stop(); }
+
+  GlyphAtlasLoader(const GlyphAtlasLoader&) = delete;
+  GlyphAtlasLoader& operator=(const GlyphAtlasLoader&) = delete;
+
+  void set_on_error(OnError cb);
+
+  void submit(std::string face, int pixel_size);
+
+  // Lock-free: a finished atlas (or a failure) is waiting for take_ready()
+  bool has_ready() const { return has_ready_.load(std::memory_order_acquire); }
+
+  // True when something finished; `out` is nullptr when the face failed
+  bool take_ready(std::shared_ptr<GlyphAtlas>& out);
+
+  void stop();
+
+private:
+  void run();
+
+  std::mutex mutex_;
+  TaskGroup tasks_;
+  bool running_ = false;
+
+  bool pending_ = false;
+  std::string pending_face_;
+  int pending_size_ = 0;
+
+  bool ready_set_ = false;
+  std::shared_ptr<GlyphAtlas> ready_;
+  std::atomic<bool> has_ready_{false};
+  OnError on_error_;
+};
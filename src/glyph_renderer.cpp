@@ -0,0 +1,233 @@
+#include "glyph_renderer.hpp"
+
+#include <algorithm>
+
+// Atlas coverage (R8) in, premultiplied color out. The outline pass takes
+// the max coverage over two rings of taps around each pixel; glyphs sit
+// GlyphAtlas::kPad texels apart, so the taps never reach a neighbour's ink.
+static const char* kGlyphEffect = R"(
+uniform float4x4 ViewProj;
+uniform texture2d image;
+uniform float opacity;
+uniform float outline_px;
+uniform float4 fill_color;
+uniform float4 outline_color;
+uniform float2 texel;
+
+sampler_state atlasSampler {
+  Filter   = Linear;
+  AddressU = Clamp;
+  AddressV = Clamp;
+};
+
+struct VertInOut {
+  float4 pos : POSITION;
+  float2 uv  : TEXCOORD0;
+};
+
+VertInOut VSGlyph(VertInOut vert_in)
+{
+  VertInOut vert_out;
+  vert_out.pos = mul(float4(vert_in.pos.xyz, 1.0), ViewProj);
+  vert_out.uv  = vert_in.uv;
+  return vert_out;
+}
+
+float4 PSFill(VertInOut vert_in) : TARGET
+{
+  float a = image.Sample(atlasSampler, vert_in.uv).r * fill_color.a * opacity;
+  return float4(fill_color.rgb * a, a);
+}
+
+float4 PSOutline(VertInOut vert_in) : TARGET
+{
+  float ring = 0.0;
+  for (int i = 0; i < 16; i++) {
+    float a = 0.39269908 * float(i);
+    float2 dir = float2(cos(a), sin(a)) * texel;
+    ring = max(ring, image.Sample(atlasSampler, vert_in.uv + dir * outline_px).r);
+    ring = max(ring, image.Sample(atlasSampler, vert_in.uv + dir * (outline_px * 0.5)).r);
+  }
+  float a = ring * outline_color.a * opacity;
+  return float4(outline_color.rgb * a, a);
+}
+
+technique Outline
+{
+  pass
+  {
+    vertex_shader = VSGlyph(vert_in);
+    pixel_shader  = PSOutline(vert_in);
+  }
+}
+
+technique Fill
+{
+  pass
+  {
+    vertex_shader = VSGlyph(vert_in);
+    pixel_shader  = PSFill(vert_in);
+  }
+}
+)";
+
+// -------------------- GlyphRun --------------------
+bool GlyphRun::lay_out(GlyphAtlas& atlas)
+{
+  active = atlas.layout(text, layout);
+  vb_stale = true;
+  return active;
+}
+
+void GlyphRun::release()
+{
+  if (vb) {
+    gs_vertexbuffer_destroy(vb);
+    vb = nullptr;
+  }
+  vb_stale = true;
+}
+
+// -------------------- GlyphRenderer --------------------
+bool GlyphRenderer::load_effect()
+{
+  if (effect_)
+    return true;
+  if (effect_failed_)
+    return false;
+
+  char* errors = nullptr;
+  effect_ = gs_effect_create(kGlyphEffect, "twich_glyph.effect", &errors);
+  if (!effect_) {
+    blog(LOG_WARNING, "[TWICH] glyph effect failed to compile: %s", errors ? errors : "(no log)");
+    bfree(errors);
+    effect_failed_ = true;
+    return false;
+  }
+
+  p_image_         = gs_effect_get_param_by_name(effect_, "image");
+  p_opacity_       = gs_effect_get_param_by_name(effect_, "opacity");
+  p_outline_px_    = gs_effect_get_param_by_name(effect_, "outline_px");
+  p_fill_color_    = gs_effect_get_param_by_name(effect_, "fill_color");
+  p_outline_color_ = gs_effect_get_param_by_name(effect_, "outline_color");
+  p_texel_         = gs_effect_get_param_by_name(effect_, "texel");
+  return true;
+}
+
+bool GlyphRenderer::stale(const GlyphAtlas& atlas) const
+{
+  return !atlas_tex_ || atlas.serial() != atlas_serial_ || atlas.generation() != atlas_generation_;
+}
+
+bool GlyphRenderer::prepare(const GlyphAtlas& atlas)
+{
+  if (!stale(atlas))
+    return true;
+
+  if (!atlas_tex_) {
+    atlas_tex_ = gs_texture_create(atlas.size(), atlas.size(), GS_R8, 1, nullptr, GS_DYNAMIC);
+    if (!atlas_tex_)
+      return false;
+  }
+
+  // whole texture: uploads only happen when an alert brought new glyphs
+  gs_texture_set_image(atlas_tex_, atlas.pixels(), atlas.size(), false);
+  atlas_serial_ = atlas.serial();
+  atlas_generation_ = atlas.generation();
+  return true;
+}
+
+// Two triangles per quad, no index buffer
+bool GlyphRenderer::build(GlyphRun& run)
+{
+  run.release();
+  run.vb_stale = false;
+
+  const size_t quads = run.layout.quads.size();
+  if (!quads)
+    return true;
+
+  gs_vb_data* vbd = gs_vbdata_create();
+  vbd->num = quads * 6;
+  vbd->points = (vec3*)bmalloc(sizeof(vec3) * vbd->num);
+  vbd->num_tex = 1;
+  vbd->tvarray = (gs_tvertarray*)bzalloc(sizeof(gs_tvertarray));
+  vbd->tvarray[0].width = 2;
+  vbd->tvarray[0].array = bmalloc(sizeof(vec2) * vbd->num);
+
+  vec3* p = vbd->points;
+  vec2* t = (vec2*)vbd->tvarray[0].array;
+  for (const GlyphQuad& q : run.layout.quads) {
+    const float xs[6] = {q.x0, q.x1, q.x0, q.x1, q.x1, q.x0};
+    const float ys[6] = {q.y0, q.y0, q.y1, q.y0, q.y1, q.y1};
+    const float us[6] = {q.u0, q.u1, q.u0, q.u1, q.u1, q.u0};
+    const float vs[6] = {q.v0, q.v0, q.v1, q.v0, q.v1, q.v1};
+    for (int i = 0; i < 6; ++i) {
+      vec3_set(p++, xs[i], ys[i], 0.0f);
+      vec2_set(t++, us[i], vs[i]);
+    }
+  }
+
+  run.vb = gs_vertexbuffer_create(vbd, 0);
+  return run.vb != nullptr;
+}
+
+void GlyphRenderer::draw(GlyphRun& run, const TextStyle& st, float opacity, size_t quads)
+{
+  if (!atlas_tex_ || opacity <= 0.0f || !quads)
+    return;
+  if (run.vb_stale && !build(run))
+    return;
+  if (!run.vb || !load_effect())
+    return;
+
+  quads = std::min(quads, run.layout.quads.size());
+  const uint32_t verts = (uint32_t)(quads * 6);
+
+  vec2 texel;
+  texel.x = texel.y = 1.0f / (float)GlyphAtlas::kSize;
+
+  vec4 fill_color;
+  vec4_set(&fill_color, (float)((st.color >> 16) & 0xFF) / 255.0f, (float)((st.color >> 8) & 0xFF) / 255.0f,
+           (float)(st.color & 0xFF) / 255.0f, 1.0f);
+
+  vec4 outline_color;
+  vec4_set(&outline_color, 0.0f, 0.0f, 0.0f, 1.0f); // solid black
+
+  gs_effect_set_texture(p_image_, atlas_tex_);
+  gs_effect_set_float(p_opacity_, opacity > 1.0f ? 1.0f : opacity);
+  gs_effect_set_float(p_outline_px_, (float)st.outline_size);
+  gs_effect_set_vec4(p_fill_color_, &fill_color);
+  gs_effect_set_vec4(p_outline_color_, &outline_color);
+  gs_effect_set_vec2(p_texel_, &texel);
+
+  gs_blend_state_push();
+  gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+
+  gs_load_vertexbuffer(run.vb);
+  gs_load_indexbuffer(nullptr);
+
+  if (st.outline && st.outline_size > 0) {
+    while (gs_effect_loop(effect_, "Outline"))
+      gs_draw(GS_TRIS, 0, verts);
+  }
+  while (gs_effect_loop(effect_, "Fill"))
+    gs_draw(GS_TRIS, 0, verts);
+
+  gs_load_vertexbuffer(nullptr);
+  gs_blend_state_pop();
+}
+
+void GlyphRenderer::release()
+{
+  if (atlas_tex_) {
+    gs_texture_destroy(atlas_tex_);
+    atlas_tex_ = nullptr;
+  }
+  if (effect_) {
+    gs_effect_destroy(effect_);
+    effect_ = nullptr;
+  }
+  effect_failed_ = false;
+  atlas_serial_ = atlas_generation_ = 0;
+}
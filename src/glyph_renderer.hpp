@@ -0,0 +1,72 @@
+#pragma once
+
+#include <obs-module.h>
+#include <graphics/graphics.h>
+
+#include <cstdint>
+#include <string>
+
+#include "glyph_atlas.hpp"
+#include "text_child.hpp"
+
+// One lane's alert text laid out against the source's glyph atlas, and the
+// vertex buffer holding its quads
+struct GlyphRun {
+  bool active = false;    // the playing text is drawn from the atlas
+  std::string text;       // laid out again when the atlas starts over or changes
+  TextLayout layout;
+
+  bool vb_stale = true;   // layout changed since the buffer was built
+  gs_vertbuffer_t* vb = nullptr;
+
+  // Video thread; false when the text does not fit in the atlas
+  bool lay_out(GlyphAtlas& atlas);
+
+  // Frees the vertex buffer; call inside obs_enter_graphics()
+  void release();
+};
+
+// Alert text drawn straight from a GlyphAtlas, without a text source.
+// The atlas is one R8 texture, uploaded again only when glyphs were added;
+// each alert's quads are one vertex buffer, drawn in two passes (every
+// outline, then every fill, so an outline never covers a neighbour's fill).
+// Color, outline width and opacity are shader uniforms.
+class GlyphRenderer {
+public:
+  GlyphRenderer() = default;
+
+  GlyphRenderer(const GlyphRenderer&) = delete;
+  GlyphRenderer& operator=(const GlyphRenderer&) = delete;
+
+  // True when the next prepare() will upload the atlas
+  bool stale(const GlyphAtlas& atlas) const;
+
+  // Graphics thread: uploads the atlas if it changed.
+  // Returns false while there is nothing to draw with.
+  bool prepare(const GlyphAtlas& atlas);
+
+  // Graphics thread: draws the first `quads` quads of `run` at the current
+  // matrix (glyph box origin), rebuilding its vertex buffer if needed
+  void draw(GlyphRun& run, const TextStyle& st, float opacity, size_t quads);
+
+  // Frees GPU objects; call inside obs_enter_graphics()
+  void release();
+
+private:
+  bool load_effect();
+  static bool build(GlyphRun& run);
+
+  gs_texture_t* atlas_tex_ = nullptr;
+  uint64_t      atlas_serial_ = 0;
+  uint64_t      atlas_generation_ = 0;
+
+  gs_effect_t* effect_ = nullptr;
+  bool         effect_failed_ = false;
+
+  gs_eparam_t* p_image_ = nullptr;
+  gs_eparam_t* p_opacity_ = nullptr;
+  gs_eparam_t* p_outline_px_ = nullptr;
+  gs_eparam_t* p_fill_color_ = nullptr;
+  gs_eparam_t* p_outline_color_ = nullptr;
+  gs_eparam_t* p_texel_ = nullptr;
+};
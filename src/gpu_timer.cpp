@@ -0,0 +1,67 @@
+#include "gpu_timer.hpp"
+
+void GpuSectionTimer::begin()
+{
+  Slot& sl = slots_[head_];
+
+  // all slots still pending: skip this sample rather than wait on the GPU
+  if (sl.in_flight)
+    return;
+
+  if (!sl.range) sl.range = gs_timer_range_create();
+  if (!sl.timer) sl.timer = gs_timer_create();
+  if (!sl.range || !sl.timer)
+    return;
+
+  gs_timer_range_begin(sl.range);
+  gs_timer_begin(sl.timer);
+  open_ = true;
+}
+
+void GpuSectionTimer::end()
+{
+  if (!open_)
+    return;
+
+  Slot& sl = slots_[head_];
+  gs_timer_end(sl.timer);
+  gs_timer_range_end(sl.range);
+
+  sl.in_flight = true;
+  head_ = (head_ + 1) % kSlots;
+  open_ = false;
+}
+
+bool GpuSectionTimer::poll(uint64_t& ns)
+{
+  Slot& sl = slots_[tail_];
+  if (!sl.in_flight)
+    return false;
+
+  bool disjoint = false;
+  uint64_t freq = 0;
+  uint64_t ticks = 0;
+  if (!gs_timer_range_get_data(sl.range, &disjoint, &freq) || !gs_timer_get_data(sl.timer, &ticks))
+    return false;
+
+  sl.in_flight = false;
+  tail_ = (tail_ + 1) % kSlots;
+
+  // a disjoint range means the clock changed mid-measurement; drop it
+  if (disjoint || freq == 0)
+    return false;
+
+  ns = (uint64_t)((double)ticks * 1e9 / (double)freq);
+  return true;
+}
+
+void GpuSectionTimer::release()
+{
+  for (Slot& sl : slots_) {
+    if (sl.timer) gs_timer_destroy(sl.timer);
+    if (sl.range) gs_timer_range_destroy(sl.range);
+    sl = Slot();
+  }
+  head_ = tail_ = 0;
+  open_ = false;
+}
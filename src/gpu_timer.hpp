@@ -0,0 +1,40 @@
+#pragma once
+
+#include <graphics/graphics.h>
+
+#include <cstdint>
+
+// GPU duration of one recurring section (e.g. video_render).
+// Queries complete a few frames late, so a small ring of timers is kept in
+// flight and finished results are collected without stalling the pipeline.
+// Graphics thread only.
+class GpuSectionTimer {
+public:
+  GpuSectionTimer() = default;
+
+  GpuSectionTimer(const GpuSectionTimer&) = delete;
+  GpuSectionTimer& operator=(const GpuSectionTimer&) = delete;
+
+  void begin();
+  void end();
+
+  // Oldest finished measurement, if any; false when none is ready yet
+  bool poll(uint64_t& ns);
+
+  // Frees GPU queries; call inside obs_enter_graphics()
+  void release();
+
+private:
+  static constexpr int kSlots = 4;
+
+  struct Slot {
+    gs_timer_range_t* range = nullptr;
+    gs_timer_t*       timer = nullptr;
+    bool              in_flight = false;
+  };
+
+  Slot slots_[kSlots];
+  int  head_ = 0;     // slot the next begin() uses
+  int  tail_ = 0;     // oldest in-flight slot
+  bool open_ = false; // between begin() and end()
+};
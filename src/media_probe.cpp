@@ -0,0 +1,232 @@
+#include "media_probe.hpp"
+
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+// EBML element IDs (marker bits included, as written in the file)
+static constexpr uint32_t kIdEbml          = 0x1A45DFA3;
+static constexpr uint32_t kIdDocType       = 0x4282;
+static constexpr uint32_t kIdSegment       = 0x18538067;
+static constexpr uint32_t kIdInfo          = 0x1549A966;
+static constexpr uint32_t kIdTimecodeScale = 0x2AD7B1;
+static constexpr uint32_t kIdDuration      = 0x4489;
+static constexpr uint32_t kIdTracks        = 0x1654AE6B;
+static constexpr uint32_t kIdTrackEntry    = 0xAE;
+static constexpr uint32_t kIdTrackType     = 0x83;
+static constexpr uint32_t kIdCodecId       = 0x86;
+static constexpr uint32_t kIdVideo         = 0xE0;
+static constexpr uint32_t kIdPixelWidth    = 0xB0;
+static constexpr uint32_t kIdPixelHeight   = 0xBA;
+static constexpr uint32_t kIdAlphaMode     = 0x53C0;
+static constexpr uint32_t kIdCluster       = 0x1F43B675;
+
+static constexpr uint64_t kUnknownSize = ~0ULL;
+
+// Head of the file read for probing; Tracks sits well before this in
+// anything written by ffmpeg/OBS/mkvmerge.
+static constexpr size_t kProbeBytes = 512 * 1024;
+
+namespace {
+
+struct ProbeState {
+  const uint8_t* d = nullptr;
+  size_t         len = 0;
+  bool           stop = false;
+
+  std::string doc_type;
+  uint64_t    timecode_scale = 1000000; // ns per tick (Matroska default)
+  double      duration_ticks = 0.0;
+  bool        have_video = false;
+
+  // current TrackEntry
+  uint64_t    track_type = 0;
+  std::string track_codec;
+  uint64_t    track_w = 0, track_h = 0, track_alpha = 0;
+
+  MediaInfo*  out = nullptr;
+};
+
+bool read_id(const ProbeState& st, size_t& pos, uint32_t& id)
+{
+  if (pos >= st.len)
+    return false;
+
+  const uint8_t b = st.d[pos];
+  const int n = std::countl_zero(b) + 1;
+  if (n > 4 || pos + (size_t)n > st.len)
+    return false;
+
+  id = 0;
+  for (int i = 0; i < n; ++i)
+    id = (id << 8) | st.d[pos + (size_t)i];
+  pos += (size_t)n;
+  return true;
+}
+
+bool read_size(const ProbeState& st, size_t& pos, uint64_t& size)
+{
+  if (pos >= st.len)
+    return false;
+
+  const uint8_t b = st.d[pos];
+  if (b == 0)
+    return false;
+
+  const int n = std::countl_zero(b) + 1;
+  if (pos + (size_t)n > st.len)
+    return false;
+
+  const uint8_t mask = (uint8_t)(0xFF >> n);
+  uint64_t v = b & mask;
+  bool all_ones = (v == mask);
+  for (int i = 1; i < n; ++i) {
+    v = (v << 8) | st.d[pos + (size_t)i];
+    all_ones = all_ones && st.d[pos + (size_t)i] == 0xFF;
+  }
+
+  size = all_ones ? kUnknownSize : v;
+  pos += (size_t)n;
+  return true;
+}
+
+uint64_t read_uint(const uint8_t* p, uint64_t size)
+{
+  uint64_t v = 0;
+  for (uint64_t i = 0; i < size && i < 8; ++i)
+    v = (v << 8) | p[i];
+  return v;
+}
+
+double read_float(const uint8_t* p, uint64_t size)
+{
+  if (size == 4) {
+    const uint32_t bits = (uint32_t)read_uint(p, 4);
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+  }
+  if (size == 8) {
+    const uint64_t bits = read_uint(p, 8);
+    double v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+  }
+  return 0.0;
+}
+
+bool is_master(uint32_t id)
+{
+  return id == kIdEbml || id == kIdSegment || id == kIdInfo || id == kIdTracks ||
+         id == kIdTrackEntry || id == kIdVideo;
+}
+
+void walk(ProbeState& st, size_t pos, size_t end, int depth)
+{
+  while (!st.stop && pos < end) {
+    uint32_t id = 0;
+    uint64_t size = 0;
+    if (!read_id(st, pos, id) || !read_size(st, pos, size)) {
+      st.stop = true;
+      return;
+    }
+
+    if (id == kIdCluster) {
+      st.stop = true; // media data from here on; everything we need came before
+      return;
+    }
+
+    const size_t body = pos;
+    const bool unknown = (size == kUnknownSize);
+    const bool truncated = !unknown && size > (uint64_t)(st.len - body);
+    const size_t body_end = (unknown || truncated) ? end : body + (size_t)size;
+
+    // Segment/Tracks/TrackEntry/Video is the deepest path we use
+    if (is_master(id) && depth < 6) {
+      if (id == kIdTrackEntry) {
+        st.track_type = 0;
+        st.track_codec.clear();
+        st.track_w = st.track_h = st.track_alpha = 0;
+      }
+
+      walk(st, body, body_end, depth + 1);
+
+      if (id == kIdTrackEntry && st.track_type == 1 && !st.have_video) {
+        st.have_video = true;
+        st.out->codec_id = st.track_codec;
+        st.out->width = (uint32_t)st.track_w;
+        st.out->height = (uint32_t)st.track_h;
+        st.out->alpha = (st.track_alpha == 1);
+      }
+    } else if (!is_master(id)) {
+      // leaves must be complete, and an unknown-size leaf cannot be skipped
+      if (unknown || truncated) {
+        st.stop = true;
+        return;
+      }
+
+      const uint8_t* p = st.d + body;
+      switch (id) {
+      case kIdDocType:       st.doc_type.assign((const char*)p, strnlen((const char*)p, (size_t)size)); break;
+      case kIdTimecodeScale: st.timecode_scale = read_uint(p, size); break;
+      case kIdDuration:      st.duration_ticks = read_float(p, size); break;
+      case kIdTrackType:     st.track_type = read_uint(p, size); break;
+      case kIdCodecId:       st.track_codec.assign((const char*)p, strnlen((const char*)p, (size_t)size)); break;
+      case kIdPixelWidth:    st.track_w = read_uint(p, size); break;
+      case kIdPixelHeight:   st.track_h = read_uint(p, size); break;
+      case kIdAlphaMode:     st.track_alpha = read_uint(p, size); break;
+      default: break;
+      }
+    }
+
+    pos = body_end;
+  }
+}
+
+} // namespace
+
+bool probe_matroska(const uint8_t* data, size_t len, MediaInfo& out, std::string& error)
+{
+  out = MediaInfo();
+
+  if (len < 4 || read_uint(data, 4) != kIdEbml) {
+    error = "not a WebM/Matroska file";
+    return false;
+  }
+
+  ProbeState st;
+  st.d = data;
+  st.len = len;
+  st.out = &out;
+  walk(st, 0, len, 0);
+
+  if (st.doc_type == "webm")
+    out.container = MediaInfo::Container::WebM;
+  else if (st.doc_type == "matroska")
+    out.container = MediaInfo::Container::Matroska;
+
+  if (st.duration_ticks > 0.0)
+    out.duration_sec = st.duration_ticks * (double)st.timecode_scale / 1e9;
+
+  if (!st.have_video) {
+    error = "no video track";
+    return false;
+  }
+  return true;
+}
+
+bool probe_media_file(const std::string& path, MediaInfo& out, std::string& error)
+{
+  std::ifstream f(path, std::ios::binary);
+  if (!f) {
+    error = "cannot open file";
+    return false;
+  }
+
+  std::vector<uint8_t> head(kProbeBytes);
+  f.read((char*)head.data(), (std::streamsize)head.size());
+  head.resize((size_t)f.gcount());
+
+  return probe_matroska(head.data(), head.size(), out, error);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// What the header of a tier media file says, read without decoding.
+struct MediaInfo {
+  enum class Container : uint8_t { Unknown, WebM, Matroska };
+
+  Container   container = Container::Unknown;
+  std::string codec_id;          // first video track, e.g. "V_VP9"
+  uint32_t    width = 0;
+  uint32_t    height = 0;
+  bool        alpha = false;     // Video/AlphaMode == 1
+  double      duration_sec = 0.0; // 0 when the segment has no Duration
+};
+
+// Walks the EBML header, Segment/Info and Segment/Tracks of a WebM or
+// Matroska file; stops at the first Cluster. `data` is the start of the file
+// (a few hundred KB is plenty for any muxer we care about).
+// Returns false with `error` set when the bytes are not a usable file.
+bool probe_matroska(const uint8_t* data, size_t len, MediaInfo& out, std::string& error);
+
+// Reads the head of `path` and probes it
+bool probe_media_file(const std::string& path, MediaInfo& out, std::string& error);
@@ -0,0 +1,408 @@
+#include "moderation.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <map>
+
+#include "unicode_word.hpp"
+
+// Lower-cases ASCII, Latin-1, Greek and Cyrillic capitals in place. Every
+// fold here maps a 2-byte sequence to a 2-byte sequence, so offsets hold.
+static void fold_case(std::string& s)
+{
+  const size_t n = s.size();
+  for (size_t i = 0; i < n; ++i) {
+    uint8_t b = (uint8_t)s[i];
+    if (b < 0x80) {
+      if (b >= 'A' && b <= 'Z')
+        s[i] = (char)(b + 32);
+      continue;
+    }
+    if (i + 1 >= n)
+      break;
+
+    uint8_t c = (uint8_t)s[i + 1];
+    if (b == 0xC3 && c >= 0x80 && c <= 0x9E && c != 0x97) {          // À..Þ (not ×)
+      c += 0x20;
+    } else if (b == 0xCE && c >= 0x91 && c <= 0x9F) {                 // Α..Ο
+      c += 0x20;
+    } else if (b == 0xCE && c >= 0xA0 && c <= 0xA9 && c != 0xA2) {    // Π..Ω
+      b = 0xCF;
+      c -= 0x20;
+    } else if (b == 0xD0 && c >= 0x90 && c <= 0x9F) {                 // А..П
+      c += 0x20;
+    } else if (b == 0xD0 && c >= 0xA0 && c <= 0xAF) {                 // Р..Я
+      b = 0xD1;
+      c -= 0x20;
+    } else if (b == 0xD0 && c >= 0x80 && c <= 0x8F) {                 // Ѐ..Џ
+      b = 0xD1;
+      c += 0x10;
+    }
+    s[i] = (char)b;
+    s[i + 1] = (char)c;
+
+    // skip the rest of this sequence
+    size_t len = (b >= 0xF0) ? 4 : (b >= 0xE0) ? 3 : 2;
+    i += len - 1;
+  }
+}
+
+// Is the code point touching a hit at this side a letter or number?
+// ASCII is answered from the byte; anything else is decoded and looked up.
+static bool word_before(const uint8_t* d, size_t n, size_t begin)
+{
+  if (begin == 0)
+    return false;
+  const uint8_t b = d[begin - 1];
+  return b < 0x80 ? is_word_code_point(b) : is_word_code_point(utf8_decode_before(d, n, begin));
+}
+
+static bool word_after(const uint8_t* d, size_t n, size_t end)
+{
+  if (end >= n)
+    return false;
+  const uint8_t b = d[end];
+  return b < 0x80 ? is_word_code_point(b) : is_word_code_point(utf8_decode_at(d, n, end));
+}
+
+// ------------------------------------------------------------
+// Matcher
+// ------------------------------------------------------------
+void BlocklistMatcher::build(const std::vector<std::string>& terms)
+{
+  terms_.clear();
+  edge_begin_.clear();
+  edges_.clear();
+  fail_.clear();
+  term_at_.clear();
+  dict_.clear();
+  term_next_.clear();
+
+  // trie with ordered children while building
+  std::vector<std::map<uint8_t, int32_t>> kids(1);
+  std::vector<int32_t> term_at(1, -1);
+
+  for (const std::string& raw : terms) {
+    std::string_view t = raw;
+    Term info;
+    if (!t.empty() && t.front() == '*') { info.open_left = true;  t.remove_prefix(1); }
+    if (!t.empty() && t.back() == '*')  { info.open_right = true; t.remove_suffix(1); }
+    if (t.empty())
+      continue;
+
+    std::string folded(t);
+    fold_case(folded);
+
+    int32_t node = 0;
+    for (char ch : folded) {
+      auto [it, added] = kids[node].try_emplace((uint8_t)ch, (int32_t)kids.size());
+      if (added) {
+        kids.emplace_back();
+        term_at.push_back(-1);
+      }
+      node = it->second;
+    }
+
+    info.len = (uint32_t)folded.size();
+    const uint32_t id = (uint32_t)terms_.size();
+    terms_.push_back(info);
+
+    // several terms can end on one node ("spam" and "*spam*"): chain them
+    term_next_.push_back(term_at[node]);
+    term_at[node] = (int32_t)id;
+  }
+
+  const size_t nodes = kids.size();
+
+  // flatten children
+  edge_begin_.resize(nodes + 1);
+  for (size_t n = 0; n < nodes; ++n) {
+    edge_begin_[n] = (uint32_t)edges_.size();
+    for (const auto& [byte, to] : kids[n])
+      edges_.push_back({byte, to});
+  }
+  edge_begin_[nodes] = (uint32_t)edges_.size();
+
+  // failure + dictionary links, breadth first
+  fail_.assign(nodes, 0);
+  dict_.assign(nodes, -1);
+  term_at_ = std::move(term_at);
+
+  for (int c = 0; c < 256; ++c)
+    root_next_[c] = 0;
+
+  std::deque<int32_t> bfs;
+  for (const auto& [byte, to] : kids[0]) {
+    root_next_[byte] = to;
+    bfs.push_back(to);
+  }
+
+  while (!bfs.empty()) {
+    const int32_t u = bfs.front();
+    bfs.pop_front();
+
+    for (const auto& [byte, v] : kids[u]) {
+      fail_[v] = step(fail_[u], byte);
+      const int32_t f = fail_[v];
+      dict_[v] = (term_at_[f] >= 0) ? f : dict_[f];
+      bfs.push_back(v);
+    }
+  }
+}
+
+int32_t BlocklistMatcher::step(int32_t state, uint8_t c) const
+{
+  while (state != 0) {
+    const Edge* first = edges_.data() + edge_begin_[state];
+    const Edge* last = edges_.data() + edge_begin_[state + 1];
+    const Edge* e = std::lower_bound(first, last, c,
+                                     [](const Edge& a, uint8_t b) { return a.byte < b; });
+    if (e != last && e->byte == c)
+      return e->to;
+    state = fail_[state];
+  }
+  return root_next_[c];
+}
+
+bool BlocklistMatcher::scan(std::string_view text, std::vector<Hit>* out) const
+{
+  if (terms_.empty() || text.empty())
+    return false;
+
+  std::string folded(text);
+  fold_case(folded);
+
+  const uint8_t* d = (const uint8_t*)folded.data();
+  const size_t n = folded.size();
+
+  bool found = false;
+  int32_t state = 0;
+  for (size_t i = 0; i < n; ++i) {
+    state = step(state, d[i]);
+
+    for (int32_t node = (term_at_[state] >= 0) ? state : dict_[state]; node >= 0; node = dict_[node]) {
+      for (int32_t t = term_at_[node]; t >= 0; t = term_next_[t]) {
+        const Term& term = terms_[t];
+        const size_t end = i + 1;
+        const size_t begin = end - term.len;
+
+        if (!term.open_left && word_before(d, n, begin))
+          continue;
+        if (!term.open_right && word_after(d, n, end))
+          continue;
+
+        found = true;
+        if (!out)
+          return true;
+        out->push_back({begin, end, (uint32_t)t});
+      }
+    }
+  }
+  return found;
+}
+
+// ------------------------------------------------------------
+// Word list + masking
+// ------------------------------------------------------------
+bool load_word_list(const std::string& path, std::vector<std::string>& terms, std::string& error)
+{
+  std::ifstream f(path, std::ios::binary);
+  if (!f) {
+    error = "cannot open " + path;
+    return false;
+  }
+
+  terms.clear();
+  std::string line;
+  bool first = true;
+  while (std::getline(f, line)) {
+    if (first && line.compare(0, 3, "\xEF\xBB\xBF") == 0)
+      line.erase(0, 3); // UTF-8 BOM
+    first = false;
+
+    const size_t b = line.find_first_not_of(" \t\r");
+    if (b == std::string::npos || line[b] == '#')
+      continue;
+    const size_t e = line.find_last_not_of(" \t\r");
+    terms.push_back(line.substr(b, e - b + 1));
+  }
+  return true;
+}
+
+std::string mask_hits(std::string_view text, const std::vector<BlocklistMatcher::Hit>& hits)
+{
+  std::vector<bool> masked(text.size(), false);
+  for (const auto& h : hits)
+    for (size_t i = h.begin; i < h.end && i < text.size(); ++i)
+      masked[i] = true;
+
+  std::string out;
+  out.reserve(text.size());
+  for (size_t i = 0; i < text.size();) {
+    const uint8_t b = (uint8_t)text[i];
+    size_t len = (b < 0x80) ? 1 : (b >= 0xF0) ? 4 : (b >= 0xE0) ? 3 : (b >= 0xC0) ? 2 : 1;
+    len = std::min(len, text.size() - i);
+
+    bool hit = false;
+    for (size_t k = i; k < i + len; ++k)
+      hit = hit || masked[k];
+
+    if (hit)
+      out += '*';
+    else
+      out.append(text.substr(i, len));
+    i += len;
+  }
+  return out;
+}
+
+// ------------------------------------------------------------
+// Stage
+// ------------------------------------------------------------
+void ModerationStage::set(std::shared_ptr<const BlocklistMatcher> matcher, ModerationPolicy policy)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  matcher_ = std::move(matcher);
+  policy_ = policy;
+}
+
+void ModerationStage::set_hold_all(bool on)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  hold_all_ = on;
+}
+
+bool ModerationStage::active() const
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return hold_all_ || (matcher_ && !matcher_->empty());
+}
+
+ModerationVerdict ModerationStage::apply(TipEvent& ev) const
+{
+  std::shared_ptr<const BlocklistMatcher> matcher;
+  ModerationPolicy policy;
+  bool hold_all;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    matcher = matcher_;
+    policy = policy_;
+    hold_all = hold_all_;
+  }
+
+  // hold-all still runs the list first, so a held event shows up masked
+  // (or never shows up, under Drop)
+  const ModerationVerdict verdict = match(matcher.get(), policy, ev);
+  if (hold_all && (verdict == ModerationVerdict::Clean || verdict == ModerationVerdict::Masked))
+    return ModerationVerdict::Review;
+  return verdict;
+}
+
+ModerationVerdict ModerationStage::match(const BlocklistMatcher* matcher, ModerationPolicy policy,
+                                         TipEvent& ev)
+{
+  if (!matcher || matcher->empty())
+    return ModerationVerdict::Clean;
+
+  std::vector<BlocklistMatcher::Hit> user_hits, msg_hits;
+  const bool in_user = matcher->scan(ev.from_username(), policy == ModerationPolicy::Mask ? &user_hits : nullptr);
+  const bool in_msg = matcher->scan(ev.message(), policy == ModerationPolicy::Mask ? &msg_hits : nullptr);
+  if (!in_user && !in_msg)
+    return ModerationVerdict::Clean;
+
+  switch (policy) {
+  case ModerationPolicy::Drop:
+    return ModerationVerdict::Drop;
+  case ModerationPolicy::Hold:
+    return ModerationVerdict::Hold;
+  case ModerationPolicy::Mask:
+  default:
+    break;
+  }
+
+  // copies first: set_text rewrites the arena these views point into
+  const std::string user = mask_hits(ev.from_username(), user_hits);
+  const std::string amount(ev.amount_str());
+  const std::string message = mask_hits(ev.message(), msg_hits);
+  ev.set_text(user, amount, message);
+  return ModerationVerdict::Masked;
+}
+
+// ------------------------------------------------------------
+// Loader
+// ------------------------------------------------------------
+void WordListLoader::set_on_load(OnLoad cb)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  on_load_ = std::move(cb);
+}
+
+void WordListLoader::submit(std::string path, ModerationPolicy policy)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  pending_path_ = std::move(path);
+  pending_policy_ = policy;
+  pending_ = true;
+
+  if (!running_) {
+    tasks_.reopen();
+    running_ = tasks_.post([this]() { run(); });
+  }
+}
+
+uint64_t WordListLoader::loaded() const
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return loaded_;
+}
+
+void WordListLoader::stop()
+{
+  tasks_.cancel();
+
+  std::lock_guard<std::mutex> lk(mutex_);
+  running_ = false;
+  pending_ = false;
+  pending_path_.clear();
+}
+
+void WordListLoader::run()
+{
+  for (;;) {
+    std::string path;
+    ModerationPolicy policy;
+    OnLoad on_load;
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      if (!pending_) {
+        running_ = false;
+        return;
+      }
+      path = std::move(pending_path_);
+      pending_path_.clear();
+      policy = pending_policy_;
+      pending_ = false;
+      on_load = on_load_;
+    }
+
+    std::shared_ptr<BlocklistMatcher> matcher;
+    std::string error;
+    if (!path.empty()) {
+      std::vector<std::string> terms;
+      if (load_word_list(path, terms, error)) {
+        matcher = std::make_shared<BlocklistMatcher>();
+        matcher->build(terms);
+      }
+    }
+
+    const size_t terms = matcher ? matcher->term_count() : 0;
+    stage_.set(std::move(matcher), policy);
+    terms_.store(terms, std::memory_order_relaxed);
+    if (on_load && !path.empty())
+      on_load(path, terms, error);
+
+    std::lock_guard<std::mutex> lk(mutex_);
+    loaded_++;
+  }
+}
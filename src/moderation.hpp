@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "event_parse.hpp"
+#include "worker_pool.hpp"
+
+// Multi-term matcher (Aho-Corasick) for a moderation word list.
+//
+// Built once from the list, then each scan is one pass over the text:
+// O(text + matches), independent of the number of terms. Matching is
+// case-insensitive for ASCII, Latin-1, Greek and Cyrillic letters (their
+// folds keep the UTF-8 byte length, so hit offsets index the original).
+//
+// Terms match whole words by default; a leading or trailing '*' lets that
+// side run into other letters ("*spam*" also hits "spammer").
+class BlocklistMatcher {
+public:
+  struct Hit {
+    size_t   begin = 0; // byte range in the scanned text
+    size_t   end = 0;
+    uint32_t term = 0;  // index into the build() list
+  };
+
+  // Empty terms (after trimming '*') are skipped
+  void build(const std::vector<std::string>& terms);
+
+  size_t term_count() const { return terms_.size(); }
+  bool empty() const { return terms_.empty(); }
+
+  // Appends hits to `out` (not cleared); false when nothing matched
+  bool scan(std::string_view text, std::vector<Hit>* out = nullptr) const;
+
+private:
+  struct Term {
+    uint32_t len = 0;
+    bool     open_left = false;  // '*' prefix
+    bool     open_right = false; // '*' suffix
+  };
+
+  struct Edge {
+    uint8_t byte;
+    int32_t to;
+  };
+
+  int32_t step(int32_t state, uint8_t c) const;
+
+  std::vector<Term> terms_;
+
+  // flattened trie: node n owns edges_[edge_begin_[n] .. edge_begin_[n + 1]), sorted by byte
+  std::vector<uint32_t> edge_begin_;
+  std::vector<Edge>     edges_;
+  std::vector<int32_t>  fail_;
+  std::vector<int32_t>  term_at_; // term ending at this node, -1 if none
+  std::vector<int32_t>  dict_;    // nearest fail-chain node with a term, -1 if none
+  std::vector<int32_t>  term_next_; // next term ending on the same node, -1 if none
+  int32_t               root_next_[256] = {};
+};
+
+// Word list file: one term per line (UTF-8), '#' starts a comment line.
+bool load_word_list(const std::string& path, std::vector<std::string>& terms, std::string& error);
+
+// Replaces every code point inside a hit with '*'
+std::string mask_hits(std::string_view text, const std::vector<BlocklistMatcher::Hit>& hits);
+
+enum class ModerationPolicy : int {
+  Mask = 0, // star out the matched words, play the alert
+  Drop = 1, // discard the event
+  Hold = 2, // park it until someone approves it
+};
+
+enum class ModerationVerdict {
+  Clean,
+  Masked,
+  Drop,
+  Hold,   // word list hit: wait for a person
+  Review, // hold-all mode, nothing (left) to object to: may auto-approve
+};
+
+// Word list + policy, swapped by the UI thread and applied on the TDLib
+// thread. Checks both the username and the message.
+class ModerationStage {
+public:
+  void set(std::shared_ptr<const BlocklistMatcher> matcher, ModerationPolicy policy);
+
+  // Hold every event that the word list lets through, for manual approval
+  void set_hold_all(bool on);
+
+  bool active() const;
+
+  // Masks `ev` in place under ModerationPolicy::Mask
+  ModerationVerdict apply(TipEvent& ev) const;
+
+private:
+  static ModerationVerdict match(const BlocklistMatcher* matcher, ModerationPolicy policy, TipEvent& ev);
+
+  mutable std::mutex mutex_;
+  std::shared_ptr<const BlocklistMatcher> matcher_;
+  ModerationPolicy policy_ = ModerationPolicy::Mask;
+  bool hold_all_ = false;
+};
+
+// Reads word lists and builds their matchers on the shared worker pool, then
+// swaps each into `stage`, so neither the video thread (settings update) nor
+// the UI thread (reload button) reads the file or builds the automaton.
+// submit() takes the latest list; a newer one replaces one not started yet,
+// and lists are applied in submit order. An empty path turns the list off.
+class WordListLoader {
+public:
+  // Worker thread, once per list: its term count, or an error
+  using OnLoad = std::function<void(const std::string& path, size_t terms, const std::string& error)>;
+
+  explicit WordListLoader(ModerationStage& stage) : stage_(stage) {}
+  ~WordListLoader() { stop(); }
+
+  WordListLoader(const WordListLoader&) = delete;
+  WordListLoader& operator=(const WordListLoader&) = delete;
+
+  void set_on_load(OnLoad cb);
+
+  void submit(std::string path, ModerationPolicy policy);
+
+  // Lock-free: terms in the list the stage applies now (0 = no list)
+  size_t terms() const { return terms_.load(std::memory_order_relaxed); }
+
+  // Lists built since the loader started
+  uint64_t loaded() const;
+
+  void stop();
+
+private:
+  void run();
+
+  ModerationStage& stage_;
+
+  mutable std::mutex mutex_;
+  TaskGroup tasks_;
+  bool running_ = false; // a task is draining requests
+
+  bool pending_ = false;
+  std::string pending_path_;
+  ModerationPolicy pending_policy_ = ModerationPolicy::Mask;
+
+  std::atomic<size_t> terms_{0};
+  uint64_t loaded_ = 0;
+  OnLoad on_load_;
+};
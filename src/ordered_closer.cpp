@@ -0,0 +1,75 @@
+#include "ordered_closer.hpp"
+
+#include <algorithm>
+
+uint64_t OrderedCloser::open(const std::string& name)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  const uint64_t generation = ++next_generation_;
+  live_.emplace(name, generation);
+  return generation;
+}
+
+void OrderedCloser::close(const std::string& name, uint64_t generation, std::function<void()> fn)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  reap_locked();
+
+  closing_++;
+  Closer& c = closers_.emplace_back();
+  c.thread = std::thread([this, &c, name, generation, fn = std::move(fn)] {
+    fn();
+
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto [first, last] = live_.equal_range(name);
+    for (auto it = first; it != last; ++it) {
+      if (it->second == generation) {
+        live_.erase(it);
+        break;
+      }
+    }
+    closing_--;
+    c.done = true;
+    cv_.notify_all();
+  });
+}
+
+void OrderedCloser::wait_closed_before(const std::string& name, uint64_t generation)
+{
+  std::unique_lock<std::mutex> lk(mutex_);
+  cv_.wait(lk, [&] {
+    auto [first, last] = live_.equal_range(name);
+    return std::none_of(first, last, [generation](const auto& e) { return e.second < generation; });
+  });
+}
+
+size_t OrderedCloser::closing() const
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return closing_;
+}
+
+void OrderedCloser::wait_all()
+{
+  std::list<Closer> closers;
+  {
+    std::unique_lock<std::mutex> lk(mutex_);
+    cv_.wait(lk, [this] { return closing_ == 0; });
+    closers.swap(closers_);
+  }
+  for (Closer& c : closers)
+    c.thread.join();
+}
+
+// Joins closers that are done (each is past its last use of mutex_); mutex_ held
+void OrderedCloser::reap_locked()
+{
+  for (auto it = closers_.begin(); it != closers_.end();) {
+    if (it->done) {
+      it->thread.join();
+      it = closers_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
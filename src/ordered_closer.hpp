@@ -0,0 +1,58 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Closes named instances (one per Telegram account login) on threads of
+// their own, so the last reference can go away on any thread without
+// waiting for the close.
+//
+// Each instance is registered when it is created and gets a generation.
+// wait_closed_before() waits only for instances of the same name created
+// earlier, never for the caller's own instance or later ones: a closer
+// that joins a starter waiting here cannot wait on itself.
+class OrderedCloser {
+public:
+  OrderedCloser() = default;
+  ~OrderedCloser() { wait_all(); }
+
+  OrderedCloser(const OrderedCloser&) = delete;
+  OrderedCloser& operator=(const OrderedCloser&) = delete;
+
+  // A new instance of `name`; returns its generation
+  uint64_t open(const std::string& name);
+
+  // Runs `fn` (the instance's teardown) on a tracked thread; the instance
+  // counts as live until `fn` returns
+  void close(const std::string& name, uint64_t generation, std::function<void()> fn);
+
+  // Blocks while an instance of `name` older than `generation` is live
+  void wait_closed_before(const std::string& name, uint64_t generation);
+
+  // Instances closing right now
+  size_t closing() const;
+
+  // Waits for every close started so far and joins the threads (unload)
+  void wait_all();
+
+private:
+  struct Closer {
+    std::thread thread;
+    bool done = false; // guarded by mutex_
+  };
+
+  void reap_locked();
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  uint64_t next_generation_ = 0;
+  std::multimap<std::string, uint64_t> live_; // name -> generations not yet closed
+  size_t closing_ = 0;
+  std::list<Closer> closers_;                 // joined on the next close, or in wait_all()
+};
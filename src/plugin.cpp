@@ -1,4 +1,5 @@
 #include <obs-module.h>
+#include "telegram_accounts.hpp"
 #include "tip_alert_source.hpp"
 
 OBS_DECLARE_MODULE()
@@ -15,6 +16,13 @@ bool obs_module_load(void)
   return true;
 }
 
+// Accounts released by the last sources close on their own threads;
+// they must be done before the module's code goes away
+void obs_module_unload(void)
+{
+  close_telegram_accounts();
+}
+
 const char* obs_module_description(void)
 {
   return "TWICH Telegram Tip Alerts";
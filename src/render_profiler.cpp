@@ -0,0 +1,167 @@
+#include "render_profiler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+static constexpr const char* kSectionNames[kProfileSectionCount] = {
+  "tick", "render", "child_update", "media_restart", "text_raster",
+};
+
+const char* profile_section_name(ProfileSection s)
+{
+  return kSectionNames[(int)s];
+}
+
+void RenderProfiler::configure(bool enabled, const std::string& trace_path)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+
+  if (enabled != enabled_.load()) {
+    for (int i = 0; i < kProfileSectionCount; ++i) {
+      cpu_[i] = Ring();
+      gpu_[i] = Ring();
+    }
+  }
+
+  const std::string path = enabled ? trace_path : std::string();
+  if (path != trace_path_) {
+    if (trace_.is_open())
+      trace_.close();
+
+    trace_path_ = path;
+    if (!trace_path_.empty()) {
+      trace_.open(trace_path_, std::ios::out | std::ios::trunc);
+      if (trace_.is_open())
+        trace_ << "frame,section,cpu_us,gpu_us\n";
+    }
+  }
+
+  enabled_.store(enabled);
+}
+
+void RenderProfiler::push(Ring& r, uint64_t ns)
+{
+  r.samples[r.next] = (uint32_t)std::min<uint64_t>(ns, UINT32_MAX);
+  r.next = (r.next + 1) % kWindow;
+  r.count++;
+}
+
+void RenderProfiler::trace_locked(ProfileSection s, const char* cpu, const char* gpu)
+{
+  if (!trace_.is_open())
+    return;
+
+  // buffered; the stream flushes itself and on close
+  trace_ << frame_.load(std::memory_order_relaxed) << ',' << profile_section_name(s) << ','
+         << cpu << ',' << gpu << '\n';
+}
+
+void RenderProfiler::record_cpu(ProfileSection s, uint64_t ns)
+{
+  if (!enabled())
+    return;
+
+  std::lock_guard<std::mutex> lk(mutex_);
+  push(cpu_[(int)s], ns);
+
+  if (trace_.is_open()) {
+    char us[32];
+    snprintf(us, sizeof(us), "%.3f", ns / 1000.0);
+    trace_locked(s, us, "");
+  }
+}
+
+void RenderProfiler::record_gpu(ProfileSection s, uint64_t ns)
+{
+  if (!enabled())
+    return;
+
+  std::lock_guard<std::mutex> lk(mutex_);
+  push(gpu_[(int)s], ns);
+
+  if (trace_.is_open()) {
+    char us[32];
+    snprintf(us, sizeof(us), "%.3f", ns / 1000.0);
+    trace_locked(s, "", us);
+  }
+}
+
+ProfileStats RenderProfiler::stats_of(const Ring& r)
+{
+  ProfileStats st;
+  st.count = r.count;
+
+  const size_t n = (size_t)std::min<uint64_t>(r.count, kWindow);
+  if (n == 0)
+    return st;
+
+  std::vector<uint32_t> v(r.samples, r.samples + n);
+
+  // Ascending quantiles: after nth_element(k) everything past k is >= v[k],
+  // so each later search only partitions the tail.
+  size_t lo = 0;
+  auto pct = [&](double q) {
+    const size_t k = std::max(lo, std::min(n - 1, (size_t)(q * (double)(n - 1) + 0.5)));
+    std::nth_element(v.begin() + lo, v.begin() + k, v.end());
+    lo = k;
+    return v[k] / 1000.0;
+  };
+
+  st.p50_us = pct(0.50);
+  st.p95_us = pct(0.95);
+  st.p99_us = pct(0.99);
+  st.max_us = *std::max_element(v.begin() + lo, v.end()) / 1000.0;
+  return st;
+}
+
+ProfileStats RenderProfiler::cpu_stats(ProfileSection s) const
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return stats_of(cpu_[(int)s]);
+}
+
+ProfileStats RenderProfiler::gpu_stats(ProfileSection s) const
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return stats_of(gpu_[(int)s]);
+}
+
+std::string RenderProfiler::summary() const
+{
+  if (!enabled())
+    return "Profiler off";
+
+  std::string out = "section: p50 / p95 / p99 / max (us), samples\n";
+  char line[160];
+
+  double frame_p99_us = 0.0;
+
+  for (int i = 0; i < kProfileSectionCount; ++i) {
+    const ProfileStats c = cpu_stats((ProfileSection)i);
+    const ProfileStats g = gpu_stats((ProfileSection)i);
+    if (!c.count && !g.count)
+      continue;
+
+    if (c.count) {
+      snprintf(line, sizeof(line), "%s cpu: %.1f / %.1f / %.1f / %.1f, %llu\n",
+               kSectionNames[i], c.p50_us, c.p95_us, c.p99_us, c.max_us,
+               (unsigned long long)c.count);
+      out += line;
+    }
+    if (g.count) {
+      snprintf(line, sizeof(line), "%s gpu: %.1f / %.1f / %.1f / %.1f, %llu\n",
+               kSectionNames[i], g.p50_us, g.p95_us, g.p99_us, g.max_us,
+               (unsigned long long)g.count);
+      out += line;
+    }
+
+    if (i == (int)ProfileSection::Tick || i == (int)ProfileSection::Render)
+      frame_p99_us += c.p99_us + g.p99_us;
+  }
+
+  snprintf(line, sizeof(line), "p99 tick+render: %.1f%% of a 16.6 ms frame",
+           frame_p99_us / 16666.7 * 100.0);
+  out += line;
+  return out;
+}
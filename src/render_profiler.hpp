@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+// Timed sections of the video path
+enum class ProfileSection : uint8_t {
+  Tick         = 0, // whole video_tick
+  Render       = 1, // whole video_render
+  ChildUpdate  = 2, // obs_source_update on a child (media/sound/text)
+  MediaRestart = 3, // obs_source_media_restart on media/sound
+  TextRaster   = 4, // alert text rasterized: new atlas glyphs + upload, or the text child's texture
+};
+constexpr int kProfileSectionCount = 5;
+
+const char* profile_section_name(ProfileSection s);
+
+// Rolling percentiles over the last kWindow samples, in microseconds
+struct ProfileStats {
+  uint64_t count = 0; // samples since enabled (not just the window)
+  double   p50_us = 0.0;
+  double   p95_us = 0.0;
+  double   p99_us = 0.0;
+  double   max_us = 0.0;
+};
+
+// Per-section CPU (and optional GPU) timings for the tip alert source.
+// Samples land in fixed ring buffers; percentiles are only computed when a
+// readout is requested, so recording costs a lock and two stores.
+// Optionally appends every sample to a CSV trace:
+//   frame,section,cpu_us,gpu_us   (gpu_us empty when not measured)
+class RenderProfiler {
+public:
+  static constexpr size_t kWindow = 512;
+
+  using Clock = std::chrono::steady_clock;
+
+  RenderProfiler() = default;
+
+  RenderProfiler(const RenderProfiler&) = delete;
+  RenderProfiler& operator=(const RenderProfiler&) = delete;
+
+  // Disabling drops collected samples; an empty trace path closes the file.
+  void configure(bool enabled, const std::string& trace_path);
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // Call once per video_tick so trace rows can be grouped by frame
+  void next_frame() { if (enabled()) frame_.fetch_add(1, std::memory_order_relaxed); }
+
+  void record_cpu(ProfileSection s, uint64_t ns);
+  void record_gpu(ProfileSection s, uint64_t ns);
+
+  ProfileStats cpu_stats(ProfileSection s) const;
+  ProfileStats gpu_stats(ProfileSection s) const;
+
+  // Multi-line readout for the properties panel, with the share of a
+  // 60 fps frame (16.6 ms) that the p99 tick + render takes.
+  std::string summary() const;
+
+private:
+  struct Ring {
+    uint32_t samples[kWindow] = {}; // nanoseconds, saturated
+    size_t   next = 0;
+    uint64_t count = 0;
+  };
+
+  static void push(Ring& r, uint64_t ns);
+  static ProfileStats stats_of(const Ring& r);
+  void trace_locked(ProfileSection s, const char* cpu, const char* gpu);
+
+  std::atomic<bool> enabled_{false}; // written by update, read on the graphics thread
+  std::atomic<uint64_t> frame_{0};
+
+  mutable std::mutex mutex_;
+  Ring cpu_[kProfileSectionCount];
+  Ring gpu_[kProfileSectionCount];
+
+  std::string   trace_path_;
+  std::ofstream trace_;
+};
+
+// Times one CPU section; free when the profiler is disabled.
+class ProfileScope {
+public:
+  ProfileScope(RenderProfiler& p, ProfileSection s)
+    : p_(p.enabled() ? &p : nullptr), s_(s)
+  {
+    if (p_) t0_ = RenderProfiler::Clock::now();
+  }
+
+  ~ProfileScope()
+  {
+    if (!p_) return;
+    const auto dt = RenderProfiler::Clock::now() - t0_;
+    p_->record_cpu(s_, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count());
+  }
+
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+  RenderProfiler* p_;
+  ProfileSection s_;
+  RenderProfiler::Clock::time_point t0_;
+};
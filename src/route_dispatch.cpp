@@ -0,0 +1,136 @@
+#include "route_dispatch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+#include <obs-module.h>
+#ifdef TWICH_HAVE_FRONTEND
+#include <obs-frontend-api.h>
+#endif
+
+#include "config.hpp"
+
+namespace {
+
+std::mutex g_mutex; // guards everything below
+bool g_loaded = false;
+std::shared_ptr<const RouteTable> g_routes;
+std::string g_status = "Routing: not loaded";
+
+} // namespace
+
+std::string routes_path()
+{
+  std::string cfg = twich_config_path();
+  auto pos = cfg.find_last_of("\\/");
+  std::string folder = (pos == std::string::npos) ? "." : cfg.substr(0, pos + 1);
+  return folder + "routes.json";
+}
+
+bool reload_routes(std::string& error)
+{
+  const std::string path = routes_path();
+  const auto t0 = std::chrono::steady_clock::now();
+
+  std::ifstream f(path, std::ios::binary);
+  if (!f.good()) {
+    std::lock_guard<std::mutex> lk(g_mutex);
+    g_loaded = true;
+    g_routes.reset();
+    g_status = "Routing: no routes.json, every source shows every event";
+    error.clear();
+    return true;
+  }
+
+  std::stringstream ss;
+  ss << f.rdbuf();
+
+  RouteSet set;
+  auto table = std::make_shared<RouteTable>();
+  if (!parse_route_set(ss.str(), set, error) || !table->build(std::move(set), error)) {
+    blog(LOG_WARNING, "[TWICH] %s: %s", path.c_str(), error.c_str());
+    std::lock_guard<std::mutex> lk(g_mutex);
+    g_loaded = true;
+    g_status = "Routing: routes.json NOT loaded (" + error + "), " +
+               (g_routes ? "previous rules kept" : "every source shows every event");
+    return false;
+  }
+
+  const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+  char buf[160];
+  snprintf(buf, sizeof(buf), "Routing: %zu rule(s) to %zu source(s), loaded in %.1f ms",
+           table->size(), table->target_count(), ms);
+  blog(LOG_INFO, "[TWICH] %s (%s)", buf, path.c_str());
+
+  std::lock_guard<std::mutex> lk(g_mutex);
+  g_loaded = true;
+  g_routes = table->empty() ? nullptr : std::move(table);
+  g_status = buf;
+  return true;
+}
+
+std::shared_ptr<const RouteTable> current_routes()
+{
+  {
+    std::lock_guard<std::mutex> lk(g_mutex);
+    if (g_loaded)
+      return g_routes;
+  }
+
+  std::string error;
+  reload_routes(error);
+
+  std::lock_guard<std::mutex> lk(g_mutex);
+  return g_routes;
+}
+
+std::string routes_status()
+{
+  current_routes();
+  std::lock_guard<std::mutex> lk(g_mutex);
+  return g_status;
+}
+
+// UI thread: owns `param` (the scene name)
+static void switch_scene_task(void* param)
+{
+  std::unique_ptr<std::string> name((std::string*)param);
+
+#ifdef TWICH_HAVE_FRONTEND
+  obs_source_t* scene = obs_get_source_by_name(name->c_str());
+  if (scene && obs_source_is_scene(scene)) {
+    blog(LOG_INFO, "[TWICH] routing: switching to scene '%s'", name->c_str());
+    obs_frontend_set_current_scene(scene);
+  } else {
+    blog(LOG_WARNING, "[TWICH] routing: no scene named '%s'", name->c_str());
+  }
+  obs_source_release(scene);
+#else
+  blog(LOG_WARNING, "[TWICH] routing: scene '%s' not switched (built without the frontend API)", name->c_str());
+#endif
+}
+
+RouteDecision route_event(const TipEvent& ev)
+{
+  RouteDecision d;
+  d.table = current_routes();
+  if (!d.table)
+    return d;
+
+  d.table->evaluate(ev, d.match);
+
+  // once per loaded table: a "continue" chain longer than a match holds
+  static std::atomic<const RouteTable*> warned{nullptr};
+  if (d.match.truncated && warned.exchange(d.table.get()) != d.table.get())
+    blog(LOG_WARNING, "[TWICH] routing: an event reached %d matching rules; rules below '%s' were not checked",
+         RouteMatch::kMaxRules, d.table->rule(d.match.rules[RouteMatch::kMaxRules - 1]).name.c_str());
+
+  const std::string_view scene = d.table->scene(d.match);
+  if (!scene.empty())
+    obs_queue_task(OBS_TASK_UI, switch_scene_task, new std::string(scene), false);
+
+  return d;
+}
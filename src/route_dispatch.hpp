@@ -0,0 +1,27 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "event_router.hpp"
+
+// Process-wide routing rules from routes.json next to config.json.
+// Each event is evaluated once, on its account's TDLib thread (see
+// TelegramAccount::dispatch); sources then keep or skip it by name.
+
+// Full path of routes.json
+std::string routes_path();
+
+// (Re)reads routes.json. A missing file means no rules. False with
+// `error` (the rules in use stay) when it cannot be parsed.
+bool reload_routes(std::string& error);
+
+// Rules in use: loaded on first call, nullptr when there are none
+std::shared_ptr<const RouteTable> current_routes();
+
+// One-line summary for the properties panel
+std::string routes_status();
+
+// Routes one event: evaluates it and runs the frontend actions of the
+// match (scene switch, queued to the UI thread)
+RouteDecision route_event(const TipEvent& ev);
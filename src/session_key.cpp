@@ -0,0 +1,516 @@
+#include "session_key.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <bcrypt.h>
+#include <dpapi.h>
+#else
+#include <fcntl.h>
+#include <sys/random.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __APPLE__
+#include <Security/Security.h>
+#endif
+
+#ifdef TWICH_HAVE_LIBSECRET
+#include <libsecret/secret.h>
+#endif
+
+static const char* kB64 = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+std::string base64_encode(const uint8_t* data, size_t len)
+{
+  std::string out;
+  out.reserve((len + 2) / 3 * 4);
+  for (size_t i = 0; i < len; i += 3) {
+    const uint32_t v = (uint32_t)data[i] << 16 |
+                       (i + 1 < len ? (uint32_t)data[i + 1] << 8 : 0) |
+                       (i + 2 < len ? (uint32_t)data[i + 2] : 0);
+    out += kB64[(v >> 18) & 63];
+    out += kB64[(v >> 12) & 63];
+    out += i + 1 < len ? kB64[(v >> 6) & 63] : '=';
+    out += i + 2 < len ? kB64[v & 63] : '=';
+  }
+  return out;
+}
+
+[[maybe_unused]] static bool base64_decode(const std::string& in, std::vector<uint8_t>& out)
+{
+  out.clear();
+  uint32_t acc = 0;
+  int bits = 0;
+  for (char c : in) {
+    if (c == '=')
+      break;
+    const char* p = strchr(kB64, c);
+    if (!p || !c)
+      return false;
+    acc = (acc << 6) | (uint32_t)(p - kB64);
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      out.push_back((uint8_t)(acc >> bits));
+    }
+  }
+  return true;
+}
+
+// -------------------- random key --------------------
+static constexpr size_t kKeyBytes = 32;
+
+static bool random_key(std::vector<uint8_t>& key, std::string& error)
+{
+  key.resize(kKeyBytes);
+#ifdef _WIN32
+  if (BCryptGenRandom(nullptr, key.data(), (ULONG)key.size(), BCRYPT_USE_SYSTEM_PREFERRED_RNG) < 0) {
+    error = "the system random number generator failed";
+    return false;
+  }
+#else
+  if (getentropy(key.data(), key.size()) != 0) {
+    error = "the system random number generator failed";
+    return false;
+  }
+#endif
+  return true;
+}
+
+// -------------------- key file --------------------
+// "TWK2", one byte naming the store, then what that store keeps in the file:
+//   'D'  DPAPI blob of the key
+//   'C'  nothing: the key is a Keychain item named by the file's path
+//   'R'  nothing: the key is a Secret Service item named by the file's path
+//   'F'  the key itself (no keystore available)
+// "TWK1" files, written before the keystores, hold a DPAPI blob on Windows
+// and the bare key elsewhere.
+static constexpr char kMagicV1[4] = {'T', 'W', 'K', '1'};
+static constexpr char kMagicV2[4] = {'T', 'W', 'K', '2'};
+
+static bool read_file(const std::string& path, std::vector<uint8_t>& data)
+{
+  std::ifstream f(path, std::ios::binary);
+  if (!f)
+    return false;
+  data.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+  return true;
+}
+
+// Written aside and renamed, so a crash never leaves half a key file
+static bool write_file(const std::string& path, const std::vector<uint8_t>& data, std::string& error)
+{
+  const std::string tmp = path + ".tmp";
+#ifdef _WIN32
+  {
+    std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+    f.write((const char*)data.data(), (std::streamsize)data.size());
+    if (!f) {
+      error = "cannot write " + tmp;
+      return false;
+    }
+  }
+  if (!MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+    error = "cannot replace " + path;
+    return false;
+  }
+#else
+  const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  if (fd < 0) {
+    error = "cannot create " + tmp;
+    return false;
+  }
+  ::fchmod(fd, 0600); // an older file may have kept wider bits
+  const bool ok = ::write(fd, data.data(), data.size()) == (ssize_t)data.size() && ::fsync(fd) == 0;
+  ::close(fd);
+  if (!ok || ::rename(tmp.c_str(), path.c_str()) != 0) {
+    ::unlink(tmp.c_str());
+    error = "cannot write " + path;
+    return false;
+  }
+#endif
+  return true;
+}
+
+// -------------------- keystores --------------------
+#ifdef _WIN32
+static bool dpapi_seal(const std::vector<uint8_t>& plain, std::vector<uint8_t>& sealed, std::string& error)
+{
+  DATA_BLOB in = {(DWORD)plain.size(), (BYTE*)plain.data()};
+  DATA_BLOB blob = {};
+  if (!CryptProtectData(&in, L"TWICH session key", nullptr, nullptr, nullptr, CRYPTPROTECT_UI_FORBIDDEN, &blob)) {
+    error = "DPAPI could not seal the key (error " + std::to_string(GetLastError()) + ")";
+    return false;
+  }
+  sealed.assign(blob.pbData, blob.pbData + blob.cbData);
+  LocalFree(blob.pbData);
+  return true;
+}
+
+static bool dpapi_unseal(const uint8_t* sealed, size_t len, std::vector<uint8_t>& plain, std::string& error)
+{
+  DATA_BLOB in = {(DWORD)len, (BYTE*)sealed};
+  DATA_BLOB blob = {};
+  if (!CryptUnprotectData(&in, nullptr, nullptr, nullptr, nullptr, CRYPTPROTECT_UI_FORBIDDEN, &blob)) {
+    error = "DPAPI could not unseal the key (another Windows user?)";
+    return false;
+  }
+  plain.assign(blob.pbData, blob.pbData + blob.cbData);
+  SecureZeroMemory(blob.pbData, blob.cbData);
+  LocalFree(blob.pbData);
+  return true;
+}
+#endif
+
+#ifdef __APPLE__
+// Generic password item: service "TWICH session key", account = key file path
+static CFMutableDictionaryRef keychain_query(const std::string& path)
+{
+  CFMutableDictionaryRef q = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, &kCFTypeDictionaryKeyCallBacks,
+                                                       &kCFTypeDictionaryValueCallBacks);
+  CFStringRef account = CFStringCreateWithCString(kCFAllocatorDefault, path.c_str(), kCFStringEncodingUTF8);
+  CFDictionarySetValue(q, kSecClass, kSecClassGenericPassword);
+  CFDictionarySetValue(q, kSecAttrService, CFSTR("TWICH session key"));
+  CFDictionarySetValue(q, kSecAttrAccount, account);
+  CFRelease(account);
+  return q;
+}
+
+static bool keychain_store(const std::string& path, const std::vector<uint8_t>& key, std::string& error)
+{
+  CFMutableDictionaryRef q = keychain_query(path);
+  SecItemDelete(q); // a stale item from a deleted key file
+
+  CFDataRef value = CFDataCreate(kCFAllocatorDefault, key.data(), (CFIndex)key.size());
+  CFDictionarySetValue(q, kSecValueData, value);
+  const OSStatus st = SecItemAdd(q, nullptr);
+  CFRelease(value);
+  CFRelease(q);
+
+  if (st != errSecSuccess) {
+    error = "Keychain refused the key (OSStatus " + std::to_string((int)st) + ")";
+    return false;
+  }
+  return true;
+}
+
+static bool keychain_load(const std::string& path, std::vector<uint8_t>& key, std::string& error)
+{
+  CFMutableDictionaryRef q = keychain_query(path);
+  CFDictionarySetValue(q, kSecReturnData, kCFBooleanTrue);
+  CFDictionarySetValue(q, kSecMatchLimit, kSecMatchLimitOne);
+
+  CFTypeRef result = nullptr;
+  const OSStatus st = SecItemCopyMatching(q, &result);
+  CFRelease(q);
+
+  if (st != errSecSuccess || !result) {
+    error = "the session key is missing from the Keychain (OSStatus " + std::to_string((int)st) + ")";
+    return false;
+  }
+  CFDataRef data = (CFDataRef)result;
+  const uint8_t* p = CFDataGetBytePtr(data);
+  key.assign(p, p + CFDataGetLength(data));
+  CFRelease(result);
+  return true;
+}
+
+static void keychain_delete(const std::string& path)
+{
+  CFMutableDictionaryRef q = keychain_query(path);
+  SecItemDelete(q);
+  CFRelease(q);
+}
+#endif
+
+#ifdef TWICH_HAVE_LIBSECRET
+static const SecretSchema* keyring_schema()
+{
+  static const SecretSchema schema = {
+    "org.twich.TipAlert.SessionKey", SECRET_SCHEMA_NONE,
+    {{"key_file", SECRET_SCHEMA_ATTRIBUTE_STRING}, {nullptr, SECRET_SCHEMA_ATTRIBUTE_STRING}},
+    0, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  };
+  return &schema;
+}
+
+static std::string take_gerror(GError* err)
+{
+  std::string msg = err && err->message ? err->message : "unknown error";
+  if (err)
+    g_error_free(err);
+  return msg;
+}
+
+static bool keyring_store(const std::string& path, const std::vector<uint8_t>& key, std::string& error)
+{
+  const std::string secret = base64_encode(key.data(), key.size());
+  GError* err = nullptr;
+  const gboolean ok = secret_password_store_sync(keyring_schema(), SECRET_COLLECTION_DEFAULT, "TWICH session key",
+                                                 secret.c_str(), nullptr, &err, "key_file", path.c_str(), nullptr);
+  if (!ok) {
+    error = "Secret Service refused the key: " + take_gerror(err);
+    return false;
+  }
+  return true;
+}
+
+static bool keyring_load(const std::string& path, std::vector<uint8_t>& key, std::string& error)
+{
+  GError* err = nullptr;
+  gchar* secret = secret_password_lookup_sync(keyring_schema(), nullptr, &err, "key_file", path.c_str(), nullptr);
+  if (!secret) {
+    error = err ? "the keyring is not available: " + take_gerror(err)
+                : std::string("the session key is missing from the keyring");
+    return false;
+  }
+  const bool ok = base64_decode(secret, key);
+  secret_password_free(secret);
+  if (!ok) {
+    error = "the keyring's session key is damaged";
+    return false;
+  }
+  return true;
+}
+
+static void keyring_delete(const std::string& path)
+{
+  secret_password_clear_sync(keyring_schema(), nullptr, nullptr, "key_file", path.c_str(), nullptr);
+}
+#endif
+
+// The key for `path` from its file (and keystore). False with `error`
+// empty when there is no key file.
+static bool load_key(const std::string& path, std::vector<uint8_t>& key, SessionKey::Protection& prot,
+                     std::string& error)
+{
+  std::vector<uint8_t> data;
+  if (!read_file(path, data))
+    return false;
+
+  char store = 0;
+  size_t header = 0;
+  if (data.size() >= sizeof(kMagicV1) && memcmp(data.data(), kMagicV1, sizeof(kMagicV1)) == 0) {
+#ifdef _WIN32
+    store = 'D';
+#else
+    store = 'F';
+#endif
+    header = sizeof(kMagicV1);
+  } else if (data.size() > sizeof(kMagicV2) && memcmp(data.data(), kMagicV2, sizeof(kMagicV2)) == 0) {
+    store = (char)data[sizeof(kMagicV2)];
+    header = sizeof(kMagicV2) + 1;
+  } else {
+    error = "key file " + path + " is not a TWICH key";
+    return false;
+  }
+  const uint8_t* payload = data.data() + header;
+  const size_t len = data.size() - header;
+
+  bool ok = false;
+  switch (store) {
+  case 'F':
+    key.assign(payload, payload + len);
+    prot = SessionKey::Protection::PlainFile;
+    ok = true;
+    break;
+#ifdef _WIN32
+  case 'D':
+    prot = SessionKey::Protection::Dpapi;
+    ok = dpapi_unseal(payload, len, key, error);
+    break;
+#endif
+#ifdef __APPLE__
+  case 'C':
+    prot = SessionKey::Protection::Keychain;
+    ok = keychain_load(path, key, error);
+    break;
+#endif
+#ifdef TWICH_HAVE_LIBSECRET
+  case 'R':
+    prot = SessionKey::Protection::Keyring;
+    ok = keyring_load(path, key, error);
+    break;
+#endif
+  default:
+    error = "key file " + path + " points to a keystore this system does not have";
+    return false;
+  }
+
+  if (ok && key.size() != kKeyBytes) {
+    error = "key file " + path + " is damaged";
+    return false;
+  }
+  return ok;
+}
+
+#if defined(__APPLE__) || defined(TWICH_HAVE_LIBSECRET)
+static constexpr bool kHaveKeystore = true;
+#else
+static constexpr bool kHaveKeystore = false;
+#endif
+
+// Puts the key in the best store this system has; the file is written last.
+// Off Windows a keystore that refuses the key (headless box, locked
+// keyring) leaves a plain 0600 file, with `note` saying why.
+static bool store_key(const std::string& path, const std::vector<uint8_t>& key, SessionKey::Protection& prot,
+                      std::string& note, std::string& error)
+{
+  std::vector<uint8_t> data(kMagicV2, kMagicV2 + sizeof(kMagicV2));
+
+#if defined(_WIN32)
+  (void)note;
+  std::vector<uint8_t> sealed;
+  if (!dpapi_seal(key, sealed, error))
+    return false;
+  data.push_back('D');
+  data.insert(data.end(), sealed.begin(), sealed.end());
+  prot = SessionKey::Protection::Dpapi;
+#else
+#if defined(__APPLE__)
+  if (keychain_store(path, key, note)) {
+    data.push_back('C');
+    prot = SessionKey::Protection::Keychain;
+  }
+#elif defined(TWICH_HAVE_LIBSECRET)
+  if (keyring_store(path, key, note)) {
+    data.push_back('R');
+    prot = SessionKey::Protection::Keyring;
+  }
+#else
+  note = "built without a keystore";
+#endif
+  if (data.size() == sizeof(kMagicV2)) {
+    data.push_back('F');
+    data.insert(data.end(), key.begin(), key.end());
+    prot = SessionKey::Protection::PlainFile;
+  }
+#endif
+
+  return write_file(path, data, error);
+}
+
+// -------------------- process cache --------------------
+struct CachedKey {
+  std::string key;
+  SessionKey::Protection protection;
+};
+
+static std::mutex g_keys_mutex;
+static std::unordered_map<std::string, CachedKey> g_keys; // key file -> base64 key
+
+static double ms_since(std::chrono::steady_clock::time_point t0)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static bool get_key(const std::string& path, bool create, SessionKey& out, std::string& error)
+{
+  const auto t0 = std::chrono::steady_clock::now();
+
+  // held throughout: two sources starting at once create one key, not two
+  std::lock_guard<std::mutex> lk(g_keys_mutex);
+
+  auto it = g_keys.find(path);
+  if (it != g_keys.end()) {
+    out.key = it->second.key;
+    out.protection = it->second.protection;
+    out.from = SessionKey::From::Cache;
+    out.ms = ms_since(t0);
+    return true;
+  }
+
+  std::vector<uint8_t> key;
+  std::string read_error;
+  if (load_key(path, key, out.protection, read_error)) {
+    out.from = SessionKey::From::Store;
+
+    // a plain key file (older build, or the keystore was away) moves into
+    // the keystore once one answers; the file is left alone otherwise
+    if (kHaveKeystore && out.protection == SessionKey::Protection::PlainFile) {
+      SessionKey::Protection moved = out.protection;
+      std::string ignored;
+      if (store_key(path, key, moved, out.note, ignored))
+        out.protection = moved;
+    }
+  } else {
+    // an unreadable key must not be replaced: the database needs that one
+    if (!read_error.empty() || !create) {
+      error = read_error;
+      return false;
+    }
+
+    if (!random_key(key, error) || !store_key(path, key, out.protection, out.note, error))
+      return false;
+    out.from = SessionKey::From::Created;
+  }
+
+  out.key = base64_encode(key.data(), key.size());
+  std::fill(key.begin(), key.end(), 0);
+  g_keys[path] = {out.key, out.protection};
+  out.ms = ms_since(t0);
+  return true;
+}
+
+bool session_key_get(const std::string& path, SessionKey& out, std::string& error)
+{
+  return get_key(path, true, out, error);
+}
+
+bool session_key_load(const std::string& path, SessionKey& out, std::string& error)
+{
+  return get_key(path, false, out, error);
+}
+
+void session_key_evict(const std::string& path)
+{
+  std::lock_guard<std::mutex> lk(g_keys_mutex);
+  g_keys.erase(path);
+}
+
+void session_key_forget(const std::string& path)
+{
+  std::lock_guard<std::mutex> lk(g_keys_mutex);
+  g_keys.erase(path);
+
+#ifdef __APPLE__
+  keychain_delete(path);
+#endif
+#ifdef TWICH_HAVE_LIBSECRET
+  keyring_delete(path);
+#endif
+  std::remove(path.c_str());
+}
+
+const char* session_key_from_name(SessionKey::From f)
+{
+  switch (f) {
+  case SessionKey::From::Cache:   return "cache";
+  case SessionKey::From::Store:   return "key store";
+  case SessionKey::From::Created: return "new key";
+  }
+  return "?";
+}
+
+const char* session_key_protection_name(SessionKey::Protection p)
+{
+  switch (p) {
+  case SessionKey::Protection::Dpapi:     return "DPAPI (current Windows user)";
+  case SessionKey::Protection::Keychain:  return "macOS Keychain";
+  case SessionKey::Protection::Keyring:   return "system keyring (Secret Service)";
+  case SessionKey::Protection::PlainFile: return "unprotected file, mode 0600 (no keystore)";
+  }
+  return "?";
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+std::string base64_encode(const uint8_t* data, size_t len);
+
+// Encryption key for the TDLib session database.
+//
+// 32 random bytes from the OS CSPRNG, created once per session folder and
+// kept in the OS keystore where there is one: DPAPI (current user) on
+// Windows, the login Keychain on macOS, the Secret Service (libsecret) on
+// Linux. Without a keystore the key is written to a 0600 file and reported
+// as such. Keys are cached per key file for the process lifetime, so a
+// TDLib restart reads nothing.
+struct SessionKey {
+  enum class From { Cache, Store, Created };
+
+  // Where the key lives at rest
+  enum class Protection {
+    Dpapi,     // key file holds a DPAPI blob for this Windows user
+    Keychain,  // macOS Keychain item; the key file only points to it
+    Keyring,   // Secret Service item; the key file only points to it
+    PlainFile, // the key itself, in a file only this user can read
+  };
+
+  std::string key;           // base64, as TDLib's JSON interface takes bytes
+  From        from = From::Cache;
+  Protection  protection = Protection::PlainFile;
+  double      ms = 0.0;      // time spent getting it
+  std::string note;          // why the keystore was not used, if it wasn't
+};
+
+// Key for `path`, created when the file is missing.
+// False if the stored key cannot be read or a new one cannot be stored;
+// `error` says why.
+bool session_key_get(const std::string& path, SessionKey& out, std::string& error);
+
+// Key already stored for `path` (cache or store) without creating one
+bool session_key_load(const std::string& path, SessionKey& out, std::string& error);
+
+// Drops the cached key for `path`; the next call reads the store again
+void session_key_evict(const std::string& path);
+
+// Drops the key from the cache, the keystore and disk
+void session_key_forget(const std::string& path);
+
+const char* session_key_from_name(SessionKey::From f);
+const char* session_key_protection_name(SessionKey::Protection p);
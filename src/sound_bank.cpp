@@ -0,0 +1,133 @@
+#include "sound_bank.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+std::shared_ptr<const AudioClip> SoundBank::find(const std::string& path) const
+{
+  auto it = sounds.find(path);
+  return it != sounds.end() ? it->second.clip : nullptr;
+}
+
+void SoundBankLoader::set_on_error(OnError cb)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  on_error_ = std::move(cb);
+}
+
+void SoundBankLoader::submit(std::vector<std::string> paths, uint32_t rate)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  pending_paths_ = std::move(paths);
+  pending_rate_ = rate;
+  pending_ = true;
+
+  if (!running_) {
+    tasks_.reopen();
+    running_ = tasks_.post([this]() { run(); });
+  }
+}
+
+std::shared_ptr<const SoundBank> SoundBankLoader::take_ready()
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  has_ready_.store(false, std::memory_order_relaxed);
+  return std::move(ready_);
+}
+
+uint64_t SoundBankLoader::decoded() const
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return decoded_;
+}
+
+void SoundBankLoader::stop()
+{
+  tasks_.cancel();
+
+  std::lock_guard<std::mutex> lk(mutex_);
+  running_ = false;
+  pending_ = false;
+  pending_paths_.clear();
+}
+
+static bool file_stamp(const std::string& path, uint64_t& size, int64_t& mtime)
+{
+  std::error_code ec;
+  size = fs::file_size(path, ec);
+  if (ec)
+    return false;
+  const auto t = fs::last_write_time(path, ec);
+  if (ec)
+    return false;
+  mtime = (int64_t)std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
+  return true;
+}
+
+void SoundBankLoader::run()
+{
+  for (;;) {
+    std::vector<std::string> paths;
+    uint32_t rate = 0;
+    std::shared_ptr<const SoundBank> prev;
+    OnError on_error;
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      if (!pending_) {
+        running_ = false;
+        return;
+      }
+      paths = std::move(pending_paths_);
+      pending_paths_.clear();
+      rate = pending_rate_;
+      pending_ = false;
+      prev = built_;
+      on_error = on_error_;
+    }
+
+    auto bank = std::make_shared<SoundBank>();
+    bank->rate = rate;
+    uint64_t decoded = 0;
+
+    for (const std::string& path : paths) {
+      if (path.empty() || bank->sounds.count(path))
+        continue;
+
+      SoundBank::Entry e;
+      if (!file_stamp(path, e.size, e.mtime)) {
+        if (on_error)
+          on_error(path, "file not found");
+        continue;
+      }
+
+      if (prev && prev->rate == rate) {
+        auto it = prev->sounds.find(path);
+        if (it != prev->sounds.end() && it->second.size == e.size && it->second.mtime == e.mtime) {
+          bank->sounds.emplace(path, it->second);
+          continue;
+        }
+      }
+
+      auto clip = std::make_shared<AudioClip>();
+      std::string error;
+      if (!load_wav_file(path, rate, *clip, error)) {
+        if (on_error)
+          on_error(path, error);
+        continue;
+      }
+      e.clip = std::move(clip);
+      bank->sounds.emplace(path, std::move(e));
+      decoded++;
+    }
+
+    std::lock_guard<std::mutex> lk(mutex_);
+    built_ = bank;
+    ready_ = std::move(bank);
+    decoded_ += decoded;
+    has_ready_.store(true, std::memory_order_release);
+  }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "audio_clip.hpp"
+#include "worker_pool.hpp"
+
+// WAV tier sounds decoded at the output rate, by path
+struct SoundBank {
+  struct Entry {
+    std::shared_ptr<const AudioClip> clip;
+    uint64_t size = 0;   // file size + mtime when decoded
+    int64_t  mtime = 0;
+  };
+
+  uint32_t rate = 0;
+  std::unordered_map<std::string, Entry> sounds;
+
+  std::shared_ptr<const AudioClip> find(const std::string& path) const;
+};
+
+// Builds SoundBanks on the shared worker pool.
+// submit() takes the latest list of WAV paths; a newer list replaces one not
+// started yet. Sounds the previous bank already holds (same path, size and
+// mtime, same rate) are reused, so a settings edit decodes only the files it
+// changed. The consumer picks up finished banks with take_ready().
+class SoundBankLoader {
+public:
+  // Worker thread, per file that could not be decoded
+  using OnError = std::function<void(const std::string& path, const std::string& error)>;
+
+  SoundBankLoader() = default;
+  ~SoundBankLoader() { stop(); }
+
+  SoundBankLoader(const SoundBankLoader&) = delete;
+  SoundBankLoader& operator=(const SoundBankLoader&) = delete;
+
+  void set_on_error(OnError cb);
+
+  void submit(std::vector<std::string> paths, uint32_t rate);
+
+  // Lock-free: a finished bank is waiting for take_ready()
+  bool has_ready() const { return has_ready_.load(std::memory_order_acquire); }
+
+  // The newest finished bank, or nullptr when there is nothing new
+  std::shared_ptr<const SoundBank> take_ready();
+
+  // Decodes done since the loader started (reused sounds not counted)
+  uint64_t decoded() const;
+
+  void stop();
+
+private:
+  void run();
+
+  mutable std::mutex mutex_;
+  TaskGroup tasks_;
+  bool running_ = false;                     // a task is draining requests
+
+  bool pending_ = false;
+  std::vector<std::string> pending_paths_;
+  uint32_t pending_rate_ = 0;
+
+  std::shared_ptr<const SoundBank> built_;   // last bank built (reuse source)
+  std::shared_ptr<const SoundBank> ready_;   // built, not taken yet
+  std::atomic<bool> has_ready_{false};
+  uint64_t decoded_ = 0;
+  OnError on_error_;
+};
@@ -0,0 +1,91 @@
+#include "status_channel.hpp"
+
+#include <utility>
+
+StatusUi status_ui_for_auth_state(const std::string& st)
+{
+  if (st == "authorizationStateWaitPhoneNumber") return StatusUi::Phone;
+  if (st == "authorizationStateWaitCode")        return StatusUi::Code;
+  if (st == "authorizationStateWaitPassword")    return StatusUi::Password;
+  if (st == "authorizationStateReady")           return StatusUi::Ready;
+  if (st == "authorizationStateClosed")          return StatusUi::NotStarted;
+  return StatusUi::Starting;
+}
+
+void StatusChannel::set_owner(obs_source_t* owner, const char* settings_key)
+{
+  owner_ = owner;
+  settings_key_ = settings_key;
+}
+
+void StatusChannel::post(std::string text, StatusUi ui)
+{
+  {
+    std::lock_guard<std::mutex> lk(slot_mutex_);
+    slot_text_ = std::move(text);
+    slot_ui_ = ui;
+  }
+
+  schedule();
+}
+
+void StatusChannel::post_note(std::string note)
+{
+  {
+    std::lock_guard<std::mutex> lk(slot_mutex_);
+    if (note == slot_note_)
+      return;
+    slot_note_ = std::move(note);
+  }
+
+  schedule();
+}
+
+void StatusChannel::schedule()
+{
+  // Already queued: that task will pick up the value we just wrote.
+  if (task_pending_.exchange(true))
+    return;
+
+  obs_source_t* ref = owner_ ? obs_source_get_ref(owner_) : nullptr;
+  if (!ref) {
+    task_pending_.store(false);
+    return;
+  }
+
+  task_ref_.store(ref);
+  obs_queue_task(OBS_TASK_UI, ui_flush, this, false);
+}
+
+void StatusChannel::ui_flush(void* param)
+{
+  auto* ch = (StatusChannel*)param;
+
+  // Our reference keeps the source (and this channel) alive until the end.
+  obs_source_t* ref = ch->task_ref_.exchange(nullptr);
+  ch->task_pending_.store(false);
+
+  std::string text;
+  StatusUi ui;
+  {
+    std::lock_guard<std::mutex> lk(ch->slot_mutex_);
+    text = ch->slot_text_;
+    if (!ch->slot_note_.empty())
+      text += "\n\n" + ch->slot_note_;
+    ui = ch->slot_ui_;
+  }
+
+  // Write the text straight into the settings object: no obs_source_update,
+  // so no settings diff or rendering work for a status change.
+  obs_data_t* d = obs_source_get_settings(ref);
+  const char* prev = obs_data_get_string(d, ch->settings_key_);
+  if (!prev || text != prev)
+    obs_data_set_string(d, ch->settings_key_, text.c_str());
+  obs_data_release(d);
+
+  const int prev_ui = ch->shown_ui_.exchange((int)ui);
+  if (prev_ui != (int)ui)
+    obs_source_update_properties(ref);
+
+  obs_source_release(ref);
+}
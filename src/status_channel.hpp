@@ -0,0 +1,57 @@
+#pragma once
+
+#include <obs-module.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+// Which login controls the properties panel shows. The panel is only
+// rebuilt when this changes; plain status-text changes are not worth it.
+enum class StatusUi : int {
+  NotStarted = 0, // creds missing / TDLib not running
+  Starting,       // waiting for TDLib
+  Phone,          // phone row
+  Code,           // code row
+  Password,       // 2FA row
+  Ready,          // logged in: login rows hidden
+};
+
+StatusUi status_ui_for_auth_state(const std::string& st);
+
+// Coalescing status channel from any thread (mostly the TDLib thread) to the
+// UI thread. Writers overwrite a single latest-value slot; at most one UI
+// task is queued at a time and it applies whatever is latest when it runs.
+class StatusChannel {
+public:
+  // owner is not ref'd here; each queued task holds its own reference
+  void set_owner(obs_source_t* owner, const char* settings_key);
+
+  // Thread-safe; cheap when a flush is already pending
+  void post(std::string text, StatusUi ui);
+
+  // Secondary block shown under the auth status (e.g. media problems);
+  // "" removes it. Thread-safe.
+  void post_note(std::string note);
+
+  // Controls currently shown (UI thread)
+  StatusUi shown_ui() const { return (StatusUi)shown_ui_.load(); }
+
+private:
+  void schedule();
+  static void ui_flush(void* param);
+
+  obs_source_t* owner_ = nullptr;
+  const char* settings_key_ = "";
+
+  // latest-value slot
+  std::mutex slot_mutex_;
+  std::string slot_text_;
+  std::string slot_note_;
+  StatusUi slot_ui_ = StatusUi::Starting;
+
+  std::atomic<bool> task_pending_{false};
+  std::atomic<obs_source_t*> task_ref_{nullptr};
+
+  std::atomic<int> shown_ui_{(int)StatusUi::Starting};
+};
@@ -0,0 +1,354 @@
+#include "telegram_accounts.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <utility>
+
+#include <obs-module.h>
+#include <util/platform.h>
+
+#include "config.hpp"
+#include "event_parse.hpp"
+#include "ordered_closer.hpp"
+#include "route_dispatch.hpp"
+#include "session_key.hpp"
+
+// Build a session dir next to config.json (portable, writable)
+std::string tg_account_session_dir(const std::string& name)
+{
+  std::string cfg = twich_config_path();
+  auto pos = cfg.find_last_of("\\/");
+  std::string folder = (pos == std::string::npos) ? "." : cfg.substr(0, pos);
+
+  // the default account keeps the single-account location
+  const std::string dir = name == kDefaultTgAccount ? "tg_session" : "tg_session_" + name;
+#ifdef _WIN32
+  return folder + "\\" + dir;
+#else
+  return folder + "/" + dir;
+#endif
+}
+
+// ---------- Status formatting ----------
+static std::string format_auth_status(const std::string& st)
+{
+  if (st == "authorizationStateWaitPhoneNumber")
+    return "Waiting for phone number\nNext: Enter phone and click \"Set Phone\".";
+  if (st == "authorizationStateWaitCode")
+    return "Waiting for login code\nNext: Enter code and click \"Submit Code\".";
+  if (st == "authorizationStateWaitPassword")
+    return "Waiting for 2FA password\nNext: Enter password and click \"Submit Password\".";
+  if (st == "authorizationStateReady")
+    return "READY (logged in)\nNext: Tips should appear when the bot sends events.";
+  if (st == "authorizationStateWaitTdlibParameters")
+    return "Initializing Telegram (TDLib)…\nNext: Wait a moment.";
+  if (st == "authorizationStateClosing")
+    return "Telegram closing…";
+  if (st == "authorizationStateClosed")
+    return "Telegram closed\nNext: Click \"Restart TDLib\".";
+  if (st.empty())
+    return "NO AUTH STATE YET\n(if logs show Ready, callback/UI update is not running)";
+  return st;
+}
+
+std::string auth_status_text(const std::string& st)
+{
+  return std::string("TDLib state: ") + (st.empty() ? "(empty)" : st) + "\n" +
+         format_auth_status(st);
+}
+
+// The session database is encrypted with the key in "<session dir>.key";
+// a marker file in the session dir says the database on disk uses it.
+static std::string database_marker_path(const std::string& session_dir)
+{
+  return session_dir + "/.twich_encrypted";
+}
+
+static void mark_database_encrypted(const std::string& session_dir, bool encrypted)
+{
+  const std::string marker = database_marker_path(session_dir);
+  if (encrypted) {
+    os_mkdirs(session_dir.c_str());
+    std::ofstream(marker, std::ios::binary | std::ios::trunc) << "1\n";
+  } else {
+    os_unlink(marker.c_str());
+    session_key_forget(session_dir + ".key");
+  }
+}
+
+// Keys TDLib opens the database with (`db_key`) and switches it to once
+// logged in (`rekey_to`); base64, "" = unencrypted. A new database is
+// created encrypted right away; an existing one is converted in place.
+// False only when an encrypted database's key cannot be read.
+static bool plan_database_key(const std::string& session_dir, bool encrypt,
+                              std::string& db_key, std::string& rekey_to, std::string& error)
+{
+  const std::string key_path = session_dir + ".key";
+  const bool encrypted = os_file_exists(database_marker_path(session_dir).c_str());
+  db_key.clear();
+  rekey_to.clear();
+
+  SessionKey k;
+  if (!encrypt && !encrypted)
+    return true;
+
+  const bool got = encrypt ? session_key_get(key_path, k, error) : session_key_load(key_path, k, error);
+  if (!got) {
+    if (encrypted)
+      return false;
+    blog(LOG_WARNING, "[TWICH] session database stays unencrypted: %s", error.c_str());
+    return true;
+  }
+  blog(LOG_INFO, "[TWICH] session key from %s in %.1f ms, kept in %s", session_key_from_name(k.from), k.ms,
+       session_key_protection_name(k.protection));
+  if (k.protection == SessionKey::Protection::PlainFile)
+    blog(LOG_WARNING, "[TWICH] no keystore for the session key (%s): it is a plain file readable only by you",
+         k.note.c_str());
+
+  if (encrypted) {
+    db_key = k.key;
+    rekey_to = encrypt ? k.key : std::string();
+  } else if (!os_file_exists((session_dir + "/td.binlog").c_str())) {
+    // nothing on disk yet: TDLib creates it encrypted
+    db_key = rekey_to = k.key;
+    mark_database_encrypted(session_dir, true);
+  } else {
+    rekey_to = k.key;
+  }
+  return true;
+}
+
+// ------------------------------------------------------------
+// Teardown: the last reference can go away on any thread (the video thread
+// destroying a source, a TDLib callback), so each account closes on a
+// thread of its own. A new instance of the same account waits in start()
+// until the instances created before it have let go of the session folder.
+// ------------------------------------------------------------
+static OrderedCloser& account_closer()
+{
+  static OrderedCloser closer;
+  return closer;
+}
+
+static void close_account(TelegramAccount* account)
+{
+  account_closer().close(account->name(), account->generation(), [account] {
+    delete account; // joins the starter, stops TDLib
+  });
+}
+
+void close_telegram_accounts()
+{
+  account_closer().wait_all();
+}
+
+// ------------------------------------------------------------
+// TelegramAccount
+// ------------------------------------------------------------
+TelegramAccount::TelegramAccount(std::string name)
+  : name_(std::move(name)),
+    tag_(intern_symbol(name_)),
+    session_dir_(tg_account_session_dir(name_)),
+    generation_(account_closer().open(name_))
+{
+}
+
+TelegramAccount::~TelegramAccount()
+{
+  {
+    std::lock_guard<std::mutex> lk(start_mutex_);
+    if (starter_.joinable())
+      starter_.join();
+  }
+  tg_.stop();
+  blog(LOG_INFO, "[TWICH] Telegram account '%s' closed", name_.c_str());
+}
+
+uint64_t TelegramAccount::subscribe(OnMessage on_message, OnStatus on_status)
+{
+  std::lock_guard<std::mutex> lk(subs_mutex_);
+  const uint64_t id = next_sub_++;
+  if (on_status && !last_status_.empty())
+    on_status(last_status_, last_ui_);
+  subs_[id] = {std::move(on_message), std::move(on_status)};
+  return id;
+}
+
+void TelegramAccount::unsubscribe(uint64_t id)
+{
+  std::lock_guard<std::mutex> lk(subs_mutex_);
+  subs_.erase(id);
+}
+
+size_t TelegramAccount::subscribers() const
+{
+  std::lock_guard<std::mutex> lk(subs_mutex_);
+  return subs_.size();
+}
+
+std::string TelegramAccount::last_status(StatusUi& ui) const
+{
+  std::lock_guard<std::mutex> lk(subs_mutex_);
+  ui = last_ui_;
+  return last_status_;
+}
+
+std::vector<std::string> TelegramAccount::bots() const
+{
+  std::lock_guard<std::mutex> lk(bots_mutex_);
+  return bots_;
+}
+
+bool TelegramAccount::launched() const
+{
+  return launched_.load();
+}
+
+void TelegramAccount::post_status(const std::string& text, StatusUi ui)
+{
+  // with several accounts, say whose login this is
+  const std::string shown = name_ == kDefaultTgAccount ? text : "Account: " + name_ + "\n" + text;
+
+  std::lock_guard<std::mutex> lk(subs_mutex_);
+  last_status_ = shown;
+  last_ui_ = ui;
+  for (auto& [id, sub] : subs_) {
+    if (sub.on_status)
+      sub.on_status(shown, ui);
+  }
+}
+
+// TDLib thread: one bot message to every subscribed source, routed once
+void TelegramAccount::dispatch(const std::string& text)
+{
+  RouteDecision route;
+  if (current_routes()) {
+    if (auto ev = parse_tip_event_from_message(text)) {
+      ev->account = tag_;
+      route = route_event(*ev);
+    }
+  }
+
+  std::lock_guard<std::mutex> lk(subs_mutex_);
+  for (auto& [id, sub] : subs_) {
+    if (sub.on_message)
+      sub.on_message(text, route);
+  }
+}
+
+void TelegramAccount::start(const TdStorageOptions& opts)
+{
+  // an earlier instance of this account may still hold the session folder
+  account_closer().wait_closed_before(name_, generation_);
+
+  TgAppCreds creds = load_tg_creds();
+  if (!creds.valid) {
+    blog(LOG_ERROR, "[TWICH] Telegram API creds missing/invalid: %s", creds.error.c_str());
+    blog(LOG_ERROR, "[TWICH] TDLib NOT started. Enter API ID/HASH and click Save.");
+
+    post_status(
+      "Telegram NOT started\n"
+      "Reason: Missing/invalid API credentials.\n"
+      "Next: Open Advanced, enter API ID/HASH, click \"Save credentials\".",
+      StatusUi::NotStarted
+    );
+    return;
+  }
+
+  std::vector<std::string> bots;
+  for (const TgAccountConfig& acc : load_tg_accounts()) {
+    if (acc.name == name_)
+      bots = acc.bots;
+  }
+  {
+    std::lock_guard<std::mutex> lk(bots_mutex_);
+    bots_ = bots;
+  }
+
+  blog(LOG_INFO, "[TWICH] Starting TDLib for account '%s'. session_dir=%s api_id=%s bots=%zu",
+       name_.c_str(), session_dir_.c_str(), creds.api_id.c_str(), bots.size());
+
+  std::string db_key, rekey_to, key_error;
+  if (!plan_database_key(session_dir_, creds.encrypt_session, db_key, rekey_to, key_error)) {
+    blog(LOG_ERROR, "[TWICH] TDLib NOT started: %s", key_error.c_str());
+    const std::string dir_name = session_dir_.substr(session_dir_.find_last_of("\\/") + 1);
+    post_status(
+      "Telegram NOT started\n"
+      "Reason: the session database is encrypted and its key cannot be read (" + key_error + ").\n"
+      "Next: restore " + dir_name + ".key, or delete " + dir_name + " to log in again.",
+      StatusUi::NotStarted
+    );
+    return;
+  }
+  const std::string session_dir = session_dir_;
+  tg_.set_database_key(db_key, rekey_to, [session_dir, rekey_to](bool ok) {
+    if (ok)
+      mark_database_encrypted(session_dir, !rekey_to.empty());
+  });
+
+  tg_.set_storage_options(opts);
+  tg_.set_allowed_bots(bots);
+
+  // TDLib thread -> every subscriber's status box
+  tg_.set_on_auth_state([this](const std::string& st) {
+    blog(LOG_INFO, "[TWICH] account '%s' auth state: %s", name_.c_str(), st.c_str());
+
+    // coalesced per source: bursts of transitions cost one UI task each
+    post_status(auth_status_text(st), status_ui_for_auth_state(st));
+  });
+
+  tg_.start(
+    creds.api_id,
+    creds.api_hash,
+    session_dir_,
+    [this](long long /*chat_id*/, const std::string& text) { dispatch(text); }
+  );
+
+  post_status("Starting Telegram… (TDLib launching)", StatusUi::Starting);
+}
+
+void TelegramAccount::launch(const TdStorageOptions& opts)
+{
+  std::lock_guard<std::mutex> lk(start_mutex_);
+  if (launched_)
+    return;
+  launched_ = true;
+
+  starter_ = std::thread([this, opts] {
+    const uint64_t t0 = os_gettime_ns();
+    start(opts);
+    blog(LOG_INFO, "[TWICH] account '%s': TDLib brought up in the background in %.1f ms",
+         name_.c_str(), (double)(os_gettime_ns() - t0) / 1e6);
+  });
+}
+
+void TelegramAccount::restart(const TdStorageOptions& opts)
+{
+  std::lock_guard<std::mutex> lk(start_mutex_);
+  if (starter_.joinable())
+    starter_.join();
+  launched_ = true;
+
+  tg_.stop();
+  start(opts);
+}
+
+// ------------------------------------------------------------
+// Process-wide registry
+// ------------------------------------------------------------
+std::shared_ptr<TelegramAccount> acquire_telegram_account(const std::string& name)
+{
+  static std::mutex mutex;
+  static std::map<std::string, std::weak_ptr<TelegramAccount>> accounts;
+
+  std::lock_guard<std::mutex> lk(mutex);
+
+  if (auto existing = accounts[name].lock())
+    return existing;
+
+  std::shared_ptr<TelegramAccount> account(new TelegramAccount(name), close_account);
+  accounts[name] = account;
+  blog(LOG_INFO, "[TWICH] Telegram account '%s' opened (session %s)", name.c_str(),
+       account->session_dir().c_str());
+  return account;
+}
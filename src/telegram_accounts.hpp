@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "event_router.hpp"
+#include "status_channel.hpp"
+#include "telegram_tdlib.hpp"
+
+// One named Telegram login (see TgAccountConfig), shared by every source
+// that shows its events: one TDLib client, session dir and receive thread
+// per account, however many sources subscribe. Bot messages and login
+// status fan out to the subscribers on the account's TDLib thread; each
+// message is routed once (see route_dispatch.hpp) before it fans out.
+class TelegramAccount {
+public:
+  using OnMessage = std::function<void(const std::string& text, const RouteDecision& route)>;
+  using OnStatus  = std::function<void(const std::string& text, StatusUi ui)>;
+
+  explicit TelegramAccount(std::string name);
+  ~TelegramAccount(); // stops TDLib (on a closer thread, see acquire_telegram_account)
+
+  TelegramAccount(const TelegramAccount&) = delete;
+  TelegramAccount& operator=(const TelegramAccount&) = delete;
+
+  const std::string& name() const { return name_; }
+  const char* tag() const { return tag_; } // interned name, for TipEvent::account
+  const std::string& session_dir() const { return session_dir_; }
+  uint64_t generation() const { return generation_; } // order among instances of this name
+
+  // `on_status` gets the latest status right away. After unsubscribe()
+  // returns, neither callback runs again.
+  uint64_t subscribe(OnMessage on_message, OnStatus on_status);
+  void unsubscribe(uint64_t id);
+  size_t subscribers() const;
+
+  // Latest status posted to subscribers, "" before the first
+  std::string last_status(StatusUi& ui) const;
+
+  // First call brings TDLib up on a background thread (creds, key,
+  // client, parameters); later calls do nothing. The storage options of
+  // whichever source launches (or restarts) the account apply.
+  void launch(const TdStorageOptions& opts);
+  bool launched() const;
+
+  // Stop + start from the UI buttons, after any background start finished
+  void restart(const TdStorageOptions& opts);
+
+  // Login steps and storage stats (UI thread)
+  TelegramTdLibClient& client() { return tg_; }
+
+  // Bots the running client accepts (as configured when it started)
+  std::vector<std::string> bots() const;
+
+private:
+  void start(const TdStorageOptions& opts);
+  void post_status(const std::string& text, StatusUi ui);
+  void dispatch(const std::string& text);
+
+  struct Subscriber {
+    OnMessage on_message;
+    OnStatus on_status;
+  };
+
+  const std::string name_;
+  const char* tag_ = "";
+  const std::string session_dir_;
+  const uint64_t generation_;
+
+  mutable std::mutex subs_mutex_; // guards subs_ + last status; held while callbacks run
+  std::map<uint64_t, Subscriber> subs_;
+  uint64_t next_sub_ = 1;
+  std::string last_status_;
+  StatusUi last_ui_ = StatusUi::NotStarted;
+
+  std::mutex start_mutex_; // guards starter_ + launched_
+  std::thread starter_;
+  std::atomic<bool> launched_{false};
+
+  mutable std::mutex bots_mutex_;
+  std::vector<std::string> bots_;
+
+  TelegramTdLibClient tg_;
+};
+
+// Process-wide account `name`, created on first use and shared by every
+// source subscribed to it. When the last reference goes away TDLib stops on
+// a closer thread, never on the thread that dropped it.
+std::shared_ptr<TelegramAccount> acquire_telegram_account(const std::string& name);
+
+// Waits for every closing account's TDLib to stop (module unload)
+void close_telegram_accounts();
+
+// Session dir of an account next to config.json: "tg_session" for the
+// default account, "tg_session_<name>" for the others
+std::string tg_account_session_dir(const std::string& name);
+
+// "TDLib state: ..." status text for an auth state
+std::string auth_status_text(const std::string& st);
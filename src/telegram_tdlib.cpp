@@ -1,9 +1,15 @@
 #include "telegram_tdlib.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string_view>
+#include <system_error>
 #include <utility>
 
 #include <obs-module.h>
 
+#include "event_ingest.hpp"
 #include "nlohmann_json.hpp"
 #include "td/telegram/td_json_client.h"
 
@@ -38,6 +44,28 @@ void TelegramTdLibClient::set_on_auth_state(OnAuthState cb)
   auth_cb_ = std::move(cb);
 }
 
+void TelegramTdLibClient::set_database_key(const std::string& db_key, const std::string& rekey_to,
+                                           OnRekeyed on_rekeyed)
+{
+  if (running_) return;
+
+  db_key_ = db_key;
+  rekey_to_ = rekey_to;
+  on_rekeyed_ = std::move(on_rekeyed);
+}
+
+void TelegramTdLibClient::set_storage_options(const TdStorageOptions& opts)
+{
+  if (running_) return;
+  storage_ = opts;
+}
+
+TdStorageStats TelegramTdLibClient::storage_stats() const
+{
+  std::lock_guard<std::mutex> lk(stats_mutex_);
+  return stats_;
+}
+
 void TelegramTdLibClient::start(const std::string& api_id,
                                 const std::string& api_hash,
                                 const std::string& session_dir,
@@ -49,6 +77,16 @@ void TelegramTdLibClient::start(const std::string& api_id,
   api_hash_ = api_hash;
   session_dir_ = session_dir;
   cb_ = std::move(cb);
+  allowed_bot_ids_.clear();
+
+  {
+    std::lock_guard<std::mutex> lk(stats_mutex_);
+    stats_ = TdStorageStats();
+    stats_.minimal = storage_.minimal;
+  }
+  started_at_ = std::chrono::steady_clock::now();
+  params_sent_at_ = std::chrono::steady_clock::time_point();
+  next_optimize_ = std::chrono::steady_clock::time_point::max();
 
   client_ = td_json_client_create();
 
@@ -161,7 +199,9 @@ static int to_int_api_id(const std::string& api_id_str)
 // TDLib v1.8.6+ expects INLINED parameters (no "parameters": {...})
 static json build_tdlib_parameters(const std::string& session_dir,
                                   int api_id_int,
-                                  const std::string& api_hash)
+                                  const std::string& api_hash,
+                                  const std::string& db_key,
+                                  bool minimal)
 {
   json p;
   p["@type"] = "setTdlibParameters";
@@ -170,12 +210,14 @@ static json build_tdlib_parameters(const std::string& session_dir,
   p["database_directory"] = session_dir;
   p["files_directory"] = session_dir + "/files";
 
-  // empty string = unencrypted local database
-  p["database_encryption_key"] = "";
+  // base64 bytes; empty string = unencrypted local database
+  p["database_encryption_key"] = db_key;
 
-  p["use_file_database"] = true;
-  p["use_chat_info_database"] = true;
-  p["use_message_database"] = true;
+  // minimal: chats and users are fetched again after a restart instead of
+  // being kept on disk; the bot is resolved online either way
+  p["use_file_database"] = !minimal;
+  p["use_chat_info_database"] = !minimal;
+  p["use_message_database"] = !minimal;
   p["use_secret_chats"] = false;
 
   p["api_id"] = api_id_int;
@@ -183,7 +225,13 @@ static json build_tdlib_parameters(const std::string& session_dir,
 
   p["system_language_code"] = "en";
   p["device_model"] = "OBS Plugin";
+#ifdef _WIN32
   p["system_version"] = "Windows";
+#elif defined(__APPLE__)
+  p["system_version"] = "macOS";
+#else
+  p["system_version"] = "Linux";
+#endif
   p["application_version"] = "1.0";
   p["enable_storage_optimizer"] = true;
 
@@ -212,6 +260,10 @@ void TelegramTdLibClient::run()
 
   while (running_) {
     const char* resp = td_json_client_receive(client_, 1.0);
+
+    if (std::chrono::steady_clock::now() >= next_optimize_)
+      optimize_storage();
+
     if (!resp)
       continue;
 
@@ -222,6 +274,39 @@ void TelegramTdLibClient::run()
       continue;
     }
 
+    // Answer to optimizeStorage: storageStatistics or an error
+    if (u.contains("@extra") && u["@extra"] == "optimize_storage") {
+      if (u.value("@type", "") == "error") {
+        blog(LOG_WARNING, "[TWICH][TDLib] optimizeStorage failed: %s", u.value("message", "").c_str());
+      } else {
+        const uint64_t before = storage_stats().session_bytes;
+        measure_session_dir();
+        const TdStorageStats st = storage_stats();
+        {
+          std::lock_guard<std::mutex> lk(stats_mutex_);
+          stats_.optimized++;
+        }
+        blog(LOG_INFO, "[TWICH][TDLib] storage optimized: session dir %.1f MB -> %.1f MB",
+             (double)before / (1024.0 * 1024.0), (double)st.session_bytes / (1024.0 * 1024.0));
+      }
+      continue;
+    }
+
+    // Answer to setDatabaseEncryptionKey: "ok" or an error
+    if (u.contains("@extra") && u["@extra"] == "rekey_db") {
+      const bool ok = u.value("@type", "") == "ok";
+      if (ok) {
+        db_key_ = rekey_to_;
+        blog(LOG_INFO, "[TWICH][TDLib] session database %s", db_key_.empty() ? "decrypted" : "encrypted");
+      } else {
+        rekey_to_ = db_key_;
+        blog(LOG_ERROR, "[TWICH][TDLib] session database re-key failed: %s", u.value("message", "").c_str());
+      }
+      if (on_rekeyed_)
+        on_rekeyed_(ok);
+      continue;
+    }
+
     // Log TDLib errors clearly
     if (u.contains("@type") && u["@type"] == "error") {
       int code = u.value("code", 0);
@@ -240,6 +325,20 @@ void TelegramTdLibClient::run()
           auth_state_ = st;
         }
 
+        // first state after the parameters: the database is open
+        const auto now = std::chrono::steady_clock::now();
+        if (params_sent_at_ != std::chrono::steady_clock::time_point() &&
+            st != "authorizationStateWaitTdlibParameters") {
+          const double open_ms = std::chrono::duration<double, std::milli>(now - params_sent_at_).count();
+          params_sent_at_ = std::chrono::steady_clock::time_point();
+          {
+            std::lock_guard<std::mutex> lk(stats_mutex_);
+            stats_.open_ms = open_ms;
+          }
+          blog(LOG_INFO, "[TWICH][TDLib] database opened in %.0f ms (%s profile)",
+               open_ms, storage_.minimal ? "minimal" : "full");
+        }
+
         blog(LOG_INFO, "[TWICH][TDLib] auth state: %s", st.c_str());
 
         // ---- NEW: notify listener (and prove it) ----
@@ -267,10 +366,23 @@ void TelegramTdLibClient::run()
             continue;
           }
 
-          json p = build_tdlib_parameters(session_dir_, api_id_int, api_hash_);
+          // init-only options: must precede setTdlibParameters
+          if (storage_.minimal) {
+            for (const char* opt : {"ignore_inline_thumbnails", "ignore_file_names",
+                                    "disable_persistent_network_statistics"})
+              send_json(json{{"@type", "setOption"}, {"name", opt},
+                             {"value", {{"@type", "optionValueBoolean"}, {"value", true}}}}.dump());
+          }
+
+          json p = build_tdlib_parameters(session_dir_, api_id_int, api_hash_, db_key_, storage_.minimal);
           const std::string payload = p.dump();
-          blog(LOG_INFO, "[TWICH][TDLib] sending INLINED setTdlibParameters: %s", payload.c_str());
+
+          // never log the key
+          if (!db_key_.empty())
+            p["database_encryption_key"] = "(set)";
+          blog(LOG_INFO, "[TWICH][TDLib] sending INLINED setTdlibParameters: %s", p.dump().c_str());
           send_json(payload);
+          params_sent_at_ = std::chrono::steady_clock::now();
           continue;
         }
 
@@ -311,9 +423,34 @@ void TelegramTdLibClient::run()
             send_json(cmd.dump());
           }
         } else if (st == "authorizationStateReady") {
-          // Resolve bot -> user_id once per run
-          if (allowed_bot_user_id_.load() <= 0) {
-            resolve_allowed_bot();
+          const double ready_ms = std::chrono::duration<double, std::milli>(now - started_at_).count();
+          {
+            std::lock_guard<std::mutex> lk(stats_mutex_);
+            if (stats_.ready_ms == 0.0)
+              stats_.ready_ms = ready_ms;
+          }
+          measure_session_dir();
+          blog(LOG_INFO, "[TWICH][TDLib] ready %.0f ms after start, session dir %.1f MB",
+               ready_ms, (double)storage_stats().session_bytes / (1024.0 * 1024.0));
+
+          if (storage_.limit_bytes > 0 && next_optimize_ == std::chrono::steady_clock::time_point::max())
+            next_optimize_ = now + std::chrono::minutes(1);
+
+          // Resolve bots -> user_ids once per run
+          if (allowed_bot_ids_.empty()) {
+            resolve_allowed_bots();
+          }
+
+          // existing database: switch its encryption now that it is open
+          if (rekey_to_ != db_key_) {
+            json cmd = {
+              {"@type", "setDatabaseEncryptionKey"},
+              {"new_encryption_key", rekey_to_},
+              {"@extra", "rekey_db"}
+            };
+            blog(LOG_INFO, "[TWICH][TDLib] %s the session database...",
+                 rekey_to_.empty() ? "decrypting" : "encrypting");
+            send_json(cmd.dump());
           }
         }
 
@@ -340,15 +477,21 @@ void TelegramTdLibClient::run()
           chat_obj = u["chat"];
         }
 
-        // Only accept the chat that came back from our resolve request
-        if (!chat_obj.contains("@extra") || chat_obj["@extra"] != "resolve_bot")
+        // Only accept chats that came back from our resolve requests
+        // ("resolve_bot:<username>")
+        static constexpr std::string_view kResolveExtra = "resolve_bot:";
+        if (!chat_obj.contains("@extra") || !chat_obj["@extra"].is_string())
+          continue;
+        const std::string extra = chat_obj["@extra"].get<std::string>();
+        if (extra.compare(0, kResolveExtra.size(), kResolveExtra) != 0)
           continue;
 
         long long uid = 0;
         if (try_extract_private_chat_user_id(chat_obj, uid)) {
-          allowed_bot_user_id_.store(uid);
+          if (std::find(allowed_bot_ids_.begin(), allowed_bot_ids_.end(), uid) == allowed_bot_ids_.end())
+            allowed_bot_ids_.push_back(uid);
           blog(LOG_INFO, "[TWICH][TDLib] bot resolved: @%s user_id=%lld",
-               allowed_bot_username_.c_str(), uid);
+               extra.c_str() + kResolveExtra.size(), uid);
         }
       } catch (...) {
         // ignore
@@ -359,23 +502,43 @@ void TelegramTdLibClient::run()
     // New incoming text message
     if (u.contains("@type") && u["@type"] == "updateNewMessage") {
       try {
-        const auto& msg = u["message"];
+        const bool allowed = u.contains("message") && is_allowed_sender(u["message"]);
+
+        // record mode: bot updates raw, before any decoding; for other
+        // senders only who sent it (their chats are none of our business)
+        {
+          std::lock_guard<std::mutex> lk(capture_mutex_);
+          if (!captures_.empty()) {
+            const long long now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::system_clock::now().time_since_epoch()).count();
+            std::string who;
+            if (!allowed) {
+              const json& msg = u["message"];
+              who = json{
+                {"chat_id", msg.value("chat_id", 0LL)},
+                {"sender_id", msg.value("sender_id", json::object())},
+              }.dump();
+            }
+            for (CaptureWriter* cap : captures_) {
+              if (allowed)
+                cap->write(CaptureRecord::Update, now_ms, resp);
+              else
+                cap->write(CaptureRecord::Filtered, now_ms, who);
+            }
+          }
+        }
 
         // DROP everything not from the bot
-        if (!is_allowed_sender(msg)) {
+        if (!allowed) {
           continue;
         }
 
-        long long chat_id = msg["chat_id"].get<long long>();
-        auto content = msg["content"];
-
-        const std::string ctype = content.value("@type", "");
-        if (ctype != "messageText") {
+        long long chat_id = 0;
+        std::string text;
+        if (!text_from_tdlib_update(u, chat_id, text)) {
           continue;
         }
 
-        std::string text = content["text"]["text"].get<std::string>();
-
         if (cb_)
           cb_(chat_id, text);
 
@@ -386,31 +549,90 @@ void TelegramTdLibClient::run()
   }
 }
 
-void TelegramTdLibClient::set_allowed_bot_username(const std::string& username)
+void TelegramTdLibClient::set_allowed_bots(const std::vector<std::string>& usernames)
 {
-  allowed_bot_username_ = normalize_username(username);
-  allowed_bot_user_id_.store(0);
+  if (running_) return;
+
+  allowed_bots_.clear();
+  for (const std::string& name : usernames) {
+    std::string u = normalize_username(name);
+    if (!u.empty())
+      allowed_bots_.push_back(std::move(u));
+  }
 }
 
-void TelegramTdLibClient::resolve_allowed_bot()
+void TelegramTdLibClient::add_capture(CaptureWriter* w)
 {
-  const std::string u = normalize_username(allowed_bot_username_);
-  if (u.empty()) return;
+  std::lock_guard<std::mutex> lk(capture_mutex_);
+  if (w && std::find(captures_.begin(), captures_.end(), w) == captures_.end())
+    captures_.push_back(w);
+}
+
+void TelegramTdLibClient::remove_capture(CaptureWriter* w)
+{
+  std::lock_guard<std::mutex> lk(capture_mutex_);
+  captures_.erase(std::remove(captures_.begin(), captures_.end(), w), captures_.end());
+}
+
+void TelegramTdLibClient::optimize_storage()
+{
+  next_optimize_ = std::chrono::steady_clock::now() + std::chrono::hours(std::max(1, storage_.interval_hours));
 
   json cmd = {
-    {"@type", "searchPublicChat"},
-    {"username", u},
-    {"@extra", "resolve_bot"}
+    {"@type", "optimizeStorage"},
+    {"size", (long long)storage_.limit_bytes},
+    {"ttl", std::max(0, storage_.ttl_days) * 86400},
+    {"count", -1},
+    {"immunity_delay", -1},
+    {"file_types", json::array()},
+    {"chat_ids", json::array()},
+    {"exclude_chat_ids", json::array()},
+    {"return_deleted_file_statistics", false},
+    {"chat_limit", 0},
+    {"@extra", "optimize_storage"}
   };
-
-  blog(LOG_INFO, "[TWICH][TDLib] resolving bot @%s via searchPublicChat...", u.c_str());
+  blog(LOG_INFO, "[TWICH][TDLib] optimizeStorage (limit %.0f MB, ttl %d days)",
+       (double)storage_.limit_bytes / (1024.0 * 1024.0), storage_.ttl_days);
   send_json(cmd.dump());
 }
 
+// Total size of the files under the session dir (TDLib thread)
+void TelegramTdLibClient::measure_session_dir()
+{
+  namespace fs = std::filesystem;
+
+  uint64_t total = 0;
+  std::error_code ec;
+  for (fs::recursive_directory_iterator it(fs::path(session_dir_), ec), end; !ec && it != end; it.increment(ec)) {
+    std::error_code fec;
+    if (it->is_regular_file(fec))
+      total += (uint64_t)it->file_size(fec);
+  }
+
+  std::lock_guard<std::mutex> lk(stats_mutex_);
+  stats_.session_bytes = total;
+}
+
+void TelegramTdLibClient::resolve_allowed_bots()
+{
+  if (allowed_bots_.empty())
+    blog(LOG_WARNING, "[TWICH][TDLib] no bots configured for %s: every message is dropped", session_dir_.c_str());
+
+  for (const std::string& u : allowed_bots_) {
+    json cmd = {
+      {"@type", "searchPublicChat"},
+      {"username", u},
+      {"@extra", "resolve_bot:" + u}
+    };
+
+    blog(LOG_INFO, "[TWICH][TDLib] resolving bot @%s via searchPublicChat...", u.c_str());
+    send_json(cmd.dump());
+  }
+}
+
 bool TelegramTdLibClient::is_allowed_sender(const json& message) const
 {
-  const long long allowed = allowed_bot_user_id_.load();
-  if (allowed <= 0) {
+  if (allowed_bot_ids_.empty()) {
     // Not resolved yet; safest is to DROP until resolved.
     return false;
   }
@@ -422,5 +644,5 @@ bool TelegramTdLibClient::is_allowed_sender(const json& message) const
   if (st != "messageSenderUser") return false;
 
   const long long uid = sid.value("user_id", 0LL);
-  return uid == allowed;
+  return std::find(allowed_bot_ids_.begin(), allowed_bot_ids_.end(), uid) != allowed_bot_ids_.end();
 }
@@ -1,13 +1,35 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
+#include "capture_file.hpp"
 #include "nlohmann_json.hpp" // IMPORTANT: include, don't forward-declare
 
+// What TDLib keeps on disk for this session
+struct TdStorageOptions {
+  // Only new bot messages matter: no file/chat/message databases, no
+  // thumbnails or file names, no persisted network statistics
+  bool     minimal = false;
+  uint64_t limit_bytes = 0;       // optimizeStorage size limit, 0 = never run it
+  int      ttl_days = 3;          // files unused this long are removed first
+  int      interval_hours = 6;    // between optimizeStorage runs (first ~1 min after login)
+};
+
+struct TdStorageStats {
+  uint64_t session_bytes = 0; // session dir, measured after login and each optimize
+  double   open_ms = 0.0;     // setTdlibParameters -> database open (next auth state)
+  double   ready_ms = 0.0;    // start() -> authorizationStateReady
+  uint64_t optimized = 0;     // optimizeStorage runs completed
+  bool     minimal = false;
+};
+
 class TelegramTdLibClient {
 public:
   using OnTextMessage = std::function<void(long long chat_id, const std::string& text)>;
@@ -23,6 +45,17 @@ public:
 
   void stop();
 
+  // Session database encryption, set before start(). `db_key` (base64,
+  // "" = unencrypted) opens the database; when `rekey_to` differs, the
+  // database is re-encrypted with it once authorized and `on_rekeyed`
+  // reports the outcome (TDLib thread).
+  using OnRekeyed = std::function<void(bool ok)>;
+  void set_database_key(const std::string& db_key, const std::string& rekey_to, OnRekeyed on_rekeyed);
+
+  // Database profile + storage optimizer, set before start()
+  void set_storage_options(const TdStorageOptions& opts);
+  TdStorageStats storage_stats() const;
+
   // auth helpers
   std::string auth_state() const;
 
@@ -39,14 +72,24 @@ public:
   void submit_code(const std::string& code);
   void submit_password(const std::string& password);
 
-  // bot-only filtering
-  void set_allowed_bot_username(const std::string& username);
+  // bot-only filtering: messages from these bots (usernames, '@'
+  // optional) are events, everything else is dropped. Set before start();
+  // each is resolved once logged in.
+  void set_allowed_bots(const std::vector<std::string>& usernames);
+
+  // record mode: every updateNewMessage (raw JSON, accepted or filtered) is
+  // appended to each added writer. After remove_capture() returns, `w` is
+  // no longer written to.
+  void add_capture(CaptureWriter* w);
+  void remove_capture(CaptureWriter* w);
 
 private:
   void run();
   void send_json(const std::string& s);
 
-  void resolve_allowed_bot();
+  void resolve_allowed_bots();
+  void optimize_storage();
+  void measure_session_dir();
   bool is_allowed_sender(const nlohmann::json& message) const;
 
   // thread / lifecycle
@@ -60,6 +103,17 @@ private:
   std::string api_id_;
   std::string api_hash_;
   std::string session_dir_;
+  std::string db_key_;
+  std::string rekey_to_;
+  OnRekeyed on_rekeyed_;
+
+  // storage profile + timings (TDLib thread writes, stats read under the mutex)
+  TdStorageOptions storage_;
+  mutable std::mutex stats_mutex_;
+  TdStorageStats stats_;
+  std::chrono::steady_clock::time_point started_at_;
+  std::chrono::steady_clock::time_point params_sent_at_;
+  std::chrono::steady_clock::time_point next_optimize_ = std::chrono::steady_clock::time_point::max();
 
   // login values (optional)
   std::mutex auth_mutex_;
@@ -78,7 +132,12 @@ private:
   mutable std::mutex auth_cb_mutex_;
   OnAuthState auth_cb_;
 
-  // bot filter state
-  std::string allowed_bot_username_ = "EddieLives_bot";
-  std::atomic<long long> allowed_bot_user_id_{0};
+  // bot filter state: usernames set before start(), ids filled in as
+  // they resolve (TDLib thread only)
+  std::vector<std::string> allowed_bots_;
+  std::vector<long long> allowed_bot_ids_;
+
+  // record mode
+  std::mutex capture_mutex_;
+  std::vector<CaptureWriter*> captures_;
 };
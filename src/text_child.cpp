@@ -0,0 +1,57 @@
+#include "text_child.hpp"
+
+static void set_font(obs_data_t* d, const TextStyle& st)
+{
+  obs_data_t* font = obs_data_create();
+  obs_data_set_string(font, "face", st.font_face.empty() ? "Arial" : st.font_face.c_str());
+  obs_data_set_int(font, "size", st.size);
+  obs_data_set_int(font, "flags", 0);
+  obs_data_set_obj(d, "font", font);
+  obs_data_release(font);
+}
+
+#ifdef _WIN32
+
+const char* text_child_source_id()
+{
+  return "text_gdiplus";
+}
+
+void text_child_apply_style(obs_data_t* d, const TextStyle& st)
+{
+  set_font(d, st);
+
+  // text_gdiplus uses RGB (0xRRGGBB)
+  obs_data_set_int(d, "color", (int)st.color);
+  obs_data_set_int(d, "opacity", 100);
+
+  obs_data_set_bool(d, "outline", false);
+  obs_data_set_int(d, "outline_size", 0);
+
+  // align left/top
+  obs_data_set_int(d, "align", 0);
+  obs_data_set_int(d, "valign", 0);
+}
+
+#else
+
+const char* text_child_source_id()
+{
+  return "text_ft2_source";
+}
+
+void text_child_apply_style(obs_data_t* d, const TextStyle& st)
+{
+  set_font(d, st);
+
+  // text_ft2_source takes the alpha byte from color1/color2; keep it opaque
+  const uint32_t c = 0xFF000000u | (st.color & 0x00FFFFFF);
+  obs_data_set_int(d, "color1", c);
+  obs_data_set_int(d, "color2", c);
+
+  obs_data_set_bool(d, "outline", false);
+  obs_data_set_bool(d, "drop_shadow", false);
+  obs_data_set_bool(d, "word_wrap", false);
+}
+
+#endif
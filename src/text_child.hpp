@@ -0,0 +1,27 @@
+#pragma once
+
+#include <obs-module.h>
+
+#include <cstdint>
+#include <string>
+
+// Alert text style; compared as a whole to detect changes.
+// Font, size and color go into the text child; outline is drawn by TextRenderer.
+struct TextStyle
+{
+  uint32_t color = 0x00FFFF00; // 0xRRGGBB
+  int size = 36;
+  bool outline = true;
+  int outline_size = 2;
+  std::string font_face = "Arial";
+
+  bool operator==(const TextStyle&) const = default;
+};
+
+// Platform text source used for the alert text:
+// text_gdiplus on Windows, the FreeType text source elsewhere.
+const char* text_child_source_id();
+
+// Font, color and alignment at full opacity, no outline (both are shader
+// uniforms in TextRenderer)
+void text_child_apply_style(obs_data_t* d, const TextStyle& st);
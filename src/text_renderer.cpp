@@ -0,0 +1,226 @@
+#include "text_renderer.hpp"
+
+#include <algorithm>
+
+// Premultiplied text texture in, premultiplied fill-over-outline out.
+// The outline is the max alpha over two rings of taps around each pixel,
+// so its thickness is a uniform instead of a text source setting.
+static const char* kTextEffect = R"(
+uniform float4x4 ViewProj;
+uniform texture2d image;
+uniform float opacity;
+uniform float outline_px;
+uniform float4 outline_color;
+uniform float2 texel;
+
+sampler_state textSampler {
+  Filter   = Linear;
+  AddressU = Border;
+  AddressV = Border;
+  BorderColor = 00000000;
+};
+
+struct VertInOut {
+  float4 pos : POSITION;
+  float2 uv  : TEXCOORD0;
+};
+
+VertInOut VSText(VertInOut vert_in)
+{
+  VertInOut vert_out;
+  vert_out.pos = mul(float4(vert_in.pos.xyz, 1.0), ViewProj);
+  vert_out.uv  = vert_in.uv;
+  return vert_out;
+}
+
+float4 PSText(VertInOut vert_in) : TARGET
+{
+  float4 fill = image.Sample(textSampler, vert_in.uv);
+
+  float ring = 0.0;
+  if (outline_px > 0.0) {
+    for (int i = 0; i < 16; i++) {
+      float a = 0.39269908 * float(i);
+      float2 dir = float2(cos(a), sin(a)) * texel;
+      ring = max(ring, image.Sample(textSampler, vert_in.uv + dir * outline_px).a);
+      ring = max(ring, image.Sample(textSampler, vert_in.uv + dir * (outline_px * 0.5)).a);
+    }
+  }
+
+  float4 outline = float4(outline_color.rgb * outline_color.a, outline_color.a) * ring;
+  return (fill + outline * (1.0 - fill.a)) * opacity;
+}
+
+technique Draw
+{
+  pass
+  {
+    vertex_shader = VSText(vert_in);
+    pixel_shader  = PSText(vert_in);
+  }
+}
+)";
+
+bool TextRenderer::load_effect()
+{
+  if (effect_)
+    return true;
+  if (effect_failed_)
+    return false;
+
+  char* errors = nullptr;
+  effect_ = gs_effect_create(kTextEffect, "twich_text.effect", &errors);
+  if (!effect_) {
+    blog(LOG_WARNING, "[TWICH] text effect failed to compile: %s", errors ? errors : "(no log)");
+    bfree(errors);
+    effect_failed_ = true;
+    return false;
+  }
+
+  p_image_         = gs_effect_get_param_by_name(effect_, "image");
+  p_opacity_       = gs_effect_get_param_by_name(effect_, "opacity");
+  p_outline_px_    = gs_effect_get_param_by_name(effect_, "outline_px");
+  p_outline_color_ = gs_effect_get_param_by_name(effect_, "outline_color");
+  p_texel_         = gs_effect_get_param_by_name(effect_, "texel");
+  return true;
+}
+
+bool TextRenderer::rasterize(obs_source_t* child, uint32_t pad)
+{
+  const uint32_t w = obs_source_get_width(child);
+  const uint32_t h = obs_source_get_height(child);
+  if (!w || !h)
+    return false;
+
+  if (!target_) {
+    target_ = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+    if (!target_)
+      return false;
+  }
+
+  const uint32_t cx = w + pad * 2;
+  const uint32_t cy = h + pad * 2;
+
+  gs_texrender_reset(target_);
+  if (!gs_texrender_begin(target_, cx, cy))
+    return false;
+
+  vec4 clear;
+  vec4_zero(&clear);
+  gs_clear(GS_CLEAR_COLOR, &clear, 0.0f, 0);
+  gs_ortho(0.0f, (float)cx, 0.0f, (float)cy, -100.0f, 100.0f);
+
+  // Keep alpha exact and color premultiplied so the outline pass can composite
+  gs_blend_state_push();
+  gs_blend_function_separate(GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA,
+                             GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+
+  gs_matrix_push();
+  gs_matrix_translate3f((float)pad, (float)pad, 0.0f);
+  obs_source_video_render(child);
+  gs_matrix_pop();
+
+  gs_blend_state_pop();
+  gs_texrender_end(target_);
+
+  cx_ = cx;
+  cy_ = cy;
+  pad_ = pad;
+  return true;
+}
+
+uint32_t TextRenderer::padding_for(const TextStyle& st)
+{
+  // One extra texel keeps linear filtering off the border
+  return (st.outline && st.outline_size > 0 ? (uint32_t)st.outline_size : 0) + 1;
+}
+
+bool TextRenderer::stale(const TextStyle& st) const
+{
+  return settle_frames_.load() > 0 || padding_for(st) != pad_ || !cx_;
+}
+
+bool TextRenderer::prepare(obs_source_t* child, const TextStyle& st)
+{
+  if (!child)
+    return false;
+
+  const uint32_t pad = padding_for(st);
+
+  int pending = settle_frames_.load();
+  if (pending > 0 || pad != pad_ || !cx_) {
+    if (rasterize(child, pad) && pending > 0)
+      settle_frames_.compare_exchange_strong(pending, pending - 1);
+  }
+
+  return cx_ && cy_;
+}
+
+void TextRenderer::draw(const TextStyle& st, float opacity)
+{
+  draw_region(st, opacity, 0, 0, cx_, cy_);
+}
+
+void TextRenderer::draw_region(const TextStyle& st, float opacity, uint32_t x, uint32_t y, uint32_t cx, uint32_t cy)
+{
+  if (!target_ || !cx_ || !cy_ || opacity <= 0.0f)
+    return;
+
+  if (x >= cx_ || y >= cy_)
+    return;
+  cx = std::min(cx, cx_ - x);
+  cy = std::min(cy, cy_ - y);
+  if (!cx || !cy)
+    return;
+
+  gs_texture_t* tex = gs_texrender_get_texture(target_);
+  if (!tex)
+    return;
+
+  if (!load_effect())
+    return;
+
+  vec2 texel;
+  texel.x = 1.0f / (float)cx_;
+  texel.y = 1.0f / (float)cy_;
+
+  vec4 outline_color;
+  vec4_set(&outline_color, 0.0f, 0.0f, 0.0f, 1.0f); // solid black
+
+  gs_effect_set_texture(p_image_, tex);
+  gs_effect_set_float(p_opacity_, opacity > 1.0f ? 1.0f : opacity);
+  gs_effect_set_float(p_outline_px_, st.outline ? (float)st.outline_size : 0.0f);
+  gs_effect_set_vec4(p_outline_color_, &outline_color);
+  gs_effect_set_vec2(p_texel_, &texel);
+
+  gs_blend_state_push();
+  gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+
+  if (x == 0 && y == 0 && cx == cx_ && cy == cy_) {
+    while (gs_effect_loop(effect_, "Draw"))
+      gs_draw_sprite(tex, 0, cx_, cy_);
+  } else {
+    gs_matrix_push();
+    gs_matrix_translate3f((float)x, (float)y, 0.0f);
+    while (gs_effect_loop(effect_, "Draw"))
+      gs_draw_sprite_subregion(tex, 0, x, y, cx, cy);
+    gs_matrix_pop();
+  }
+
+  gs_blend_state_pop();
+}
+
+void TextRenderer::release()
+{
+  if (target_) {
+    gs_texrender_destroy(target_);
+    target_ = nullptr;
+  }
+  if (effect_) {
+    gs_effect_destroy(effect_);
+    effect_ = nullptr;
+  }
+  effect_failed_ = false;
+  cx_ = cy_ = pad_ = 0;
+  settle_frames_.store(kSettleFrames);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <obs-module.h>
+#include <graphics/graphics.h>
+
+#include <atomic>
+#include <cstdint>
+
+#include "text_child.hpp"
+
+// Cached alert text, used when there is no glyph atlas (see GlyphRenderer).
+// The platform text source is only used as a rasterizer: it is drawn into an
+// offscreen texture when the text or style changes, and every frame after
+// that is one textured quad. Opacity and outline are shader uniforms, so a
+// fade never touches the text child's settings.
+class TextRenderer {
+public:
+  TextRenderer() = default;
+
+  TextRenderer(const TextRenderer&) = delete;
+  TextRenderer& operator=(const TextRenderer&) = delete;
+
+  // Text or style changed; safe from any thread.
+  void invalidate() { settle_frames_.store(kSettleFrames); }
+
+  // True when the next prepare() will re-rasterize
+  bool stale(const TextStyle& st) const;
+
+  // Graphics thread: re-rasterizes `child` if needed.
+  // Returns false while there is nothing to draw.
+  bool prepare(obs_source_t* child, const TextStyle& st);
+
+  // Size of the cached texture including the outline padding
+  uint32_t width() const { return cx_; }
+  uint32_t height() const { return cy_; }
+  uint32_t padding() const { return pad_; }
+
+  // Graphics thread: draws the cached texture at the current matrix
+  void draw(const TextStyle& st, float opacity);
+
+  // Same for the texture rectangle at (x, y), drawn at its own offset
+  // (per-line strips for the character reveal)
+  void draw_region(const TextStyle& st, float opacity, uint32_t x, uint32_t y, uint32_t cx, uint32_t cy);
+
+  // Frees GPU objects; call inside obs_enter_graphics()
+  void release();
+
+private:
+  // Child updates are deferred to its next video_tick, so keep re-rasterizing
+  // for a couple of frames after an invalidate.
+  static constexpr int kSettleFrames = 2;
+
+  static uint32_t padding_for(const TextStyle& st);
+
+  bool load_effect();
+  bool rasterize(obs_source_t* child, uint32_t pad);
+
+  std::atomic<int> settle_frames_{kSettleFrames};
+
+  gs_texrender_t* target_ = nullptr;
+  gs_effect_t*    effect_ = nullptr;
+  bool            effect_failed_ = false;
+
+  gs_eparam_t* p_image_ = nullptr;
+  gs_eparam_t* p_opacity_ = nullptr;
+  gs_eparam_t* p_outline_px_ = nullptr;
+  gs_eparam_t* p_outline_color_ = nullptr;
+  gs_eparam_t* p_texel_ = nullptr;
+
+  uint32_t cx_ = 0;
+  uint32_t cy_ = 0;
+  uint32_t pad_ = 0;
+};
@@ -0,0 +1,62 @@
+#include "text_template.hpp"
+
+static CompiledTemplate::Field field_for(std::string_view name)
+{
+  using F = CompiledTemplate::Field;
+  if (name == "user")    return F::User;
+  if (name == "amount")  return F::Amount;
+  if (name == "symbol")  return F::Symbol;
+  if (name == "message") return F::Message;
+  if (name == "account") return F::Account;
+  return F::Literal;
+}
+
+void CompiledTemplate::compile(std::string_view tpl)
+{
+  text_.assign(tpl.data(), tpl.size());
+  segments_.clear();
+
+  size_t lit_start = 0;
+  size_t pos = 0;
+
+  while ((pos = text_.find('{', pos)) != std::string::npos) {
+    const size_t close = text_.find('}', pos + 1);
+    if (close == std::string::npos) break;
+
+    const Field f = field_for(std::string_view(text_).substr(pos + 1, close - pos - 1));
+    if (f == Field::Literal) {
+      // Unknown placeholder: keep it verbatim
+      pos += 1;
+      continue;
+    }
+
+    if (pos > lit_start)
+      segments_.push_back({Field::Literal, lit_start, pos - lit_start});
+    segments_.push_back({f, 0, 0});
+
+    pos = close + 1;
+    lit_start = pos;
+  }
+
+  if (lit_start < text_.size())
+    segments_.push_back({Field::Literal, lit_start, text_.size() - lit_start});
+}
+
+std::string CompiledTemplate::render(const TipEvent& ev) const
+{
+  std::string out;
+  out.reserve(text_.size() + 64);
+
+  for (const Segment& seg : segments_) {
+    switch (seg.field) {
+    case Field::Literal: out.append(text_, seg.off, seg.len); break;
+    case Field::User:    out.append(ev.from_username()); break;
+    case Field::Amount:  out.append(ev.amount_str()); break;
+    case Field::Symbol:  out.append(ev.symbol); break;
+    case Field::Message: out.append(ev.message()); break;
+    case Field::Account: out.append(ev.account); break;
+    }
+  }
+
+  return out;
+}
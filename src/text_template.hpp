@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "event_parse.hpp"
+
+// Alert text template ("{user} tipped {amount} {symbol}\n{message}")
+// compiled once into literal/field segments, so rendering is a single
+// append pass instead of repeated find/replace.
+class CompiledTemplate {
+public:
+  enum class Field : unsigned char { Literal, User, Amount, Symbol, Message, Account };
+
+  CompiledTemplate() = default;
+  explicit CompiledTemplate(std::string_view tpl) { compile(tpl); }
+
+  void compile(std::string_view tpl);
+  bool empty() const { return segments_.empty(); }
+
+  std::string render(const TipEvent& ev) const;
+
+private:
+  struct Segment {
+    Field  field = Field::Literal;
+    size_t off = 0; // literal range in text_
+    size_t len = 0;
+  };
+
+  std::string text_;
+  std::vector<Segment> segments_;
+};
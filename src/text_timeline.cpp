@@ -0,0 +1,352 @@
+#include "text_timeline.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// ------------------------------------------------------------
+// Easing
+// ------------------------------------------------------------
+float apply_ease(Ease e, float u)
+{
+  if (u <= 0.0f) return 0.0f;
+  if (u >= 1.0f) return 1.0f;
+
+  switch (e) {
+  case Ease::Linear:    return u;
+  case Ease::InQuad:    return u * u;
+  case Ease::OutQuad:   return 1.0f - (1.0f - u) * (1.0f - u);
+  case Ease::InOutQuad: return u < 0.5f ? 2.0f * u * u : 1.0f - 2.0f * (1.0f - u) * (1.0f - u);
+  case Ease::InCubic:   return u * u * u;
+  case Ease::OutCubic: {
+    const float v = 1.0f - u;
+    return 1.0f - v * v * v;
+  }
+  case Ease::InOutCubic: {
+    if (u < 0.5f)
+      return 4.0f * u * u * u;
+    const float v = 1.0f - u;
+    return 1.0f - 4.0f * v * v * v;
+  }
+  case Ease::OutBack: {
+    constexpr float c1 = 1.70158f, c3 = c1 + 1.0f;
+    const float v = u - 1.0f;
+    return 1.0f + c3 * v * v * v + c1 * v * v;
+  }
+  case Ease::OutElastic: {
+    constexpr float c4 = 2.0f * 3.14159265f / 3.0f;
+    return std::pow(2.0f, -10.0f * u) * std::sin((u * 10.0f - 0.75f) * c4) + 1.0f;
+  }
+  case Ease::OutBounce: {
+    constexpr float n1 = 7.5625f, d1 = 2.75f;
+    if (u < 1.0f / d1) return n1 * u * u;
+    if (u < 2.0f / d1) { u -= 1.5f / d1;  return n1 * u * u + 0.75f; }
+    if (u < 2.5f / d1) { u -= 2.25f / d1; return n1 * u * u + 0.9375f; }
+    u -= 2.625f / d1;
+    return n1 * u * u + 0.984375f;
+  }
+  case Ease::Step:
+    return 0.0f; // holds until the keyframe itself
+  }
+  return u;
+}
+
+// ------------------------------------------------------------
+// Presets
+// ------------------------------------------------------------
+namespace {
+
+struct Preset {
+  const char* name;
+  const char* spec;
+};
+
+constexpr Preset kPresets[] = {
+  {"fade",       "alpha 0 0, 0.2 1, end-0.25 1, end 0"},
+  {"slide-up",   "y 0 60, 0.45 0 out-cubic; alpha 0 0, 0.3 1, end-0.3 1, end 0"},
+  {"pop",        "scale 0 0.3, 0.4 1 out-back; alpha 0 0, 0.15 1, end-0.25 1, end 0"},
+  {"bounce",     "y 0 -240, 0.7 0 out-bounce; alpha 0 0, 0.1 1, end-0.3 1, end 0"},
+  {"typewriter", "reveal 0 0, 1.5 1; alpha end-0.3 1, end 0"},
+  {"zoom",       "scale 0 1.6, 0.35 1 out-cubic, end-0.3 1, end 0.6 in-quad; "
+                 "alpha 0 0, 0.25 1, end-0.3 1, end 0"},
+  {"none",       "alpha 0 1"},
+};
+
+constexpr const char* kTrackNames[] = {"x", "y", "scale", "alpha", "reveal"};
+
+constexpr const char* kEaseNames[] = {
+  "linear", "in-quad", "out-quad", "in-out-quad", "in-cubic", "out-cubic",
+  "in-out-cubic", "out-back", "out-elastic", "out-bounce", "step",
+};
+
+std::string_view trim(std::string_view s)
+{
+  while (!s.empty() && (s.front() == ' ' || s.front() == '\t' || s.front() == '\n' || s.front() == '\r'))
+    s.remove_prefix(1);
+  while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\n' || s.back() == '\r'))
+    s.remove_suffix(1);
+  return s;
+}
+
+// Next whitespace-separated word of `s` (consumed)
+std::string_view next_word(std::string_view& s)
+{
+  s = trim(s);
+  size_t n = 0;
+  while (n < s.size() && s[n] != ' ' && s[n] != '\t')
+    ++n;
+  std::string_view w = s.substr(0, n);
+  s.remove_prefix(n);
+  return w;
+}
+
+bool parse_float(std::string_view w, float& out)
+{
+  if (w.empty() || w.size() > 31)
+    return false;
+  char buf[32];
+  w.copy(buf, w.size());
+  buf[w.size()] = '\0';
+  char* end = nullptr;
+  out = std::strtof(buf, &end);
+  return end == buf + w.size() && std::isfinite(out);
+}
+
+} // namespace
+
+size_t TextTimeline::preset_count()
+{
+  return sizeof(kPresets) / sizeof(kPresets[0]);
+}
+
+const char* TextTimeline::preset_name(size_t i)
+{
+  return i < preset_count() ? kPresets[i].name : nullptr;
+}
+
+const char* TextTimeline::preset(std::string_view name)
+{
+  for (const Preset& p : kPresets)
+    if (name == p.name)
+      return p.spec;
+  return nullptr;
+}
+
+// ------------------------------------------------------------
+// Compile
+// ------------------------------------------------------------
+bool TextTimeline::compile(std::string_view spec, std::string& error)
+{
+  spec = trim(spec);
+  if (const char* p = preset(spec))
+    spec = p;
+
+  std::vector<Key> per_track[(size_t)TimelineTrack::Count];
+
+  while (!spec.empty()) {
+    const size_t semi = spec.find(';');
+    std::string_view part = spec.substr(0, semi);
+    spec = (semi == std::string_view::npos) ? std::string_view() : spec.substr(semi + 1);
+
+    part = trim(part);
+    if (part.empty())
+      continue;
+
+    const std::string_view name = next_word(part);
+    size_t track = (size_t)TimelineTrack::Count;
+    for (size_t i = 0; i < (size_t)TimelineTrack::Count; ++i)
+      if (name == kTrackNames[i])
+        track = i;
+    if (track == (size_t)TimelineTrack::Count) {
+      error = "unknown track \"" + std::string(name) + "\" (x, y, scale, alpha, reveal)";
+      return false;
+    }
+    if (!per_track[track].empty()) {
+      error = "track \"" + std::string(name) + "\" given twice";
+      return false;
+    }
+
+    while (!part.empty()) {
+      const size_t comma = part.find(',');
+      std::string_view kf = part.substr(0, comma);
+      part = (comma == std::string_view::npos) ? std::string_view() : part.substr(comma + 1);
+
+      const std::string_view t_word = next_word(kf);
+      const std::string_view v_word = next_word(kf);
+      const std::string_view e_word = next_word(kf);
+      if (t_word.empty())
+        continue;
+
+      Key k{};
+      k.ease = Ease::Linear;
+      if (t_word.substr(0, 3) == "end") {
+        k.from_end = true;
+        std::string_view rest = t_word.substr(3);
+        if (rest.empty()) {
+          k.time = 0.0f;
+        } else if (rest.front() != '-' || !parse_float(rest.substr(1), k.time) || k.time < 0.0f) {
+          error = "bad time \"" + std::string(t_word) + "\" (use end or end-<seconds>)";
+          return false;
+        }
+      } else if (!parse_float(t_word, k.time) || k.time < 0.0f) {
+        error = "bad time \"" + std::string(t_word) + "\"";
+        return false;
+      }
+
+      if (!parse_float(v_word, k.value)) {
+        error = "keyframe \"" + std::string(t_word) + "\" of " + std::string(name) + " needs a value";
+        return false;
+      }
+
+      if (!e_word.empty()) {
+        size_t e = sizeof(kEaseNames) / sizeof(kEaseNames[0]);
+        for (size_t i = 0; i < sizeof(kEaseNames) / sizeof(kEaseNames[0]); ++i)
+          if (e_word == kEaseNames[i])
+            e = i;
+        if (e == sizeof(kEaseNames) / sizeof(kEaseNames[0])) {
+          error = "unknown easing \"" + std::string(e_word) + "\"";
+          return false;
+        }
+        k.ease = (Ease)e;
+      }
+      if (!trim(kf).empty()) {
+        error = "unexpected \"" + std::string(trim(kf)) + "\" in " + std::string(name);
+        return false;
+      }
+
+      if (per_track[track].size() >= kMaxKeysPerTrack) {
+        error = "too many keyframes in " + std::string(name);
+        return false;
+      }
+      per_track[track].push_back(k);
+    }
+  }
+
+  keys_.clear();
+  for (size_t i = 0; i < (size_t)TimelineTrack::Count; ++i) {
+    track_begin_[i] = (uint16_t)keys_.size();
+    keys_.insert(keys_.end(), per_track[i].begin(), per_track[i].end());
+  }
+  track_begin_[(size_t)TimelineTrack::Count] = (uint16_t)keys_.size();
+
+  if (keys_.empty()) {
+    error = "no keyframes";
+    return false;
+  }
+  return true;
+}
+
+TextTimeline TextTimeline::fade(float in_sec, float out_sec)
+{
+  TextTimeline tl;
+  const size_t alpha = (size_t)TimelineTrack::Alpha;
+
+  for (size_t i = 0; i <= alpha; ++i)
+    tl.track_begin_[i] = 0;
+
+  if (in_sec > 0.0f) {
+    tl.keys_.push_back({0.0f, 0.0f, Ease::Linear, false});
+    tl.keys_.push_back({in_sec, 1.0f, Ease::Linear, false});
+  } else {
+    tl.keys_.push_back({0.0f, 1.0f, Ease::Linear, false});
+  }
+  if (out_sec > 0.0f) {
+    tl.keys_.push_back({out_sec, 1.0f, Ease::Linear, true});
+    tl.keys_.push_back({0.0f, 0.0f, Ease::Linear, true});
+  }
+
+  for (size_t i = alpha + 1; i <= (size_t)TimelineTrack::Count; ++i)
+    tl.track_begin_[i] = (uint16_t)tl.keys_.size();
+  return tl;
+}
+
+// ------------------------------------------------------------
+// Sample
+// ------------------------------------------------------------
+float TextTimeline::eval(size_t track, float t, float duration, float fallback) const
+{
+  const size_t b = track_begin_[track];
+  const size_t e = track_begin_[track + 1];
+  if (b == e)
+    return fallback;
+
+  // absolute key times, kept non-decreasing so a short alert squeezes
+  // "end-" keys against the opening ones instead of reordering them
+  float prev_t = 0.0f;
+  float prev_v = keys_[b].value;
+  for (size_t i = b; i < e; ++i) {
+    const Key& k = keys_[i];
+    float kt = k.from_end ? duration - k.time : k.time;
+    if (kt < prev_t)
+      kt = prev_t;
+
+    if (t < kt) {
+      if (i == b)
+        return k.value;
+      const float span = kt - prev_t;
+      const float u = span > 0.0f ? (t - prev_t) / span : 1.0f;
+      return prev_v + (k.value - prev_v) * apply_ease(k.ease, u);
+    }
+    prev_t = kt;
+    prev_v = k.value;
+  }
+  return prev_v;
+}
+
+TimelineSample TextTimeline::sample(float t, float duration) const
+{
+  TimelineSample s;
+  s.x = eval((size_t)TimelineTrack::X, t, duration, s.x);
+  s.y = eval((size_t)TimelineTrack::Y, t, duration, s.y);
+  s.scale = eval((size_t)TimelineTrack::Scale, t, duration, s.scale);
+  s.alpha = std::clamp(eval((size_t)TimelineTrack::Alpha, t, duration, s.alpha), 0.0f, 1.0f);
+  s.reveal = std::clamp(eval((size_t)TimelineTrack::Reveal, t, duration, s.reveal), 0.0f, 1.0f);
+  return s;
+}
+
+// ------------------------------------------------------------
+// Reveal layout
+// ------------------------------------------------------------
+RevealLayout RevealLayout::measure(std::string_view text)
+{
+  RevealLayout l;
+  size_t line = 0;
+  for (size_t i = 0; i < text.size(); ++i) {
+    const unsigned char c = (unsigned char)text[i];
+    if (c == '\n') {
+      if (line + 1 < kMaxLines)
+        ++line;
+      continue;
+    }
+    if (c == '\r' || (c & 0xC0) == 0x80) // CR, UTF-8 continuation byte
+      continue;
+    if (l.chars[line] < UINT16_MAX)
+      ++l.chars[line];
+  }
+
+  l.lines = (uint16_t)(line + 1);
+  for (size_t i = 0; i < l.lines; ++i) {
+    l.widest = std::max(l.widest, l.chars[i]);
+    l.total += l.chars[i];
+  }
+  return l;
+}
+
+float RevealLayout::visible(size_t line, float reveal) const
+{
+  if (line >= lines || !widest)
+    return 0.0f;
+  if (reveal >= 1.0f)
+    return (float)chars[line] / (float)widest;
+
+  // whole characters only: a typewriter, not a wipe
+  const uint32_t shown = (uint32_t)(reveal * (float)total + 1e-4f);
+  uint32_t before = 0;
+  for (size_t i = 0; i < line; ++i)
+    before += chars[i];
+
+  if (shown <= before)
+    return 0.0f;
+  const uint32_t n = std::min<uint32_t>(shown - before, chars[line]);
+  return (float)n / (float)widest;
+}
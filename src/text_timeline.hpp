@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Easing applied to the segment that arrives at a keyframe
+enum class Ease : uint8_t {
+  Linear,
+  InQuad,
+  OutQuad,
+  InOutQuad,
+  InCubic,
+  OutCubic,
+  InOutCubic,
+  OutBack,    // overshoots, then settles
+  OutElastic,
+  OutBounce,
+  Step,       // jumps at the keyframe
+};
+
+// u in [0..1] -> eased progress (may leave [0..1] for Back/Elastic)
+float apply_ease(Ease e, float u);
+
+enum class TimelineTrack : uint8_t {
+  X,      // px offset from the text position
+  Y,
+  Scale,  // about the text's center
+  Alpha,  // 0..1
+  Reveal, // share of characters shown, 0..1
+  Count
+};
+
+// Values of every track at one point in time
+struct TimelineSample {
+  float x = 0.0f;
+  float y = 0.0f;
+  float scale = 1.0f;
+  float alpha = 1.0f;
+  float reveal = 1.0f;
+};
+
+// Keyframe animation for the alert text, compiled once per tier.
+//
+// Spec: tracks separated by ';', each a track name followed by keyframes
+// separated by ','. A keyframe is "<time> <value> [ease]", where time is
+// seconds from the start, "end", or "end-<seconds>" (so fade-outs follow
+// the alert's length):
+//
+//   y 0 60, 0.45 0 out-cubic; alpha 0 0, 0.3 1, end-0.3 1, end 0
+//
+// A preset name ("pop", "slide-up", ...) stands for its spec. Keys live in
+// one flat array, track by track; sample() walks it without allocating.
+// Tracks without keys keep their TimelineSample default.
+class TextTimeline {
+public:
+  static constexpr size_t kMaxKeysPerTrack = 16;
+
+  bool compile(std::string_view spec_or_preset, std::string& error);
+
+  // Classic fade: in over `in_sec`, out over the last `out_sec`
+  static TextTimeline fade(float in_sec, float out_sec);
+
+  // Spec of a named preset, nullptr if unknown
+  static const char* preset(std::string_view name);
+  static size_t preset_count();
+  static const char* preset_name(size_t i);
+
+  bool empty() const { return keys_.empty(); }
+
+  // `t` seconds into an alert lasting `duration` seconds
+  TimelineSample sample(float t, float duration) const;
+
+private:
+  struct Key {
+    float time;      // seconds from the start, or before the end
+    float value;
+    Ease  ease;
+    bool  from_end;
+  };
+
+  float eval(size_t track, float t, float duration, float fallback) const;
+
+  std::vector<Key> keys_;
+  uint16_t track_begin_[(size_t)TimelineTrack::Count + 1] = {};
+};
+
+// Line/character layout of the rendered text, for the per-character reveal.
+// The text child renders left-aligned, one line per '\n', so a line's
+// first n characters are approximated by the left n/widest of the glyph box.
+struct RevealLayout {
+  static constexpr size_t kMaxLines = 16; // further lines count as the last
+
+  uint16_t lines = 1;
+  uint16_t chars[kMaxLines] = {};
+  uint16_t widest = 0;
+  uint32_t total = 0;
+
+  static RevealLayout measure(std::string_view text);
+
+  // Visible share [0..1] of the glyph box width on `line` at `reveal`
+  float visible(size_t line, float reveal) const;
+};
@@ -0,0 +1,69 @@
+#include "tier_table.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+void TierTable::rebuild(std::vector<TierSpec> specs,
+                        const std::string& fallback_template,
+                        float default_duration_sec)
+{
+  std::vector<size_t> order(specs.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return specs[a].min_milli < specs[b].min_milli;
+  });
+
+  keys_.clear();
+  tiers_.clear();
+  keys_.reserve(specs.size());
+  tiers_.reserve(specs.size());
+
+  std::string media;
+  std::string tpl = fallback_template;
+  std::string sound;
+  std::shared_ptr<const TextTimeline> effect;
+  float duration = default_duration_sec;
+  bool duration_set = false;
+
+  for (size_t i : order) {
+    TierSpec& sp = specs[i];
+
+    if (!sp.media.empty()) media = std::move(sp.media);
+    if (!sp.text_template.empty()) tpl = std::move(sp.text_template);
+    if (!sp.sound.empty()) sound = std::move(sp.sound);
+
+    // compiled once here; tiers inheriting it share the same key arrays
+    std::string effect_error;
+    if (!sp.effect.empty()) {
+      auto tl = std::make_shared<TextTimeline>();
+      if (tl->compile(sp.effect, effect_error))
+        effect = std::move(tl);
+    }
+    if (sp.duration_sec > 0.f) {
+      duration = sp.duration_sec;
+      duration_set = true;
+    }
+
+    Tier t;
+    t.index = (int)i;
+    t.min_milli = sp.min_milli;
+    t.media = media;
+    t.tpl.compile(tpl);
+    t.duration_sec = duration;
+    t.duration_set = duration_set;
+    t.sound = sound;
+    t.effect = effect;
+    t.effect_error = std::move(effect_error);
+
+    keys_.push_back(t.min_milli);
+    tiers_.push_back(std::move(t));
+  }
+}
+
+const Tier* TierTable::lookup(long long amount_milli) const
+{
+  auto it = std::upper_bound(keys_.begin(), keys_.end(), amount_milli);
+  if (it == keys_.begin())
+    return nullptr;
+  return &tiers_[(size_t)(it - keys_.begin()) - 1];
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "text_template.hpp"
+#include "text_timeline.hpp"
+
+// One alert tier as configured in the properties
+struct TierSpec {
+  long long   min_milli = 0;      // threshold in fixed-point thousandths
+  std::string media;              // WebM path ("" = inherit from lower tier)
+  std::string text_template;      // "" = inherit (lowest tier falls back to the kind template)
+  float       duration_sec = 0.f; // 0 = inherit / source default
+  std::string sound;              // audio clip path ("" = inherit)
+  std::string effect;             // text timeline preset or spec ("" = inherit)
+};
+
+// Resolved tier: inherited fields filled in, template compiled
+struct Tier {
+  int              index = 0;     // position in the settings (0-based), for logging/UI
+  long long        min_milli = 0;
+  std::string      media;
+  CompiledTemplate tpl;
+  float            duration_sec = 0.f;
+  bool             duration_set = false; // this or a lower tier has an explicit duration
+  std::string      sound;
+  std::shared_ptr<const TextTimeline> effect; // nullptr = the source's plain fade
+  std::string      effect_error; // why this tier's own effect did not compile
+};
+
+// Sorted tier table, rebuilt when settings change and queried per event
+// with a binary search on the fixed-point amount.
+class TierTable {
+public:
+  // Sorts by threshold (stable, so equal thresholds keep settings order) and
+  // resolves inheritance: an empty field takes the value of the next lower tier.
+  void rebuild(std::vector<TierSpec> specs,
+               const std::string& fallback_template,
+               float default_duration_sec);
+
+  // Highest tier whose threshold is <= amount_milli; nullptr if none
+  const Tier* lookup(long long amount_milli) const;
+
+  size_t size() const { return tiers_.size(); }
+  const Tier& at(size_t i) const { return tiers_[i]; }
+
+private:
+  std::vector<long long> keys_; // thresholds, contiguous for the search
+  std::vector<Tier> tiers_;
+};
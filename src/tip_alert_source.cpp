@@ -1,26 +1,46 @@
 #include "tip_alert_source.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <string>
+#include <vector>
 
 #include <obs-module.h>
 #include <graphics/graphics.h>
+#include <util/platform.h>
 
 #include "config.hpp"
 #include "event_parse.hpp"
-
-// Build a session dir next to config.json (portable, writable)
-static std::string session_dir_from_config_path()
+#include "nlohmann_json.hpp"
+#include "route_dispatch.hpp"
+#include "text_child.hpp"
+
+// Per-source spill journal next to config.json (removed when the queue
+// drains). Named by the source's UUID, which the scene collection keeps,
+// so a journal left by a crash is replayed when the source is created again.
+static std::string spill_journal_path(const tip_alert_source* s)
 {
   std::string cfg = twich_config_path();
   auto pos = cfg.find_last_of("\\/");
-  std::string folder = (pos == std::string::npos) ? "." : cfg.substr(0, pos);
+  std::string folder = (pos == std::string::npos) ? "." : cfg.substr(0, pos + 1);
+
+  const char* uuid = s->source ? obs_source_get_uuid(s->source) : nullptr;
+  if (!uuid || !*uuid)
+    return std::string();   // no stable name: spilling is off
 
-#ifdef _WIN32
-  return folder + "\\tg_session";
-#else
-  return folder + "/tg_session";
-#endif
+  return folder + "event_spill_" + uuid + ".jsonl";
+}
+
+static void apply_queue_settings(tip_alert_source* s)
+{
+  int kb = s->queue_budget_kb;
+  if (kb < 16) kb = 16;
+
+  s->queue.configure((size_t)kb * 1024, (OverflowPolicy)s->queue_policy, spill_journal_path(s));
 }
 
 static const char* tip_alert_get_name(void*)
@@ -28,18 +48,41 @@ static const char* tip_alert_get_name(void*)
   return "TWICH Tip Alerts (Telegram)";
 }
 
+// Settings key for an event kind: tips use the bare key, others are prefixed
+static std::string kind_key(EventKind kind, const std::string& key)
+{
+  return std::string(event_kind_info(kind).setting_prefix) + key;
+}
+
+static std::string tier_key(EventKind kind, int tier, const char* field)
+{
+  return kind_key(kind, "tier" + std::to_string(tier + 1) + "_" + field);
+}
+
 static void tip_alert_defaults(obs_data_t* settings)
 {
-  // Tier defaults
-  obs_data_set_default_double(settings, "tier1_threshold", 0.0);
-  obs_data_set_default_double(settings, "tier2_threshold", 10.0);
-  obs_data_set_default_double(settings, "tier3_threshold", 50.0);
+  // Per-kind tier + template defaults
+  for (int k = 0; k < kEventKindCount; ++k) {
+    const EventKind kind = (EventKind)k;
+    const EventKindInfo& info = event_kind_info(kind);
+
+    obs_data_set_default_int(settings, kind_key(kind, "tier_count").c_str(), 3);
+
+    for (int t = 0; t < kMaxTiers; ++t) {
+      const double thr = (t < 3) ? info.default_thresholds[t] : info.default_thresholds[2];
+      obs_data_set_default_double(settings, tier_key(kind, t, "threshold").c_str(), thr);
+      obs_data_set_default_string(settings, tier_key(kind, t, "media").c_str(), "");
+      obs_data_set_default_string(settings, tier_key(kind, t, "template").c_str(), "");
+      obs_data_set_default_double(settings, tier_key(kind, t, "duration").c_str(), 0.0);
+      obs_data_set_default_string(settings, tier_key(kind, t, "sound").c_str(), "");
+      obs_data_set_default_string(settings, tier_key(kind, t, "effect").c_str(), "");
+    }
 
-  // Legacy + tier media
+    obs_data_set_default_string(settings, kind_key(kind, "text_template").c_str(), info.default_template);
+  }
+
+  // Legacy
   obs_data_set_default_string(settings, "animation", "");
-  obs_data_set_default_string(settings, "tier1_media", "");
-  obs_data_set_default_string(settings, "tier2_media", "");
-  obs_data_set_default_string(settings, "tier3_media", "");
 
   // Text UI defaults
   obs_data_set_default_int(settings,  "text_color",  0x000000aa); // red (0xRRGGBB)
@@ -50,18 +93,66 @@ static void tip_alert_defaults(obs_data_t* settings)
 
   obs_data_set_default_int(settings, "text_position", 0); // top
   obs_data_set_default_int(settings, "text_margin", 40);
+  obs_data_set_default_int(settings, "alert_lanes", 1);
 
   obs_data_set_default_double(settings, "text_fade_in",  0.20);
   obs_data_set_default_double(settings, "text_fade_out", 0.25);
 
-  obs_data_set_default_string(
-    settings,
-    "text_template",
-    "{user} tipped {amount} {symbol}\n{message}"
-  );
-
   // Match header default
   obs_data_set_default_double(settings, "duration", 8.9);
+  obs_data_set_default_bool(settings, "duration_from_media", false);
+
+  // Moderation (no word list = off)
+  obs_data_set_default_string(settings, "moderation_list", "");
+  obs_data_set_default_int(settings, "moderation_policy", (int)ModerationPolicy::Mask);
+
+  // Manual approval (off); held events that passed the list auto-approve after a minute
+  obs_data_set_default_bool(settings, "approval_hold_all", false);
+  obs_data_set_default_int(settings, "approval_timeout", 60);
+
+  // Text-to-speech (off)
+  obs_data_set_default_bool(settings, "tts_enabled", false);
+  obs_data_set_default_int(settings, "tts_engine", 0);
+  obs_data_set_default_string(settings, "tts_command", CommandTtsEngine::default_command());
+  obs_data_set_default_int(settings, "tts_deadline_ms", 3000);
+  obs_data_set_default_double(settings, "tts_delay", 0.5);
+
+  // Older alert sounds drop by this much while a newer one plays
+  obs_data_set_default_int(settings, "sound_duck_db", 12);
+
+  // Tier files up to this size are read once in the background (0 = off)
+  obs_data_set_default_int(settings, "asset_preload_mb", 32);
+
+  // Children: created on activation, kept for good (0 = no idle teardown)
+  obs_data_set_default_bool(settings, "child_warmup", true);
+
+  // Telegram account this source shows (bots empty = keep the saved list)
+  obs_data_set_default_string(settings, "tg_account", kDefaultTgAccount);
+  obs_data_set_default_string(settings, "tg_account_bots", "");
+
+  // Telegram session database encrypted (stored in config.json on Save)
+  obs_data_set_default_bool(settings, "tg_encrypt_session", true);
+
+  // TDLib keeps everything on disk; no periodic optimizeStorage
+  obs_data_set_default_int(settings, "tg_db_profile", 0);
+  obs_data_set_default_int(settings, "tg_storage_limit_mb", 0);
+  obs_data_set_default_int(settings, "tg_optimize_hours", 6);
+  obs_data_set_default_int(settings, "child_idle_teardown_min", 0);
+
+  // Event queue memory budget
+  obs_data_set_default_int(settings, "queue_budget_kb", 256);
+  obs_data_set_default_int(settings, "queue_overflow_policy", (int)OverflowPolicy::Reject);
+
+  // Record mode (off)
+  obs_data_set_default_string(settings, "capture_path", "");
+
+  // Browser-overlay event feed (off)
+  obs_data_set_default_bool(settings, "feed_enabled", false);
+  obs_data_set_default_int(settings, "feed_port", 17480);
+
+  // Render-path profiler
+  obs_data_set_default_bool(settings, "profiler_enabled", false);
+  obs_data_set_default_string(settings, "profiler_trace_path", "");
 }
 
 // Read a string from current source settings (works even before user clicks OK)
@@ -73,31 +164,6 @@ static std::string get_setting_str(obs_source_t* src, const char* key)
   return v;
 }
 
-// ---- template helpers ----
-static void replace_all(std::string& s, const std::string& from, const std::string& to)
-{
-  if (from.empty()) return;
-  size_t pos = 0;
-  while ((pos = s.find(from, pos)) != std::string::npos) {
-    s.replace(pos, from.size(), to);
-    pos += to.size();
-  }
-}
-
-static std::string format_tip_text(const tip_alert_source* s, const TipEvent& ev)
-{
-  std::string out = s->text_template.empty()
-    ? std::string("{user} tipped {amount} {symbol}\n{message}")
-    : s->text_template;
-
-  replace_all(out, "{user}", ev.from_username);
-  replace_all(out, "{amount}", ev.amount_str);
-  replace_all(out, "{symbol}", ev.symbol);
-  replace_all(out, "{message}", ev.message);
-
-  return out;
-}
-
 // Blend RGB colors (both 0xRRGGBB). t in [0..1], returns a*(1-t)+b*t
 static uint32_t lerp_rgb(uint32_t a, uint32_t b, float t)
 {
@@ -119,278 +185,469 @@ static uint32_t lerp_rgb(uint32_t a, uint32_t b, float t)
   return ((uint32_t)rr << 16) | ((uint32_t)rg << 8) | (uint32_t)rb;
 }
 
-// Apply consistent styling to Text (GDI+)
-static void apply_tip_text_style(
-  obs_data_t* d,
-  uint32_t color_rgb,
-  const std::string& face,
-  int text_size,
-  bool outline_enabled,
-  int outline_size)
+// Tier specs of one kind as configured (legacy "animation" fills tip tier 1)
+static std::vector<TierSpec> read_tier_specs(obs_data_t* settings, EventKind kind)
 {
-  obs_data_t* font = obs_data_create();
-  obs_data_set_string(font, "face", face.empty() ? "Arial" : face.c_str());
-  obs_data_set_int(font, "size", text_size);
-  obs_data_set_int(font, "flags", 0);
-  obs_data_set_obj(d, "font", font);
-  obs_data_release(font);
-
-  // text_gdiplus uses RGB (0xRRGGBB)
-  obs_data_set_int(d, "color", (int)color_rgb);
+  int count = (int)obs_data_get_int(settings, kind_key(kind, "tier_count").c_str());
+  if (count < 1) count = 1;
+  if (count > kMaxTiers) count = kMaxTiers;
+
+  std::vector<TierSpec> specs((size_t)count);
+  for (int t = 0; t < count; ++t) {
+    TierSpec& sp = specs[(size_t)t];
+    sp.min_milli = llround(obs_data_get_double(settings, tier_key(kind, t, "threshold").c_str()) * 1000.0);
+    sp.media = obs_data_get_string(settings, tier_key(kind, t, "media").c_str());
+    sp.text_template = obs_data_get_string(settings, tier_key(kind, t, "template").c_str());
+    sp.duration_sec = (float)obs_data_get_double(settings, tier_key(kind, t, "duration").c_str());
+    sp.sound = obs_data_get_string(settings, tier_key(kind, t, "sound").c_str());
+    sp.effect = obs_data_get_string(settings, tier_key(kind, t, "effect").c_str());
+  }
 
-  obs_data_set_bool(d, "outline", outline_enabled);
-  obs_data_set_int(d, "outline_size", outline_enabled ? outline_size : 0);
-  obs_data_set_int(d, "outline_color", 0x000000); // black RGB
+  // legacy single animation
+  if (kind == EventKind::Tip && specs[0].media.empty())
+    specs[0].media = obs_data_get_string(settings, "animation");
 
-  // align left/top
-  obs_data_set_int(d, "align", 0);
-  obs_data_set_int(d, "valign", 0);
+  return specs;
 }
 
-// Fade helper:
-// - Use "opacity" for reliable fill fading.
-// - Additionally: make outline_color blend toward fill color as opacity decreases,
-//   so outline visually "fades" too.
-static void set_text_opacity(tip_alert_source* s, int opacity_0_100)
+// Rebuild one kind's tier table from settings (only when its settings changed)
+static void load_profile(tip_alert_source* s, obs_data_t* settings, EventKind kind)
 {
-  if (!s || !s->text) return;
+  if (kind == EventKind::Tip)
+    s->animation_path = obs_data_get_string(settings, "animation");
+
+  AlertProfile& prof = s->profiles[(int)kind];
+  build_alert_profile(prof, kind, read_tier_specs(settings, kind),
+                      obs_data_get_string(settings, kind_key(kind, "text_template").c_str()),
+                      s->duration_sec);
+
+  for (size_t i = 0; i < prof.tiers.size(); ++i) {
+    const Tier& t = prof.tiers.at(i);
+    if (!t.effect_error.empty())
+      blog(LOG_WARNING, "[TWICH] %s tier %d text effect: %s (using the lower tier's)",
+           event_kind_info(kind).setting_prefix, t.index + 1, t.effect_error.c_str());
+  }
+}
 
-  if (opacity_0_100 < 0) opacity_0_100 = 0;
-  if (opacity_0_100 > 100) opacity_0_100 = 100;
+// Hand the WAV tier sounds to the background decoder (at the output rate);
+// files it already decoded are reused, and the tick swaps the new bank in.
+// Other formats (or a WAV that fails to decode) play through the ffmpeg
+// sound child.
+static void load_sound_bank(tip_alert_source* s)
+{
+  obs_audio_info oai = {};
+  const uint32_t rate = obs_get_audio_info(&oai) ? oai.samples_per_sec : 48000;
+
+  std::vector<std::string> paths;
+  for (int k = 0; k < kEventKindCount; ++k) {
+    const TierTable& tiers = s->profiles[k].tiers;
+    for (size_t i = 0; i < tiers.size(); ++i) {
+      const std::string& path = tiers.at(i).sound;
+      if (!path.empty() && is_wav_path(path))
+        paths.push_back(path);
+    }
+  }
 
-  if (s->last_opacity == opacity_0_100)
-    return;
+  s->sounds.submit(std::move(paths), rate);
+}
 
-  obs_data_t* td = obs_source_get_settings(s->text);
+// An event that made it past moderation: start its speech (when it will
+// play) and show it to browser overlays (even when the queue had no room)
+static void announce_event(tip_alert_source* s, const TipEvent& ev, bool will_play)
+{
+  if (will_play && !ev.message().empty())
+    s->tts.request(ev.dedupe_hash, std::string(ev.message()));
 
-  // Fill fade (works reliably)
-  obs_data_set_int(td, "opacity", opacity_0_100);
+  std::lock_guard<std::mutex> lk(s->feed_mutex);
+  if (s->feed)
+    s->feed->broadcast(ev);
+}
 
-  // Outline fade: scale outline thickness with the SAME opacity ratio
-  if (s->text_outline) {
-    const float t = (float)opacity_0_100 / 100.0f;
+// Approved by hand or by timeout: on to the alert queue
+static void release_held(tip_alert_source* s, TipEvent ev)
+{
+  announce_event(s, ev, true);
+  s->queue.push(std::move(ev));
+}
 
-    // keep it integer, and allow it to hit 0 near the end
-    int scaled = (int)lround((double)s->outline_size * (double)t);
+// Wall-clock deadline for the dock's countdown, 0 = never
+static long long held_expiry_ms(const ApprovalQueue::Held& h)
+{
+  if (h.seconds_left <= 0.0)
+    return 0;
+  const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::system_clock::now().time_since_epoch());
+  return (long long)now.count() + (long long)(h.seconds_left * 1000.0);
+}
 
-    // if you want it to drop a tiny bit earlier, uncomment:
-    // if (opacity_0_100 <= 5) scaled = 0;
+// Held queue -> moderation dock, one message per change (runs with the
+// queue locked, on whichever thread changed it)
+static void on_held_change(tip_alert_source* s, ApprovalQueue::Change what, const ApprovalQueue::Held& h)
+{
+  std::lock_guard<std::mutex> lk(s->feed_mutex);
+  if (!s->feed)
+    return;
 
-    obs_data_set_bool(td, "outline", scaled > 0);
-    obs_data_set_int(td, "outline_size", scaled);
-    obs_data_set_int(td, "outline_color", 0x000000); // keep solid black
-  } else {
-    obs_data_set_bool(td, "outline", false);
-    obs_data_set_int(td, "outline_size", 0);
+  switch (what) {
+  case ApprovalQueue::Change::Added:
+    s->feed->publish_pending(h.id, pending_to_feed_json(h.id, h, held_expiry_ms(h)));
+    break;
+  case ApprovalQueue::Change::Approved:
+    s->feed->resolve_pending(h.id, resolved_to_feed_json(h.id, "approved"));
+    break;
+  case ApprovalQueue::Change::Rejected:
+    s->feed->resolve_pending(h.id, resolved_to_feed_json(h.id, "rejected"));
+    break;
+  case ApprovalQueue::Change::Expired:
+    s->feed->resolve_pending(h.id, resolved_to_feed_json(h.id, "expired"));
+    break;
   }
+}
 
-  obs_source_update(s->text, td);
-  obs_data_release(td);
+// {"cmd":"approve"|"reject","id":"<hex>"} from the dock, on the feed's I/O
+// thread; ids held by other sources are not found and ignored
+static void on_feed_command(tip_alert_source* s, const std::string& text)
+{
+  const nlohmann::json j = nlohmann::json::parse(text, nullptr, false);
+  if (!j.is_object() || !j.contains("cmd") || !j["cmd"].is_string() ||
+      !j.contains("id") || !j["id"].is_string())
+    return;
 
-  s->last_opacity = opacity_0_100;
-}
+  const std::string cmd = j["cmd"].get<std::string>();
+  const uint64_t id = strtoull(j["id"].get<std::string>().c_str(), nullptr, 16);
 
+  if (cmd == "approve") {
+    TipEvent ev;
+    if (s->held.approve(id, ev))
+      release_held(s, std::move(ev));
+  } else if (cmd == "reject") {
+    s->held.reject(id);
+  }
+}
 
-// ---------- Status formatting ----------
-static std::string format_auth_status(const std::string& st)
+// Point the source at another feed server (or none): moves the dock
+// handler and the held entries over
+static void switch_feed(tip_alert_source* s, std::shared_ptr<EventFeedServer> feed)
 {
-  if (st == "authorizationStateWaitPhoneNumber")
-    return "Waiting for phone number\nNext: Enter phone and click \"Set Phone\".";
-  if (st == "authorizationStateWaitCode")
-    return "Waiting for login code\nNext: Enter code and click \"Submit Code\".";
-  if (st == "authorizationStateWaitPassword")
-    return "Waiting for 2FA password\nNext: Enter password and click \"Submit Password\".";
-  if (st == "authorizationStateReady")
-    return "READY (logged in)\nNext: Tips should appear when the bot sends events.";
-  if (st == "authorizationStateWaitTdlibParameters")
-    return "Initializing Telegram (TDLib)…\nNext: Wait a moment.";
-  if (st == "authorizationStateClosing")
-    return "Telegram closing…";
-  if (st == "authorizationStateClosed")
-    return "Telegram closed\nNext: Click \"Restart TDLib\".";
-  if (st.empty())
-    return "NO AUTH STATE YET\n(if logs show Ready, callback/UI update is not running)";
-  return st;
+  std::shared_ptr<EventFeedServer> old;
+  {
+    std::lock_guard<std::mutex> lk(s->feed_mutex);
+    old = std::move(s->feed);
+    s->feed = feed;
+  }
+
+  // outside feed_mutex: removal waits out a running command, which may need it
+  if (old) {
+    old->remove_command_handler(s->feed_commands);
+    s->held.replay([&](const ApprovalQueue::Held& h) {
+      old->resolve_pending(h.id, resolved_to_feed_json(h.id, "withdrawn"));
+    });
+  }
+  s->feed_commands = 0;
+
+  if (feed) {
+    s->feed_commands = feed->add_command_handler([s](const std::string& cmd) { on_feed_command(s, cmd); });
+    s->held.replay([&](const ApprovalQueue::Held& h) {
+      feed->publish_pending(h.id, pending_to_feed_json(h.id, h, held_expiry_ms(h)));
+    });
+  }
 }
 
-// ---------- UI-thread update plumbing ----------
-struct AuthStatusTask
+static bool on_approve_held(obs_properties_t*, obs_property_t*, void* data)
 {
-  obs_source_t* source = nullptr; // ref-counted
-  std::string text;
-  bool refresh_props = true;
-};
+  auto* s = (tip_alert_source*)data;
+  TipEvent ev;
+  if (!s->held.approve_oldest(ev))
+    return false;
 
-static void ui_set_auth_status(void* param)
-{
-  auto* t = (AuthStatusTask*)param;
-  if (!t) return;
+  release_held(s, std::move(ev));
+  return true;
+}
 
-  if (t->source) {
-    obs_data_t* d = obs_source_get_settings(t->source);
+static bool on_reject_held(obs_properties_t*, obs_property_t*, void* data)
+{
+  auto* s = (tip_alert_source*)data;
+  return s->held.reject_oldest();
+}
 
-    const char* prev_c = obs_data_get_string(d, "tg_auth_status");
-    const std::string prev = prev_c ? prev_c : "";
+static void on_approve_hotkey(void* data, obs_hotkey_id, obs_hotkey_t*, bool pressed)
+{
+  auto* s = (tip_alert_source*)data;
+  TipEvent ev;
+  if (pressed && s->held.approve_oldest(ev)) {
+    blog(LOG_INFO, "[TWICH] held event approved (%zu waiting)", s->held.size());
+    release_held(s, std::move(ev));
+  }
+}
 
-    if (prev != t->text) {
-      obs_data_set_string(d, "tg_auth_status", t->text.c_str());
-      obs_source_update(t->source, d);
-    }
+static void on_reject_hotkey(void* data, obs_hotkey_id, obs_hotkey_t*, bool pressed)
+{
+  auto* s = (tip_alert_source*)data;
+  if (pressed && s->held.reject_oldest())
+    blog(LOG_INFO, "[TWICH] held event rejected (%zu waiting)", s->held.size());
+}
 
-    obs_data_release(d);
+static bool on_reload_word_list(obs_properties_t*, obs_property_t*, void* data)
+{
+  auto* s = (tip_alert_source*)data;
+  obs_data_t* st = obs_source_get_settings(s->source);
+  s->word_list.submit(obs_data_get_string(st, "moderation_list"),
+                      (ModerationPolicy)obs_data_get_int(st, "moderation_policy"));
+  obs_data_release(st);
+  return true;
+}
 
-    if (t->refresh_props) {
-      obs_source_update_properties(t->source);
-    }
+// -------------------- Telegram account --------------------
+// Account named in the settings; the default one for unusable names
+static std::string account_setting(obs_data_t* settings)
+{
+  const std::string name = obs_data_get_string(settings, "tg_account");
+  if (valid_tg_account_name(name))
+    return name;
 
-    obs_source_release(t->source);
-    t->source = nullptr;
-  }
+  if (!name.empty())
+    blog(LOG_WARNING, "[TWICH] invalid Telegram account name '%s', using '%s'", name.c_str(), kDefaultTgAccount);
+  return kDefaultTgAccount;
+}
 
-  delete t;
+// Storage profile for an account this source launches or restarts
+static TdStorageOptions storage_options(tip_alert_source* s)
+{
+  obs_data_t* st = obs_source_get_settings(s->source);
+  TdStorageOptions so;
+  so.minimal        = obs_data_get_int(st, "tg_db_profile") == 1;
+  so.limit_bytes    = (uint64_t)obs_data_get_int(st, "tg_storage_limit_mb") * 1024 * 1024;
+  so.interval_hours = (int)obs_data_get_int(st, "tg_optimize_hours");
+  obs_data_release(st);
+  return so;
 }
 
-static void queue_auth_status_update(obs_source_t* source, const std::string& text, bool refresh_props)
+static std::shared_ptr<TelegramAccount> current_account(tip_alert_source* s)
 {
-  if (!source) return;
+  std::lock_guard<std::mutex> lk(s->account_mutex);
+  return s->account;
+}
 
-  auto* t = new AuthStatusTask();
-  t->text = text;
-  t->refresh_props = refresh_props;
+// Account thread: one bot message through this source's pipeline, unless
+// the routing rules send it elsewhere
+static void on_account_message(tip_alert_source* s, const char* account, const std::string& text,
+                               const RouteDecision& route)
+{
+  if (route.table) {
+    std::lock_guard<std::mutex> lk(s->name_mutex);
+    if (!route.delivers_to(s->name))
+      return;
+  }
 
-  t->source = obs_source_get_ref(source);
-  if (!t->source) {
-    delete t;
-    return;
+  TipEvent parsed;
+  const IngestResult r = ingest_message(text, s->dedupe, s->queue, &parsed, &s->moderation, &s->held, account);
+
+  switch (r) {
+  case IngestResult::Duplicate:
+    blog(LOG_INFO, "[TWICH] duplicate event ignored");
+    break;
+  case IngestResult::Dropped:
+    blog(LOG_WARNING, "[TWICH] event queue over budget, tip dropped");
+    break;
+  case IngestResult::Blocked:
+    blog(LOG_INFO, "[TWICH] event blocked by the word list");
+    break;
+  case IngestResult::Held:
+    blog(LOG_INFO, "[TWICH] event held for approval (%zu waiting)", s->held.size());
+    break;
+  default:
+    break;
   }
 
-  obs_queue_task(OBS_TASK_UI, ui_set_auth_status, t, false);
+  if (r == IngestResult::Queued || r == IngestResult::Dropped)
+    announce_event(s, parsed, r == IngestResult::Queued);
 }
 
-// Start/Restart TDLib based on config.json
-static void start_tdlib(tip_alert_source* s)
+// Subscribe to another account ("" = none): moves the capture writer
+// over and, once the source has been shown, starts the new account
+static void switch_account(tip_alert_source* s, const std::string& name)
 {
-  TgAppCreds creds = load_tg_creds();
-  if (!creds.valid) {
-    blog(LOG_ERROR, "[TWICH] Telegram API creds missing/invalid: %s", creds.error.c_str());
-    blog(LOG_ERROR, "[TWICH] TDLib NOT started. Enter API ID/HASH and click Save.");
-
-    queue_auth_status_update(
-      s->source,
-      "Telegram NOT started\n"
-      "Reason: Missing/invalid API credentials.\n"
-      "Next: Open Advanced, enter API ID/HASH, click \"Save credentials\".",
-      true
-    );
-    return;
+  std::shared_ptr<TelegramAccount> old;
+  uint64_t old_sub = 0;
+  {
+    std::lock_guard<std::mutex> lk(s->account_mutex);
+    old = std::move(s->account);
+    old_sub = s->account_sub;
+    s->account_sub = 0;
   }
 
-  const std::string session_dir = session_dir_from_config_path();
+  // outside account_mutex: unsubscribing waits out a running callback
+  if (old) {
+    old->unsubscribe(old_sub);
+    old->client().remove_capture(&s->capture);
+    old.reset(); // last source on it: its TDLib stops here
+  }
+  if (name.empty())
+    return;
 
-  blog(LOG_INFO, "[TWICH] Starting TDLib. session_dir=%s api_id=%s",
-       session_dir.c_str(),
-       creds.api_id.c_str());
+  auto account = acquire_telegram_account(name);
+  const char* tag = account->tag();
+  const uint64_t sub = account->subscribe(
+    [s, tag](const std::string& text, const RouteDecision& route) { on_account_message(s, tag, text, route); },
+    [s](const std::string& text, StatusUi ui) { s->status.post(text, ui); });
+  if (s->capture.is_open())
+    account->client().add_capture(&s->capture);
 
-  s->tg.set_allowed_bot_username("EddieLives_bot");
+  {
+    std::lock_guard<std::mutex> lk(s->account_mutex);
+    s->account = account;
+    s->account_sub = sub;
+  }
+  if (s->shown.load())
+    account->launch(storage_options(s));
+}
 
-  // TDLib thread -> UI thread auth state callback
-  s->tg.set_on_auth_state([s](const std::string& st) {
-    if (!s || !s->source) return;
+// First activation: the account's TDLib comes up on a background thread
+// (creds from disk, client creation, key and parameters), once per account
+static void launch_account(tip_alert_source* s)
+{
+  if (!s->shown.exchange(true))
+    blog(LOG_INFO, "[TWICH] source first shown %.0f ms after it was created",
+         (double)(os_gettime_ns() - s->created_ns) / 1e6);
 
-    blog(LOG_INFO, "[TWICH] UI auth callback: %s", st.c_str());
+  if (auto account = current_account(s))
+    account->launch(storage_options(s));
+}
 
-    std::string ui =
-      std::string("TDLib state: ") + (st.empty() ? "(empty)" : st) + "\n" +
-      format_auth_status(st);
+// (Re)start from the UI buttons, after any background start has finished
+static void restart_tdlib(tip_alert_source* s)
+{
+  if (auto account = current_account(s))
+    account->restart(storage_options(s));
+}
 
-    queue_auth_status_update(s->source, ui, true);
-  });
+// -------------------- OBS callbacks --------------------
+static void tip_alert_update(void* data, obs_data_t* settings);
 
-  // Start TDLib and parse incoming messages into TipEvent queue
-  s->tg.start(
-    creds.api_id,
-    creds.api_hash,
-    session_dir,
-    [s](long long /*chat_id*/, const std::string& text) {
-      auto ev = parse_tip_event_from_message(text);
-      if (!ev) return;
-      std::lock_guard<std::mutex> lk(s->queue_mutex);
-      s->queue.push(*ev);
-    }
-  );
+// UI thread: the routing rules match the new name from the next message on
+static void on_source_rename(void* data, calldata_t* cd)
+{
+  auto* s = (tip_alert_source*)data;
+  const char* name = calldata_string(cd, "new_name");
 
-  queue_auth_status_update(s->source, "Starting Telegram… (TDLib launching)", true);
+  std::lock_guard<std::mutex> lk(s->name_mutex);
+  s->name = name ? name : "";
 }
 
-// -------------------- OBS callbacks --------------------
 static void* tip_alert_create(obs_data_t* settings, obs_source_t* source)
 {
+  const uint64_t t0 = os_gettime_ns();
   auto* s = new tip_alert_source();
   s->source = source;
+  s->created_ns = t0;
 
-  // tiers
-  s->tier1_threshold = obs_data_get_double(settings, "tier1_threshold");
-  s->tier2_threshold = obs_data_get_double(settings, "tier2_threshold");
-  s->tier3_threshold = obs_data_get_double(settings, "tier3_threshold");
-
-  if (s->tier2_threshold < s->tier1_threshold)
-    s->tier2_threshold = s->tier1_threshold;
-  if (s->tier3_threshold < s->tier2_threshold)
-    s->tier3_threshold = s->tier2_threshold;
+  const char* name = obs_source_get_name(source);
+  s->name = name ? name : "";
+  signal_handler_connect(obs_source_get_signal_handler(source), "rename", on_source_rename, s);
 
-  s->tier1_media = obs_data_get_string(settings, "tier1_media");
-  s->tier2_media = obs_data_get_string(settings, "tier2_media");
-  s->tier3_media = obs_data_get_string(settings, "tier3_media");
-
-  // legacy
-  s->animation_path = obs_data_get_string(settings, "animation");
-  if (s->tier1_media.empty() && !s->animation_path.empty())
-    s->tier1_media = s->animation_path;
-
-  // text config
-  s->text_color    = (uint32_t)obs_data_get_int(settings, "text_color");
-  s->text_size     = (int)obs_data_get_int(settings, "text_size");
-  s->text_outline  = obs_data_get_bool(settings, "text_outline");
-  s->outline_size  = (int)obs_data_get_int(settings, "outline_size");
-  s->font_face     = obs_data_get_string(settings, "font_face");
+  // media problems show under the auth status
+  s->assets.set_on_report([s](const std::string& problems) {
+    s->status.post_note(problems.empty() ? std::string() : "Media check:\n" + problems);
+  });
+  s->sounds.set_on_error([](const std::string& path, const std::string& error) {
+    blog(LOG_WARNING, "[TWICH] sound %s: %s (playing it as media instead)", path.c_str(), error.c_str());
+  });
+  s->word_list.set_on_load([](const std::string& path, size_t terms, const std::string& error) {
+    if (error.empty())
+      blog(LOG_INFO, "[TWICH] word list %s: %zu terms", path.c_str(), terms);
+    else
+      blog(LOG_WARNING, "[TWICH] word list: %s", error.c_str());
+  });
+  s->glyph_loader.set_on_error([](const std::string& face, const std::string& error) {
+    blog(LOG_WARNING, "[TWICH] font %s: %s (drawing alert text with the text source)", face.c_str(),
+         error.c_str());
+  });
+  s->sched.set_media_duration([s](const std::string& path) {
+    return s->duration_from_media.load() ? s->assets.media_duration(path) : 0.0f;
+  });
+  s->held.set_on_change([s](ApprovalQueue::Change what, const ApprovalQueue::Held& h) {
+    on_held_change(s, what, h);
+  });
 
-  s->text_position = (int)obs_data_get_int(settings, "text_position");
-  s->text_margin   = (int)obs_data_get_int(settings, "text_margin");
+  // bound under Settings > Hotkeys, per source
+  s->approve_hotkey = obs_hotkey_register_source(source, "twich_approve_held",
+                                                 "Approve oldest held alert", on_approve_hotkey, s);
+  s->reject_hotkey = obs_hotkey_register_source(source, "twich_reject_held",
+                                                "Reject oldest held alert", on_reject_hotkey, s);
 
-  s->text_fade_in  = (float)obs_data_get_double(settings, "text_fade_in");
-  s->text_fade_out = (float)obs_data_get_double(settings, "text_fade_out");
+  // same settings path as later edits
+  tip_alert_update(s, settings);
 
-  s->text_template = obs_data_get_string(settings, "text_template");
+  // Initial status value stored in settings
+  obs_data_set_string(settings, "tg_auth_status", "Telegram starts when this source is first shown (or click Restart TDLib)");
+  s->status.set_owner(source, "tg_auth_status");
+
+  // an account other sources already brought up shows its state right away
+  if (auto account = current_account(s)) {
+    StatusUi ui;
+    std::string text = account->last_status(ui);
+    if (!text.empty())
+      s->status.post(std::move(text), ui);
+  }
 
-  s->duration_sec  = (float)obs_data_get_double(settings, "duration");
+  // TDLib waits for tip_alert_activate: scene collections load without it
+  blog(LOG_INFO, "[TWICH] source created in %.2f ms", (double)(os_gettime_ns() - t0) / 1e6);
+  return s;
+}
 
-  // telegram fields
-  s->tg_phone = obs_data_get_string(settings, "tg_phone");
-  s->tg_code  = obs_data_get_string(settings, "tg_code");
-  s->tg_pass  = obs_data_get_string(settings, "tg_pass");
+// Drop a lane's children (not its cached texture: that needs the graphics context)
+static void release_lane_children(tip_alert_source* s, AlertLane& l)
+{
+  // remove active children before releasing
+  if (s->source) {
+    if (l.media) obs_source_remove_active_child(s->source, l.media);
+    if (l.sound) obs_source_remove_active_child(s->source, l.sound);
+    if (l.text)  obs_source_remove_active_child(s->source, l.text);
+  }
 
-  // Initial status value stored in settings
-  obs_data_set_string(settings, "tg_auth_status", "Starting Telegram…");
-  obs_source_update(source, settings);
+  if (l.media) obs_source_release(l.media);
+  if (l.sound) obs_source_release(l.sound);
+  if (l.text)  obs_source_release(l.text);
 
-  start_tdlib(s);
-  return s;
+  l.media = l.sound = l.text = nullptr;
+  l.media_path.clear();
+  l.sound_path.clear();
+  l.style_dirty = true;
 }
 
 static void tip_alert_destroy(void* data)
 {
   auto* s = (tip_alert_source*)data;
 
-  // remove active children before releasing
-  if (s->source) {
-    if (s->media) obs_source_remove_active_child(s->source, s->media);
-    if (s->text)  obs_source_remove_active_child(s->source, s->text);
-  }
+  signal_handler_disconnect(obs_source_get_signal_handler(s->source), "rename", on_source_rename, s);
+
+  // no more bot messages; the account stops if no other source uses it
+  switch_account(s, std::string());
+
+  if (s->approve_hotkey != OBS_INVALID_HOTKEY_ID) obs_hotkey_unregister(s->approve_hotkey);
+  if (s->reject_hotkey != OBS_INVALID_HOTKEY_ID)  obs_hotkey_unregister(s->reject_hotkey);
+
+  for (AlertLane& l : s->lanes)
+    release_lane_children(s, l);
 
-  if (s->media) obs_source_release(s->media);
-  if (s->text)  obs_source_release(s->text);
+  s->assets.stop();
+  s->sounds.stop();
+  s->glyph_loader.stop();
+  s->word_list.stop();
+  s->tts.stop();
+
+  // takes this source's held events off a dock that outlives it
+  switch_feed(s, nullptr);
+
+  obs_enter_graphics();
+  for (AlertLane& l : s->lanes) {
+    l.text_cache.release();
+    l.glyphs.release();
+  }
+  s->glyph_gpu.release();
+  s->gpu_render_timer.release();
+  obs_leave_graphics();
 
-  s->tg.stop();
   delete s;
 }
 
@@ -398,75 +655,69 @@ static void tip_alert_destroy(void* data)
 static bool on_set_phone(obs_properties_t*, obs_property_t*, void* data)
 {
   auto* s = (tip_alert_source*)data;
+  auto account = current_account(s);
+  if (!account) return false;
 
   const std::string phone = get_setting_str(s->source, "tg_phone");
-  const std::string st = s->tg.auth_state();
+  const std::string st = account->client().auth_state();
 
   blog(LOG_INFO, "[TWICH] Set Phone clicked. auth_state=%s phone='%s'", st.c_str(), phone.c_str());
 
   if (st == "authorizationStateWaitPhoneNumber") {
-    s->tg.send_phone_now(phone);
+    account->client().send_phone_now(phone);
     blog(LOG_INFO, "[TWICH] phone sent");
   } else {
     blog(LOG_INFO, "[TWICH] not waiting for phone, ignoring");
   }
 
-  std::string ui =
-    std::string("TDLib state: ") + (st.empty() ? "(empty)" : st) + "\n" +
-    format_auth_status(st);
-  queue_auth_status_update(s->source, ui, true);
-
-  return true;
+  // The resulting auth transition arrives through the status channel.
+  return false;
 }
 
 static bool on_submit_code(obs_properties_t*, obs_property_t*, void* data)
 {
   auto* s = (tip_alert_source*)data;
+  auto account = current_account(s);
+  if (!account) return false;
 
   const std::string code = get_setting_str(s->source, "tg_code");
-  const std::string st = s->tg.auth_state();
+  const std::string st = account->client().auth_state();
 
   blog(LOG_INFO, "[TWICH] Submit Code clicked. auth_state=%s code_len=%d",
        st.c_str(), (int)code.size());
 
   if (st == "authorizationStateWaitCode") {
-    s->tg.send_code_now(code);
+    account->client().send_code_now(code);
     blog(LOG_INFO, "[TWICH] code sent");
   } else {
     blog(LOG_INFO, "[TWICH] not waiting for code, ignoring");
   }
 
-  std::string ui =
-    std::string("TDLib state: ") + (st.empty() ? "(empty)" : st) + "\n" +
-    format_auth_status(st);
-  queue_auth_status_update(s->source, ui, true);
-
-  return true;
+  // The resulting auth transition arrives through the status channel.
+  return false;
 }
 
 static bool on_submit_pass(obs_properties_t*, obs_property_t*, void* data)
 {
   auto* s = (tip_alert_source*)data;
+  auto account = current_account(s);
+  if (!account) return false;
 
   const std::string pass = get_setting_str(s->source, "tg_pass");
-  const std::string st = s->tg.auth_state();
+  const std::string st = account->client().auth_state();
 
   blog(LOG_INFO, "[TWICH] Submit Password clicked. auth_state=%s pass_len=%d",
        st.c_str(), (int)pass.size());
 
   if (st == "authorizationStateWaitPassword") {
-    s->tg.send_password_now(pass);
+    account->client().send_password_now(pass);
     blog(LOG_INFO, "[TWICH] password sent");
   } else {
     blog(LOG_INFO, "[TWICH] not waiting for password, ignoring");
   }
 
-  std::string ui =
-    std::string("TDLib state: ") + (st.empty() ? "(empty)" : st) + "\n" +
-    format_auth_status(st);
-  queue_auth_status_update(s->source, ui, true);
-
-  return true;
+  // The resulting auth transition arrives through the status channel.
+  return false;
 }
 
 // -------------------- Credentials UI (Save only) --------------------
@@ -479,20 +730,25 @@ static bool on_save_creds(obs_properties_t*, obs_property_t*, void* data)
 
   const std::string api_id   = obs_data_get_string(st, "tg_api_id");
   const std::string api_hash = obs_data_get_string(st, "tg_api_hash");
+  const bool encrypt         = obs_data_get_bool(st, "tg_encrypt_session");
+  const TgAccountConfig account{account_setting(st), parse_bot_list(obs_data_get_string(st, "tg_account_bots"))};
 
   obs_data_release(st);
 
   std::string err;
-  if (!save_tg_creds(api_id, api_hash, err)) {
+  if (!save_tg_creds(api_id, api_hash, encrypt, err) ||
+      (!account.bots.empty() && !save_tg_account(account, err))) {
     blog(LOG_ERROR, "[TWICH] Save credentials FAILED: %s", err.c_str());
-    queue_auth_status_update(s->source, std::string("Credentials NOT saved\nReason: ") + err, true);
+    // UI thread already: write the status now and let OBS refresh the panel
+    obs_data_t* d = obs_source_get_settings(s->source);
+    obs_data_set_string(d, "tg_auth_status", (std::string("Credentials NOT saved\nReason: ") + err).c_str());
+    obs_data_release(d);
     return true;
   }
 
   blog(LOG_INFO, "[TWICH] Saved Telegram API creds to config.json");
 
-  s->tg.stop();
-  start_tdlib(s);
+  restart_tdlib(s);
 
   return true;
 }
@@ -501,12 +757,62 @@ static bool on_restart_tdlib(obs_properties_t*, obs_property_t*, void* data)
 {
   auto* s = (tip_alert_source*)data;
   blog(LOG_INFO, "[TWICH] Restart TDLib clicked");
-  s->tg.stop();
-  start_tdlib(s);
+  restart_tdlib(s);
+  return true;
+}
+
+static bool on_reload_routes(obs_properties_t*, obs_property_t*, void*)
+{
+  std::string error;
+  if (!reload_routes(error))
+    blog(LOG_WARNING, "[TWICH] routing rules not reloaded: %s", error.c_str());
   return true;
 }
 
 // -------------------- Properties --------------------
+static void add_tier_properties(obs_properties_t* parent, EventKind kind, int t)
+{
+  obs_properties_t* g = obs_properties_create();
+
+  obs_properties_add_float(g, tier_key(kind, t, "threshold").c_str(), "Threshold", 0.0, 1e9, 0.1);
+  obs_properties_add_path (g, tier_key(kind, t, "media").c_str(), "Media (WebM)",
+                           OBS_PATH_FILE, "WebM Files (*.webm)", nullptr);
+  obs_properties_add_text (g, tier_key(kind, t, "template").c_str(), "Text template (optional)",
+                           OBS_TEXT_MULTILINE);
+  obs_properties_add_float(g, tier_key(kind, t, "duration").c_str(), "Duration (sec, 0 = default)",
+                           0.0, 60.0, 0.1);
+  obs_properties_add_path (g, tier_key(kind, t, "sound").c_str(), "Sound (optional)",
+                           OBS_PATH_FILE, "Audio Files (*.wav *.mp3 *.ogg)", nullptr);
+
+  // a preset, or a keyframe spec typed in (see TextTimeline)
+  obs_property_t* fx = obs_properties_add_list(g, tier_key(kind, t, "effect").c_str(), "Text effect",
+                                               OBS_COMBO_TYPE_EDITABLE, OBS_COMBO_FORMAT_STRING);
+  obs_property_list_add_string(fx, "(same as lower tier)", "");
+  for (size_t i = 0; i < TextTimeline::preset_count(); ++i)
+    obs_property_list_add_string(fx, TextTimeline::preset_name(i), TextTimeline::preset_name(i));
+  obs_property_set_long_description(fx,
+    "Keyframes: \"y 0 60, 0.45 0 out-cubic; alpha 0 0, 0.3 1, end-0.3 1, end 0\". "
+    "Tracks x, y, scale, alpha, reveal. The lowest tier defaults to the text fade.");
+
+  const std::string name = kind_key(kind, "tier" + std::to_string(t + 1));
+  const std::string title = "Tier " + std::to_string(t + 1);
+  obs_properties_add_group(parent, name.c_str(), title.c_str(), OBS_GROUP_NORMAL, g);
+}
+
+// Show only the first tier_count tier groups of the kind that changed
+static bool on_tier_count_changed(obs_properties_t* props, obs_property_t* p, obs_data_t* settings)
+{
+  const std::string name = obs_property_name(p);
+  const std::string prefix = name.substr(0, name.size() - strlen("tier_count"));
+  const int count = (int)obs_data_get_int(settings, name.c_str());
+
+  for (int t = 0; t < kMaxTiers; ++t) {
+    obs_property_t* g = obs_properties_get(props, (prefix + "tier" + std::to_string(t + 1)).c_str());
+    if (g) obs_property_set_visible(g, t < count);
+  }
+  return true;
+}
+
 static obs_properties_t* tip_alert_properties(void* data)
 {
   obs_properties_t* props = obs_properties_create();
@@ -520,39 +826,75 @@ static obs_properties_t* tip_alert_properties(void* data)
   );
   obs_property_set_enabled(p_status, false);
 
-  // Telegram login UI
-  obs_properties_add_text(props, "tg_phone", "Telegram phone", OBS_TEXT_DEFAULT);
-  obs_properties_add_button(props, "tg_set_phone", "Set Phone", on_set_phone);
-
-  obs_properties_add_text(props, "tg_code", "Telegram login code", OBS_TEXT_DEFAULT);
-  obs_properties_add_button(props, "tg_submit_code", "Submit Code", on_submit_code);
+  // Event queue usage (refreshed whenever the panel is rebuilt)
+  {
+    auto* s = (tip_alert_source*)data;
+    const QueueStats qs = s ? s->queue.stats() : QueueStats();
+
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "Event queue: %zu queued, %.1f / %.1f KB\n"
+             "Rejected: %llu  Summarized: %llu  Spilled: %llu (%llu on disk)",
+             qs.depth, qs.bytes / 1024.0, qs.budget / 1024.0,
+             (unsigned long long)qs.rejected,
+             (unsigned long long)qs.summarized,
+             (unsigned long long)qs.spilled,
+             (unsigned long long)qs.spill_pending);
+    std::string text = buf;
+    if (qs.recovered)
+      text += "\nRecovered after a crash: " + std::to_string(qs.recovered);
+    obs_properties_add_text(props, "queue_status", text.c_str(), OBS_TEXT_INFO);
+  }
 
-  obs_properties_add_text(props, "tg_pass", "Telegram 2FA password (if enabled)", OBS_TEXT_PASSWORD);
-  obs_properties_add_button(props, "tg_submit_pass", "Submit Password", on_submit_pass);
+  // Telegram login UI: only the step TDLib is waiting for is shown
+  const StatusUi ui = data ? ((tip_alert_source*)data)->status.shown_ui() : StatusUi::Starting;
+
+  obs_property_t* p_phone = obs_properties_add_text(props, "tg_phone", "Telegram phone", OBS_TEXT_DEFAULT);
+  obs_property_t* b_phone = obs_properties_add_button(props, "tg_set_phone", "Set Phone", on_set_phone);
+  obs_property_set_visible(p_phone, ui == StatusUi::Phone);
+  obs_property_set_visible(b_phone, ui == StatusUi::Phone);
+
+  obs_property_t* p_code = obs_properties_add_text(props, "tg_code", "Telegram login code", OBS_TEXT_DEFAULT);
+  obs_property_t* b_code = obs_properties_add_button(props, "tg_submit_code", "Submit Code", on_submit_code);
+  obs_property_set_visible(p_code, ui == StatusUi::Code);
+  obs_property_set_visible(b_code, ui == StatusUi::Code);
+
+  obs_property_t* p_pass = obs_properties_add_text(props, "tg_pass", "Telegram 2FA password (if enabled)", OBS_TEXT_PASSWORD);
+  obs_property_t* b_pass = obs_properties_add_button(props, "tg_submit_pass", "Submit Password", on_submit_pass);
+  obs_property_set_visible(p_pass, ui == StatusUi::Password);
+  obs_property_set_visible(b_pass, ui == StatusUi::Password);
+
+  // Tier tables, one group per event kind; tier rows are generated
+  for (int k = 0; k < kEventKindCount; ++k) {
+    const EventKind kind = (EventKind)k;
+    const EventKindInfo& info = event_kind_info(kind);
+
+    obs_properties_t* media_grp = obs_properties_create();
+
+    if (kind == EventKind::Tip) {
+      obs_properties_add_text(
+        media_grp,
+        "tier_help",
+        "Highest tier whose threshold is met will be played.\n"
+        "Empty tier fields reuse the next lower tier's value.",
+        OBS_TEXT_INFO
+      );
+    }
 
-  // Tiered animation settings
-  obs_properties_t* media_grp = obs_properties_create();
-  obs_properties_add_text(
-    media_grp,
-    "tier_help",
-    "Highest tier whose threshold is met will be played.\n"
-    "Defaults are 0 / 10 / 50.",
-    OBS_TEXT_INFO
-  );
+    obs_property_t* p_count = obs_properties_add_int(
+      media_grp, kind_key(kind, "tier_count").c_str(), "Number of tiers", 1, kMaxTiers, 1);
+    obs_property_set_modified_callback(p_count, on_tier_count_changed);
 
-  obs_properties_add_float(media_grp, "tier1_threshold", "Tier 1 threshold", 0.0, 1e9, 0.1);
-  obs_properties_add_path (media_grp, "tier1_media", "Tier 1 media (WebM)",
-                           OBS_PATH_FILE, "WebM Files (*.webm)", nullptr);
+    obs_properties_add_text(media_grp, kind_key(kind, "text_template").c_str(),
+                            "Text template", OBS_TEXT_MULTILINE);
 
-  obs_properties_add_float(media_grp, "tier2_threshold", "Tier 2 threshold", 0.0, 1e9, 0.1);
-  obs_properties_add_path (media_grp, "tier2_media", "Tier 2 media (WebM)",
-                           OBS_PATH_FILE, "WebM Files (*.webm)", nullptr);
+    for (int t = 0; t < kMaxTiers; ++t)
+      add_tier_properties(media_grp, kind, t);
 
-  obs_properties_add_float(media_grp, "tier3_threshold", "Tier 3 threshold", 0.0, 1e9, 0.1);
-  obs_properties_add_path (media_grp, "tier3_media", "Tier 3 media (WebM)",
-                           OBS_PATH_FILE, "WebM Files (*.webm)", nullptr);
-
-  obs_properties_add_group(props, "tiered_media", "Alert Media (by Amount)", OBS_GROUP_NORMAL, media_grp);
+    const std::string title = std::string(info.label) + " \xe2\x80\x93 Alert Media (by Amount)";
+    obs_properties_add_group(props, kind_key(kind, "tiered_media").c_str(), title.c_str(),
+                             OBS_GROUP_NORMAL, media_grp);
+  }
 
   // Text config
   obs_properties_add_color(props, "text_color", "Tip text color");
@@ -585,17 +927,101 @@ static obs_properties_t* tip_alert_properties(void* data)
 
   obs_properties_add_int(props, "text_margin", "Text margin (px)", 0, 400, 1);
 
+  obs_property_t* p_lanes = obs_properties_add_int(props, "alert_lanes", "Concurrent alerts (lanes)",
+                                                   1, AlertScheduler::kMaxLanes, 1);
+  obs_property_set_long_description(p_lanes,
+    "Alerts without media play side by side, their texts stacked from the text position. "
+    "Alerts with media still play one at a time.");
+
   obs_properties_add_float(props, "text_fade_in",  "Text fade-in (sec)",  0.0, 5.0, 0.05);
   obs_properties_add_float(props, "text_fade_out", "Text fade-out (sec)", 0.0, 5.0, 0.05);
 
-  obs_properties_add_text(props, "text_template", "Text template", OBS_TEXT_MULTILINE);
-
   obs_properties_add_float(
     props,
     "duration",
     "Alert Duration (seconds)",
     1.0, 20.0, 0.1
   );
+  obs_properties_add_bool(props, "duration_from_media",
+                          "Tiers without a duration play for the media's length");
+
+  {
+    obs_properties_t* tts = obs_properties_create();
+
+    obs_properties_add_bool(tts, "tts_enabled", "Read event messages aloud");
+
+    obs_property_t* p_engine = obs_properties_add_list(
+      tts,
+      "tts_engine",
+      "Voice",
+      OBS_COMBO_TYPE_LIST,
+      OBS_COMBO_FORMAT_INT
+    );
+    obs_property_list_add_int(p_engine, "System voice (command below)", 0);
+    obs_property_list_add_int(p_engine, "Test tone (no speech)", 1);
+
+    obs_properties_add_text(tts, "tts_command", "Command ({in} = text file, {out} = WAV)", OBS_TEXT_DEFAULT);
+    obs_properties_add_int(tts, "tts_deadline_ms", "Give up after (ms)", 250, 30000, 250);
+    obs_properties_add_float(tts, "tts_delay", "Start speech after (sec)", 0.0, 10.0, 0.1);
+
+    auto* s = (tip_alert_source*)data;
+    if (s && s->tts.running()) {
+      const TtsStats st = s->tts.stats();
+      const std::string line = "Synthesized " + std::to_string(st.synthesized) + ", cached " +
+                               std::to_string(st.cache_hits) + ", late " + std::to_string(st.late) +
+                               ", failed " + std::to_string(st.failed);
+      obs_properties_add_text(tts, "tts_status", line.c_str(), OBS_TEXT_INFO);
+    }
+
+    obs_properties_add_group(props, "tts", "Text-to-Speech", OBS_GROUP_NORMAL, tts);
+  }
+
+  {
+    obs_properties_t* mod = obs_properties_create();
+
+    obs_properties_add_path(mod, "moderation_list", "Word list (one term per line, optional)",
+                            OBS_PATH_FILE, "Text files (*.txt);;All files (*.*)", nullptr);
+
+    obs_property_t* p_mod = obs_properties_add_list(
+      mod,
+      "moderation_policy",
+      "On a match",
+      OBS_COMBO_TYPE_LIST,
+      OBS_COMBO_FORMAT_INT
+    );
+    obs_property_list_add_int(p_mod, "Mask the words", (int)ModerationPolicy::Mask);
+    obs_property_list_add_int(p_mod, "Drop the alert", (int)ModerationPolicy::Drop);
+    obs_property_list_add_int(p_mod, "Hold for approval", (int)ModerationPolicy::Hold);
+
+    obs_properties_add_bool(mod, "approval_hold_all", "Hold every alert for approval");
+    obs_property_t* p_to = obs_properties_add_int(mod, "approval_timeout",
+                                                  "Auto-approve after (s, 0 = never)", 0, 3600, 5);
+    obs_property_set_long_description(p_to,
+      "Applies to alerts held by \"Hold every alert\". Word list matches wait for a decision.");
+
+    auto* s = (tip_alert_source*)data;
+    if (s) {
+      const size_t terms = s->word_list.terms();
+      std::string line = terms
+        ? std::to_string(terms) + " terms loaded"
+        : std::string("No word list");
+      line += ", " + std::to_string(s->held.size()) + " held";
+      for (const std::string& h : s->held.describe(5))
+        line += "\n\xe2\x80\xa2 " + h;
+      line += s->feed_port
+        ? "\nLive view: add http://127.0.0.1:" + std::to_string(s->feed_port) +
+          "/pending as a Custom Browser Dock"
+        : std::string("\nLive view: enable the event feed (Advanced)");
+      line += "\nHotkeys: Settings > Hotkeys > this source";
+      obs_properties_add_text(mod, "moderation_status", line.c_str(), OBS_TEXT_INFO);
+    }
+
+    obs_properties_add_button(mod, "moderation_approve", "Approve oldest held", on_approve_held);
+    obs_properties_add_button(mod, "moderation_reject", "Reject oldest held", on_reject_held);
+    obs_properties_add_button(mod, "moderation_reload", "Reload word list", on_reload_word_list);
+
+    obs_properties_add_group(props, "moderation", "Moderation", OBS_GROUP_NORMAL, mod);
+  }
 
   // ✅ Test alert (RESTORED)
   obs_properties_add_button(
@@ -605,13 +1031,12 @@ static obs_properties_t* tip_alert_properties(void* data)
     [](obs_properties_t*, obs_property_t*, void* data2) {
       auto* s = (tip_alert_source*)data2;
       TipEvent ev;
-      ev.amount_str = "12.500";
-      ev.symbol = "TWICH";
-      ev.message = "Test tip message";
-      ev.from_username = "tester";
-      ev.dedupe_key = "test";
-      std::lock_guard<std::mutex> lk(s->queue_mutex);
-      s->queue.push(ev);
+      ev.set_text("tester", "12.500", "Test tip message");
+      ev.symbol = kTokens[kTokenTwich].symbol;
+      ev.amount_milli = 12500;
+      ev.dedupe_hash = fnv1a_64("test");
+      s->tts.request(ev.dedupe_hash, std::string(ev.message()));
+      s->queue.push(std::move(ev));
       return true;
     }
   );
@@ -641,6 +1066,146 @@ static obs_properties_t* tip_alert_properties(void* data)
 
   obs_properties_add_text(adv, "tg_api_id",   "API ID",   OBS_TEXT_PASSWORD);
   obs_properties_add_text(adv, "tg_api_hash", "API HASH", OBS_TEXT_PASSWORD);
+  obs_property_t* p_acc = obs_properties_add_list(adv, "tg_account", "Telegram account",
+                                                  OBS_COMBO_TYPE_EDITABLE, OBS_COMBO_FORMAT_STRING);
+  for (const TgAccountConfig& a : load_tg_accounts())
+    obs_property_list_add_string(p_acc, a.name.c_str(), a.name.c_str());
+  obs_property_set_long_description(p_acc,
+    "Each account has its own login and session folder and is shared by every source set to it. "
+    "Type a new name to add one, list its bots below and click \"Save credentials\".");
+  obs_property_t* p_bots = obs_properties_add_text(adv, "tg_account_bots", "Bots of this account (comma separated)",
+                                                   OBS_TEXT_DEFAULT);
+  obs_property_set_long_description(p_bots,
+    "Only messages from these bots become alerts. Saved with \"Save credentials\"; empty keeps the saved list.");
+  {
+    auto* s = (tip_alert_source*)data;
+    auto account = s ? current_account(s) : nullptr;
+    std::string text = "No Telegram account";
+    if (account) {
+      std::vector<std::string> bots = account->bots();
+      if (!account->launched()) {
+        for (const TgAccountConfig& a : load_tg_accounts()) {
+          if (a.name == account->name())
+            bots = a.bots;
+        }
+      }
+      std::string list;
+      for (const std::string& b : bots)
+        list += (list.empty() ? "@" : ", @") + b;
+
+      text = "Account \"" + account->name() + "\": " + std::to_string(account->subscribers()) +
+             " source(s), " + (list.empty() ? std::string("no bots configured") : "bots " + list);
+    }
+    obs_properties_add_text(adv, "tg_account_status", text.c_str(), OBS_TEXT_INFO);
+  }
+
+  obs_property_t* p_enc = obs_properties_add_bool(adv, "tg_encrypt_session", "Encrypt the Telegram session database");
+  obs_property_set_long_description(p_enc,
+    "Applied with \"Save credentials\". The key is random and kept in the system keystore (DPAPI, Keychain or "
+    "Secret Service); without one it is a plain file only you can read. An existing session is converted once "
+    "logged in.");
+
+  obs_property_t* p_prof = obs_properties_add_list(adv, "tg_db_profile", "Telegram storage profile",
+                                                   OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+  obs_property_list_add_int(p_prof, "Full (keep chats, messages and files)", 0);
+  obs_property_list_add_int(p_prof, "Minimal footprint (bot messages only)", 1);
+  obs_property_set_long_description(p_prof,
+    "Minimal keeps no chat, message or file databases: the session folder stays small and opens faster. "
+    "Applies on the next TDLib restart.");
+  obs_properties_add_int(adv, "tg_storage_limit_mb", "Trim Telegram files above (MB, 0 = never)", 0, 4096, 8);
+  obs_properties_add_int(adv, "tg_optimize_hours", "Trim every (hours)", 1, 168, 1);
+  {
+    auto* s = (tip_alert_source*)data;
+    auto account = s ? current_account(s) : nullptr;
+    std::string text = "TDLib not started";
+    if (account && account->launched()) {
+      const TdStorageStats st = account->client().storage_stats();
+      char buf[160];
+      if (st.ready_ms > 0.0)
+        snprintf(buf, sizeof(buf), "Session: %.1f MB, database opened in %.0f ms, ready in %.0f ms (%s), trimmed %llu time(s)",
+                 (double)st.session_bytes / (1024.0 * 1024.0), st.open_ms, st.ready_ms,
+                 st.minimal ? "minimal" : "full", (unsigned long long)st.optimized);
+      else if (st.open_ms > 0.0)
+        snprintf(buf, sizeof(buf), "Database opened in %.0f ms (%s), waiting for login",
+                 st.open_ms, st.minimal ? "minimal" : "full");
+      else
+        snprintf(buf, sizeof(buf), "TDLib starting");
+      text = buf;
+    }
+    obs_properties_add_text(adv, "tg_storage_status", text.c_str(), OBS_TEXT_INFO);
+  }
+
+  obs_properties_add_int(adv, "queue_budget_kb", "Event queue memory budget (KB)", 16, 65536, 16);
+
+  obs_property_t* p_policy = obs_properties_add_list(
+    adv,
+    "queue_overflow_policy",
+    "When the budget is full",
+    OBS_COMBO_TYPE_LIST,
+    OBS_COMBO_FORMAT_INT
+  );
+  obs_property_list_add_int(p_policy, "Reject new tips", (int)OverflowPolicy::Reject);
+  obs_property_list_add_int(p_policy, "Summarize into one alert", (int)OverflowPolicy::Summarize);
+  obs_property_list_add_int(p_policy, "Spill to disk journal", (int)OverflowPolicy::Spill);
+
+  obs_properties_add_int(adv, "asset_preload_mb", "Preload tier files up to (MB, 0 = off)", 0, 1024, 1);
+
+  obs_property_t* p_warm = obs_properties_add_bool(adv, "child_warmup",
+                                                   "Load alert media and text when the source becomes visible");
+  obs_property_set_long_description(p_warm,
+    "Creates the text and lowest-tier media sources up front, so the first alert does not wait for them.");
+  obs_property_t* p_idle = obs_properties_add_int(adv, "child_idle_teardown_min",
+                                                  "Unload them after idle (min, 0 = never)", 0, 240, 1);
+  obs_property_set_long_description(p_idle,
+    "Releases decoder and texture memory when no alert played for this long. "
+    "The next alert loads them again.");
+  {
+    auto* s = (tip_alert_source*)data;
+    std::string mem = "No child sources loaded";
+    if (s) {
+      std::lock_guard<std::mutex> lk(s->footprint_mutex);
+      mem = child_memory_report(s->footprint, s->footprint_count);
+    }
+    obs_properties_add_text(adv, "child_status", mem.c_str(), OBS_TEXT_INFO);
+  }
+  obs_properties_add_int(adv, "sound_duck_db", "Duck overlapping alert sounds by (dB, 0 = off)", 0, 40, 1);
+
+  obs_properties_add_path(adv, "capture_path", "Record bot updates to (replay capture, optional)",
+                          OBS_PATH_FILE_SAVE, "TWICH capture (*.twcap)", nullptr);
+
+  obs_properties_add_bool(adv, "feed_enabled", "Serve events to browser overlays (ws://127.0.0.1)");
+  obs_properties_add_int(adv, "feed_port", "Event feed port", 1024, 65535, 1);
+  {
+    auto* s = (tip_alert_source*)data;
+    std::string feed_text = "Event feed off";
+    if (s) {
+      std::lock_guard<std::mutex> lk(s->feed_mutex);
+      if (s->feed) {
+        const EventFeedStats st = s->feed->stats();
+        feed_text = "Event feed: ws://127.0.0.1:" + std::to_string(s->feed->port()) + "/ \xe2\x80\x94 " +
+                    std::to_string(st.clients - st.docks) + " overlay(s), " +
+                    std::to_string(st.docks) + " dock(s), " + std::to_string(st.broadcast) +
+                    " event(s) sent, " + std::to_string(st.evicted) + " evicted";
+      }
+    }
+    obs_properties_add_text(adv, "feed_status", feed_text.c_str(), OBS_TEXT_INFO);
+  }
+
+  // routing rules are shared by every source; the button reloads the file
+  obs_property_t* p_routes = obs_properties_add_text(adv, "routes_status", routes_status().c_str(), OBS_TEXT_INFO);
+  obs_property_set_long_description(p_routes, ("Rules file: " + routes_path()).c_str());
+  obs_properties_add_button(adv, "routes_reload", "Reload routing rules", on_reload_routes);
+
+  obs_properties_add_bool(adv, "profiler_enabled", "Profile tick/render timings");
+  obs_properties_add_path(adv, "profiler_trace_path", "Timing trace (CSV, optional)",
+                          OBS_PATH_FILE_SAVE, "CSV Files (*.csv)", nullptr);
+  {
+    auto* s = (tip_alert_source*)data;
+    const std::string perf = s ? s->profiler.summary() : std::string("Profiler off");
+    obs_properties_add_text(adv, "profiler_status", perf.c_str(), OBS_TEXT_INFO);
+  }
+  obs_properties_add_button(adv, "profiler_refresh", "Refresh timings",
+                            [](obs_properties_t*, obs_property_t*, void*) { return true; });
 
   obs_properties_add_button(adv, "tg_save_creds", "Save credentials", on_save_creds);
   obs_properties_add_button(adv, "tg_restart_tdlib", "Restart TDLib", on_restart_tdlib);
@@ -650,249 +1215,805 @@ static obs_properties_t* tip_alert_properties(void* data)
   return props;
 }
 
-static void tip_alert_update(void* data, obs_data_t* settings)
+// Fingerprint of one kind's tier/template settings (plus the shared inputs
+// its table depends on), so unchanged kinds skip the rebuild.
+static uint64_t kind_settings_hash(obs_data_t* settings, EventKind kind, double duration)
 {
-  auto* s = (tip_alert_source*)data;
+  uint64_t h = fnv1a_64(std::to_string(duration));
+
+  if (kind == EventKind::Tip)
+    h = fnv1a_64(obs_data_get_string(settings, "animation"), h);
+
+  const long long count = obs_data_get_int(settings, kind_key(kind, "tier_count").c_str());
+  h = fnv1a_64(std::to_string(count), h);
+  h = fnv1a_64(obs_data_get_string(settings, kind_key(kind, "text_template").c_str()), h);
+
+  for (int t = 0; t < count && t < kMaxTiers; ++t) {
+    h = fnv1a_64(std::to_string(obs_data_get_double(settings, tier_key(kind, t, "threshold").c_str())), h);
+    h = fnv1a_64(std::to_string(obs_data_get_double(settings, tier_key(kind, t, "duration").c_str())), h);
+    h = fnv1a_64(obs_data_get_string(settings, tier_key(kind, t, "media").c_str()), h);
+    h = fnv1a_64("\x1f", h);
+    h = fnv1a_64(obs_data_get_string(settings, tier_key(kind, t, "template").c_str()), h);
+    h = fnv1a_64("\x1f", h);
+    h = fnv1a_64(obs_data_get_string(settings, tier_key(kind, t, "sound").c_str()), h);
+    h = fnv1a_64("\x1f", h);
+    h = fnv1a_64(obs_data_get_string(settings, tier_key(kind, t, "effect").c_str()), h);
+    h = fnv1a_64("\x1e", h);
+  }
+  return h;
+}
+
+// Queue every configured tier file for a background check + preload
+static void submit_asset_checks(tip_alert_source* s, obs_data_t* settings)
+{
+  std::vector<AssetRequest> reqs;
+  auto add = [&](std::string label, const char* path, bool video) {
+    if (!path || !*path)
+      return;
+    for (const AssetRequest& r : reqs)
+      if (r.path == path)
+        return;
+    reqs.push_back(AssetRequest{std::move(label), path, video});
+  };
+
+  add("Legacy animation", obs_data_get_string(settings, "animation"), true);
+
+  for (int k = 0; k < kEventKindCount; ++k) {
+    const EventKind kind = (EventKind)k;
+    const std::string label = event_kind_info(kind).label;
 
-  // tiers
-  s->tier1_threshold = obs_data_get_double(settings, "tier1_threshold");
-  s->tier2_threshold = obs_data_get_double(settings, "tier2_threshold");
-  s->tier3_threshold = obs_data_get_double(settings, "tier3_threshold");
+    long long count = obs_data_get_int(settings, kind_key(kind, "tier_count").c_str());
+    if (count > kMaxTiers) count = kMaxTiers;
 
-  if (s->tier2_threshold < s->tier1_threshold)
-    s->tier2_threshold = s->tier1_threshold;
-  if (s->tier3_threshold < s->tier2_threshold)
-    s->tier3_threshold = s->tier2_threshold;
+    for (int t = 0; t < count; ++t) {
+      const std::string tier = label + " tier " + std::to_string(t + 1);
+      add(tier + " media", obs_data_get_string(settings, tier_key(kind, t, "media").c_str()), true);
+      add(tier + " sound", obs_data_get_string(settings, tier_key(kind, t, "sound").c_str()), false);
+    }
+  }
+
+  s->assets.set_preload_cap((uint64_t)s->asset_preload_mb * 1024 * 1024);
+  s->assets.submit(std::move(reqs));
+}
 
-  s->tier1_media = obs_data_get_string(settings, "tier1_media");
-  s->tier2_media = obs_data_get_string(settings, "tier2_media");
-  s->tier3_media = obs_data_get_string(settings, "tier3_media");
+// Settings snapshot for the capture file, so a replay schedules like we did
+static void write_capture_config(tip_alert_source* s, obs_data_t* settings)
+{
+  CaptureConfig cfg;
+  cfg.duration_sec = s->duration_sec;
+  cfg.duration_from_media = s->duration_from_media.load();
+  cfg.queue_budget_kb = s->queue_budget_kb;
+  cfg.queue_policy = s->queue_policy;
+  cfg.lanes = s->sched.lanes();
+
+  for (int k = 0; k < kEventKindCount; ++k) {
+    const EventKind kind = (EventKind)k;
+    cfg.text_template[k] = obs_data_get_string(settings, kind_key(kind, "text_template").c_str());
+    cfg.tiers[k] = read_tier_specs(settings, kind);
+  }
 
-  // legacy
-  s->animation_path = obs_data_get_string(settings, "animation");
-  if (s->tier1_media.empty() && !s->animation_path.empty())
-    s->tier1_media = s->animation_path;
+  // wall clock, same as the TDLib thread's update records
+  const long long now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+  s->capture.write(CaptureRecord::Config, now_ms, capture_config_to_json(cfg));
+}
 
-  // text
-  s->text_color    = (uint32_t)obs_data_get_int(settings, "text_color");
-  s->text_size     = (int)obs_data_get_int(settings, "text_size");
-  s->text_outline  = obs_data_get_bool(settings, "text_outline");
-  s->outline_size  = (int)obs_data_get_int(settings, "outline_size");
-  s->font_face     = obs_data_get_string(settings, "font_face");
+// Applies settings as a diff: each group only invalidates its own cache.
+// A status-only change (tg_auth_status, login fields) touches no rendering state.
+static void tip_alert_update(void* data, obs_data_t* settings)
+{
+  auto* s = (tip_alert_source*)data;
+  const bool first = !s->settings_applied;
+
+  // text style -> text child settings
+  TextStyle style;
+  style.color        = (uint32_t)obs_data_get_int(settings, "text_color");
+  style.size         = (int)obs_data_get_int(settings, "text_size");
+  style.outline      = obs_data_get_bool(settings, "text_outline");
+  style.outline_size = (int)obs_data_get_int(settings, "outline_size");
+  style.font_face    = obs_data_get_string(settings, "font_face");
+
+  if (first || !(style == s->style)) {
+    // color and outline are uniforms; only a new font or size needs new glyphs
+    if (first || style.font_face != s->style.font_face || style.size != s->style.size)
+      s->glyph_loader.submit(style.font_face, style.size);
+
+    s->style = std::move(style);
+
+    // outline width changes the cached texture's padding
+    for (AlertLane& l : s->lanes) {
+      l.style_dirty = true;
+      l.text_cache.invalidate();
+    }
+  }
 
+  // layout + fades are read directly by tick/render; no cache behind them
   s->text_position = (int)obs_data_get_int(settings, "text_position");
   s->text_margin   = (int)obs_data_get_int(settings, "text_margin");
 
-  s->text_fade_in  = (float)obs_data_get_double(settings, "text_fade_in");
-  s->text_fade_out = (float)obs_data_get_double(settings, "text_fade_out");
+  // concurrent alerts; alerts on lanes taken away play to their end
+  const int old_lanes = s->sched.lanes();
+  s->sched.set_lanes((int)obs_data_get_int(settings, "alert_lanes"));
+  const bool lanes_changed = first || s->sched.lanes() != old_lanes;
+
+  const float fade_in  = (float)obs_data_get_double(settings, "text_fade_in");
+  const float fade_out = (float)obs_data_get_double(settings, "text_fade_out");
+  if (first || fade_in != s->text_fade_in || fade_out != s->text_fade_out) {
+    s->text_fade_in = fade_in;
+    s->text_fade_out = fade_out;
+    s->text_fade = std::make_shared<const TextTimeline>(TextTimeline::fade(fade_in, fade_out));
+  }
+
+  // tier tables + compiled templates, per kind
+  const double duration = obs_data_get_double(settings, "duration");
+  s->duration_sec = (float)duration;
+
+  bool tiers_changed = false;
+  for (int k = 0; k < kEventKindCount; ++k) {
+    const uint64_t h = kind_settings_hash(settings, (EventKind)k, duration);
+    if (first || h != s->kind_settings_hash[k]) {
+      load_profile(s, settings, (EventKind)k);
+      s->kind_settings_hash[k] = h;
+      tiers_changed = true;
+    }
+  }
+
+  if (tiers_changed)
+    load_sound_bank(s);
+
+  // moderation: rebuild the matcher (on the pool) when the list or policy changes
+  {
+    const std::string list = obs_data_get_string(settings, "moderation_list");
+    const int policy = (int)obs_data_get_int(settings, "moderation_policy");
+    const std::string config = list + "|" + std::to_string(policy);
+    if (first || config != s->moderation_config) {
+      s->word_list.submit(list, (ModerationPolicy)policy);
+      s->moderation_config = config;
+    }
+
+    s->moderation.set_hold_all(obs_data_get_bool(settings, "approval_hold_all"));
+    s->held.set_timeout(std::chrono::seconds(obs_data_get_int(settings, "approval_timeout")));
+  }
+
+  // speech pool: restarted only when engine, rate or deadline change
+  {
+    std::string config;
+    std::shared_ptr<TtsEngine> engine;
+    obs_audio_info oai = {};
+    const uint32_t rate = obs_get_audio_info(&oai) ? oai.samples_per_sec : 48000;
+    const int deadline_ms = (int)obs_data_get_int(settings, "tts_deadline_ms");
+
+    if (obs_data_get_bool(settings, "tts_enabled")) {
+      const int kind = (int)obs_data_get_int(settings, "tts_engine");
+      const std::string command = obs_data_get_string(settings, "tts_command");
+      config = std::to_string(kind) + "|" + command + "|" + std::to_string(rate) + "|" +
+               std::to_string(deadline_ms);
+      if (config != s->tts_config) {
+        if (kind == 1)
+          engine = std::make_shared<ToneTtsEngine>();
+        else
+          engine = std::make_shared<CommandTtsEngine>(command);
+      }
+    }
+
+    if (config != s->tts_config) {
+      if (engine)
+        s->tts.start(std::move(engine), config, rate, std::chrono::milliseconds(deadline_ms));
+      else
+        s->tts.stop();
+      s->tts_config = config;
+    }
+
+    s->tts_delay_sec.store((float)obs_data_get_double(settings, "tts_delay"));
+  }
+
+  const int duck_db = (int)obs_data_get_int(settings, "sound_duck_db");
+  s->sound_duck_gain.store(std::pow(10.0f, -(float)duck_db / 20.0f));
+
+  // tier files: re-check in the background when paths or the preload cap change
+  s->duration_from_media.store(obs_data_get_bool(settings, "duration_from_media"));
 
-  s->text_template = obs_data_get_string(settings, "text_template");
+  // child lifetime
+  s->child_warmup.store(obs_data_get_bool(settings, "child_warmup"));
+  s->children.set_teardown_after((float)obs_data_get_int(settings, "child_idle_teardown_min") * 60.0f);
 
-  s->duration_sec  = (float)obs_data_get_double(settings, "duration");
+  const int preload_mb = (int)obs_data_get_int(settings, "asset_preload_mb");
+  if (tiers_changed || preload_mb != s->asset_preload_mb) {
+    s->asset_preload_mb = preload_mb;
+    submit_asset_checks(s, settings);
+  }
+
+  // queue budget
+  s->queue_budget_kb = (int)obs_data_get_int(settings, "queue_budget_kb");
+  s->queue_policy    = (int)obs_data_get_int(settings, "queue_overflow_policy");
 
-  // if style changes while running, force opacity update
-  s->last_opacity = -1;
+  const uint64_t qh = ((uint64_t)(uint32_t)s->queue_budget_kb << 8) ^ (uint64_t)s->queue_policy;
+  const bool queue_changed = first || qh != s->queue_settings_hash;
+  if (queue_changed) {
+    apply_queue_settings(s);
+    s->queue_settings_hash = qh;
+  }
+
+  // Telegram account: sources on the same account share its TDLib thread
+  const std::string account = account_setting(settings);
+  if (first || account != s->account_name) {
+    s->account_name = account;
+    switch_account(s, account);
+  }
+
+  // record mode: (re)open on path change, snapshot settings whenever they matter
+  const std::string capture_path = obs_data_get_string(settings, "capture_path");
+  bool capture_opened = false;
+  if (first || capture_path != s->capture_path) {
+    s->capture_path = capture_path;
+    if (auto account = current_account(s))
+      account->client().remove_capture(&s->capture);
+    s->capture.close();
+
+    if (!capture_path.empty()) {
+      if (s->capture.open(capture_path)) {
+        if (auto account = current_account(s))
+          account->client().add_capture(&s->capture);
+        capture_opened = true;
+        blog(LOG_INFO, "[TWICH] recording bot updates to %s", capture_path.c_str());
+      } else {
+        blog(LOG_WARNING, "[TWICH] cannot create capture file %s", capture_path.c_str());
+      }
+    }
+  }
+  if (s->capture.is_open() && (capture_opened || tiers_changed || queue_changed || lanes_changed))
+    write_capture_config(s, settings);
+
+  // browser-overlay feed: sources on the same port share one server
+  const int feed_port = obs_data_get_bool(settings, "feed_enabled")
+    ? (int)obs_data_get_int(settings, "feed_port") : 0;
+  if (feed_port != s->feed_port) {
+    std::shared_ptr<EventFeedServer> feed;
+    if (feed_port > 0) {
+      std::string error;
+      feed = acquire_event_feed((uint16_t)feed_port, error);
+      if (feed)
+        blog(LOG_INFO, "[TWICH] event feed on ws://127.0.0.1:%d/", feed_port);
+      else
+        blog(LOG_WARNING, "[TWICH] event feed: %s", error.c_str());
+    }
+
+    // a failed bind is retried on the next settings change
+    s->feed_port = feed ? feed_port : 0;
+    switch_feed(s, std::move(feed));
+  }
+
+  // profiler (configure is a no-op when nothing changed)
+  s->profiler.configure(obs_data_get_bool(settings, "profiler_enabled"),
+                        obs_data_get_string(settings, "profiler_trace_path"));
 
   s->tg_phone = obs_data_get_string(settings, "tg_phone");
   s->tg_code  = obs_data_get_string(settings, "tg_code");
   s->tg_pass  = obs_data_get_string(settings, "tg_pass");
+
+  s->settings_applied = true;
 }
 
 // -------------------- Tick/render --------------------
-static void tip_alert_tick(void* data, float seconds)
+// Point an ffmpeg_source child at `path`, creating it on first use.
+// loaded_path caches what the child already has, so repeats skip the update.
+static void point_media_child(tip_alert_source* s, obs_source_t*& child, std::string& loaded_path,
+                              const char* name, const std::string& path)
 {
-  auto* s = (tip_alert_source*)data;
+  if (child && loaded_path == path)
+    return;
 
-  if (s->playing) {
-    s->alert_elapsed += seconds;
-    s->time_left -= seconds;
+  ProfileScope ps(s->profiler, ProfileSection::ChildUpdate);
+  loaded_path = path;
 
-    // fade alpha [0..1]
-    float alpha = 1.0f;
+  if (!child) {
+    obs_data_t* d = obs_data_create();
+    obs_data_set_string(d, "local_file", path.c_str());
+    obs_data_set_bool(d, "is_local_file", true);
+    obs_data_set_bool(d, "restart_on_activate", true);
+    obs_data_set_bool(d, "close_when_inactive", false);
 
-    if (s->text_fade_in > 0.0f && s->alert_elapsed < s->text_fade_in)
-      alpha = s->alert_elapsed / s->text_fade_in;
+    child = obs_source_create("ffmpeg_source", name, d, nullptr);
+    obs_data_release(d);
 
-    if (s->text_fade_out > 0.0f && s->time_left < s->text_fade_out) {
-      float a2 = s->time_left / s->text_fade_out;
-      if (a2 < alpha) alpha = a2;
-    }
+    if (child)
+      obs_source_add_active_child(s->source, child);
+    return;
+  }
 
-    if (alpha < 0.0f) alpha = 0.0f;
-    if (alpha > 1.0f) alpha = 1.0f;
+  obs_data_t* md = obs_source_get_settings(child);
+  obs_data_set_string(md, "local_file", path.c_str());
+  obs_data_set_bool(md, "is_local_file", true);
+  obs_data_set_bool(md, "restart_on_activate", true);
+  obs_data_set_bool(md, "close_when_inactive", false);
 
-    set_text_opacity(s, (int)(alpha * 100.0f + 0.5f));
+  obs_source_update(child, md);
+  obs_data_release(md);
+}
 
-    if (s->time_left <= 0.0f) {
-      s->playing = false;
-      if (s->media) obs_source_set_enabled(s->media, false);
-      if (s->text)  obs_source_set_enabled(s->text, false);
-    }
+// Push the mixed sound for the frame interval that just ended. Chunks are
+// cut at frame times, so a clip started this frame opens the next chunk.
+static void output_sound(tip_alert_source* s, uint64_t frame_ns)
+{
+  uint64_t ts = 0;
+  const size_t frames = s->mixer.render_until(frame_ns, ts);
+  if (!frames)
     return;
-  }
 
-  TipEvent ev;
-  {
-    std::lock_guard<std::mutex> lk(s->queue_mutex);
-    if (s->queue.empty())
-      return;
-    ev = s->queue.front();
-    s->queue.pop();
-  }
-
-  // choose media for this event
-  const std::string* chosen_media = nullptr;
-  double amount = 0.0;
-  try { amount = std::stod(ev.amount_str); } catch (...) { amount = 0.0; }
-
-  if (amount >= s->tier3_threshold && !s->tier3_media.empty())
-    chosen_media = &s->tier3_media;
-  else if (amount >= s->tier2_threshold && !s->tier2_media.empty())
-    chosen_media = &s->tier2_media;
-  else if (amount >= s->tier1_threshold && !s->tier1_media.empty())
-    chosen_media = &s->tier1_media;
-
-  // media child
-  if (chosen_media && !chosen_media->empty()) {
-    if (!s->media) {
-      obs_data_t* d = obs_data_create();
-      obs_data_set_string(d, "local_file", chosen_media->c_str());
-      obs_data_set_bool(d, "is_local_file", true);
-      obs_data_set_bool(d, "restart_on_activate", true);
-      obs_data_set_bool(d, "close_when_inactive", false);
-
-      s->media = obs_source_create("ffmpeg_source", "tip_anim", d, nullptr);
-      obs_data_release(d);
-
-      if (s->media)
-        obs_source_add_active_child(s->source, s->media);
-    } else {
-      obs_data_t* md = obs_source_get_settings(s->media);
-      obs_data_set_string(md, "local_file", chosen_media->c_str());
-      obs_data_set_bool(md, "is_local_file", true);
-      obs_data_set_bool(md, "restart_on_activate", true);
-      obs_data_set_bool(md, "close_when_inactive", false);
-
-      obs_source_update(s->media, md);
-      obs_data_release(md);
+  obs_source_audio a = {};
+  a.data[0] = (const uint8_t*)s->mixer.left();
+  a.data[1] = (const uint8_t*)s->mixer.right();
+  a.frames = (uint32_t)frames;
+  a.speakers = SPEAKERS_STEREO;
+  a.format = AUDIO_FORMAT_FLOAT_PLANAR;
+  a.samples_per_sec = s->mixer.sample_rate();
+  a.timestamp = ts;
+  obs_source_output_audio(s->source, &a);
+}
+
+// Child name on lane `lane`: "tip_anim", "tip_anim_2", ...
+static std::string lane_child_name(const char* base, int lane)
+{
+  return lane ? std::string(base) + "_" + std::to_string(lane + 1) : std::string(base);
+}
+
+// Create lane `lane`'s text child (empty, current style) if it has none
+static void ensure_text_child(tip_alert_source* s, int lane)
+{
+  AlertLane& l = s->lanes[lane];
+  if (l.text)
+    return;
+
+  obs_data_t* d = obs_data_create();
+  obs_data_set_string(d, "text", "");
+
+  text_child_apply_style(d, s->style);
+  l.style_dirty = false;
+
+  l.text = obs_source_create(text_child_source_id(), lane_child_name("tip_text", lane).c_str(), d, nullptr);
+  obs_data_release(d);
+
+  if (l.text)
+    obs_source_add_active_child(s->source, l.text);
+}
+
+// Snapshot of the live children for the memory report; stored only when it changed
+static void refresh_footprint(tip_alert_source* s)
+{
+  ChildFootprint fp[AlertScheduler::kMaxLanes * 3];
+  size_t n = 0;
+
+  for (int i = 0; i < AlertScheduler::kMaxLanes; ++i) {
+    const AlertLane& l = s->lanes[i];
+    if (l.media) {
+      ChildFootprint& f = fp[n++];
+      f.role = ChildRole::Media;
+      f.lane = i;
+      f.cx = obs_source_get_width(l.media);
+      f.cy = obs_source_get_height(l.media);
+    }
+    if (l.sound) {
+      ChildFootprint& f = fp[n++];
+      f.role = ChildRole::Sound;
+      f.lane = i;
+    }
+    if (l.text) {
+      ChildFootprint& f = fp[n++];
+      f.role = ChildRole::Text;
+      f.lane = i;
+      f.cx = obs_source_get_width(l.text);
+      f.cy = obs_source_get_height(l.text);
+      f.cache_cx = l.text_cache.width();
+      f.cache_cy = l.text_cache.height();
     }
   }
 
-  // text child
-  if (!s->text) {
-    obs_data_t* d = obs_data_create();
-    obs_data_set_string(d, "text", "");
+  if (n == s->footprint_count && std::equal(fp, fp + n, s->footprint))
+    return;
 
-    apply_tip_text_style(d, s->text_color, s->font_face, s->text_size, s->text_outline, s->outline_size);
+  std::lock_guard<std::mutex> lk(s->footprint_mutex);
+  std::copy(fp, fp + n, s->footprint);
+  s->footprint_count = n;
+}
 
-    s->text = obs_source_create("text_gdiplus", "tip_text", d, nullptr);
-    obs_data_release(d);
+// Create the children ahead of the first alert: every lane's text, and
+// the media of the lowest tip tier that has one (decoder opened, paused)
+static void warm_children(tip_alert_source* s)
+{
+  if (!s->glyph_atlas)
+    for (int i = 0; i < s->sched.lanes(); ++i)
+      ensure_text_child(s, i);
+
+  const TierTable& tiers = s->profiles[(int)EventKind::Tip].tiers;
+  for (size_t i = 0; i < tiers.size(); ++i) {
+    const Tier& t = tiers.at(i);
+    if (t.media.empty())
+      continue;
+    AlertLane& l = s->lanes[0];
+    point_media_child(s, l.media, l.media_path, "tip_anim", t.media);
+    if (l.media)
+      obs_source_set_enabled(l.media, false);
+    break;
+  }
+
+  s->children.created();
+  refresh_footprint(s);
+}
 
-    if (s->text)
-      obs_source_add_active_child(s->source, s->text);
+// Release every child after the idle timeout; the next alert recreates them
+static void teardown_children(tip_alert_source* s)
+{
+  for (AlertLane& l : s->lanes)
+    release_lane_children(s, l);
+
+  obs_enter_graphics();
+  for (AlertLane& l : s->lanes) {
+    l.text_cache.release();
+    l.glyphs.release();
   }
+  s->glyph_gpu.release();
+  obs_leave_graphics();
 
-  if (s->text) {
-    obs_data_t* td = obs_source_get_settings(s->text);
+  refresh_footprint(s);
+  blog(LOG_INFO, "[TWICH] released alert child sources after %.0f idle minute(s)",
+       s->children.teardown_after() / 60.0f);
+}
 
-    const std::string txt = format_tip_text(s, ev);
-    obs_data_set_string(td, "text", txt.c_str());
+// Apply an alert the scheduler just placed on lane st.lane
+static void start_alert(tip_alert_source* s, const AlertStart& st, uint64_t frame_ns)
+{
+  AlertLane& l = s->lanes[st.lane];
+
+  const Tier* tier = st.tier;
+  const std::string* chosen_media = (tier && !tier->media.empty()) ? &tier->media : nullptr;
+  const std::string* chosen_sound = (tier && !tier->sound.empty()) ? &tier->sound : nullptr;
+
+  // decoded sounds go to the mixer, starting on this frame
+  std::shared_ptr<const AudioClip> clip;
+  if (chosen_sound && s->sound_bank)
+    clip = s->sound_bank->find(*chosen_sound);
+  // speech synthesized while the event waited (nullptr if late: silent)
+  std::shared_ptr<const AudioClip> speech = s->tts.take(st.ev.dedupe_hash);
+
+  if (clip || speech) {
+    obs_audio_info oai = {};
+    if (obs_get_audio_info(&oai))
+      s->mixer.set_sample_rate(oai.samples_per_sec);
+    s->mixer.set_duck_gain(s->sound_duck_gain.load());
+  }
+  if (clip) {
+    s->mixer.play(std::move(clip), frame_ns);
+    chosen_sound = nullptr; // no media child for this one
+  }
+  if (speech) {
+    const uint64_t delay_ns = (uint64_t)(std::max(0.0f, s->tts_delay_sec.load()) * 1e9f);
+    s->mixer.play(std::move(speech), frame_ns + delay_ns);
+  }
+
+  // media + sound children
+  if (chosen_media)
+    point_media_child(s, l.media, l.media_path, lane_child_name("tip_anim", st.lane).c_str(), *chosen_media);
+  if (chosen_sound)
+    point_media_child(s, l.sound, l.sound_path, lane_child_name("tip_sound", st.lane).c_str(), *chosen_sound);
+
+  // text: quads from the glyph atlas, no child update at all; the text
+  // child only when there is no atlas or the text does not fit in it
+  l.glyphs.text = st.text;
+  bool laid_out = false;
+  if (s->glyph_atlas) {
+    ProfileScope ps_glyphs(s->profiler, ProfileSection::TextRaster);
+    laid_out = l.glyphs.lay_out(*s->glyph_atlas);
+  }
+  if (!laid_out) {
+    l.glyphs.active = false;
+    ensure_text_child(s, st.lane);
+  }
+  s->children.created();
 
-    // force style each alert
-    apply_tip_text_style(td, s->text_color, s->font_face, s->text_size, s->text_outline, s->outline_size);
+  // one child update per alert (text, plus style if it changed);
+  // fades and outline are uniforms from here on
+  if (l.text && !l.glyphs.active) {
+    ProfileScope ps_text(s->profiler, ProfileSection::ChildUpdate);
+    obs_data_t* td = obs_source_get_settings(l.text);
 
-    // start faded if fade-in enabled
-    obs_data_set_int(td, "opacity", (s->text_fade_in > 0.0f) ? 0 : 100);
+    obs_data_set_string(td, "text", st.text.c_str());
 
-    obs_source_update(s->text, td);
+    if (l.style_dirty) {
+      text_child_apply_style(td, s->style);
+      l.style_dirty = false;
+    }
+
+    obs_source_update(l.text, td);
     obs_data_release(td);
 
-    s->last_opacity = -1;
-    set_text_opacity(s, (s->text_fade_in > 0.0f) ? 0 : 100);
+    l.text_cache.invalidate();
   }
 
+  // the tier's text timeline, sampled every tick from here on
+  l.fx = (tier && tier->effect) ? tier->effect : s->text_fade;
+  l.fx_now = l.fx ? l.fx->sample(0.0f, st.duration_sec) : TimelineSample();
+  l.layout = RevealLayout::measure(st.text);
+
   // play media only if chosen this event (avoid sticky old tier)
-  if (chosen_media && !chosen_media->empty() && s->media) {
-    obs_source_set_enabled(s->media, true);
-    obs_source_media_restart(s->media);
+  if (chosen_media && l.media) {
+    obs_source_set_enabled(l.media, true);
+    ProfileScope ps_restart(s->profiler, ProfileSection::MediaRestart);
+    obs_source_media_restart(l.media);
   } else {
-    if (s->media) obs_source_set_enabled(s->media, false);
+    if (l.media) obs_source_set_enabled(l.media, false);
   }
 
-  if (s->text)
-    obs_source_set_enabled(s->text, true);
+  if (chosen_sound && l.sound) {
+    obs_source_set_enabled(l.sound, true);
+    ProfileScope ps_restart(s->profiler, ProfileSection::MediaRestart);
+    obs_source_media_restart(l.sound);
+  } else {
+    if (l.sound) obs_source_set_enabled(l.sound, false);
+  }
 
-  s->playing = true;
-  s->time_left = s->duration_sec;
-  s->alert_elapsed = 0.0f;
+  if (l.text)
+    obs_source_set_enabled(l.text, !l.glyphs.active);
 }
 
-// sizing
-static uint32_t tip_alert_get_width(void* data)
+// Size: the media child's, else the text's, else 1080p. Media may report
+// its size a few frames after a restart, so this runs every playing tick.
+static void measure_alert(tip_alert_source* s)
 {
-  auto* s = (tip_alert_source*)data;
-  if (s->media) {
-    uint32_t w = obs_source_get_width(s->media);
-    if (w) return w;
+  uint32_t w = 0, h = 0;
+  for (const AlertLane& l : s->lanes) {
+    if (!l.media) continue;
+    w = obs_source_get_width(l.media);
+    h = obs_source_get_height(l.media);
+    if (w && h) break;
   }
-  if (s->text) {
-    uint32_t w = obs_source_get_width(s->text);
-    if (w) return w;
+  if (!w || !h) {
+    for (const AlertLane& l : s->lanes) {
+      if (l.glyphs.active) {
+        w = l.glyphs.layout.width;
+        h = l.glyphs.layout.height;
+      } else if (l.text) {
+        w = obs_source_get_width(l.text);
+        h = obs_source_get_height(l.text);
+      }
+      if (w && h) break;
+    }
   }
-  return 1920;
+  s->width.store(w && h ? w : 1920, std::memory_order_relaxed);
+  s->height.store(w && h ? h : 1080, std::memory_order_relaxed);
+
+  refresh_footprint(s);
 }
 
-static uint32_t tip_alert_get_height(void* data)
+static void tip_alert_tick(void* data, float seconds)
 {
   auto* s = (tip_alert_source*)data;
-  if (s->media) {
-    uint32_t h = obs_source_get_height(s->media);
-    if (h) return h;
+
+  s->profiler.next_frame();
+  ProfileScope ps(s->profiler, ProfileSection::Tick);
+
+  const uint64_t frame_ns = obs_get_video_frame_time();
+  if (s->mixer.active())
+    output_sound(s, frame_ns);
+
+  // held events nobody decided on in time
+  if (s->held.may_expire()) {
+    std::vector<TipEvent> due;
+    if (s->held.expire(ApprovalQueue::Clock::now(), due))
+      for (TipEvent& ev : due)
+        release_held(s, std::move(ev));
   }
-  if (s->text) {
-    uint32_t h = obs_source_get_height(s->text);
-    if (h) return h;
+
+  // activation: load the children now rather than on the first alert
+  if (s->warm_request.load(std::memory_order_relaxed) && s->warm_request.exchange(false) &&
+      s->child_warmup.load() && !s->children.live())
+    warm_children(s);
+
+  if (s->children.tick(seconds, s->sched.playing()))
+    teardown_children(s);
+
+  // sounds decoded after a settings change
+  if (s->sounds.has_ready())
+    if (auto bank = s->sounds.take_ready())
+      s->sound_bank = std::move(bank);
+
+  // glyphs for a new font/size: playing atlas texts are laid out again
+  if (s->glyph_loader.has_ready() && s->glyph_loader.take_ready(s->glyph_atlas)) {
+    for (AlertLane& l : s->lanes)
+      if (l.glyphs.active && !(s->glyph_atlas && l.glyphs.lay_out(*s->glyph_atlas)))
+        l.glyphs.active = false;
   }
-  return 1080;
+
+  // idle: nothing playing or queued -> no queue lock, no child queries
+  if (!s->sched.playing() && !s->queue.pending())
+    return;
+
+  const uint32_t ended = s->sched.advance(seconds);
+  for (int i = 0; i < AlertScheduler::kMaxLanes; ++i) {
+    if (!(ended & (1u << i)))
+      continue;
+    AlertLane& l = s->lanes[i];
+    if (l.media) obs_source_set_enabled(l.media, false);
+    if (l.sound) obs_source_set_enabled(l.sound, false);
+    if (l.text)  obs_source_set_enabled(l.text, false);
+    l.glyphs.active = false;
+  }
+
+  // fill free lanes; started lanes sample their timeline at 0 in start_alert
+  uint32_t started = 0;
+  AlertStart st;
+  while (s->sched.start_next(s->queue, s->profiles, s->duration_sec, st)) {
+    start_alert(s, st, frame_ns);
+    started |= 1u << st.lane;
+  }
+
+  for (int i = 0; i < AlertScheduler::kMaxLanes; ++i) {
+    AlertLane& l = s->lanes[i];
+    if (!s->sched.playing(i) || (started & (1u << i)) || !l.fx)
+      continue;
+    const float t = s->sched.elapsed(i);
+    l.fx_now = l.fx->sample(t, t + s->sched.time_left(i));
+  }
+
+  if (s->sched.playing())
+    measure_alert(s);
 }
 
-static void render_child_at(obs_source_t* child, float x, float y)
+// Called wherever the source becomes visible in the output: children warm
+// up on the next tick, TDLib starts in the background (first time only)
+static void tip_alert_activate(void* data)
 {
-  if (!child) return;
-  gs_matrix_push();
-  gs_matrix_translate3f(x, y, 0.0f);
-  obs_source_video_render(child);
-  gs_matrix_pop();
+  auto* s = (tip_alert_source*)data;
+  s->warm_request.store(true);
+  launch_account(s);
 }
 
-static void tip_alert_render(void* data, gs_effect_t*)
+static uint32_t tip_alert_get_width(void* data)
 {
-  auto* s = (tip_alert_source*)data;
-  if (!s->playing) return;
+  return ((tip_alert_source*)data)->width.load(std::memory_order_relaxed);
+}
+
+static uint32_t tip_alert_get_height(void* data)
+{
+  return ((tip_alert_source*)data)->height.load(std::memory_order_relaxed);
+}
 
-  if (s->media)
-    obs_source_video_render(s->media);
+// Draw one lane's text with its glyph box at (x, y)
+static void draw_lane_text(tip_alert_source* s, AlertLane& l, float x, float y,
+                           uint32_t tw, uint32_t th)
+{
+  const TimelineSample& fx = l.fx_now;
+  if (fx.alpha <= 0.0f || fx.scale <= 0.0f || fx.reveal <= 0.0f)
+    return;
 
-  if (s->text) {
-    const uint32_t W = tip_alert_get_width(data);
-    const uint32_t H = tip_alert_get_height(data);
+  // the cached texture extends `pad` past the glyph box for the outline;
+  // atlas quads are already in glyph box coordinates
+  const float pad = l.glyphs.active ? 0.0f : (float)l.text_cache.padding();
 
-    const uint32_t tw = obs_source_get_width(s->text);
-    const uint32_t th = obs_source_get_height(s->text);
+  // timeline offset, then scale about the glyph box center
+  const float hw = (float)tw * 0.5f;
+  const float hh = (float)th * 0.5f;
+
+  gs_matrix_push();
+  gs_matrix_translate3f(x + hw + fx.x, y + hh + fx.y, 0.0f);
+  if (fx.scale != 1.0f)
+    gs_matrix_scale3f(fx.scale, fx.scale, 1.0f);
+  gs_matrix_translate3f(-hw - pad, -hh - pad, 0.0f);
+
+  if (l.glyphs.active) {
+    // typewriter: the first characters' quads, one batch
+    s->glyph_gpu.draw(l.glyphs, s->style, fx.alpha, l.glyphs.layout.shown_quads(fx.reveal));
+  } else if (fx.reveal >= 1.0f) {
+    l.text_cache.draw(s->style, fx.alpha);
+  } else {
+    // typewriter: per line, a strip as wide as its shown characters
+    const RevealLayout& lay = l.layout;
+    const uint32_t p = l.text_cache.padding();
+    for (size_t i = 0; i < lay.lines; ++i) {
+      const float share = lay.visible(i, fx.reveal);
+      if (share <= 0.0f)
+        continue;
+
+      // outer lines keep the outline padding above/below them
+      const uint32_t y0 = (i == 0) ? 0 : p + (uint32_t)((uint64_t)th * i / lay.lines);
+      const uint32_t y1 = (i + 1 == lay.lines) ? l.text_cache.height()
+                                               : p + (uint32_t)((uint64_t)th * (i + 1) / lay.lines);
+      const uint32_t w = 2 * p + (uint32_t)(share * (float)tw + 0.5f);
+      l.text_cache.draw_region(s->style, fx.alpha, 0, y0, w, y1 - y0);
+    }
+  }
+  gs_matrix_pop();
+}
+
+// One pass over the playing lanes. The media alert (at most one) goes
+// underneath; texts stack in lane order from the text position: downward
+// for top/center, upward for bottom.
+static void draw_alert(tip_alert_source* s)
+{
+  const int media_lane = s->sched.media_lane();
+  if (media_lane >= 0 && s->lanes[media_lane].media)
+    obs_source_video_render(s->lanes[media_lane].media);
+
+  const uint32_t W = tip_alert_get_width(s);
+  const uint32_t H = tip_alert_get_height(s);
+  const float gap = (float)std::max(4, s->style.size / 4);
+
+  float stack = 0.0f; // height taken by the lanes drawn so far, gaps included
+
+  for (int i = 0; i < AlertScheduler::kMaxLanes; ++i) {
+    AlertLane& l = s->lanes[i];
+    if (!s->sched.playing(i) || (!l.text && !l.glyphs.active))
+      continue;
+
+    uint32_t tw, th;
+    if (l.glyphs.active) {
+      GlyphAtlas& atlas = *s->glyph_atlas;
+      // another lane's text filled the atlas and it started over
+      if (l.glyphs.layout.epoch != atlas.epoch() && !l.glyphs.lay_out(atlas))
+        continue;
+
+      bool ready;
+      if (s->glyph_gpu.stale(atlas)) {
+        ProfileScope ps(s->profiler, ProfileSection::TextRaster);
+        ready = s->glyph_gpu.prepare(atlas);
+      } else {
+        ready = true;
+      }
+      if (!ready)
+        continue;
+
+      tw = l.glyphs.layout.width;
+      th = l.glyphs.layout.height;
+    } else {
+      bool ready;
+      if (l.text_cache.stale(s->style)) {
+        ProfileScope ps(s->profiler, ProfileSection::TextRaster);
+        ready = l.text_cache.prepare(l.text, s->style);
+      } else {
+        ready = true;
+      }
+      if (!ready)
+        continue;
+
+      tw = l.text_cache.width() - 2 * l.text_cache.padding();
+      th = l.text_cache.height() - 2 * l.text_cache.padding();
+    }
 
     float x = (tw > 0 && W > tw) ? (float)(W - tw) * 0.5f : 0.0f;
     float y = 0.0f;
 
     if (s->text_position == 0) {          // top
-      y = (float)s->text_margin;
+      y = (float)s->text_margin + stack;
     } else if (s->text_position == 1) {   // center
-      y = (th > 0 && H > th) ? (float)(H - th) * 0.5f : 0.0f;
+      y = ((th > 0 && H > th) ? (float)(H - th) * 0.5f : 0.0f) + stack;
     } else {                               // bottom
-      y = (th > 0 && H > th) ? (float)(H - th - s->text_margin) : 0.0f;
+      y = (th > 0 && H > th) ? (float)(H - th - s->text_margin) - stack : 0.0f;
     }
+    stack += (float)th + gap;
+
+    draw_lane_text(s, l, x, y, tw, th);
+  }
+}
+
+static void tip_alert_render(void* data, gs_effect_t*)
+{
+  auto* s = (tip_alert_source*)data;
+  const bool profiling = s->profiler.enabled();
 
-    render_child_at(s->text, x, y);
+  // collect GPU timings from earlier frames (queries finish a few frames late)
+  if (profiling) {
+    uint64_t ns = 0;
+    while (s->gpu_render_timer.poll(ns))
+      s->profiler.record_gpu(ProfileSection::Render, ns);
   }
+
+  if (!s->sched.playing()) return;
+
+  ProfileScope ps(s->profiler, ProfileSection::Render);
+  if (profiling) s->gpu_render_timer.begin();
+
+  draw_alert(s);
+
+  if (profiling) s->gpu_render_timer.end();
 }
 
 // ------------------------------------------------------------
@@ -904,7 +2025,7 @@ void init_tip_alert_source_info(void)
 {
   tip_alert_source_info.id           = "twich_tip_alert";
   tip_alert_source_info.type         = OBS_SOURCE_TYPE_INPUT;
-  tip_alert_source_info.output_flags = OBS_SOURCE_VIDEO;
+  tip_alert_source_info.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_AUDIO | OBS_SOURCE_CUSTOM_DRAW;
 
   tip_alert_source_info.get_name       = tip_alert_get_name;
   tip_alert_source_info.create         = tip_alert_create;
@@ -914,6 +2035,7 @@ void init_tip_alert_source_info(void)
   tip_alert_source_info.get_defaults   = tip_alert_defaults;
   tip_alert_source_info.get_properties = tip_alert_properties;
   tip_alert_source_info.update         = tip_alert_update;
+  tip_alert_source_info.activate       = tip_alert_activate;
   tip_alert_source_info.video_tick     = tip_alert_tick;
   tip_alert_source_info.video_render   = tip_alert_render;
 }
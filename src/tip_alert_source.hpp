@@ -2,13 +2,55 @@
 
 #include <obs-module.h>
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <string>
-
+#include <unordered_map>
+
+#include "alert_scheduler.hpp"
+#include "asset_manager.hpp"
+#include "audio_mixer.hpp"
+#include "capture_file.hpp"
+#include "child_lifecycle.hpp"
+#include "event_feed.hpp"
+#include "event_ingest.hpp"
 #include "event_parse.hpp"
-#include "telegram_tdlib.hpp"
+#include "event_queue.hpp"
+#include "glyph_atlas.hpp"
+#include "glyph_renderer.hpp"
+#include "gpu_timer.hpp"
+#include "render_profiler.hpp"
+#include "sound_bank.hpp"
+#include "status_channel.hpp"
+#include "telegram_accounts.hpp"
+#include "text_child.hpp"
+#include "text_renderer.hpp"
+#include "text_timeline.hpp"
+#include "tier_table.hpp"
+#include "tts.hpp"
+
+// Upper bound on configurable tiers per event kind
+constexpr int kMaxTiers = 10;
+
+// One concurrently playing alert: its own children, cached text and timeline
+struct AlertLane
+{
+  obs_source_t* media = nullptr; // ffmpeg_source
+  obs_source_t* sound = nullptr; // ffmpeg_source (non-WAV tier sounds)
+  obs_source_t* text  = nullptr; // platform text source: rasterizer when there is no glyph atlas
+  std::string media_path;        // file currently loaded in `media`
+  std::string sound_path;        // file currently loaded in `sound`
+
+  bool style_dirty = true;  // style not yet pushed into the text child
+  TextRenderer text_cache;  // rasterized alert text + outline/opacity shader
+  GlyphRun glyphs;          // the same text as atlas quads (when the atlas has the font)
+
+  std::shared_ptr<const TextTimeline> fx; // timeline of the playing alert
+  TimelineSample fx_now;                  // its values this frame (matrix + uniforms)
+  RevealLayout layout;                    // lines/characters of the playing text
+};
 
 struct tip_alert_source
 {
@@ -18,52 +60,112 @@ struct tip_alert_source
   std::string animation_path; // legacy key "animation"
   float duration_sec = 8.9f;
 
-  // --- Telegram ---
-  TelegramTdLibClient tg;
+  // --- Telegram: the account whose bot messages this source shows ---
+  std::mutex account_mutex; // guards account + account_sub (update swaps, UI/activate read)
+  std::shared_ptr<TelegramAccount> account;
+  uint64_t account_sub = 0;
+  std::string account_name; // update only
+
+  // source name for routing rules, read on the TDLib thread: cached at
+  // create and from the "rename" signal instead of asking OBS there
+  std::mutex name_mutex;
+  std::string name;
+  StatusChannel status; // account's TDLib thread -> properties status box
   std::string tg_phone;
   std::string tg_code;
   std::string tg_pass;
 
-  // --- queued tip events ---
-  std::mutex queue_mutex;
-  std::queue<TipEvent> queue;
-
-  // --- tiered media ---
-  double tier1_threshold = 0.0;
-  double tier2_threshold = 10.0;
-  double tier3_threshold = 50.0;
-
-  std::string tier1_media;
-  std::string tier2_media;
-  std::string tier3_media;
-
-  // --- child sources ---
-  obs_source_t* media = nullptr; // ffmpeg_source
-  obs_source_t* text  = nullptr; // text_gdiplus
-
-  // --- playback state ---
-  bool playing = false;
-  float time_left = 0.0f;
+  // deferred bring-up: the account's TDLib starts on a background thread
+  // when a source on it is first shown, not while OBS creates sources
+  std::atomic<bool> shown{false};
+  uint64_t created_ns = 0;
+
+  // --- record mode (capture of raw bot updates + alert settings) ---
+  CaptureWriter capture;
+  std::string capture_path;
+
+  // --- local WebSocket feed for browser-source overlays (shared per port) ---
+  std::mutex feed_mutex; // guards `feed` (UI thread swaps, TDLib thread reads)
+  std::shared_ptr<EventFeedServer> feed;
+  int feed_port = 0;     // port of `feed`, 0 = off
+
+  // --- moderation: word list stage + events held for approval ---
+  ModerationStage moderation; // applied on the TDLib thread
+  WordListLoader word_list{moderation}; // builds the matcher on the shared pool
+  ApprovalQueue held;
+  std::string moderation_config; // list path + policy in effect
+  uint64_t feed_commands = 0;    // approve/reject handler on `feed`, 0 = none
+  obs_hotkey_id approve_hotkey = OBS_INVALID_HOTKEY_ID;
+  obs_hotkey_id reject_hotkey = OBS_INVALID_HOTKEY_ID;
+
+  // --- queued tip events (memory-budgeted) ---
+  DedupeWindow dedupe; // TDLib thread only
+  TipEventQueue queue;
+  int queue_budget_kb = 256;
+  int queue_policy = 0; // OverflowPolicy
+
+  // --- tiered media + template, per event kind ---
+  AlertProfile profiles[kEventKindCount];
+
+  // --- tier file checks (background) ---
+  AssetManager assets;
+  int asset_preload_mb = 32;
+  std::atomic<bool> duration_from_media{false}; // tiers without a duration play their media length
+
+  // --- tier sounds: WAV decoded in the background, mixed into our own audio ---
+  SoundBankLoader sounds;                    // decodes changed files on the shared pool
+  std::shared_ptr<const SoundBank> sound_bank; // video_tick only: swapped in when ready
+  AudioMixer mixer;                          // video_tick only
+  std::atomic<float> sound_duck_gain{0.25f}; // overlapped sounds, linear
+
+  // --- text-to-speech of event messages (synthesized while queued) ---
+  TtsPipeline tts;
+  std::string tts_config;             // update only: engine + rate + deadline the pool runs with, "" = off
+  std::atomic<float> tts_delay_sec{0.5f}; // speech starts this long after the alert
+
+  // --- applied-settings fingerprints (incremental tip_alert_update) ---
+  bool settings_applied = false;
+  uint64_t kind_settings_hash[kEventKindCount] = {};
+  uint64_t queue_settings_hash = 0;
+
+  // --- playback state: lanes [0, sched.lanes()) take new alerts ---
+  AlertScheduler sched;
+  AlertLane lanes[AlertScheduler::kMaxLanes];
+
+  // source size, measured from the children while an alert plays and kept
+  // while idle (get_width/get_height run off the video thread)
+  std::atomic<uint32_t> width{1920};
+  std::atomic<uint32_t> height{1080};
+
+  // --- child lifetime: warmed up on activation, released after idling ---
+  ChildLifecycle children;                   // video_tick only
+  std::atomic<bool> child_warmup{true};
+  std::atomic<bool> warm_request{false};     // set on activation, served by the next tick
+  std::mutex footprint_mutex;                // guards footprint (tick writes, properties read)
+  ChildFootprint footprint[AlertScheduler::kMaxLanes * 3];
+  size_t footprint_count = 0;
 
   // --- text UI config ---
-  uint32_t text_color = 0x00FFFF00; // 0xRRGGBB
-  int text_size = 36;
-  bool text_outline = true;
-  int outline_size = 2;
-  std::string font_face = "Arial";
+  TextStyle style;
+
+  // alert text glyphs for the style's font/size, opened on the shared pool;
+  // without one (no FreeType, font missing) text goes through the text child
+  GlyphAtlasLoader glyph_loader;
+  std::shared_ptr<GlyphAtlas> glyph_atlas; // video thread only (tick + render)
+  GlyphRenderer glyph_gpu;                 // atlas texture + glyph effect
 
   // position preset
   int text_position = 0; // 0=top 1=center 2=bottom
   int text_margin = 40;
 
-  // fade
+  // text animation: the tier's timeline, or a plain fade from these two
   float text_fade_in  = 0.20f;
   float text_fade_out = 0.25f;
-  float alert_elapsed = 0.0f;
-  int last_opacity = -1;
+  std::shared_ptr<const TextTimeline> text_fade;
 
-  // template
-  std::string text_template = "{user} tipped {amount} {symbol}\n{message}";
+  // --- render-path timing (off unless enabled in Advanced) ---
+  RenderProfiler profiler;
+  GpuSectionTimer gpu_render_timer;
 };
 
 extern obs_source_info tip_alert_source_info;
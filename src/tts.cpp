@@ -0,0 +1,452 @@
+#include "tts.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  include <windows.h>
+#else
+#  include <signal.h>
+#  include <spawn.h>
+#  include <sys/wait.h>
+#  include <unistd.h>
+extern char** environ;
+#endif
+
+#include "event_types.hpp" // fnv1a_64
+
+namespace fs = std::filesystem;
+
+// ------------------------------------------------------------
+// Command engine
+// ------------------------------------------------------------
+CommandTtsEngine::CommandTtsEngine(std::string command_template)
+  : command_(std::move(command_template))
+{
+}
+
+const char* CommandTtsEngine::default_command()
+{
+#if defined(_WIN32)
+  return "powershell -NoProfile -NonInteractive -Command \"Add-Type -AssemblyName System.Speech; "
+         "$s = New-Object System.Speech.Synthesis.SpeechSynthesizer; $s.SetOutputToWaveFile('{out}'); "
+         "$s.Speak([IO.File]::ReadAllText('{in}', [Text.Encoding]::UTF8)); $s.Dispose()\"";
+#elif defined(__APPLE__)
+  return "say -f \"{in}\" -o \"{out}\" --file-format=WAVE --data-format=LEI16@22050";
+#else
+  return "espeak-ng -f \"{in}\" -w \"{out}\"";
+#endif
+}
+
+static void replace_all(std::string& s, const std::string& from, const std::string& to)
+{
+  for (size_t p = s.find(from); p != std::string::npos; p = s.find(from, p + to.size()))
+    s.replace(p, from.size(), to);
+}
+
+// Runs `cmd`, killing it at `deadline`. True when it exited with status 0.
+static bool run_with_deadline(const std::string& cmd, TtsClock::time_point deadline, std::string& error)
+{
+#ifdef _WIN32
+  STARTUPINFOA si = {};
+  si.cb = sizeof(si);
+  PROCESS_INFORMATION pi = {};
+  std::vector<char> line(cmd.begin(), cmd.end());
+  line.push_back('\0');
+
+  if (!CreateProcessA(nullptr, line.data(), nullptr, nullptr, FALSE, CREATE_NO_WINDOW,
+                      nullptr, nullptr, &si, &pi)) {
+    error = "cannot start TTS command";
+    return false;
+  }
+
+  const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - TtsClock::now());
+  const DWORD wait_ms = (DWORD)std::max<long long>(0, left.count());
+
+  bool ok = false;
+  if (WaitForSingleObject(pi.hProcess, wait_ms) == WAIT_TIMEOUT) {
+    TerminateProcess(pi.hProcess, 1);
+    WaitForSingleObject(pi.hProcess, INFINITE);
+    error = "timed out";
+  } else {
+    DWORD code = 1;
+    GetExitCodeProcess(pi.hProcess, &code);
+    ok = code == 0;
+    if (!ok)
+      error = "TTS command failed (exit " + std::to_string(code) + ")";
+  }
+
+  CloseHandle(pi.hThread);
+  CloseHandle(pi.hProcess);
+  return ok;
+#else
+  // own process group, so a timeout also kills whatever the shell started
+  posix_spawnattr_t attr;
+  posix_spawnattr_init(&attr);
+  posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+  posix_spawnattr_setpgroup(&attr, 0);
+
+  const char* argv[] = {"sh", "-c", cmd.c_str(), nullptr};
+  pid_t pid = 0;
+  const int rc = posix_spawn(&pid, "/bin/sh", nullptr, &attr, (char* const*)argv, environ);
+  posix_spawnattr_destroy(&attr);
+  if (rc != 0) {
+    error = "cannot start TTS command";
+    return false;
+  }
+
+  for (;;) {
+    int status = 0;
+    const pid_t r = waitpid(pid, &status, WNOHANG);
+    if (r == pid) {
+      if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+        return true;
+      error = WIFEXITED(status) ? "TTS command failed (exit " + std::to_string(WEXITSTATUS(status)) + ")"
+                                : std::string("TTS command crashed");
+      return false;
+    }
+    if (r < 0) {
+      error = "lost the TTS process";
+      return false;
+    }
+
+    if (TtsClock::now() >= deadline) {
+      kill(-pid, SIGKILL);
+      waitpid(pid, &status, 0);
+      error = "timed out";
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+#endif
+}
+
+bool CommandTtsEngine::synthesize(const std::string& text, uint32_t sample_rate,
+                                  TtsClock::time_point deadline, AudioClip& out, std::string& error)
+{
+  static std::atomic<uint64_t> counter{0};
+
+#ifdef _WIN32
+  const unsigned long pid = GetCurrentProcessId();
+#else
+  const unsigned long pid = (unsigned long)getpid();
+#endif
+
+  std::error_code ec;
+  const fs::path dir = fs::temp_directory_path(ec);
+  if (ec) {
+    error = "no temp directory";
+    return false;
+  }
+
+  const std::string stem = "twich_tts_" + std::to_string(pid) + "_" + std::to_string(counter++);
+  const std::string in_path = (dir / (stem + ".txt")).string();
+  const std::string out_path = (dir / (stem + ".wav")).string();
+
+  {
+    std::ofstream f(in_path, std::ios::binary | std::ios::trunc);
+    f << text;
+    if (!f) {
+      error = "cannot write " + in_path;
+      return false;
+    }
+  }
+
+  std::string cmd = command_;
+  replace_all(cmd, "{in}", in_path);
+  replace_all(cmd, "{out}", out_path);
+
+  bool ok = run_with_deadline(cmd, deadline, error);
+  if (ok)
+    ok = load_wav_file(out_path, sample_rate, out, error);
+
+  fs::remove(in_path, ec);
+  fs::remove(out_path, ec);
+  return ok;
+}
+
+// ------------------------------------------------------------
+// Stub engine
+// ------------------------------------------------------------
+bool ToneTtsEngine::synthesize(const std::string& text, uint32_t sample_rate,
+                               TtsClock::time_point deadline, AudioClip& out, std::string& error)
+{
+  if (latency_.count() > 0) {
+    const auto until = std::min(TtsClock::now() + latency_, deadline);
+    std::this_thread::sleep_until(until);
+  }
+  if (TtsClock::now() >= deadline) {
+    error = "timed out";
+    return false;
+  }
+
+  constexpr double kBeepSec = 0.12;
+  constexpr double kGapSec = 0.04;
+  constexpr double kFadeSec = 0.01;
+  constexpr double kPi = 3.14159265358979323846;
+
+  out = AudioClip();
+  out.sample_rate = sample_rate;
+
+  const size_t beep = (size_t)(sample_rate * kBeepSec);
+  const size_t gap = (size_t)(sample_rate * kGapSec);
+  const size_t fade = (size_t)(sample_rate * kFadeSec);
+
+  size_t i = 0;
+  while (i < text.size()) {
+    while (i < text.size() && isspace((unsigned char)text[i])) ++i;
+    const size_t start = i;
+    while (i < text.size() && !isspace((unsigned char)text[i])) ++i;
+    if (i == start)
+      break;
+
+    const uint64_t h = fnv1a_64(std::string_view(text).substr(start, i - start));
+    const double freq = 400.0 + (double)(h % 8) * 60.0;
+
+    for (size_t n = 0; n < beep; ++n) {
+      const double env = std::min({1.0, (double)n / fade, (double)(beep - n) / fade});
+      const float v = (float)(0.3 * env * std::sin(2.0 * kPi * freq * n / sample_rate));
+      out.left.push_back(v);
+      out.right.push_back(v);
+    }
+    out.left.insert(out.left.end(), gap, 0.0f);
+    out.right.insert(out.right.end(), gap, 0.0f);
+  }
+
+  if (out.frames() == 0) {
+    error = "nothing to say";
+    return false;
+  }
+  return true;
+}
+
+// ------------------------------------------------------------
+// Pipeline
+// ------------------------------------------------------------
+TtsPipeline::~TtsPipeline()
+{
+  stop();
+
+  // tasks capture this: wait out the ones still inside the engine
+  tasks_.cancel();
+}
+
+void TtsPipeline::start(std::shared_ptr<TtsEngine> engine, const std::string& engine_key,
+                        uint32_t sample_rate, std::chrono::milliseconds deadline, int workers)
+{
+  stop();
+
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (engine_key != engine_key_ || sample_rate != rate_) {
+    lru_.clear();
+    cache_.clear();
+    cache_bytes_ = 0;
+  }
+
+  engine_ = std::move(engine);
+  engine_key_ = engine_key;
+  rate_ = sample_rate;
+  deadline_ = deadline;
+  max_workers_ = std::max(1, workers);
+}
+
+// Never waits for the engine: tasks of an older generation notice the bump,
+// drop whatever they finish and leave
+void TtsPipeline::stop()
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  generation_++;
+  max_workers_ = 0;
+  active_ = 0;
+  slots_.clear();
+  order_.clear();
+  jobs_.clear();
+  engine_.reset();
+}
+
+bool TtsPipeline::running() const
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return max_workers_ > 0;
+}
+
+void TtsPipeline::drop_oldest_pending()
+{
+  while (!order_.empty()) {
+    const uint64_t key = order_.front();
+    order_.pop_front();
+    if (slots_.erase(key))
+      return;
+  }
+}
+
+void TtsPipeline::request(uint64_t key, std::string text)
+{
+  if (text.empty())
+    return;
+
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (max_workers_ == 0 || slots_.count(key))
+    return;
+
+  while (slots_.size() >= kMaxPending)
+    drop_oldest_pending();
+
+  // order_ keeps keys already taken; compact it now and then
+  if (order_.size() > 4 * kMaxPending) {
+    std::deque<uint64_t> live;
+    for (uint64_t k : order_)
+      if (slots_.count(k))
+        live.push_back(k);
+    order_.swap(live);
+  }
+
+  Slot slot;
+  slot.phrase = fnv1a_64(text);
+  slot.deadline = TtsClock::now() + deadline_;
+
+  if (auto clip = cache_get(slot.phrase)) {
+    slot.state = State::Ready;
+    slot.clip = std::move(clip);
+    stats_.cache_hits++;
+  } else {
+    slot.text = std::move(text);
+    jobs_.push_back(key);
+  }
+
+  const bool queued = slot.state == State::Queued;
+  slots_.emplace(key, std::move(slot));
+  order_.push_back(key);
+
+  if (queued && active_ < max_workers_ && tasks_.post([this, gen = generation_]() { run(gen); }))
+    active_++;
+}
+
+std::shared_ptr<const AudioClip> TtsPipeline::take(uint64_t key)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = slots_.find(key);
+  if (it == slots_.end())
+    return nullptr;
+
+  std::shared_ptr<const AudioClip> clip;
+  if (it->second.state == State::Ready)
+    clip = std::move(it->second.clip);
+  else if (it->second.state != State::Failed)
+    stats_.late++; // still synthesizing: this alert plays without speech
+
+  // a running job finishes into the cache only
+  slots_.erase(it);
+  return clip;
+}
+
+TtsStats TtsPipeline::stats() const
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return stats_;
+}
+
+std::shared_ptr<const AudioClip> TtsPipeline::cache_get(uint64_t phrase)
+{
+  auto it = cache_.find(phrase);
+  if (it == cache_.end())
+    return nullptr;
+
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return it->second->clip;
+}
+
+void TtsPipeline::cache_put(uint64_t phrase, std::shared_ptr<const AudioClip> clip)
+{
+  if (cache_.count(phrase))
+    return;
+
+  const size_t bytes = clip->frames() * 2 * sizeof(float);
+  if (bytes > kCacheBytes)
+    return;
+
+  while (cache_bytes_ + bytes > kCacheBytes && !lru_.empty()) {
+    cache_bytes_ -= lru_.back().bytes;
+    cache_.erase(lru_.back().phrase);
+    lru_.pop_back();
+  }
+
+  lru_.push_front({phrase, std::move(clip), bytes});
+  cache_[phrase] = lru_.begin();
+  cache_bytes_ += bytes;
+}
+
+void TtsPipeline::run(uint64_t generation)
+{
+  std::unique_lock<std::mutex> lk(mutex_);
+
+  for (;;) {
+    if (generation != generation_)
+      return; // stopped (or restarted) since this task was posted
+    if (jobs_.empty()) {
+      active_--;
+      return;
+    }
+
+    const uint64_t key = jobs_.front();
+    jobs_.pop_front();
+
+    auto it = slots_.find(key);
+    if (it == slots_.end())
+      continue; // taken (or evicted) before a worker got to it
+
+    Slot& slot = it->second;
+    if (TtsClock::now() >= slot.deadline) {
+      slot.state = State::Failed;
+      stats_.failed++;
+      continue;
+    }
+
+    // an identical phrase may have finished while this one waited
+    if (auto clip = cache_get(slot.phrase)) {
+      slot.state = State::Ready;
+      slot.clip = std::move(clip);
+      stats_.cache_hits++;
+      continue;
+    }
+
+    slot.state = State::Running;
+    const std::string text = std::move(slot.text);
+    const uint64_t phrase = slot.phrase;
+    const TtsClock::time_point deadline = slot.deadline;
+    const std::shared_ptr<TtsEngine> engine = engine_;
+    const uint32_t rate = rate_;
+
+    lk.unlock();
+    auto clip = std::make_shared<AudioClip>();
+    std::string error;
+    const bool ok = engine && engine->synthesize(text, rate, deadline, *clip, error);
+    lk.lock();
+
+    if (generation != generation_)
+      return; // the result belongs to an engine config that is gone
+
+    if (ok) {
+      stats_.synthesized++;
+      cache_put(phrase, clip);
+    } else {
+      stats_.failed++;
+    }
+
+    // slot may be gone (taken while running)
+    auto again = slots_.find(key);
+    if (again != slots_.end()) {
+      again->second.state = ok ? State::Ready : State::Failed;
+      if (ok)
+        again->second.clip = std::move(clip);
+    }
+  }
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "audio_clip.hpp"
+#include "worker_pool.hpp"
+
+using TtsClock = std::chrono::steady_clock;
+
+// Offline speech synthesizer. Called from pool threads, possibly in
+// parallel; must give up (return false) once `deadline` has passed.
+class TtsEngine {
+public:
+  virtual ~TtsEngine() = default;
+  virtual bool synthesize(const std::string& text, uint32_t sample_rate,
+                          TtsClock::time_point deadline, AudioClip& out, std::string& error) = 0;
+};
+
+// Runs a local command that writes a WAV file, e.g.
+//   espeak-ng -f "{in}" -w "{out}"
+// {in} is a UTF-8 text file holding the phrase, {out} the WAV to write.
+// The phrase never appears on the command line, so viewer text cannot
+// inject shell syntax. The process is killed at the deadline.
+class CommandTtsEngine : public TtsEngine {
+public:
+  explicit CommandTtsEngine(std::string command_template);
+
+  bool synthesize(const std::string& text, uint32_t sample_rate,
+                  TtsClock::time_point deadline, AudioClip& out, std::string& error) override;
+
+  // A command that works out of the box on this platform (SAPI on Windows,
+  // say on macOS, espeak-ng elsewhere)
+  static const char* default_command();
+
+private:
+  std::string command_;
+};
+
+// Stub engine: one short beep per word, pitch keyed on the word. Stands in
+// for a real voice when previewing timing, and for testing the pipeline;
+// `latency` simulates a slow engine.
+class ToneTtsEngine : public TtsEngine {
+public:
+  explicit ToneTtsEngine(std::chrono::milliseconds latency = std::chrono::milliseconds(0))
+    : latency_(latency) {}
+
+  bool synthesize(const std::string& text, uint32_t sample_rate,
+                  TtsClock::time_point deadline, AudioClip& out, std::string& error) override;
+
+private:
+  std::chrono::milliseconds latency_;
+};
+
+struct TtsStats {
+  uint64_t synthesized = 0; // engine runs that produced audio
+  uint64_t cache_hits = 0;  // phrases served from the cache
+  uint64_t late = 0;        // not ready when the alert started (played silent)
+  uint64_t failed = 0;      // engine errors and timeouts
+};
+
+// Background speech for queued events.
+//
+// request() is called as an event is queued, keyed by its dedupe hash, and
+// hands the phrase to the shared worker pool (at most `workers` at a time
+// per pipeline); take() is called when the alert
+// starts and never blocks: it returns the clip if synthesis finished, or
+// nullptr (silent alert) if it is still running or failed. Each job has a
+// deadline measured from request(); the engine is stopped there. Finished
+// phrases go into an LRU cache, so repeated messages are synthesized once.
+// start() and stop() never wait for the engine, so settings changes can
+// restart the pipeline from the video thread.
+class TtsPipeline {
+public:
+  static constexpr size_t kMaxPending = 256;                   // requests awaiting take()
+  static constexpr size_t kCacheBytes = 32ull * 1024 * 1024;   // decoded PCM kept for repeats
+
+  TtsPipeline() = default;
+  ~TtsPipeline();
+
+  TtsPipeline(const TtsPipeline&) = delete;
+  TtsPipeline& operator=(const TtsPipeline&) = delete;
+
+  // (Re)starts the pipeline; clears pending requests but keeps the cache when
+  // the engine config (`engine_key`) and rate are unchanged
+  void start(std::shared_ptr<TtsEngine> engine, const std::string& engine_key, uint32_t sample_rate,
+             std::chrono::milliseconds deadline, int workers = 2);
+  void stop();
+
+  bool running() const;
+
+  void request(uint64_t key, std::string text);
+  std::shared_ptr<const AudioClip> take(uint64_t key);
+
+  TtsStats stats() const;
+
+private:
+  enum class State { Queued, Running, Ready, Failed };
+
+  struct Slot {
+    State state = State::Queued;
+    std::string text;
+    uint64_t phrase = 0;
+    TtsClock::time_point deadline;
+    std::shared_ptr<const AudioClip> clip;
+  };
+
+  struct CacheEntry {
+    uint64_t phrase;
+    std::shared_ptr<const AudioClip> clip;
+    size_t bytes;
+  };
+
+  void run(uint64_t generation);
+  std::shared_ptr<const AudioClip> cache_get(uint64_t phrase);
+  void cache_put(uint64_t phrase, std::shared_ptr<const AudioClip> clip);
+  void drop_oldest_pending();
+
+  mutable std::mutex mutex_;
+  TaskGroup tasks_;
+  int  max_workers_ = 0;   // 0 = not started
+  int  active_ = 0;        // pool tasks of this generation working through jobs_
+  uint64_t generation_ = 0; // bumped by stop(); older tasks drop their results
+
+  std::shared_ptr<TtsEngine> engine_;
+  std::string engine_key_;
+  uint32_t rate_ = 48000;
+  std::chrono::milliseconds deadline_{3000};
+
+  std::unordered_map<uint64_t, Slot> slots_; // by event dedupe hash
+  std::deque<uint64_t> order_;               // request order of slots_, for eviction
+  std::deque<uint64_t> jobs_;                // slots waiting for a worker
+
+  std::list<CacheEntry> lru_;                // front = most recent
+  std::unordered_map<uint64_t, std::list<CacheEntry>::iterator> cache_;
+  size_t cache_bytes_ = 0;
+
+  TtsStats stats_;
+};
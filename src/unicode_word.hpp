@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Code point classes for word boundaries (moderation whole-word terms).
+
+constexpr char32_t kInvalidCodePoint = 0xFFFFFFFF;
+
+// Letters, combining marks and numbers in any script, plus '_'. Emoji (with
+// their variation selectors), punctuation such as "—", "…", "«", and spaces
+// are not word characters.
+bool is_word_code_point(char32_t cp);
+
+// Code point starting at d[i]; kInvalidCodePoint for a malformed or cut sequence
+char32_t utf8_decode_at(const uint8_t* d, size_t n, size_t i);
+
+// Code point ending right before d[end] (the one a match at `end` touches)
+char32_t utf8_decode_before(const uint8_t* d, size_t n, size_t end);
@@ -0,0 +1,125 @@
+#include "worker_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+WorkerPool::WorkerPool(int threads)
+{
+  for (int i = 0; i < std::max(1, threads); ++i)
+    threads_.emplace_back([this]() { run(); });
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    stopping_ = true;
+    tasks_.clear();
+  }
+  cv_.notify_all();
+
+  for (std::thread& t : threads_)
+    t.join();
+}
+
+void WorkerPool::post(std::function<void()> task)
+{
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (stopping_)
+      return;
+    tasks_.push_back(std::move(task));
+  }
+  cv_.notify_one();
+}
+
+void WorkerPool::run()
+{
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lk(mutex_);
+      cv_.wait(lk, [&]() { return stopping_ || !tasks_.empty(); });
+      if (stopping_)
+        return;
+
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+std::shared_ptr<WorkerPool> acquire_worker_pool()
+{
+  static std::mutex mutex;
+  static std::weak_ptr<WorkerPool> shared;
+
+  std::lock_guard<std::mutex> lk(mutex);
+
+  if (auto existing = shared.lock())
+    return existing;
+
+  // enough for a decode and a synthesis side by side, no more
+  const int threads = std::clamp((int)std::thread::hardware_concurrency() / 2, 2, 4);
+  auto pool = std::make_shared<WorkerPool>(threads);
+  shared = pool;
+  return pool;
+}
+
+bool TaskGroup::post(std::function<void()> task)
+{
+  std::shared_ptr<WorkerPool> pool;
+  uint64_t generation = 0;
+  {
+    std::lock_guard<std::mutex> lk(state_->mutex);
+    if (state_->cancelled)
+      return false;
+    if (!state_->pool)
+      state_->pool = acquire_worker_pool();
+    pool = state_->pool;
+    generation = state_->generation;
+  }
+
+  pool->post([state = state_, generation, task = std::move(task)]() {
+    {
+      std::lock_guard<std::mutex> lk(state->mutex);
+      if (state->cancelled || state->generation != generation)
+        return;
+      state->running++;
+    }
+
+    task();
+
+    std::lock_guard<std::mutex> lk(state->mutex);
+    if (--state->running == 0)
+      state->idle.notify_all();
+  });
+  return true;
+}
+
+void TaskGroup::cancel()
+{
+  std::unique_lock<std::mutex> lk(state_->mutex);
+  state_->cancelled = true;
+  state_->generation++;
+  state_->idle.wait(lk, [&]() { return state_->running == 0; });
+}
+
+TaskGroup::~TaskGroup()
+{
+  cancel();
+
+  // Let go of the pool here, not from a queued task still holding the
+  // state: the last reference stops the pool, which must not happen on
+  // one of its own threads.
+  std::shared_ptr<WorkerPool> pool;
+  std::lock_guard<std::mutex> lk(state_->mutex);
+  pool = std::move(state_->pool);
+}
+
+void TaskGroup::reopen()
+{
+  std::lock_guard<std::mutex> lk(state_->mutex);
+  state_->cancelled = false;
+}
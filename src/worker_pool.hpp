@@ -0,0 +1,70 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A few background threads shared by every alert source in the process.
+// Sound decoding, media checks and speech synthesis post their work here
+// instead of each starting threads of their own, so the thread count stays
+// fixed however many sources a scene collection has.
+class WorkerPool {
+public:
+  explicit WorkerPool(int threads);
+  ~WorkerPool(); // drops queued tasks, waits for running ones
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  void post(std::function<void()> task);
+
+  int threads() const { return (int)threads_.size(); }
+
+private:
+  void run();
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  std::vector<std::thread> threads_;
+  bool stopping_ = false;
+};
+
+// The process-wide pool: started on first use, stopped when the last
+// TaskGroup holding it goes away
+std::shared_ptr<WorkerPool> acquire_worker_pool();
+
+// One owner's work on the shared pool. cancel() drops the group's queued
+// tasks and waits for the ones already running, so tasks can safely
+// capture the owner; it never waits for other groups' tasks.
+class TaskGroup {
+public:
+  TaskGroup() = default;
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  // False (task dropped) after cancel(), until reopen()
+  bool post(std::function<void()> task);
+
+  void cancel();
+  void reopen();
+
+private:
+  struct State {
+    std::mutex mutex;
+    std::condition_variable idle;
+    int      running = 0;
+    uint64_t generation = 0; // bumped by cancel(): older queued tasks are dropped
+    bool     cancelled = false;
+    std::shared_ptr<WorkerPool> pool; // acquired by the first post()
+  };
+
+  std::shared_ptr<State> state_ = std::make_shared<State>();
+};
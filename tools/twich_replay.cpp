@@ -0,0 +1,335 @@
+// Headless replay of a record-mode capture (see capture_file.hpp).
+//
+// Feeds every captured bot update through the same parse -> dedupe -> queue
+// -> AlertScheduler path the plugin uses, on a virtual clock stepped at the
+// OBS frame rate, and prints the resulting alert timeline. Idle gaps are
+// skipped, so an evening of captures replays in well under a second.
+//
+//   twich_replay <capture.twcap> [--fps N] [--words list.txt] [--policy mask|drop|hold]
+//                [--routes routes.json]
+//
+// --words runs the moderation stage with a word list; held events are
+// reported but never approved (there is nobody to approve them).
+// --routes prints where the routing rules send each event; the timeline
+// itself is the one every source would play.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "alert_scheduler.hpp"
+#include "capture_file.hpp"
+#include "event_ingest.hpp"
+#include "event_queue.hpp"
+#include "event_router.hpp"
+#include "media_probe.hpp"
+
+using nlohmann::json;
+
+namespace {
+
+const char* kind_name(EventKind k)
+{
+  switch (k) {
+  case EventKind::Tip:    return "tip";
+  case EventKind::Follow: return "follow";
+  case EventKind::Sub:    return "sub";
+  }
+  return "?";
+}
+
+const char* policy_name(int p)
+{
+  switch ((OverflowPolicy)p) {
+  case OverflowPolicy::Reject:    return "reject";
+  case OverflowPolicy::Summarize: return "summarize";
+  case OverflowPolicy::Spill:     return "spill";
+  }
+  return "?";
+}
+
+// One line per alert: newlines in rendered text become " / "
+std::string one_line(const std::string& s)
+{
+  std::string out;
+  for (char c : s) {
+    if (c == '\n') out += " / ";
+    else out += c;
+  }
+  return out;
+}
+
+struct Replay {
+  AlertProfile   profiles[kEventKindCount];
+  CaptureConfig  cfg;
+  TipEventQueue  queue;
+  DedupeWindow   dedupe;
+  ModerationStage moderation;
+  ApprovalQueue  held;
+  AlertScheduler sched;
+  std::string    spill_path;
+
+  std::map<std::string, float> media_len; // probed on first use
+
+  uint64_t updates = 0, filtered = 0, not_events = 0, events = 0;
+  uint64_t duplicates = 0, dropped = 0, blocked = 0, played = 0;
+
+  void apply_config(const CaptureConfig& c)
+  {
+    cfg = c;
+    for (int k = 0; k < kEventKindCount; ++k)
+      build_alert_profile(profiles[k], (EventKind)k, cfg.tiers[k], cfg.text_template[k], cfg.duration_sec);
+
+    queue.configure((size_t)cfg.queue_budget_kb * 1024, (OverflowPolicy)cfg.queue_policy, spill_path);
+    sched.set_lanes(cfg.lanes);
+
+    sched.set_media_duration([this](const std::string& path) -> float {
+      if (!cfg.duration_from_media)
+        return 0.0f;
+      auto it = media_len.find(path);
+      if (it == media_len.end()) {
+        MediaInfo mi;
+        std::string err;
+        const float len = probe_media_file(path, mi, err) ? (float)mi.duration_sec : 0.0f;
+        it = media_len.emplace(path, len).first;
+      }
+      return it->second;
+    });
+  }
+};
+
+// "-> A, B (scene X)" for one routed event
+std::string route_text(const RouteTable& routes, const TipEvent& ev)
+{
+  RouteMatch m;
+  routes.evaluate(ev, m);
+  if (m.drop)
+    return "dropped by " + routes.rule(m.rules[0]).name;
+  if (m.count == 0)
+    return "no rule (fallback sources)";
+
+  std::string out;
+  for (int i = 0; i < m.count; ++i) {
+    for (const std::string& s : routes.rule(m.rules[i]).sources)
+      out += (out.empty() ? "" : ", ") + s;
+  }
+  if (out.empty())
+    out = "fallback sources";
+  const std::string_view scene = routes.scene(m);
+  if (!scene.empty())
+    out += " (scene " + std::string(scene) + ")";
+  return out;
+}
+
+void print_at(double t, const char* what, const std::string& detail)
+{
+  printf("%+10.3fs  %-9s %s\n", t, what, detail.c_str());
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <capture.twcap> [--fps N] [--words list.txt] [--policy mask|drop|hold]"
+                    " [--routes routes.json]\n", argv[0]);
+    return 2;
+  }
+
+  const std::string path = argv[1];
+  int fps = 60;
+  std::string words_path;
+  std::string routes_path;
+  ModerationPolicy policy = ModerationPolicy::Mask;
+  for (int i = 2; i < argc; ++i) {
+    if (!strcmp(argv[i], "--fps") && i + 1 < argc) {
+      fps = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--routes") && i + 1 < argc) {
+      routes_path = argv[++i];
+    } else if (!strcmp(argv[i], "--words") && i + 1 < argc) {
+      words_path = argv[++i];
+    } else if (!strcmp(argv[i], "--policy") && i + 1 < argc) {
+      const char* p = argv[++i];
+      policy = !strcmp(p, "drop") ? ModerationPolicy::Drop
+             : !strcmp(p, "hold") ? ModerationPolicy::Hold
+             : ModerationPolicy::Mask;
+    }
+  }
+  if (fps <= 0) fps = 60;
+
+  CaptureReader reader;
+  if (!reader.open(path)) {
+    fprintf(stderr, "%s: not a capture file\n", path.c_str());
+    return 1;
+  }
+
+  std::vector<CaptureReader::Record> records;
+  CaptureReader::Record rec;
+  while (reader.next(rec))
+    records.push_back(std::move(rec));
+
+  if (records.empty()) {
+    printf("empty capture\n");
+    return 0;
+  }
+
+  const long long t0_ms = records.front().ts_ms;
+  const time_t t0 = (time_t)(t0_ms / 1000);
+  char t0_buf[64];
+  strftime(t0_buf, sizeof(t0_buf), "%Y-%m-%d %H:%M:%S UTC", gmtime(&t0));
+  printf("capture %s: %zu records from %s, %d fps\n", path.c_str(), records.size(), t0_buf, fps);
+
+  Replay r;
+  r.spill_path = path + ".replay_spill.jsonl";
+
+  if (!words_path.empty()) {
+    std::vector<std::string> terms;
+    std::string error;
+    if (!load_word_list(words_path, terms, error)) {
+      fprintf(stderr, "%s\n", error.c_str());
+      return 1;
+    }
+    auto matcher = std::make_shared<BlocklistMatcher>();
+    matcher->build(terms);
+    r.moderation.set(matcher, policy);
+    printf("word list: %zu terms\n", matcher->term_count());
+  }
+  RouteTable routes;
+  if (!routes_path.empty()) {
+    std::ifstream f(routes_path, std::ios::binary);
+    const std::string text((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    RouteSet set;
+    std::string error;
+    if (!f.good() && text.empty()) {
+      fprintf(stderr, "%s: cannot read\n", routes_path.c_str());
+      return 1;
+    }
+    if (!parse_route_set(text, set, error) || !routes.build(std::move(set), error)) {
+      fprintf(stderr, "%s: %s\n", routes_path.c_str(), error.c_str());
+      return 1;
+    }
+    printf("routes: %zu rules to %zu sources\n", routes.size(), routes.target_count());
+  }
+  r.apply_config(CaptureConfig()); // plugin defaults until the first Config record
+
+  const double dt = 1.0 / fps;
+  long long frame = 0;
+  size_t next = 0;
+
+  auto rel_sec = [&](const CaptureReader::Record& x) { return (double)(x.ts_ms - t0_ms) / 1000.0; };
+
+  for (;;) {
+    const double now = (double)frame * dt;
+
+    // deliver everything that arrived by this frame (TDLib thread side)
+    while (next < records.size() && rel_sec(records[next]) <= now) {
+      const CaptureReader::Record& x = records[next++];
+      const double at = rel_sec(x);
+
+      if (x.type == CaptureRecord::Config) {
+        CaptureConfig c;
+        if (capture_config_from_json(x.payload, c)) {
+          r.apply_config(c);
+          char buf[160];
+          snprintf(buf, sizeof(buf), "tiers %zu/%zu/%zu, duration %.1fs%s, queue %d KB (%s)",
+                   c.tiers[0].size(), c.tiers[1].size(), c.tiers[2].size(), c.duration_sec,
+                   c.duration_from_media ? " or media length" : "",
+                   c.queue_budget_kb, policy_name(c.queue_policy));
+          print_at(at, "config", buf);
+        }
+        continue;
+      }
+
+      if (x.type == CaptureRecord::Filtered) {
+        r.filtered++;
+        print_at(at, "filtered", "message from another sender: " + x.payload);
+        continue;
+      }
+
+      r.updates++;
+      long long chat_id = 0;
+      std::string text;
+      json u;
+      try { u = json::parse(x.payload); } catch (...) { continue; }
+      if (!text_from_tdlib_update(u, chat_id, text))
+        continue;
+
+      TipEvent ev;
+      const IngestResult res = ingest_message(text, r.dedupe, r.queue, &ev, &r.moderation, &r.held);
+      if (res == IngestResult::NotEvent) {
+        r.not_events++;
+        continue;
+      }
+
+      r.events++;
+      const char* outcome = "queued";
+      if (res == IngestResult::Duplicate) { outcome = "DUPLICATE"; r.duplicates++; }
+      if (res == IngestResult::Dropped)   { outcome = "DROPPED (queue full)"; r.dropped++; }
+      if (res == IngestResult::Blocked)   { outcome = "BLOCKED (word list)"; r.blocked++; }
+      if (res == IngestResult::Held)      { outcome = "HELD (word list)"; r.blocked++; }
+
+      char buf[256];
+      snprintf(buf, sizeof(buf), "%s %.*s %.*s %s -> %s (hash %016llx)",
+               kind_name(ev.kind),
+               (int)ev.from_username().size(), ev.from_username().data(),
+               (int)ev.amount_str().size(), ev.amount_str().data(),
+               ev.symbol, outcome, (unsigned long long)ev.dedupe_hash);
+      print_at(at, "event", buf);
+      if (!routes.empty())
+        print_at(at, "route", route_text(routes, ev));
+    }
+
+    // video tick side
+    const uint32_t ended = r.sched.advance((float)dt);
+    for (int i = 0; i < AlertScheduler::kMaxLanes; ++i)
+      if (ended & (1u << i))
+        print_at(now, "end", "lane " + std::to_string(i));
+
+    AlertStart st;
+    while (r.sched.start_next(r.queue, r.profiles, r.cfg.duration_sec, st)) {
+      r.played++;
+      char buf[112];
+      if (st.tier)
+        snprintf(buf, sizeof(buf), "lane %d %s tier %d (%.2fs)", st.lane, kind_name(st.ev.kind),
+                 st.tier->index + 1, st.duration_sec);
+      else
+        snprintf(buf, sizeof(buf), "lane %d %s no tier (%.2fs)", st.lane, kind_name(st.ev.kind),
+                 st.duration_sec);
+
+      std::string detail = buf;
+      if (st.tier && !st.tier->media.empty())
+        detail += " media=" + st.tier->media;
+      detail += " \"" + one_line(st.text) + "\"";
+      print_at(now, "START", detail);
+    }
+
+    if (!r.sched.playing()) {
+      if (next >= records.size())
+        break;
+
+      // nothing to play: jump to the frame of the next record
+      const long long f = (long long)(rel_sec(records[next]) / dt);
+      if (f > frame) {
+        frame = f;
+        continue;
+      }
+    }
+
+    frame++;
+  }
+
+  r.queue.clear();
+
+  printf("\n%llu bot updates (%llu not events), %llu filtered, %llu events: "
+         "%llu duplicates, %llu dropped, %llu blocked/held, %llu alerts played\n",
+         (unsigned long long)r.updates, (unsigned long long)r.not_events,
+         (unsigned long long)r.filtered, (unsigned long long)r.events,
+         (unsigned long long)r.duplicates, (unsigned long long)r.dropped,
+         (unsigned long long)r.blocked, (unsigned long long)r.played);
+  return 0;
+}